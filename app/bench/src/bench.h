@@ -0,0 +1,190 @@
+/**
+ * @file bench.h
+ * @brief Micro-benchmarks for the inter-thread queues and buffers
+ * @details Every implementation under test is wrapped in a bench_impl_t so
+ * the same access patterns and thread mixes run against safe_queue,
+ * safe_buffer and the kernel primitives they can be compared with. Results
+ * are printed as CSV rows (see BENCH_CSV_HEADER); lines starting with '#'
+ * are comments.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#if !defined(CONFIG_BOARD_NATIVE_SIM)
+#include <zephyr/timing/timing.h>
+#endif
+
+/*============================================================================*/
+/* Benchmark Constants                                                        */
+/*============================================================================*/
+
+/** @defgroup BenchConfig Benchmark Configuration
+ * @{
+ */
+
+/** @brief Operations per timed single-thread run */
+#define BENCH_OPS                      20000U
+
+/** @brief Untimed operations before each run */
+#define BENCH_WARMUP_OPS               1000U
+
+/** @brief Elements moved end to end per producer/consumer run */
+#define BENCH_THREAD_ELEMS             8000U
+
+/** @brief Largest element and capacities the adapters are sized for */
+#define BENCH_MAX_ELEM_SIZE            256U
+#define BENCH_MAX_QUEUE_CAPACITY       32U
+#define BENCH_MAX_BUFFER_CAPACITY      4096U
+
+/** @brief Most producer plus consumer threads in one run */
+#define BENCH_MAX_THREADS              8U
+
+/** @brief Stack size of each producer/consumer thread */
+#define BENCH_THREAD_STACK_SIZE        1024U
+
+/** @brief Priority of the producer/consumer threads (main waits below them) */
+#define BENCH_THREAD_PRIORITY          5
+
+/** @brief CSV header matching bench_print_result() */
+#define BENCH_CSV_HEADER \
+    "impl,pattern,elem_size,capacity,producers,consumers,ops,elapsed_ns," \
+    "ops_per_sec,ns_per_op,cycles_per_op"
+
+/** @} */ /* End of BenchConfig group */
+
+/*============================================================================*/
+/* Benchmark Types                                                            */
+/*============================================================================*/
+
+/**
+ * @brief Access patterns of the single-thread runs
+ */
+typedef enum {
+    BENCH_PATTERN_PINGPONG = 0,     /**< One put, one get: the container never holds more than one element */
+    BENCH_PATTERN_BURST,            /**< Fill to full, then drain to empty */
+    BENCH_PATTERN_STRADDLE,         /**< Ping-pong behind a one-unit standing offset, so byte
+                                         buffers split writes and reads at the wrap point */
+    BENCH_PATTERN_MAX
+} bench_pattern_t;
+
+/**
+ * @brief Implementation under test
+ * @details Capacity is in elements for queues and in bytes for buffers.
+ * put and get are non-blocking and return the bytes moved (0 when full or
+ * empty); queues move whole elements, buffers may move part of one.
+ */
+typedef struct {
+    const char *name;
+    bool thread_safe;               /**< May be shared by several threads */
+    bool byte_stream;               /**< Capacity in bytes, elements may be split */
+    size_t max_capacity;
+    int (*init)(size_t capacity, size_t elem_size);
+    size_t (*put)(const uint8_t *data, size_t size);
+    size_t (*get)(uint8_t *data, size_t size);
+} bench_impl_t;
+
+/** @brief Timestamp for bench_clock_elapsed() */
+typedef struct {
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    uint64_t ns;
+    uint64_t cycles;
+#else
+    timing_t counter;
+#endif
+} bench_stamp_t;
+
+/** @brief One benchmark result (one CSV row) */
+typedef struct {
+    const char *impl;
+    const char *pattern;
+    size_t elem_size;
+    size_t capacity;
+    uint32_t producers;
+    uint32_t consumers;
+    uint32_t ops;                   /**< Successful put and get calls */
+    uint64_t elapsed_ns;
+    uint64_t cycles;
+} bench_result_t;
+
+/*============================================================================*/
+/* Implementations Under Test                                                 */
+/*============================================================================*/
+
+extern const bench_impl_t bench_impl_safe_queue;
+extern const bench_impl_t bench_impl_msgq;
+extern const bench_impl_t bench_impl_safe_buffer;
+extern const bench_impl_t bench_impl_ring_buf;
+
+/*============================================================================*/
+/* Benchmark API                                                              */
+/*============================================================================*/
+
+/**
+ * @brief Prepare the cycle counter
+ */
+void bench_clock_init(void);
+
+/**
+ * @brief Take a timestamp
+ */
+void bench_clock_now(bench_stamp_t *stamp);
+
+/**
+ * @brief Time between two timestamps
+ *
+ * @param start Earlier timestamp
+ * @param end Later timestamp
+ * @param[out] ns Elapsed nanoseconds
+ * @param[out] cycles Elapsed CPU cycles (TSC ticks on an x86 host, 0 if unknown)
+ */
+void bench_clock_elapsed(const bench_stamp_t *start, const bench_stamp_t *end,
+                         uint64_t *ns, uint64_t *cycles);
+
+/**
+ * @brief Name of the clock behind the cycle counts, for the CSV comments
+ */
+const char *bench_clock_source(void);
+
+/**
+ * @brief Time one access pattern on a single thread
+ *
+ * @param impl Implementation under test
+ * @param pattern Access pattern
+ * @param elem_size Bytes per put and get
+ * @param capacity Capacity handed to impl->init()
+ * @param[out] result Filled on success
+ * @return 0 on success, negative if the combination is not supported
+ */
+int bench_run_pattern(const bench_impl_t *impl, bench_pattern_t pattern,
+                      size_t elem_size, size_t capacity, bench_result_t *result);
+
+/**
+ * @brief Time BENCH_THREAD_ELEMS elements through producer and consumer threads
+ *
+ * @param impl Implementation under test (must be thread_safe)
+ * @param producers Producer thread count
+ * @param consumers Consumer thread count
+ * @param elem_size Bytes per element
+ * @param capacity Capacity handed to impl->init()
+ * @param[out] result Filled on success
+ * @return 0 on success, negative if the combination is not supported
+ */
+int bench_run_threads(const bench_impl_t *impl, uint32_t producers, uint32_t consumers,
+                      size_t elem_size, size_t capacity, bench_result_t *result);
+
+/**
+ * @brief Print a result as one CSV row
+ */
+void bench_print_result(const bench_result_t *result);
+
+#endif /* BENCH_H */
@@ -0,0 +1,80 @@
+/**
+ * @file bench_clock.c
+ * @brief Benchmark timestamps
+ * @details Targets use the kernel timing API (the DWT cycle counter where
+ * the core has one). native_sim cannot: its simulated clock only advances
+ * when the CPU idles, so a busy benchmark loop would take no time at all.
+ * There the host's monotonic clock and time-stamp counter are read through
+ * bench_host_clock.c, which is built into the native simulator.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "bench.h"
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+/* Host side (bench_host_clock.c) */
+extern uint64_t bench_host_time_ns(void);
+extern uint64_t bench_host_cycles(void);
+#endif
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Prepare the cycle counter
+ */
+void bench_clock_init(void)
+{
+#if !defined(CONFIG_BOARD_NATIVE_SIM)
+    timing_init();
+    timing_start();
+#endif
+}
+
+/**
+ * @brief Take a timestamp
+ */
+void bench_clock_now(bench_stamp_t *stamp)
+{
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    stamp->cycles = bench_host_cycles();
+    stamp->ns = bench_host_time_ns();
+#else
+    stamp->counter = timing_counter_get();
+#endif
+}
+
+/**
+ * @brief Time between two timestamps
+ */
+void bench_clock_elapsed(const bench_stamp_t *start, const bench_stamp_t *end,
+                         uint64_t *ns, uint64_t *cycles)
+{
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    *ns = end->ns - start->ns;
+    *cycles = end->cycles - start->cycles;
+#else
+    timing_t from = start->counter;
+    timing_t to = end->counter;
+
+    *cycles = timing_cycles_get(&from, &to);
+    *ns = timing_cycles_to_ns(*cycles);
+#endif
+}
+
+/**
+ * @brief Name of the clock behind the cycle counts
+ */
+const char *bench_clock_source(void)
+{
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    return "host monotonic clock, host TSC";
+#else
+    return "timing API cycle counter";
+#endif
+}
@@ -0,0 +1,40 @@
+/**
+ * @file bench_host_clock.c
+ * @brief Host clock for native_sim benchmark runs
+ * @details Built into the native simulator rather than the Zephyr image, so
+ * it runs against the host C library.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Host monotonic time in nanoseconds
+ */
+uint64_t bench_host_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Host time-stamp counter (0 where there is none)
+ */
+uint64_t bench_host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
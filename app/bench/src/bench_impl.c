@@ -0,0 +1,176 @@
+/**
+ * @file bench_impl.c
+ * @brief Implementations under test
+ * @details safe_queue hands over pointers, so its cost does not depend on
+ * the element size; k_msgq copies every element in and out and is the
+ * kernel's answer to the same problem. safe_buffer is compared against the
+ * lock-free sys ring buffer, which is single-producer single-consumer only
+ * and so is left out of the threaded runs.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "bench.h"
+#include "safe_queue.h"
+#include "safe_buffer.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static safe_queue_t queue;
+static safe_buffer_t buffer;
+static struct k_msgq msgq;
+static struct ring_buf ring;
+
+/** @brief Storage shared by the copying implementations (one runs at a time) */
+static uint8_t __aligned(4) storage[BENCH_MAX_BUFFER_CAPACITY * 2U];
+
+BUILD_ASSERT(sizeof(storage) >= BENCH_MAX_QUEUE_CAPACITY * BENCH_MAX_ELEM_SIZE,
+             "storage too small for the largest message queue");
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static int safe_queue_bench_init(size_t capacity, size_t elem_size);
+static size_t safe_queue_bench_put(const uint8_t *data, size_t size);
+static size_t safe_queue_bench_get(uint8_t *data, size_t size);
+static int msgq_bench_init(size_t capacity, size_t elem_size);
+static size_t msgq_bench_put(const uint8_t *data, size_t size);
+static size_t msgq_bench_get(uint8_t *data, size_t size);
+static int safe_buffer_bench_init(size_t capacity, size_t elem_size);
+static size_t safe_buffer_bench_put(const uint8_t *data, size_t size);
+static size_t safe_buffer_bench_get(uint8_t *data, size_t size);
+static int ring_buf_bench_init(size_t capacity, size_t elem_size);
+static size_t ring_buf_bench_put(const uint8_t *data, size_t size);
+static size_t ring_buf_bench_get(uint8_t *data, size_t size);
+
+/*============================================================================*/
+/* Public Variables                                                           */
+/*============================================================================*/
+
+const bench_impl_t bench_impl_safe_queue = {
+    .name = "safe_queue",
+    .thread_safe = true,
+    .byte_stream = false,
+    .max_capacity = SAFE_QUEUE_MAX_SIZE,
+    .init = safe_queue_bench_init,
+    .put = safe_queue_bench_put,
+    .get = safe_queue_bench_get,
+};
+
+const bench_impl_t bench_impl_msgq = {
+    .name = "k_msgq",
+    .thread_safe = true,
+    .byte_stream = false,
+    .max_capacity = BENCH_MAX_QUEUE_CAPACITY,
+    .init = msgq_bench_init,
+    .put = msgq_bench_put,
+    .get = msgq_bench_get,
+};
+
+const bench_impl_t bench_impl_safe_buffer = {
+    .name = "safe_buffer",
+    .thread_safe = true,
+    .byte_stream = true,
+    .max_capacity = BENCH_MAX_BUFFER_CAPACITY,
+    .init = safe_buffer_bench_init,
+    .put = safe_buffer_bench_put,
+    .get = safe_buffer_bench_get,
+};
+
+const bench_impl_t bench_impl_ring_buf = {
+    .name = "ring_buf",
+    .thread_safe = false,
+    .byte_stream = true,
+    .max_capacity = BENCH_MAX_BUFFER_CAPACITY,
+    .init = ring_buf_bench_init,
+    .put = ring_buf_bench_put,
+    .get = ring_buf_bench_get,
+};
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+static int safe_queue_bench_init(size_t capacity, size_t elem_size)
+{
+    ARG_UNUSED(elem_size);
+
+    return safe_queue_init(&queue, capacity);
+}
+
+static size_t safe_queue_bench_put(const uint8_t *data, size_t size)
+{
+    return (safe_queue_enqueue_nb(&queue, data, size) == QUEUE_OK) ? size : 0U;
+}
+
+static size_t safe_queue_bench_get(uint8_t *data, size_t size)
+{
+    ARG_UNUSED(data);
+    ARG_UNUSED(size);
+
+    queue_item_t item;
+
+    return (safe_queue_dequeue_nb(&queue, &item) == QUEUE_OK) ? item.size : 0U;
+}
+
+static int msgq_bench_init(size_t capacity, size_t elem_size)
+{
+    k_msgq_init(&msgq, (char *)storage, elem_size, (uint32_t)capacity);
+    return 0;
+}
+
+static size_t msgq_bench_put(const uint8_t *data, size_t size)
+{
+    return (k_msgq_put(&msgq, data, K_NO_WAIT) == 0) ? size : 0U;
+}
+
+static size_t msgq_bench_get(uint8_t *data, size_t size)
+{
+    return (k_msgq_get(&msgq, data, K_NO_WAIT) == 0) ? size : 0U;
+}
+
+static int safe_buffer_bench_init(size_t capacity, size_t elem_size)
+{
+    ARG_UNUSED(elem_size);
+
+    return safe_buffer_init(&buffer, storage, capacity, false);
+}
+
+static size_t safe_buffer_bench_put(const uint8_t *data, size_t size)
+{
+    size_t written = 0;
+
+    return (safe_buffer_write_nb(&buffer, data, size, &written) == BUFFER_OK) ? written : 0U;
+}
+
+static size_t safe_buffer_bench_get(uint8_t *data, size_t size)
+{
+    size_t read_bytes = 0;
+
+    return (safe_buffer_read_nb(&buffer, data, size, &read_bytes) == BUFFER_OK) ? read_bytes : 0U;
+}
+
+static int ring_buf_bench_init(size_t capacity, size_t elem_size)
+{
+    ARG_UNUSED(elem_size);
+
+    ring_buf_init(&ring, (uint32_t)capacity, storage);
+    return 0;
+}
+
+static size_t ring_buf_bench_put(const uint8_t *data, size_t size)
+{
+    return ring_buf_put(&ring, data, (uint32_t)size);
+}
+
+static size_t ring_buf_bench_get(uint8_t *data, size_t size)
+{
+    return ring_buf_get(&ring, data, (uint32_t)size);
+}
@@ -0,0 +1,291 @@
+/**
+ * @file bench_runner.c
+ * @brief Access patterns and producer/consumer runs
+ * @details Threaded runs use equal-priority threads that yield when their
+ * side is full or empty. Without time slicing that makes every hand-over a
+ * full container's worth of elements, which is also how the application's
+ * pipeline threads behave.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "bench.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static const char *const pattern_names[BENCH_PATTERN_MAX] = {
+    [BENCH_PATTERN_PINGPONG] = "pingpong",
+    [BENCH_PATTERN_BURST] = "burst",
+    [BENCH_PATTERN_STRADDLE] = "straddle",
+};
+
+/** @brief Single-thread element buffers */
+static uint8_t elem_in[BENCH_MAX_ELEM_SIZE];
+static uint8_t elem_out[BENCH_MAX_ELEM_SIZE];
+
+K_THREAD_STACK_ARRAY_DEFINE(bench_stacks, BENCH_MAX_THREADS, BENCH_THREAD_STACK_SIZE);
+static struct k_thread bench_threads[BENCH_MAX_THREADS];
+
+/** @brief Shared state of a producer/consumer run */
+static struct {
+    const bench_impl_t *impl;
+    size_t elem_size;
+    uint32_t quota;                 /* Elements per producer */
+    atomic_val_t total_bytes;
+    atomic_t consumed;              /* Bytes taken out so far */
+    atomic_t ops;
+} run;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static uint32_t run_ops(const bench_impl_t *impl, bench_pattern_t pattern,
+                        size_t elem_size, uint32_t target);
+static void producer_thread(void *arg1, void *arg2, void *arg3);
+static void consumer_thread(void *arg1, void *arg2, void *arg3);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Time one access pattern on a single thread
+ */
+int bench_run_pattern(const bench_impl_t *impl, bench_pattern_t pattern,
+                      size_t elem_size, size_t capacity, bench_result_t *result)
+{
+    if (pattern >= BENCH_PATTERN_MAX || elem_size == 0U || elem_size > BENCH_MAX_ELEM_SIZE ||
+        capacity > impl->max_capacity) {
+        return -EINVAL;
+    }
+
+    /* Byte buffers need room for an element (plus the offset) to move it whole */
+    if (impl->byte_stream) {
+        size_t needed = elem_size + ((pattern == BENCH_PATTERN_STRADDLE) ? 1U : 0U);
+
+        if (needed > capacity) {
+            return -ENOTSUP;
+        }
+    }
+
+    if (impl->init(capacity, elem_size) != 0) {
+        return -EINVAL;
+    }
+
+    memset(elem_in, 0xA5, sizeof(elem_in));
+
+    /* One unit parked in the container: an element for queues, a byte for buffers */
+    if (pattern == BENCH_PATTERN_STRADDLE && impl->put(elem_in, 1U) == 0U) {
+        return -EIO;
+    }
+
+    if (run_ops(impl, pattern, elem_size, BENCH_WARMUP_OPS) == 0U) {
+        return -EIO;
+    }
+
+    bench_stamp_t start;
+    bench_stamp_t end;
+
+    bench_clock_now(&start);
+    uint32_t ops = run_ops(impl, pattern, elem_size, BENCH_OPS);
+    bench_clock_now(&end);
+
+    if (ops == 0U) {
+        return -EIO;
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->impl = impl->name;
+    result->pattern = pattern_names[pattern];
+    result->elem_size = elem_size;
+    result->capacity = capacity;
+    result->producers = 1U;
+    result->consumers = 1U;
+    result->ops = ops;
+    bench_clock_elapsed(&start, &end, &result->elapsed_ns, &result->cycles);
+
+    return 0;
+}
+
+/**
+ * @brief Time BENCH_THREAD_ELEMS elements through producer and consumer threads
+ */
+int bench_run_threads(const bench_impl_t *impl, uint32_t producers, uint32_t consumers,
+                      size_t elem_size, size_t capacity, bench_result_t *result)
+{
+    if (!impl->thread_safe || producers == 0U || consumers == 0U ||
+        producers + consumers > BENCH_MAX_THREADS ||
+        elem_size == 0U || elem_size > BENCH_MAX_ELEM_SIZE || capacity > impl->max_capacity) {
+        return -EINVAL;
+    }
+
+    if (impl->init(capacity, elem_size) != 0) {
+        return -EINVAL;
+    }
+
+    run.impl = impl;
+    run.elem_size = elem_size;
+    run.quota = BENCH_THREAD_ELEMS / producers;
+    run.total_bytes = (atomic_val_t)(run.quota * producers * elem_size);
+    atomic_set(&run.consumed, 0);
+    atomic_set(&run.ops, 0);
+
+    bench_stamp_t start;
+    bench_stamp_t end;
+    uint32_t count = producers + consumers;
+
+    bench_clock_now(&start);
+
+    /* Main outranks the workers, so none starts until all are created */
+    for (uint32_t i = 0; i < count; i++) {
+        k_thread_entry_t entry = (i < producers) ? producer_thread : consumer_thread;
+
+        k_thread_create(&bench_threads[i], bench_stacks[i], K_THREAD_STACK_SIZEOF(bench_stacks[i]),
+                        entry, (void *)(uintptr_t)i, NULL, NULL,
+                        BENCH_THREAD_PRIORITY, 0, K_NO_WAIT);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        k_thread_join(&bench_threads[i], K_FOREVER);
+    }
+
+    bench_clock_now(&end);
+
+    memset(result, 0, sizeof(*result));
+    result->impl = impl->name;
+    result->pattern = "threads";
+    result->elem_size = elem_size;
+    result->capacity = capacity;
+    result->producers = producers;
+    result->consumers = consumers;
+    result->ops = (uint32_t)atomic_get(&run.ops);
+    bench_clock_elapsed(&start, &end, &result->elapsed_ns, &result->cycles);
+
+    return 0;
+}
+
+/**
+ * @brief Print a result as one CSV row
+ */
+void bench_print_result(const bench_result_t *result)
+{
+    uint64_t ns = MAX(result->elapsed_ns, 1U);
+    uint64_t ops = MAX(result->ops, 1U);
+    uint64_t ops_per_sec = ops * 1000000000ULL / ns;
+    uint64_t ns_per_op_x100 = ns * 100U / ops;
+    uint64_t cycles_per_op_x100 = result->cycles * 100U / ops;
+
+    printk("%s,%s,%u,%u,%u,%u,%u,%llu,%llu,%llu.%02llu,%llu.%02llu\n",
+           result->impl, result->pattern,
+           (uint32_t)result->elem_size, (uint32_t)result->capacity,
+           result->producers, result->consumers, result->ops,
+           (unsigned long long)result->elapsed_ns, (unsigned long long)ops_per_sec,
+           (unsigned long long)(ns_per_op_x100 / 100U),
+           (unsigned long long)(ns_per_op_x100 % 100U),
+           (unsigned long long)(cycles_per_op_x100 / 100U),
+           (unsigned long long)(cycles_per_op_x100 % 100U));
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Run a pattern until at least target calls have succeeded
+ * @return Successful put and get calls, 0 if the container stopped moving
+ */
+static uint32_t run_ops(const bench_impl_t *impl, bench_pattern_t pattern,
+                        size_t elem_size, uint32_t target)
+{
+    uint32_t ops = 0;
+
+    while (ops < target) {
+        if (pattern == BENCH_PATTERN_BURST) {
+            uint32_t moved = 0;
+
+            while (impl->put(elem_in, elem_size) > 0U) {
+                moved++;
+            }
+            while (impl->get(elem_out, elem_size) > 0U) {
+                moved++;
+            }
+            if (moved == 0U) {
+                return 0U;
+            }
+            ops += moved;
+        } else {
+            if (impl->put(elem_in, elem_size) == 0U || impl->get(elem_out, elem_size) == 0U) {
+                return 0U;
+            }
+            ops += 2U;
+        }
+    }
+
+    return ops;
+}
+
+/**
+ * @brief Put run.quota elements, yielding while the container is full
+ */
+static void producer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint8_t elem[BENCH_MAX_ELEM_SIZE];
+    uint32_t ops = 0;
+
+    memset(elem, (int)(uintptr_t)arg1, sizeof(elem));
+
+    for (uint32_t i = 0; i < run.quota; i++) {
+        size_t sent = 0;
+
+        while (sent < run.elem_size) {
+            size_t n = run.impl->put(&elem[sent], run.elem_size - sent);
+
+            if (n == 0U) {
+                k_yield();
+                continue;
+            }
+            sent += n;
+            ops++;
+        }
+    }
+
+    atomic_add(&run.ops, (atomic_val_t)ops);
+}
+
+/**
+ * @brief Get until every produced byte has been taken, yielding while empty
+ */
+static void consumer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint8_t elem[BENCH_MAX_ELEM_SIZE];
+    uint32_t ops = 0;
+
+    while (atomic_get(&run.consumed) < run.total_bytes) {
+        size_t n = run.impl->get(elem, run.elem_size);
+
+        if (n == 0U) {
+            k_yield();
+            continue;
+        }
+        atomic_add(&run.consumed, (atomic_val_t)n);
+        ops++;
+    }
+
+    atomic_add(&run.ops, (atomic_val_t)ops);
+}
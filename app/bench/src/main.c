@@ -0,0 +1,197 @@
+/**
+ * @file main.c
+ * @brief Micro-benchmark runner for safe_queue and safe_buffer
+ * @details Sweeps element size, capacity and access pattern on one thread,
+ * then moves a fixed number of elements through 1..N producer and consumer
+ * threads. Every result is one CSV row on the console; capture it with
+ * `make bench-native` or `make bench-qemu`.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "bench.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+#include <posix_board_if.h>
+#endif
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief One single-thread sweep: implementations and the sizes to cross */
+typedef struct {
+    const bench_impl_t *const *impls;
+    size_t impl_count;
+    const size_t *capacities;
+    size_t capacity_count;
+    const size_t *elem_sizes;
+    size_t elem_size_count;
+} bench_sweep_t;
+
+/** @brief One producer/consumer mix */
+typedef struct {
+    uint32_t producers;
+    uint32_t consumers;
+} bench_mix_t;
+
+/** @brief Threaded run of one implementation */
+typedef struct {
+    const bench_impl_t *impl;
+    size_t capacity;
+    size_t elem_size;
+} bench_thread_case_t;
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static const bench_impl_t *const queue_impls[] = {
+    &bench_impl_safe_queue,
+    &bench_impl_msgq,
+};
+
+/* The application's queues hold 10-32 entries of up to a sensor_data_t */
+static const size_t queue_capacities[] = { 4U, 16U, 32U };
+static const size_t queue_elem_sizes[] = { 4U, 32U, 256U };
+
+static const bench_impl_t *const buffer_impls[] = {
+    &bench_impl_safe_buffer,
+    &bench_impl_ring_buf,
+};
+
+/* From a short frame buffer up to the largest transport buffer */
+static const size_t buffer_capacities[] = { 256U, 1024U, 4096U };
+static const size_t buffer_elem_sizes[] = { 1U, 16U, 64U, 256U };
+
+static const bench_sweep_t sweeps[] = {
+    {
+        .impls = queue_impls,
+        .impl_count = ARRAY_SIZE(queue_impls),
+        .capacities = queue_capacities,
+        .capacity_count = ARRAY_SIZE(queue_capacities),
+        .elem_sizes = queue_elem_sizes,
+        .elem_size_count = ARRAY_SIZE(queue_elem_sizes),
+    },
+    {
+        .impls = buffer_impls,
+        .impl_count = ARRAY_SIZE(buffer_impls),
+        .capacities = buffer_capacities,
+        .capacity_count = ARRAY_SIZE(buffer_capacities),
+        .elem_sizes = buffer_elem_sizes,
+        .elem_size_count = ARRAY_SIZE(buffer_elem_sizes),
+    },
+};
+
+static const bench_mix_t mixes[] = {
+    { 1U, 1U }, { 1U, 2U }, { 1U, 4U }, { 2U, 1U }, { 4U, 1U }, { 2U, 2U },
+};
+
+static const bench_thread_case_t thread_cases[] = {
+    { &bench_impl_safe_queue, 16U, 32U },
+    { &bench_impl_msgq, 16U, 32U },
+    { &bench_impl_safe_buffer, 1024U, 64U },
+};
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void run_sweep(const bench_sweep_t *sweep);
+static void run_thread_cases(void);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Benchmark entry point
+ */
+int main(void)
+{
+    bench_clock_init();
+
+    printk("# medical_wearable queue/buffer benchmarks\n");
+    printk("# board: %s\n", CONFIG_BOARD);
+    printk("# clock: %s\n", bench_clock_source());
+    printk("# ops per run: %u (+%u warm-up), elements per threaded run: %u\n",
+           BENCH_OPS, BENCH_WARMUP_OPS, BENCH_THREAD_ELEMS);
+    printk("%s\n", BENCH_CSV_HEADER);
+
+    for (size_t i = 0; i < ARRAY_SIZE(sweeps); i++) {
+        run_sweep(&sweeps[i]);
+    }
+
+    run_thread_cases();
+
+    printk("# done\n");
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    posix_exit(0);
+#endif
+
+    return 0;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Run every pattern for every implementation, capacity and element size
+ */
+static void run_sweep(const bench_sweep_t *sweep)
+{
+    bench_result_t result;
+
+    for (size_t i = 0; i < sweep->impl_count; i++) {
+        const bench_impl_t *impl = sweep->impls[i];
+
+        for (size_t c = 0; c < sweep->capacity_count; c++) {
+            for (size_t e = 0; e < sweep->elem_size_count; e++) {
+                for (int p = 0; p < BENCH_PATTERN_MAX; p++) {
+                    int ret = bench_run_pattern(impl, (bench_pattern_t)p,
+                                                sweep->elem_sizes[e],
+                                                sweep->capacities[c], &result);
+
+                    if (ret == 0) {
+                        bench_print_result(&result);
+                    } else if (ret != -ENOTSUP) {
+                        printk("# %s: pattern %d, elem %u, capacity %u failed (%d)\n",
+                               impl->name, p, (uint32_t)sweep->elem_sizes[e],
+                               (uint32_t)sweep->capacities[c], ret);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Run every producer/consumer mix for the thread-safe implementations
+ */
+static void run_thread_cases(void)
+{
+    bench_result_t result;
+
+    for (size_t i = 0; i < ARRAY_SIZE(thread_cases); i++) {
+        const bench_thread_case_t *tc = &thread_cases[i];
+
+        for (size_t m = 0; m < ARRAY_SIZE(mixes); m++) {
+            int ret = bench_run_threads(tc->impl, mixes[m].producers, mixes[m].consumers,
+                                        tc->elem_size, tc->capacity, &result);
+
+            if (ret == 0) {
+                bench_print_result(&result);
+            } else {
+                printk("# %s: %u producers, %u consumers failed (%d)\n",
+                       tc->impl->name, mixes[m].producers, mixes[m].consumers, ret);
+            }
+        }
+    }
+}
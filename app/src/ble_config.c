@@ -0,0 +1,490 @@
+/**
+ * @file ble_config.c
+ * @brief BLE GATT configuration service
+ * @details The attribute table is built from config_get_entry_info() and
+ * registered through the dynamic GATT database, so adding a configuration
+ * key adds its characteristic without touching this file. GATT callbacks run
+ * in the Bluetooth RX thread and the delayed commit on the system work
+ * queue; the staged transaction is shared between them under a mutex.
+ *
+ * Control point read layout, little-endian:
+ *   [staged keys u32][config version u32][restart pending keys u32][last commit result i8]
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "ble_config.h"
+#include "config.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Configuration service UUID */
+#define BLE_CONFIG_SERVICE_UUID_VAL \
+    BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1235, 0x56789abc0000)
+
+/** @brief Control point characteristic UUID */
+#define BLE_CONFIG_CONTROL_UUID_VAL \
+    BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1235, 0x56789abc0001)
+
+/** @brief Key characteristic UUIDs: this base plus the key number */
+#define BLE_CONFIG_KEY_UUID_BASE_VAL \
+    BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1235, 0x56789abc0010)
+
+/** @brief Attributes per key: declaration, value, user description, format */
+#define BLE_CONFIG_ATTRS_PER_KEY       4U
+
+/** @brief Service declaration, control point declaration and value, keys */
+#define BLE_CONFIG_ATTR_COUNT          (3U + CONFIG_KEY_MAX * BLE_CONFIG_ATTRS_PER_KEY)
+
+/** @brief Presentation format codes (Bluetooth Assigned Numbers) */
+#define BLE_CONFIG_CPF_BOOLEAN         0x01U
+#define BLE_CONFIG_CPF_UINT32          0x08U
+#define BLE_CONFIG_CPF_FLOAT32         0x14U
+#define BLE_CONFIG_CPF_UTF8S           0x19U
+#define BLE_CONFIG_CPF_STRUCT          0x1BU
+
+/** @brief Presentation format unit: unitless */
+#define BLE_CONFIG_CPF_UNITLESS        0x2700U
+
+/*
+ * Configuration changes always need an encrypted link. Without pairing
+ * support no link can be encrypted, so the service is registered read-only.
+ */
+#define BLE_CONFIG_WRITABLE            IS_ENABLED(CONFIG_BT_SMP)
+#define BLE_CONFIG_PERM_WRITE          BT_GATT_PERM_WRITE_ENCRYPT
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static struct bt_uuid_128 config_svc_uuid = BT_UUID_INIT_128(BLE_CONFIG_SERVICE_UUID_VAL);
+static struct bt_uuid_128 control_uuid = BT_UUID_INIT_128(BLE_CONFIG_CONTROL_UUID_VAL);
+static struct bt_uuid_128 key_uuids[CONFIG_KEY_MAX];
+
+/** @brief Generated attribute table and the declarations it points at */
+static struct bt_gatt_attr svc_attrs[BLE_CONFIG_ATTR_COUNT];
+static struct bt_gatt_chrc svc_chrcs[CONFIG_KEY_MAX + 1];
+static struct bt_gatt_cpf key_formats[CONFIG_KEY_MAX];
+static struct bt_gatt_service config_svc = BT_GATT_SERVICE(svc_attrs);
+
+/** @brief Service state */
+static struct {
+    struct k_mutex lock;
+    config_txn_t txn;               /* Writes staged since the last commit */
+    struct k_work_delayable commit_work;
+    int last_result;                /* CONFIG_* result of the last commit */
+    bool initialized;
+} ble_cfg;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static ssize_t read_key(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                        void *buf, uint16_t len, uint16_t offset);
+static ssize_t write_key(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                         const void *buf, uint16_t len, uint16_t offset, uint8_t flags);
+static ssize_t read_control(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                            void *buf, uint16_t len, uint16_t offset);
+static ssize_t write_control(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                             const void *buf, uint16_t len, uint16_t offset, uint8_t flags);
+static void commit_work_handler(struct k_work *work);
+static int commit_staged(void);
+static void abort_staged(void);
+static size_t encode_key(config_key_t key, uint8_t *out);
+static uint8_t att_error(int config_error);
+static uint8_t cpf_format(config_type_t type);
+static void disconnected(struct bt_conn *conn, uint8_t reason);
+
+/*============================================================================*/
+/* BLE Connection Callbacks                                                   */
+/*============================================================================*/
+
+BT_CONN_CB_DEFINE(ble_config_conn_callbacks) = {
+    .disconnected = disconnected,
+};
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Build and register the configuration service
+ */
+int ble_config_init(void)
+{
+    if (ble_cfg.initialized) {
+        return BLE_CONFIG_OK;
+    }
+
+    size_t n = 0;
+
+    svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_PRIMARY_SERVICE(&config_svc_uuid);
+
+    for (int key = 0; key < CONFIG_KEY_MAX; key++) {
+        config_entry_t entry;
+
+        if (config_get_entry_info(key, &entry) != CONFIG_OK) {
+            return BLE_CONFIG_ERROR_INVALID;
+        }
+
+        bool writable = BLE_CONFIG_WRITABLE && !entry.read_only;
+        uint8_t props = BT_GATT_CHRC_READ | (writable ? BT_GATT_CHRC_WRITE : 0U);
+        uint16_t perm = BT_GATT_PERM_READ | (writable ? BLE_CONFIG_PERM_WRITE : 0U);
+
+        /* The first value byte is the least significant byte of the UUID */
+        key_uuids[key] = (struct bt_uuid_128)BT_UUID_INIT_128(BLE_CONFIG_KEY_UUID_BASE_VAL);
+        key_uuids[key].val[0] += (uint8_t)key;
+
+        svc_chrcs[key] = (struct bt_gatt_chrc)BT_GATT_CHRC_INIT(&key_uuids[key].uuid, 0U, props);
+        key_formats[key] = (struct bt_gatt_cpf){
+            .format = cpf_format(entry.type),
+            .unit = BLE_CONFIG_CPF_UNITLESS,
+        };
+
+        svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_ATTRIBUTE(
+            BT_UUID_GATT_CHRC, BT_GATT_PERM_READ, bt_gatt_attr_read_chrc, NULL, &svc_chrcs[key]);
+        svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_ATTRIBUTE(
+            &key_uuids[key].uuid, perm, read_key, writable ? write_key : NULL,
+            UINT_TO_POINTER(key));
+        svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_ATTRIBUTE(
+            BT_UUID_GATT_CUD, BT_GATT_PERM_READ, bt_gatt_attr_read_cud, NULL, (void *)entry.name);
+        svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_ATTRIBUTE(
+            BT_UUID_GATT_CPF, BT_GATT_PERM_READ, bt_gatt_attr_read_cpf, NULL, &key_formats[key]);
+    }
+
+    svc_chrcs[CONFIG_KEY_MAX] = (struct bt_gatt_chrc)BT_GATT_CHRC_INIT(
+        &control_uuid.uuid, 0U,
+        BT_GATT_CHRC_READ | (BLE_CONFIG_WRITABLE ? BT_GATT_CHRC_WRITE : 0U));
+    svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_ATTRIBUTE(
+        BT_UUID_GATT_CHRC, BT_GATT_PERM_READ, bt_gatt_attr_read_chrc, NULL,
+        &svc_chrcs[CONFIG_KEY_MAX]);
+    svc_attrs[n++] = (struct bt_gatt_attr)BT_GATT_ATTRIBUTE(
+        &control_uuid.uuid,
+        BT_GATT_PERM_READ | (BLE_CONFIG_WRITABLE ? BLE_CONFIG_PERM_WRITE : 0U),
+        read_control, BLE_CONFIG_WRITABLE ? write_control : NULL, NULL);
+
+    __ASSERT_NO_MSG(n == ARRAY_SIZE(svc_attrs));
+
+    k_mutex_init(&ble_cfg.lock);
+    k_work_init_delayable(&ble_cfg.commit_work, commit_work_handler);
+    if (config_begin(&ble_cfg.txn) != CONFIG_OK) {
+        return BLE_CONFIG_ERROR_INVALID;
+    }
+    ble_cfg.last_result = CONFIG_OK;
+
+    int ret = bt_gatt_service_register(&config_svc);
+    if (ret != 0) {
+        DIAG_ERROR(DIAG_CAT_COMMUNICATION, "Config GATT service registration failed: %d", ret);
+        return BLE_CONFIG_ERROR_REGISTER;
+    }
+
+    ble_cfg.initialized = true;
+    DIAG_INFO(DIAG_CAT_COMMUNICATION, "Config GATT service: %d key(s)%s", CONFIG_KEY_MAX,
+              BLE_CONFIG_WRITABLE ? "" : ", read-only (no pairing support)");
+    return BLE_CONFIG_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Read a key's current (committed) value
+ */
+static ssize_t read_key(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                        void *buf, uint16_t len, uint16_t offset)
+{
+    config_key_t key = (config_key_t)POINTER_TO_UINT(attr->user_data);
+    uint8_t value[CONFIG_VALUE_MAX_SIZE];
+    size_t size = encode_key(key, value);
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, value, (uint16_t)size);
+}
+
+/**
+ * @brief Stage a key write
+ * @details The whole value must arrive in one write, so blobs need an ATT MTU
+ * of at least their size plus three.
+ */
+static ssize_t write_key(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                         const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    ARG_UNUSED(conn);
+
+    config_key_t key = (config_key_t)POINTER_TO_UINT(attr->user_data);
+    config_entry_t entry;
+    config_value_t value = {0};
+    char string[CONFIG_VALUE_MAX_SIZE];
+
+    if (offset != 0U) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    /* Prepared writes are checked when executed */
+    if (flags & BT_GATT_WRITE_FLAG_PREPARE) {
+        return 0;
+    }
+
+    if (config_get_entry_info(key, &entry) != CONFIG_OK) {
+        return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+    }
+
+    value.type = entry.type;
+
+    switch (entry.type) {
+    case CONFIG_TYPE_UINT32:
+    case CONFIG_TYPE_FLOAT:
+        if (len != sizeof(uint32_t)) {
+            return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+        }
+        value.size = sizeof(uint32_t);
+        value.value.uint32_val = sys_get_le32(buf);
+        break;
+    case CONFIG_TYPE_BOOL:
+        if (len != 1U || ((const uint8_t *)buf)[0] > 1U) {
+            return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+        }
+        value.size = sizeof(bool);
+        value.value.bool_val = ((const uint8_t *)buf)[0] != 0U;
+        break;
+    case CONFIG_TYPE_STRING:
+        /* Sent without the terminator */
+        if (len >= sizeof(string)) {
+            return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+        }
+        memcpy(string, buf, len);
+        string[len] = '\0';
+        value.size = len + 1U;
+        value.value.string_val = string;
+        break;
+    default:
+        value.size = len;
+        value.value.blob_val = buf;
+        break;
+    }
+
+    k_mutex_lock(&ble_cfg.lock, K_FOREVER);
+    int ret = config_txn_set(&ble_cfg.txn, key, &value);
+    k_mutex_unlock(&ble_cfg.lock);
+
+    if (ret != CONFIG_OK) {
+        return BT_GATT_ERR(att_error(ret));
+    }
+
+    /* Each write restarts the quiet period, so a burst commits as one batch */
+    k_work_reschedule(&ble_cfg.commit_work, K_MSEC(BLE_CONFIG_COMMIT_DELAY_MS));
+    return len;
+}
+
+/**
+ * @brief Read the control point status
+ */
+static ssize_t read_control(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                            void *buf, uint16_t len, uint16_t offset)
+{
+    uint8_t status[BLE_CONFIG_STATUS_SIZE];
+
+    k_mutex_lock(&ble_cfg.lock, K_FOREVER);
+    sys_put_le32(ble_cfg.txn.staged, &status[0]);
+    status[12] = (uint8_t)(int8_t)ble_cfg.last_result;
+    k_mutex_unlock(&ble_cfg.lock);
+
+    sys_put_le32(config_get_version(), &status[4]);
+    sys_put_le32(config_get_restart_pending(), &status[8]);
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, status, sizeof(status));
+}
+
+/**
+ * @brief Commit or discard staged writes
+ */
+static ssize_t write_control(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                             const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    ARG_UNUSED(conn);
+    ARG_UNUSED(attr);
+
+    if (offset != 0U) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+    if (len != 1U) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+    if (flags & BT_GATT_WRITE_FLAG_PREPARE) {
+        return 0;
+    }
+
+    switch (((const uint8_t *)buf)[0]) {
+    case BLE_CONFIG_OP_COMMIT: {
+        k_work_cancel_delayable(&ble_cfg.commit_work);
+
+        int ret = commit_staged();
+        if (ret != CONFIG_OK) {
+            return BT_GATT_ERR(att_error(ret));
+        }
+        break;
+    }
+    case BLE_CONFIG_OP_ABORT:
+        k_work_cancel_delayable(&ble_cfg.commit_work);
+        abort_staged();
+        break;
+    default:
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    }
+
+    return len;
+}
+
+/**
+ * @brief Commit staged writes once the client has gone quiet
+ */
+static void commit_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    commit_staged();
+}
+
+/**
+ * @brief Apply, persist and announce the staged writes as one batch
+ */
+static int commit_staged(void)
+{
+    k_mutex_lock(&ble_cfg.lock, K_FOREVER);
+    uint32_t staged = ble_cfg.txn.staged;
+    int ret = config_commit(&ble_cfg.txn);
+    ble_cfg.last_result = ret;
+    k_mutex_unlock(&ble_cfg.lock);
+
+    if (ret != CONFIG_OK) {
+        DIAG_WARNING(DIAG_CAT_COMMUNICATION, "BLE config commit of keys 0x%x rejected: %d",
+                     staged, ret);
+    } else if (staged != 0U) {
+        DIAG_INFO(DIAG_CAT_COMMUNICATION, "BLE config committed keys 0x%x", staged);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Discard staged writes
+ */
+static void abort_staged(void)
+{
+    k_mutex_lock(&ble_cfg.lock, K_FOREVER);
+    config_abort(&ble_cfg.txn);
+    k_mutex_unlock(&ble_cfg.lock);
+}
+
+/**
+ * @brief Encode a key's value as sent over the air
+ * @return Encoded size in bytes
+ */
+static size_t encode_key(config_key_t key, uint8_t *out)
+{
+    config_value_t value;
+    size_t size;
+    uint32_t seq;
+
+    do {
+        seq = config_read_begin();
+        config_get(key, &value);
+
+        switch (value.type) {
+        case CONFIG_TYPE_UINT32:
+            sys_put_le32(value.value.uint32_val, out);
+            size = sizeof(uint32_t);
+            break;
+        case CONFIG_TYPE_FLOAT: {
+            uint32_t word;
+
+            memcpy(&word, &value.value.float_val, sizeof(word));
+            sys_put_le32(word, out);
+            size = sizeof(uint32_t);
+            break;
+        }
+        case CONFIG_TYPE_BOOL:
+            out[0] = value.value.bool_val ? 1U : 0U;
+            size = 1U;
+            break;
+        case CONFIG_TYPE_STRING:
+            /* Sent without the terminator */
+            size = (value.size > 0U) ? value.size - 1U : 0U;
+            memcpy(out, value.value.string_val, size);
+            break;
+        default:
+            size = value.size;
+            memcpy(out, value.value.blob_val, size);
+            break;
+        }
+    } while (config_read_retry(seq));
+
+    return size;
+}
+
+/**
+ * @brief Map a configuration error to an ATT error code
+ */
+static uint8_t att_error(int config_error)
+{
+    switch (config_error) {
+    case CONFIG_ERROR_READ_ONLY:
+        return BT_ATT_ERR_WRITE_NOT_PERMITTED;
+    case CONFIG_ERROR_VALIDATION:
+        return BT_ATT_ERR_OUT_OF_RANGE;
+    case CONFIG_ERROR_INVALID:
+        return BT_ATT_ERR_VALUE_NOT_ALLOWED;
+    default:
+        return BT_ATT_ERR_UNLIKELY;
+    }
+}
+
+/**
+ * @brief Presentation format for a configuration type
+ */
+static uint8_t cpf_format(config_type_t type)
+{
+    switch (type) {
+    case CONFIG_TYPE_UINT32:
+        return BLE_CONFIG_CPF_UINT32;
+    case CONFIG_TYPE_FLOAT:
+        return BLE_CONFIG_CPF_FLOAT32;
+    case CONFIG_TYPE_BOOL:
+        return BLE_CONFIG_CPF_BOOLEAN;
+    case CONFIG_TYPE_STRING:
+        return BLE_CONFIG_CPF_UTF8S;
+    default:
+        return BLE_CONFIG_CPF_STRUCT;
+    }
+}
+
+/**
+ * @brief Discard a batch left unfinished by a dropped link
+ */
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    ARG_UNUSED(conn);
+    ARG_UNUSED(reason);
+
+    if (!ble_cfg.initialized) {
+        return;
+    }
+
+    k_work_cancel_delayable(&ble_cfg.commit_work);
+    abort_staged();
+}
@@ -0,0 +1,83 @@
+/**
+ * @file ble_config.h
+ * @brief BLE GATT configuration service
+ * @details Publishes every configuration key as a characteristic of one
+ * GATT service, generated at boot from the configuration table: the value is
+ * the key's typed little-endian encoding, a User Description descriptor
+ * carries the key name and a Presentation Format descriptor its type, and
+ * read-only keys are registered without write access. Writes need an
+ * encrypted link; without pairing support (CONFIG_BT_SMP) every key and the
+ * control point are registered read-only. Writes are checked by
+ * the key's validator and staged in a configuration transaction that is
+ * committed (validated across keys, applied, persisted and notified once)
+ * when the client writes BLE_CONFIG_OP_COMMIT to the control point or
+ * BLE_CONFIG_COMMIT_DELAY_MS after the last write.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BLE_CONFIG_H
+#define BLE_CONFIG_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/*============================================================================*/
+/* BLE Config Constants                                                       */
+/*============================================================================*/
+
+/** @defgroup BleConfigConstants BLE Config Constants
+ * @{
+ */
+
+/** @brief Quiet time after the last write before staged keys are committed */
+#define BLE_CONFIG_COMMIT_DELAY_MS     500U
+
+/** @brief Control point op code: commit staged writes now */
+#define BLE_CONFIG_OP_COMMIT           0x01U
+
+/** @brief Control point op code: discard staged writes */
+#define BLE_CONFIG_OP_ABORT            0x02U
+
+/** @brief Control point read size in bytes (see ble_config.c for the layout) */
+#define BLE_CONFIG_STATUS_SIZE         13U
+
+/** @} */ /* End of BleConfigConstants group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup BleConfigReturnCodes BLE Config Return Codes
+ * @{
+ */
+
+#define BLE_CONFIG_OK                  0   /**< Operation successful */
+#define BLE_CONFIG_ERROR_INVALID      -1   /**< Configuration not initialized */
+#define BLE_CONFIG_ERROR_REGISTER     -2   /**< GATT service registration failed */
+
+/** @} */ /* End of BleConfigReturnCodes group */
+
+/*============================================================================*/
+/* BLE Config API                                                             */
+/*============================================================================*/
+
+/**
+ * @brief Build and register the configuration service
+ * @details Call after config_init() and bt_enable(), before advertising
+ * starts, so the service is in the database the first client discovers.
+ *
+ * @return BLE_CONFIG_OK on success, error code on failure
+ */
+#if defined(CONFIG_BT)
+int ble_config_init(void);
+#else
+static inline int ble_config_init(void)
+{
+    return BLE_CONFIG_ERROR_REGISTER; /* No Bluetooth stack (native_sim) */
+}
+#endif
+
+#endif /* BLE_CONFIG_H */
@@ -0,0 +1,92 @@
+/**
+ * @file boot_profile.c
+ * @brief Start-up timing for the medical wearable
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "boot_profile.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Stage names for the report */
+static const char *const stage_names[BOOT_STAGE_MAX] = {
+    [BOOT_STAGE_MAIN] = "main",
+    [BOOT_STAGE_HARDWARE] = "hardware",
+    [BOOT_STAGE_SYSTEM] = "system",
+    [BOOT_STAGE_THREADS] = "threads",
+    [BOOT_STAGE_SENSORS] = "sensors",
+    [BOOT_STAGE_FIRST_SAMPLE] = "first sample",
+};
+
+/** @brief Boot profile state */
+static struct {
+    atomic_t reached;               /* Bit per stage */
+    uint32_t stage_us[BOOT_STAGE_MAX];
+} profile;
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Record that a stage has been reached
+ */
+void boot_profile_mark(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_MAX || atomic_test_bit(&profile.reached, stage)) {
+        return;
+    }
+
+    /* Each stage is marked from a single context; the bit publishes the time */
+    profile.stage_us[stage] = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+    atomic_set_bit(&profile.reached, stage);
+}
+
+/**
+ * @brief Time a stage was reached
+ */
+uint32_t boot_profile_get_us(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_MAX || !atomic_test_bit(&profile.reached, stage)) {
+        return 0U;
+    }
+
+    return profile.stage_us[stage];
+}
+
+/**
+ * @brief Print the stage timings and log time to first sample
+ */
+void boot_profile_report(void)
+{
+    printk("\n=== Boot Profile ===\n");
+    for (int stage = 0; stage < BOOT_STAGE_MAX; stage++) {
+        if (atomic_test_bit(&profile.reached, stage)) {
+            printk("  %-12s %8u us\n", stage_names[stage], profile.stage_us[stage]);
+        } else {
+            printk("  %-12s  not reached\n", stage_names[stage]);
+        }
+    }
+    printk("====================\n\n");
+
+    uint32_t first_us = boot_profile_get_us(BOOT_STAGE_FIRST_SAMPLE);
+
+    if (first_us == 0U) {
+        DIAG_WARNING(DIAG_CAT_SYSTEM, "Boot: no sample received yet");
+    } else if (first_us > BOOT_PROFILE_TARGET_US) {
+        DIAG_WARNING(DIAG_CAT_SYSTEM, "Boot: first sample at %u us, over the %u us target",
+                     first_us, BOOT_PROFILE_TARGET_US);
+    } else {
+        DIAG_INFO(DIAG_CAT_SYSTEM, "Boot: first sample at %u us (target %u us)",
+                  first_us, BOOT_PROFILE_TARGET_US);
+    }
+}
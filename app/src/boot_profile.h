@@ -0,0 +1,63 @@
+/**
+ * @file boot_profile.h
+ * @brief Start-up timing for the medical wearable
+ * @details Records when each boot stage is first reached, in microseconds
+ * since reset, and reports the stages against the time-to-first-sample
+ * target once the console is available.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/*============================================================================*/
+/* Boot Profile Constants                                                     */
+/*============================================================================*/
+
+/** @brief Time-to-first-sample target */
+#define BOOT_PROFILE_TARGET_US         200000U
+
+/** @brief Boot stages, in start-up order */
+typedef enum {
+    BOOT_STAGE_MAIN = 0,            /**< main() entered (kernel and drivers up) */
+    BOOT_STAGE_HARDWARE,            /**< Hardware abstraction layer ready */
+    BOOT_STAGE_SYSTEM,              /**< Core system and medical device ready */
+    BOOT_STAGE_THREADS,             /**< Application threads created */
+    BOOT_STAGE_SENSORS,             /**< Sensor hub started */
+    BOOT_STAGE_FIRST_SAMPLE,        /**< First sample reached the sink */
+    BOOT_STAGE_MAX                  /**< Stage count */
+} boot_stage_t;
+
+/*============================================================================*/
+/* Boot Profile API                                                           */
+/*============================================================================*/
+
+/**
+ * @brief Record that a stage has been reached
+ * @details Only the first mark of each stage counts, so this is cheap to
+ * call from a hot path such as the sensor hub sink.
+ *
+ * @param stage Stage reached
+ */
+void boot_profile_mark(boot_stage_t stage);
+
+/**
+ * @brief Time a stage was reached
+ *
+ * @param stage Stage to query
+ * @return Microseconds since reset, 0 if the stage has not been reached
+ */
+uint32_t boot_profile_get_us(boot_stage_t stage);
+
+/**
+ * @brief Print the stage timings and log time to first sample
+ */
+void boot_profile_report(void);
+
+#endif /* BOOT_PROFILE_H */
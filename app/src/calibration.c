@@ -0,0 +1,356 @@
+/**
+ * @file calibration.c
+ * @brief Per-channel sensor calibration compiled from the calibration blob
+ * @details Floating point is used only while compiling; the per-sample path
+ * is integer. Two transform sets are kept: loading fills the inactive one
+ * and publishes it with an atomic pointer store, so the sensor hub never
+ * sees a half-built set. Loads come from the configuration observer on the
+ * system work queue, the same context the sensor hub publishes from.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "calibration.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <math.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Blob header and entry header sizes */
+#define BLOB_HEADER_SIZE               4U
+#define ENTRY_HEADER_SIZE              4U
+
+/** @brief Most coefficients of one entry (domain plus table points) */
+#define ENTRY_MAX_COEFFS               (2U + CALIBRATION_TABLE_MAX_POINTS)
+
+/** @brief Linear gain fraction bits */
+#define GAIN_Q                         16
+
+/** @brief Widest curve segment, so interpolation stays within 64 bits */
+#define SEGMENT_SHIFT_MAX              27U
+
+/** @brief Compiled transform kinds */
+typedef enum {
+    TRANSFORM_IDENTITY = 0,
+    TRANSFORM_LINEAR,
+    TRANSFORM_TABLE
+} transform_kind_t;
+
+/** @brief Compiled transform of one channel */
+typedef struct {
+    uint8_t kind;                   /* transform_kind_t */
+    uint8_t shift;                  /* log2 of the segment width */
+    int32_t x0;                     /* Start of the domain */
+    int32_t x1;                     /* End of the domain (inputs saturate here) */
+    int32_t gain_q16;
+    int32_t offset;
+    int32_t y[CALIBRATION_TABLE_SEGMENTS + 1U];
+} transform_t;
+
+/** @brief Transforms of every channel */
+typedef struct {
+    uint32_t channels;              /* Channels that are not identity */
+    transform_t transforms[SENSOR_HUB_CH_MAX];
+} transform_set_t;
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Double-buffered transform sets; NULL while every channel is identity */
+static transform_set_t transform_sets[2];
+static atomic_ptr_t active_set;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static int compile(const uint8_t *blob, size_t size, transform_set_t *set);
+static int compile_entry(uint8_t kind, const float *coeffs, size_t count, transform_t *transform);
+static double evaluate(uint8_t kind, const float *coeffs, size_t count, double x);
+static bool to_int32(double value, int32_t *out);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Check a blob without loading it
+ */
+int calibration_validate(const uint8_t *blob, size_t size)
+{
+    return compile(blob, size, NULL);
+}
+
+/**
+ * @brief Compile a blob and make it the active calibration
+ */
+int calibration_load(const uint8_t *blob, size_t size)
+{
+    transform_set_t *set = (atomic_ptr_get(&active_set) == &transform_sets[0]) ?
+                           &transform_sets[1] : &transform_sets[0];
+
+    int ret = compile(blob, size, set);
+    if (ret != CALIBRATION_OK) {
+        DIAG_ERROR(DIAG_CAT_SENSOR, "Calibration blob rejected: %d", ret);
+        return ret;
+    }
+
+    atomic_ptr_set(&active_set, (set->channels != 0U) ? set : NULL);
+
+    DIAG_INFO(DIAG_CAT_SENSOR, "Calibration loaded: channel mask 0x%03x", set->channels);
+    return CALIBRATION_OK;
+}
+
+/**
+ * @brief Channels with an active calibration
+ */
+uint32_t calibration_get_channels(void)
+{
+    const transform_set_t *set = atomic_ptr_get(&active_set);
+
+    return (set != NULL) ? set->channels : 0U;
+}
+
+/**
+ * @brief Calibrate one value
+ */
+int32_t calibration_apply(uint8_t channel, int32_t value)
+{
+    const transform_set_t *set = atomic_ptr_get(&active_set);
+
+    if (set == NULL || channel >= SENSOR_HUB_CH_MAX) {
+        return value;
+    }
+
+    const transform_t *t = &set->transforms[channel];
+    int64_t y;
+
+    switch (t->kind) {
+        case TRANSFORM_LINEAR:
+            y = (((int64_t)value * t->gain_q16 + BIT(GAIN_Q - 1)) >> GAIN_Q) + t->offset;
+            break;
+
+        case TRANSFORM_TABLE: {
+            int64_t d = (int64_t)CLAMP(value, t->x0, t->x1) - t->x0;
+            uint32_t i = MIN((uint32_t)(d >> t->shift), CALIBRATION_TABLE_SEGMENTS - 1U);
+            int64_t f = d - ((int64_t)i << t->shift);
+
+            y = t->y[i] + ((((int64_t)t->y[i + 1U] - t->y[i]) * f) >> t->shift);
+            break;
+        }
+
+        default:
+            return value;
+    }
+
+    return (int32_t)CLAMP(y, INT32_MIN, INT32_MAX);
+}
+
+/**
+ * @brief Calibrate samples in place
+ */
+void calibration_apply_samples(sensor_hub_sample_t *samples, size_t count)
+{
+    uint32_t channels = calibration_get_channels();
+
+    for (size_t i = 0; i < count && channels != 0U; i++) {
+        if (samples[i].channel < SENSOR_HUB_CH_MAX && (channels & BIT(samples[i].channel))) {
+            samples[i].value = calibration_apply(samples[i].channel, samples[i].value);
+        }
+    }
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Parse and compile a blob
+ * @param set Destination, or NULL to validate only
+ */
+static int compile(const uint8_t *blob, size_t size, transform_set_t *set)
+{
+    if (blob == NULL) {
+        return CALIBRATION_ERROR_INVALID;
+    }
+
+    if (size < CALIBRATION_BLOB_MIN_SIZE || size > CALIBRATION_BLOB_MAX_SIZE) {
+        return CALIBRATION_ERROR_FORMAT;
+    }
+
+    size_t end = size - sizeof(uint32_t);
+
+    if (crc32_ieee(blob, end) != sys_get_le32(&blob[end])) {
+        return CALIBRATION_ERROR_CRC;
+    }
+
+    if (blob[0] != CALIBRATION_BLOB_VERSION) {
+        return CALIBRATION_ERROR_FORMAT;
+    }
+
+    if (set != NULL) {
+        memset(set, 0, sizeof(*set));
+    }
+
+    uint32_t seen = 0U;
+    size_t off = BLOB_HEADER_SIZE;
+
+    for (uint8_t i = 0; i < blob[1]; i++) {
+        float coeffs[ENTRY_MAX_COEFFS];
+        transform_t transform;
+
+        if (off + ENTRY_HEADER_SIZE > end) {
+            return CALIBRATION_ERROR_FORMAT;
+        }
+
+        uint8_t channel = blob[off];
+        uint8_t kind = blob[off + 1U];
+        uint8_t count = blob[off + 2U];
+
+        off += ENTRY_HEADER_SIZE;
+        if (channel >= SENSOR_HUB_CH_MAX || (seen & BIT(channel)) ||
+            count > ENTRY_MAX_COEFFS || off + count * sizeof(float) > end) {
+            return CALIBRATION_ERROR_FORMAT;
+        }
+
+        for (uint8_t c = 0; c < count; c++) {
+            uint32_t word = sys_get_le32(&blob[off]);
+
+            memcpy(&coeffs[c], &word, sizeof(float));
+            off += sizeof(float);
+        }
+
+        int ret = compile_entry(kind, coeffs, count, &transform);
+        if (ret != CALIBRATION_OK) {
+            return ret;
+        }
+
+        seen |= BIT(channel);
+        if (set != NULL) {
+            set->transforms[channel] = transform;
+            set->channels |= BIT(channel);
+        }
+    }
+
+    return (off == end) ? CALIBRATION_OK : CALIBRATION_ERROR_FORMAT;
+}
+
+/**
+ * @brief Compile one entry into a fixed-point transform
+ */
+static int compile_entry(uint8_t kind, const float *coeffs, size_t count, transform_t *transform)
+{
+    memset(transform, 0, sizeof(*transform));
+
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(coeffs[i])) {
+            return CALIBRATION_ERROR_RANGE;
+        }
+    }
+
+    if (kind == CALIBRATION_KIND_LINEAR) {
+        if (count != 2U ||
+            !to_int32((double)coeffs[0] * BIT(GAIN_Q), &transform->gain_q16) ||
+            !to_int32(coeffs[1], &transform->offset)) {
+            return (count != 2U) ? CALIBRATION_ERROR_FORMAT : CALIBRATION_ERROR_RANGE;
+        }
+        transform->kind = TRANSFORM_LINEAR;
+        return CALIBRATION_OK;
+    }
+
+    if ((kind == CALIBRATION_KIND_POLYNOMIAL &&
+         (count < 4U || count > 3U + CALIBRATION_POLY_MAX_DEGREE)) ||
+        (kind == CALIBRATION_KIND_TABLE && count < 4U) ||
+        (kind != CALIBRATION_KIND_POLYNOMIAL && kind != CALIBRATION_KIND_TABLE)) {
+        return CALIBRATION_ERROR_FORMAT;
+    }
+
+    int32_t x_min;
+    int32_t x_max;
+
+    if (!to_int32(floor(coeffs[0]), &x_min) || !to_int32(ceil(coeffs[1]), &x_max) ||
+        x_max <= x_min) {
+        return CALIBRATION_ERROR_RANGE;
+    }
+
+    /* Smallest power-of-two segment covering the domain; the last point may
+     * lie past x_max, where the curve is extrapolated so the final segment
+     * still interpolates correctly up to x_max */
+    uint8_t shift = 0U;
+
+    while (((int64_t)CALIBRATION_TABLE_SEGMENTS << shift) < (int64_t)x_max - x_min) {
+        shift++;
+    }
+    if (shift > SEGMENT_SHIFT_MAX) {
+        return CALIBRATION_ERROR_RANGE;
+    }
+
+    transform->kind = TRANSFORM_TABLE;
+    transform->shift = shift;
+    transform->x0 = x_min;
+    transform->x1 = x_max;
+
+    for (uint32_t i = 0; i <= CALIBRATION_TABLE_SEGMENTS; i++) {
+        double x = (double)x_min + (double)((int64_t)i << shift);
+
+        if (!to_int32(evaluate(kind, coeffs, count, x), &transform->y[i])) {
+            return CALIBRATION_ERROR_RANGE;
+        }
+    }
+
+    return CALIBRATION_OK;
+}
+
+/**
+ * @brief Evaluate a curve entry at x (compile time only)
+ * @details Tables extrapolate their end segments outside the domain.
+ */
+static double evaluate(uint8_t kind, const float *coeffs, size_t count, double x)
+{
+    double x_min = coeffs[0];
+    double x_max = coeffs[1];
+
+    if (kind == CALIBRATION_KIND_POLYNOMIAL) {
+        double y = 0.0;
+
+        for (size_t i = count; i > 2U; i--) {
+            y = y * x + coeffs[i - 1U];
+        }
+        return y;
+    }
+
+    /* Table: points evenly spaced over [x_min, x_max] */
+    size_t points = count - 2U;
+    double pos = (x - x_min) / (x_max - x_min) * (double)(points - 1U);
+    size_t i = (pos <= 0.0) ? 0U : MIN((size_t)pos, points - 2U);
+    double frac = pos - (double)i;
+
+    return coeffs[2U + i] + (coeffs[3U + i] - coeffs[2U + i]) * frac;
+}
+
+/**
+ * @brief Round to int32 if in range
+ */
+static bool to_int32(double value, int32_t *out)
+{
+    double rounded = round(value);
+
+    if (!(rounded >= (double)INT32_MIN && rounded <= (double)INT32_MAX)) {
+        return false;
+    }
+
+    *out = (int32_t)rounded;
+    return true;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file calibration.h
+ * @brief Per-channel sensor calibration compiled from the calibration blob
+ * @details CONFIG_KEY_CALIBRATION_DATA holds a little-endian blob:
+ *
+ *   [version u8][entry count u8][reserved u16][entries...][CRC-32 u32]
+ *
+ * where the CRC-32 (IEEE) covers every byte before it, and each entry is
+ *
+ *   [channel u8][kind u8][coefficient count u8][reserved u8][float32 x count]
+ *
+ * The coefficients by kind (x and y in channel units):
+ * - CALIBRATION_KIND_LINEAR: gain, offset (y = gain * x + offset)
+ * - CALIBRATION_KIND_POLYNOMIAL: x_min, x_max, c0..cN (y = c0 + c1 x + ...,
+ *   degree 1 to 3)
+ * - CALIBRATION_KIND_TABLE: x_min, x_max, y0..yN (2 to 16 points evenly
+ *   spaced from x_min to x_max, linearly interpolated)
+ *
+ * Loading compiles every entry into a fixed-point transform: linear entries
+ * into a Q16 gain and an offset, curves into a CALIBRATION_TABLE_SEGMENTS
+ * piecewise-linear table whose segment width is a power of two, so applying
+ * any calibration is a shift, a table lookup and one multiply. Curves
+ * saturate outside their domain.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "sensor_hub.h"
+
+/*============================================================================*/
+/* Calibration Constants                                                      */
+/*============================================================================*/
+
+/** @defgroup CalibrationConfig Calibration Configuration
+ * @{
+ */
+
+/** @brief Blob format version */
+#define CALIBRATION_BLOB_VERSION       1U
+
+/** @brief Largest blob (the size of CONFIG_KEY_CALIBRATION_DATA) */
+#define CALIBRATION_BLOB_MAX_SIZE      128U
+
+/** @brief Smallest blob: header and CRC, no entries (identity) */
+#define CALIBRATION_BLOB_MIN_SIZE      8U
+
+/** @brief Segments of a compiled curve */
+#define CALIBRATION_TABLE_SEGMENTS     16U
+
+/** @brief Most points of a CALIBRATION_KIND_TABLE entry */
+#define CALIBRATION_TABLE_MAX_POINTS   16U
+
+/** @brief Highest polynomial degree */
+#define CALIBRATION_POLY_MAX_DEGREE    3U
+
+/** @} */ /* End of CalibrationConfig group */
+
+/** @brief Entry kinds */
+typedef enum {
+    CALIBRATION_KIND_LINEAR = 1,    /**< Gain and offset */
+    CALIBRATION_KIND_POLYNOMIAL,    /**< Polynomial over a domain */
+    CALIBRATION_KIND_TABLE          /**< Evenly spaced lookup table over a domain */
+} calibration_kind_t;
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup CalibrationReturnCodes Calibration Return Codes
+ * @{
+ */
+
+#define CALIBRATION_OK                 0   /**< Operation successful */
+#define CALIBRATION_ERROR_INVALID     -1   /**< Invalid parameter */
+#define CALIBRATION_ERROR_CRC         -2   /**< Blob CRC mismatch */
+#define CALIBRATION_ERROR_FORMAT      -3   /**< Malformed blob or unsupported entry */
+#define CALIBRATION_ERROR_RANGE       -4   /**< Coefficients overflow the fixed-point transform */
+
+/** @} */ /* End of CalibrationReturnCodes group */
+
+/*============================================================================*/
+/* Calibration API                                                            */
+/*============================================================================*/
+
+/**
+ * @brief Check a blob without loading it
+ * @details Used as the validator of CONFIG_KEY_CALIBRATION_DATA.
+ *
+ * @param blob Blob bytes
+ * @param size Blob size
+ * @return CALIBRATION_OK if the blob would load, error code otherwise
+ */
+int calibration_validate(const uint8_t *blob, size_t size);
+
+/**
+ * @brief Compile a blob and make it the active calibration
+ * @details The new transforms are built aside and swapped in with one
+ * pointer store. On error the active calibration is kept.
+ *
+ * @param blob Blob bytes
+ * @param size Blob size
+ * @return CALIBRATION_OK on success, error code on failure
+ */
+int calibration_load(const uint8_t *blob, size_t size);
+
+/**
+ * @brief Channels with an active calibration
+ * @return BIT(sensor_hub_channel_t) mask, 0 when every channel is identity
+ */
+uint32_t calibration_get_channels(void);
+
+/**
+ * @brief Calibrate one value
+ *
+ * @param channel sensor_hub_channel_t
+ * @param value Raw value in channel units
+ * @return Calibrated value in channel units
+ */
+int32_t calibration_apply(uint8_t channel, int32_t value);
+
+/**
+ * @brief Calibrate samples in place
+ *
+ * @param samples Samples to correct
+ * @param count Number of samples
+ */
+void calibration_apply_samples(sensor_hub_sample_t *samples, size_t count);
+
+#endif /* CALIBRATION_H */
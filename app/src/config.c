@@ -1,10 +1,89 @@
 #include "config.h"
+#include "diagnostics.h"
+#include "calibration.h"
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
 #include <string.h>
 
-/* Configuration storage */
-static config_value_t config_values[CONFIG_KEY_MAX];
+#if defined(CONFIG_NVS)
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/storage/flash_map.h>
+#if FIXED_PARTITION_EXISTS(storage_partition)
+#define STORE_ENABLED 1
+#endif
+#endif
+
+/* NVS record IDs: one record per key, so a save only rewrites what changed */
+#define STORE_ID_VERSION        0x0001
+#define STORE_ID_KEY_BASE       0x0010
+#define STORE_FORMAT_VERSION    2U
+
+/* Stored record: header followed by the value bytes (scalars as one word) */
+typedef struct {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t size;
+} store_header_t;
+
+/* Configuration storage: scalars one word per key, variable-size values in the arena */
+static uint32_t config_scalars[CONFIG_KEY_MAX];
+static uint8_t config_arena[CONFIG_ARENA_SIZE];
+static uint16_t config_offsets[CONFIG_KEY_MAX];
+static uint16_t config_sizes[CONFIG_KEY_MAX];
 static bool config_initialized = false;
+
+/*
+ * Writers serialise on config_mutex and bump config_seq around every update
+ * (odd while one is in progress). Readers never lock: they copy and retry if
+ * the sequence moved. Writers also lock the scheduler, so on this single-core
+ * part a reader thread can never preempt a half-finished update and spin.
+ */
 static struct k_mutex config_mutex;
+static atomic_t config_seq;
+
+/* Keys changed since the last save (bit per key) */
+static atomic_t config_dirty;
+static struct k_work_delayable config_save_work;
+
+/* Change observers; changes are batched into one callback per observer */
+static struct {
+    config_observer_t observer;
+    uint32_t key_mask;
+    void *user_data;
+} config_observers[CONFIG_MAX_OBSERVERS];
+static atomic_t config_notify_pending;
+static atomic_t config_restart_pending;
+static struct k_work_delayable config_notify_work;
+
+#ifdef STORE_ENABLED
+static struct nvs_fs config_fs;
+static bool store_mounted;
+#endif
+
+static bool type_is_scalar(config_type_t type);
+static uint32_t scalar_from_value(const config_value_t *value);
+static void value_from_scalar(config_type_t type, uint32_t word, config_value_t *value);
+static void read_value(config_key_t key, config_value_t *value);
+static bool write_value(config_key_t key, const config_value_t *value);
+static void write_begin(void);
+static void write_end(void);
+static int check_value(const config_entry_t *entry, const config_value_t *value);
+static bool value_equal(const config_value_t *a, const config_value_t *b);
+static uint32_t find_conflicts(const uint32_t scalars[CONFIG_KEY_MAX]);
+static bool consistent_with(config_key_t key, const config_value_t *value);
+static void txn_view(const config_txn_t *txn, config_key_t key, config_value_t *value);
+static void mark_dirty(config_key_t key);
+static void mark_changed(config_key_t key);
+static void config_save_work_handler(struct k_work *work);
+static void config_notify_work_handler(struct k_work *work);
+#ifdef STORE_ENABLED
+static int store_mount(void);
+static int store_write_key(config_key_t key);
+static int store_read_key(config_key_t key, uint8_t *record, size_t record_size,
+                          config_value_t *value);
+#endif
 
 /* Validation functions */
 static bool validate_device_id(const config_value_t *value);
@@ -13,8 +92,29 @@ static bool validate_alert_thresholds(const config_value_t *value);
 static bool validate_communication_interval(const config_value_t *value);
 static bool validate_power_management(const config_value_t *value);
 static bool validate_safety_limits(const config_value_t *value);
+static bool validate_calibration_data(const config_value_t *value);
 static bool validate_diagnostic_level(const config_value_t *value);
 
+/* Blob defaults */
+/* Alert thresholds: one little-endian uint32 per sensor type (HR bpm, Temp degC,
+ * Motion g, SpO2 %), 0 disables the alert; others must lie in the sensor's range */
+#define ALERT_THRESHOLD_COUNT 4U
+static const struct {
+    uint32_t min;
+    uint32_t max;
+} alert_threshold_ranges[ALERT_THRESHOLD_COUNT] = {
+    {30, 250},  /* Heart rate */
+    {34, 43},   /* Body temperature */
+    {1, 16},    /* Motion (accelerometer full scale) */
+    {70, 100},  /* Blood oxygen */
+};
+static const uint8_t default_alert_thresholds[ALERT_THRESHOLD_COUNT * sizeof(uint32_t)] = {
+    80, 0, 0, 0, 38, 0, 0, 0, 8, 0, 0, 0, 95, 0, 0, 0
+};
+static const uint8_t default_safety_limits[8] = {10, 0, 0, 0, 30, 0, 0, 0}; /* Battery 10%, Signal 30% */
+/* Calibration blob: version 1, no entries (identity), CRC-32; see calibration.h */
+static const uint8_t default_calibration_data[CALIBRATION_BLOB_MIN_SIZE] = {1, 0, 0, 0, 0x79, 0xB8, 0xF8, 0x99};
+
 /* Configuration entries definition */
 static const config_entry_t config_entries[CONFIG_KEY_MAX] = {
     {
@@ -33,13 +133,14 @@ static const config_entry_t config_entries[CONFIG_KEY_MAX] = {
         .default_value = {.type = CONFIG_TYPE_UINT32, .size = sizeof(uint32_t), .value.uint32_val = 100},
         .validator = validate_sampling_rate,
         .read_only = false,
-        .requires_restart = true
+        .requires_restart = false
     },
     {
         .key = CONFIG_KEY_ALERT_THRESHOLDS,
         .name = "alert_thresholds",
         .type = CONFIG_TYPE_BLOB,
-        .default_value = {.type = CONFIG_TYPE_BLOB, .size = 16, .value.blob_val = {80, 0, 0, 0, 100, 0, 0, 0, 150, 0, 0, 0, 95, 0, 0, 0}},
+        .max_size = sizeof(default_alert_thresholds),
+        .default_value = {.type = CONFIG_TYPE_BLOB, .size = sizeof(default_alert_thresholds), .value.blob_val = default_alert_thresholds},
         .validator = validate_alert_thresholds,
         .read_only = false,
         .requires_restart = false
@@ -48,7 +149,7 @@ static const config_entry_t config_entries[CONFIG_KEY_MAX] = {
         .key = CONFIG_KEY_COMMUNICATION_INTERVAL,
         .name = "comm_interval_ms",
         .type = CONFIG_TYPE_UINT32,
-        .default_value = {.type = CONFIG_TYPE_UINT32, .size = sizeof(uint32_t), .value.uint32_val = 5000},
+        .default_value = {.type = CONFIG_TYPE_UINT32, .size = sizeof(uint32_t), .value.uint32_val = 15000},
         .validator = validate_communication_interval,
         .read_only = false,
         .requires_restart = false
@@ -66,7 +167,8 @@ static const config_entry_t config_entries[CONFIG_KEY_MAX] = {
         .key = CONFIG_KEY_SAFETY_LIMITS,
         .name = "safety_limits",
         .type = CONFIG_TYPE_BLOB,
-        .default_value = {.type = CONFIG_TYPE_BLOB, .size = 8, .value.blob_val = {10, 0, 0, 0, 30, 0, 0, 0}}, /* Battery 10%, Signal 30% */
+        .max_size = sizeof(default_safety_limits),
+        .default_value = {.type = CONFIG_TYPE_BLOB, .size = sizeof(default_safety_limits), .value.blob_val = default_safety_limits},
         .validator = validate_safety_limits,
         .read_only = false,
         .requires_restart = false
@@ -75,10 +177,11 @@ static const config_entry_t config_entries[CONFIG_KEY_MAX] = {
         .key = CONFIG_KEY_CALIBRATION_DATA,
         .name = "calibration_data",
         .type = CONFIG_TYPE_BLOB,
-        .default_value = {.type = CONFIG_TYPE_BLOB, .size = 32, .value.blob_val = {0}},
-        .validator = NULL, /* No validation for calibration data */
+        .max_size = CALIBRATION_BLOB_MAX_SIZE,
+        .default_value = {.type = CONFIG_TYPE_BLOB, .size = sizeof(default_calibration_data), .value.blob_val = default_calibration_data},
+        .validator = validate_calibration_data,
         .read_only = false,
-        .requires_restart = true
+        .requires_restart = false
     },
     {
         .key = CONFIG_KEY_DIAGNOSTIC_LEVEL,
@@ -110,28 +213,170 @@ int config_init(void)
     }
 
     k_mutex_init(&config_mutex);
+    k_work_init_delayable(&config_save_work, config_save_work_handler);
+    k_work_init_delayable(&config_notify_work, config_notify_work_handler);
+    atomic_clear(&config_dirty);
+    atomic_clear(&config_notify_pending);
+    atomic_clear(&config_restart_pending);
+    memset(config_observers, 0, sizeof(config_observers));
+
+    /* Lay out the arena from the schema */
+    size_t arena_used = 0;
+
+    for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+        const config_entry_t *entry = &config_entries[i];
+
+        if (!type_is_scalar(entry->type)) {
+            if (entry->max_size > CONFIG_VALUE_MAX_SIZE ||
+                arena_used + entry->max_size > sizeof(config_arena)) {
+                return CONFIG_ERROR_INVALID;
+            }
+            config_offsets[i] = (uint16_t)arena_used;
+            arena_used += entry->max_size;
+        }
+    }
 
     /* Initialize with default values */
+    atomic_clear(&config_seq);
     for (int i = 0; i < CONFIG_KEY_MAX; i++) {
-        config_values[i] = config_entries[i].default_value;
+        write_value(i, &config_entries[i].default_value);
     }
 
     config_initialized = true;
     return CONFIG_OK;
 }
 
+int config_deinit(void)
+{
+    struct k_work_sync sync;
+
+    if (!config_initialized) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    k_work_cancel_delayable_sync(&config_save_work, &sync);
+    k_work_cancel_delayable_sync(&config_notify_work, &sync);
+
+#ifdef STORE_ENABLED
+    /* NVS has no unmount; the next mount scans the partition afresh */
+    store_mounted = false;
+#endif
+
+    config_initialized = false;
+    return CONFIG_OK;
+}
+
 int config_load(void)
 {
-    /* In a real implementation, this would load from persistent storage */
-    /* For now, just use defaults */
+    if (!config_initialized) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+#ifdef STORE_ENABLED
+    if (store_mount() != 0) {
+        return CONFIG_ERROR_STORAGE;
+    }
+
+    /* Records from another format are ignored and replaced on the next save */
+    uint32_t version = 0;
+    bool compatible = nvs_read(&config_fs, STORE_ID_VERSION, &version, sizeof(version)) ==
+                      sizeof(version) && version == STORE_FORMAT_VERSION;
+    int loaded = 0;
+
+    for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+        const config_entry_t *entry = &config_entries[i];
+        uint8_t record[sizeof(store_header_t) + CONFIG_VALUE_MAX_SIZE];
+        config_value_t value;
+        int ret = store_read_key(i, record, sizeof(record), &value);
+
+        if (ret == -ENOENT) {
+            continue; /* Never changed from the default */
+        }
+
+        if (ret != 0 || !compatible || entry->read_only ||
+            check_value(entry, &value) != CONFIG_OK) {
+            mark_dirty(i);
+            continue;
+        }
+
+        k_mutex_lock(&config_mutex, K_FOREVER);
+        write_begin();
+        write_value(i, &value);
+        write_end();
+        k_mutex_unlock(&config_mutex);
+        loaded++;
+    }
+
+    /* Records valid on their own may still conflict; fall back to defaults */
+    k_mutex_lock(&config_mutex, K_FOREVER);
+    uint32_t conflicts = find_conflicts(config_scalars);
+
+    if (conflicts != 0U) {
+        write_begin();
+        for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+            if (conflicts & BIT(i)) {
+                write_value(i, &config_entries[i].default_value);
+                mark_dirty(i);
+            }
+        }
+        write_end();
+    }
+    k_mutex_unlock(&config_mutex);
+
+    if (conflicts != 0U) {
+        DIAG_WARNING(DIAG_CAT_SYSTEM, "Config stored keys 0x%x conflict, using defaults", conflicts);
+    }
+
+    if (!compatible) {
+        version = STORE_FORMAT_VERSION;
+        if (nvs_write(&config_fs, STORE_ID_VERSION, &version, sizeof(version)) < 0) {
+            return CONFIG_ERROR_STORAGE;
+        }
+    }
+
+    DIAG_INFO(DIAG_CAT_SYSTEM, "Config loaded: %d stored key(s)", loaded);
     return CONFIG_OK;
+#else
+    return CONFIG_ERROR_STORAGE;
+#endif
 }
 
 int config_save(void)
 {
-    /* In a real implementation, this would save to persistent storage */
-    /* For now, just return success */
-    return CONFIG_OK;
+    if (!config_initialized) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+#ifdef STORE_ENABLED
+    if (store_mount() != 0) {
+        return CONFIG_ERROR_STORAGE;
+    }
+
+    /* Keys changed while saving are marked again and caught next time */
+    atomic_val_t dirty = atomic_clear(&config_dirty);
+    int ret = CONFIG_OK;
+    int written = 0;
+
+    for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+        if (!(dirty & BIT(i))) {
+            continue;
+        }
+
+        if (store_write_key(i) != 0) {
+            atomic_set_bit(&config_dirty, i);
+            ret = CONFIG_ERROR_STORAGE;
+            continue;
+        }
+        written++;
+    }
+
+    if (written > 0) {
+        DIAG_DEBUG(DIAG_CAT_SYSTEM, "Config saved: %d key(s)", written);
+    }
+    return ret;
+#else
+    return CONFIG_ERROR_STORAGE;
+#endif
 }
 
 int config_get(config_key_t key, config_value_t *value)
@@ -140,9 +385,12 @@ int config_get(config_key_t key, config_value_t *value)
         return CONFIG_ERROR_INVALID;
     }
 
-    k_mutex_lock(&config_mutex, K_FOREVER);
-    *value = config_values[key];
-    k_mutex_unlock(&config_mutex);
+    uint32_t seq;
+
+    do {
+        seq = config_read_begin();
+        read_value(key, value);
+    } while (config_read_retry(seq));
 
     return CONFIG_OK;
 }
@@ -160,37 +408,41 @@ int config_set(config_key_t key, const config_value_t *value)
         return CONFIG_ERROR_READ_ONLY;
     }
 
-    /* Check type compatibility */
-    if (value->type != entry->type) {
-        return CONFIG_ERROR_INVALID;
+    /* Check type, size and validator */
+    int ret = check_value(entry, value);
+    if (ret != CONFIG_OK) {
+        return ret;
     }
 
-    /* Validate value */
-    if (entry->validator && !entry->validator(value)) {
+    k_mutex_lock(&config_mutex, K_FOREVER);
+    if (!consistent_with(key, value)) {
+        k_mutex_unlock(&config_mutex);
         return CONFIG_ERROR_VALIDATION;
     }
 
-    k_mutex_lock(&config_mutex, K_FOREVER);
-    config_values[key] = *value;
+    write_begin();
+    bool changed = write_value(key, value);
+    write_end();
     k_mutex_unlock(&config_mutex);
 
+    if (changed) {
+        mark_changed(key);
+    }
+
     return CONFIG_OK;
 }
 
 int config_get_uint32(config_key_t key, uint32_t *value)
 {
-    config_value_t config_val;
-    int ret = config_get(key, &config_val);
-    
-    if (ret == CONFIG_OK) {
-        if (config_val.type == CONFIG_TYPE_UINT32) {
-            *value = config_val.value.uint32_val;
-        } else {
-            ret = CONFIG_ERROR_INVALID;
-        }
+    if (!config_initialized || key >= CONFIG_KEY_MAX || value == NULL ||
+        config_entries[key].type != CONFIG_TYPE_UINT32) {
+        return CONFIG_ERROR_INVALID;
     }
-    
-    return ret;
+
+    /* A single aligned word: no retry needed */
+    *value = config_scalars[key];
+
+    return CONFIG_OK;
 }
 
 int config_set_uint32(config_key_t key, uint32_t value)
@@ -206,18 +458,15 @@ int config_set_uint32(config_key_t key, uint32_t value)
 
 int config_get_float(config_key_t key, float *value)
 {
-    config_value_t config_val;
-    int ret = config_get(key, &config_val);
-    
-    if (ret == CONFIG_OK) {
-        if (config_val.type == CONFIG_TYPE_FLOAT) {
-            *value = config_val.value.float_val;
-        } else {
-            ret = CONFIG_ERROR_INVALID;
-        }
+    if (!config_initialized || key >= CONFIG_KEY_MAX || value == NULL ||
+        config_entries[key].type != CONFIG_TYPE_FLOAT) {
+        return CONFIG_ERROR_INVALID;
     }
-    
-    return ret;
+
+    uint32_t word = config_scalars[key];
+    memcpy(value, &word, sizeof(*value));
+
+    return CONFIG_OK;
 }
 
 int config_set_float(config_key_t key, float value)
@@ -233,18 +482,14 @@ int config_set_float(config_key_t key, float value)
 
 int config_get_bool(config_key_t key, bool *value)
 {
-    config_value_t config_val;
-    int ret = config_get(key, &config_val);
-    
-    if (ret == CONFIG_OK) {
-        if (config_val.type == CONFIG_TYPE_BOOL) {
-            *value = config_val.value.bool_val;
-        } else {
-            ret = CONFIG_ERROR_INVALID;
-        }
+    if (!config_initialized || key >= CONFIG_KEY_MAX || value == NULL ||
+        config_entries[key].type != CONFIG_TYPE_BOOL) {
+        return CONFIG_ERROR_INVALID;
     }
-    
-    return ret;
+
+    *value = config_scalars[key] != 0U;
+
+    return CONFIG_OK;
 }
 
 int config_set_bool(config_key_t key, bool value)
@@ -260,19 +505,22 @@ int config_set_bool(config_key_t key, bool value)
 
 int config_get_string(config_key_t key, char *value, size_t max_len)
 {
-    config_value_t config_val;
-    int ret = config_get(key, &config_val);
-    
-    if (ret == CONFIG_OK) {
-        if (config_val.type == CONFIG_TYPE_STRING) {
-            strncpy(value, config_val.value.string_val, max_len - 1);
-            value[max_len - 1] = '\0';
-        } else {
-            ret = CONFIG_ERROR_INVALID;
-        }
+    if (!config_initialized || key >= CONFIG_KEY_MAX || value == NULL || max_len == 0 ||
+        config_entries[key].type != CONFIG_TYPE_STRING) {
+        return CONFIG_ERROR_INVALID;
     }
-    
-    return ret;
+
+    uint32_t seq;
+    size_t len;
+
+    do {
+        seq = config_read_begin();
+        len = MIN((size_t)config_sizes[key], max_len);
+        memcpy(value, &config_arena[config_offsets[key]], len);
+    } while (config_read_retry(seq));
+
+    value[(len > 0) ? len - 1 : 0] = '\0';
+    return CONFIG_OK;
 }
 
 int config_set_string(config_key_t key, const char *value)
@@ -283,15 +531,201 @@ int config_set_string(config_key_t key, const char *value)
     
     config_value_t config_val = {
         .type = CONFIG_TYPE_STRING,
-        .size = strlen(value) + 1
+        .size = strlen(value) + 1,
+        .value.string_val = value
     };
     
-    strncpy(config_val.value.string_val, value, sizeof(config_val.value.string_val) - 1);
-    config_val.value.string_val[sizeof(config_val.value.string_val) - 1] = '\0';
-    
     return config_set(key, &config_val);
 }
 
+int config_get_blob(config_key_t key, void *data, size_t max_len, size_t *len)
+{
+    if (!config_initialized || key >= CONFIG_KEY_MAX || data == NULL ||
+        config_entries[key].type != CONFIG_TYPE_BLOB) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    uint32_t seq;
+    size_t size;
+
+    do {
+        seq = config_read_begin();
+        size = config_sizes[key];
+        if (size <= max_len) {
+            memcpy(data, &config_arena[config_offsets[key]], size);
+        }
+    } while (config_read_retry(seq));
+
+    if (len) {
+        *len = size;
+    }
+    return (size <= max_len) ? CONFIG_OK : CONFIG_ERROR_INVALID;
+}
+
+int config_set_blob(config_key_t key, const void *data, size_t len)
+{
+    if (data == NULL) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    config_value_t config_val = {
+        .type = CONFIG_TYPE_BLOB,
+        .size = len,
+        .value.blob_val = data
+    };
+
+    return config_set(key, &config_val);
+}
+
+int config_begin(config_txn_t *txn)
+{
+    if (!config_initialized || txn == NULL) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    txn->staged = 0U;
+    return CONFIG_OK;
+}
+
+int config_txn_set(config_txn_t *txn, config_key_t key, const config_value_t *value)
+{
+    if (!config_initialized || txn == NULL || key >= CONFIG_KEY_MAX || value == NULL) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    const config_entry_t *entry = &config_entries[key];
+
+    if (entry->read_only) {
+        return CONFIG_ERROR_READ_ONLY;
+    }
+
+    /* Per-key checks now; cross-key constraints once, at commit */
+    int ret = check_value(entry, value);
+    if (ret != CONFIG_OK) {
+        return ret;
+    }
+
+    if (type_is_scalar(value->type)) {
+        txn->scalars[key] = scalar_from_value(value);
+    } else {
+        memcpy(&txn->data[config_offsets[key]], value->value.blob_val, value->size);
+    }
+    txn->sizes[key] = (uint16_t)value->size;
+    txn->staged |= BIT(key);
+
+    return CONFIG_OK;
+}
+
+int config_txn_set_uint32(config_txn_t *txn, config_key_t key, uint32_t value)
+{
+    config_value_t config_val = {
+        .type = CONFIG_TYPE_UINT32,
+        .size = sizeof(uint32_t),
+        .value.uint32_val = value
+    };
+
+    return config_txn_set(txn, key, &config_val);
+}
+
+int config_txn_set_float(config_txn_t *txn, config_key_t key, float value)
+{
+    config_value_t config_val = {
+        .type = CONFIG_TYPE_FLOAT,
+        .size = sizeof(float),
+        .value.float_val = value
+    };
+
+    return config_txn_set(txn, key, &config_val);
+}
+
+int config_txn_set_bool(config_txn_t *txn, config_key_t key, bool value)
+{
+    config_value_t config_val = {
+        .type = CONFIG_TYPE_BOOL,
+        .size = sizeof(bool),
+        .value.bool_val = value
+    };
+
+    return config_txn_set(txn, key, &config_val);
+}
+
+int config_txn_set_blob(config_txn_t *txn, config_key_t key, const void *data, size_t len)
+{
+    if (data == NULL) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    config_value_t config_val = {
+        .type = CONFIG_TYPE_BLOB,
+        .size = len,
+        .value.blob_val = data
+    };
+
+    return config_txn_set(txn, key, &config_val);
+}
+
+int config_commit(config_txn_t *txn)
+{
+    if (!config_initialized || txn == NULL) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    uint32_t scalars[CONFIG_KEY_MAX];
+    uint32_t changed = 0U;
+    int ret = CONFIG_OK;
+
+    k_mutex_lock(&config_mutex, K_FOREVER);
+
+    /* Check the configuration as it will be once every staged key is applied */
+    memcpy(scalars, config_scalars, sizeof(scalars));
+    for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+        if ((txn->staged & BIT(i)) && type_is_scalar(config_entries[i].type)) {
+            scalars[i] = txn->scalars[i];
+        }
+    }
+
+    if (find_conflicts(scalars) != 0U) {
+        ret = CONFIG_ERROR_VALIDATION;
+    } else if (txn->staged != 0U) {
+        /* One sequence bump: readers see all of the batch or none of it */
+        write_begin();
+        for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+            config_value_t value;
+
+            if (txn->staged & BIT(i)) {
+                txn_view(txn, i, &value);
+                if (write_value(i, &value)) {
+                    changed |= BIT(i);
+                }
+            }
+        }
+        write_end();
+    }
+
+    k_mutex_unlock(&config_mutex);
+
+    for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+        if (changed & BIT(i)) {
+            mark_changed(i);
+        }
+    }
+
+    /* The batch is complete: persist it now in one save pass */
+    if (changed != 0U) {
+        k_work_reschedule(&config_save_work, K_NO_WAIT);
+    }
+
+    txn->staged = 0U;
+    return ret;
+}
+
+void config_abort(config_txn_t *txn)
+{
+    if (txn != NULL) {
+        txn->staged = 0U;
+    }
+}
+
 int config_reset_to_defaults(void)
 {
     if (!config_initialized) {
@@ -299,11 +733,15 @@ int config_reset_to_defaults(void)
     }
 
     k_mutex_lock(&config_mutex, K_FOREVER);
+    write_begin();
     
     for (int i = 0; i < CONFIG_KEY_MAX; i++) {
-        config_values[i] = config_entries[i].default_value;
+        if (write_value(i, &config_entries[i].default_value)) {
+            mark_changed(i);
+        }
     }
     
+    write_end();
     k_mutex_unlock(&config_mutex);
     return CONFIG_OK;
 }
@@ -321,7 +759,16 @@ int config_reset_key(config_key_t key)
     }
 
     k_mutex_lock(&config_mutex, K_FOREVER);
-    config_values[key] = entry->default_value;
+    if (!consistent_with(key, &entry->default_value)) {
+        k_mutex_unlock(&config_mutex);
+        return CONFIG_ERROR_VALIDATION;
+    }
+
+    write_begin();
+    if (write_value(key, &entry->default_value)) {
+        mark_changed(key);
+    }
+    write_end();
     k_mutex_unlock(&config_mutex);
 
     return CONFIG_OK;
@@ -335,23 +782,30 @@ int config_validate_all(config_key_t *invalid_keys, size_t max_invalid,
     }
 
     int invalid_count = 0;
-    
-    if (actual_invalid) {
-        *actual_invalid = 0;
-    }
+    size_t stored = 0;
+
+    k_mutex_lock(&config_mutex, K_FOREVER);
 
     for (int i = 0; i < CONFIG_KEY_MAX; i++) {
         const config_entry_t *entry = &config_entries[i];
-        
-        if (entry->validator && !entry->validator(&config_values[i])) {
+        config_value_t value;
+
+        read_value(i, &value);
+        if (entry->validator && !entry->validator(&value)) {
             invalid_count++;
             
-            if (invalid_keys && *actual_invalid < max_invalid) {
-                invalid_keys[(*actual_invalid)++] = i;
+            if (invalid_keys && stored < max_invalid) {
+                invalid_keys[stored++] = i;
             }
         }
     }
 
+    k_mutex_unlock(&config_mutex);
+
+    if (actual_invalid) {
+        *actual_invalid = stored;
+    }
+
     return invalid_count;
 }
 
@@ -365,6 +819,56 @@ int config_get_entry_info(config_key_t key, config_entry_t *entry)
     return CONFIG_OK;
 }
 
+int config_add_observer(config_observer_t observer, uint32_t key_mask, void *user_data)
+{
+    if (!config_initialized || observer == NULL || key_mask == 0U) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    int ret = CONFIG_ERROR_FULL;
+
+    k_mutex_lock(&config_mutex, K_FOREVER);
+    for (int i = 0; i < CONFIG_MAX_OBSERVERS; i++) {
+        if (config_observers[i].observer == NULL) {
+            config_observers[i].observer = observer;
+            config_observers[i].key_mask = key_mask;
+            config_observers[i].user_data = user_data;
+            ret = CONFIG_OK;
+            break;
+        }
+    }
+    k_mutex_unlock(&config_mutex);
+
+    return ret;
+}
+
+uint32_t config_get_restart_pending(void)
+{
+    return (uint32_t)atomic_get(&config_restart_pending);
+}
+
+uint32_t config_read_begin(void)
+{
+    atomic_val_t seq;
+
+    /* Only reachable on SMP or from an ISR-preempted writer */
+    while ((seq = atomic_get(&config_seq)) & 1) {
+        k_yield();
+    }
+
+    return (uint32_t)seq;
+}
+
+bool config_read_retry(uint32_t seq)
+{
+    return (uint32_t)atomic_get(&config_seq) != seq;
+}
+
+uint32_t config_get_version(void)
+{
+    return (uint32_t)atomic_get(&config_seq) / 2U;
+}
+
 const char *config_get_key_name(config_key_t key)
 {
     if (key < CONFIG_KEY_MAX) {
@@ -386,8 +890,19 @@ static bool validate_sampling_rate(const config_value_t *value)
 
 static bool validate_alert_thresholds(const config_value_t *value)
 {
-    /* Basic validation - check if values are reasonable */
-    return value->size >= 16; /* At least 4 uint32 values */
+    if (value->size != sizeof(default_alert_thresholds)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < ALERT_THRESHOLD_COUNT; i++) {
+        uint32_t threshold = sys_get_le32(&value->value.blob_val[i * sizeof(uint32_t)]);
+
+        if (threshold != 0U && (threshold < alert_threshold_ranges[i].min ||
+                                threshold > alert_threshold_ranges[i].max)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 static bool validate_communication_interval(const config_value_t *value)
@@ -406,7 +921,363 @@ static bool validate_safety_limits(const config_value_t *value)
     return value->size >= 8; /* At least 2 uint32 values */
 }
 
+static bool validate_calibration_data(const config_value_t *value)
+{
+    return calibration_validate(value->value.blob_val, value->size) == CALIBRATION_OK;
+}
+
 static bool validate_diagnostic_level(const config_value_t *value)
 {
     return value->value.uint32_val <= 4; /* LOG_LEVEL_CRITICAL */
-}
\ No newline at end of file
+}
+
+/* Typed storage */
+static bool type_is_scalar(config_type_t type)
+{
+    return type == CONFIG_TYPE_UINT32 || type == CONFIG_TYPE_FLOAT || type == CONFIG_TYPE_BOOL;
+}
+
+static uint32_t scalar_from_value(const config_value_t *value)
+{
+    uint32_t word = 0;
+
+    switch (value->type) {
+    case CONFIG_TYPE_UINT32:
+        word = value->value.uint32_val;
+        break;
+    case CONFIG_TYPE_FLOAT:
+        memcpy(&word, &value->value.float_val, sizeof(word));
+        break;
+    case CONFIG_TYPE_BOOL:
+        word = value->value.bool_val ? 1U : 0U;
+        break;
+    default:
+        break;
+    }
+
+    return word;
+}
+
+static void value_from_scalar(config_type_t type, uint32_t word, config_value_t *value)
+{
+    memset(value, 0, sizeof(*value));
+    value->type = type;
+
+    switch (type) {
+    case CONFIG_TYPE_UINT32:
+        value->size = sizeof(uint32_t);
+        value->value.uint32_val = word;
+        break;
+    case CONFIG_TYPE_FLOAT:
+        value->size = sizeof(float);
+        memcpy(&value->value.float_val, &word, sizeof(word));
+        break;
+    default:
+        value->size = sizeof(bool);
+        value->value.bool_val = word != 0U;
+        break;
+    }
+}
+
+/* Caller holds config_mutex; strings and blobs point into the arena */
+static void read_value(config_key_t key, config_value_t *value)
+{
+    config_type_t type = config_entries[key].type;
+
+    if (type_is_scalar(type)) {
+        value_from_scalar(type, config_scalars[key], value);
+        return;
+    }
+
+    memset(value, 0, sizeof(*value));
+    value->type = type;
+    value->size = config_sizes[key];
+    value->value.blob_val = &config_arena[config_offsets[key]];
+}
+
+/* Staged value of a key; strings and blobs point into the transaction */
+static void txn_view(const config_txn_t *txn, config_key_t key, config_value_t *value)
+{
+    config_type_t type = config_entries[key].type;
+
+    if (type_is_scalar(type)) {
+        value_from_scalar(type, txn->scalars[key], value);
+        return;
+    }
+
+    memset(value, 0, sizeof(*value));
+    value->type = type;
+    value->size = txn->sizes[key];
+    value->value.blob_val = &txn->data[config_offsets[key]];
+}
+
+/* Caller holds config_mutex and has checked the value; returns true if it changed */
+static bool write_value(config_key_t key, const config_value_t *value)
+{
+    if (type_is_scalar(value->type)) {
+        uint32_t word = scalar_from_value(value);
+        bool changed = config_scalars[key] != word;
+
+        config_scalars[key] = word;
+        return changed;
+    }
+
+    uint8_t *slot = &config_arena[config_offsets[key]];
+    bool changed = config_sizes[key] != value->size ||
+                   (value->size > 0 && memcmp(slot, value->value.blob_val, value->size) != 0);
+
+    if (changed && value->size > 0) {
+        memmove(slot, value->value.blob_val, value->size);
+    }
+    if (changed) {
+        config_sizes[key] = (uint16_t)value->size;
+    }
+    return changed;
+}
+
+static int check_value(const config_entry_t *entry, const config_value_t *value)
+{
+    /* Check type compatibility */
+    if (value->type != entry->type) {
+        return CONFIG_ERROR_INVALID;
+    }
+
+    if (!type_is_scalar(value->type)) {
+        if (value->size > entry->max_size || (value->size > 0 && value->value.blob_val == NULL)) {
+            return CONFIG_ERROR_INVALID;
+        }
+        if (value->type == CONFIG_TYPE_STRING &&
+            (value->size == 0 || value->value.string_val[value->size - 1] != '\0')) {
+            return CONFIG_ERROR_INVALID;
+        }
+    }
+
+    /* Validate value */
+    if (entry->validator && !entry->validator(value)) {
+        return CONFIG_ERROR_VALIDATION;
+    }
+
+    return CONFIG_OK;
+}
+
+static bool value_equal(const config_value_t *a, const config_value_t *b)
+{
+    if (a->type != b->type) {
+        return false;
+    }
+
+    if (type_is_scalar(a->type)) {
+        return scalar_from_value(a) == scalar_from_value(b);
+    }
+
+    return a->size == b->size && memcmp(a->value.blob_val, b->value.blob_val, a->size) == 0;
+}
+
+/* Cross-key constraints over scalar keys; returns the keys in conflict */
+static uint32_t find_conflicts(const uint32_t scalars[CONFIG_KEY_MAX])
+{
+    uint32_t conflicts = 0U;
+
+    /* Power management caps the sampling rate */
+    if (scalars[CONFIG_KEY_POWER_MANAGEMENT] != 0U &&
+        scalars[CONFIG_KEY_SAMPLING_RATE] > CONFIG_POWER_SAVE_MAX_RATE_HZ) {
+        conflicts |= BIT(CONFIG_KEY_POWER_MANAGEMENT) | BIT(CONFIG_KEY_SAMPLING_RATE);
+    }
+
+    return conflicts;
+}
+
+/* Caller holds config_mutex; true if setting key to value keeps the constraints */
+static bool consistent_with(config_key_t key, const config_value_t *value)
+{
+    uint32_t scalars[CONFIG_KEY_MAX];
+
+    if (!type_is_scalar(value->type)) {
+        return true;
+    }
+
+    memcpy(scalars, config_scalars, sizeof(scalars));
+    scalars[key] = scalar_from_value(value);
+    return find_conflicts(scalars) == 0U;
+}
+
+/* Sequence lock (caller holds config_mutex) */
+static void write_begin(void)
+{
+    k_sched_lock();
+    atomic_inc(&config_seq);
+}
+
+static void write_end(void)
+{
+    atomic_inc(&config_seq);
+    k_sched_unlock();
+}
+
+/* Change tracking */
+static void mark_dirty(config_key_t key)
+{
+    atomic_set_bit(&config_dirty, key);
+
+    /* Coalesce bursts of changes into one save; does not push back a pending save */
+    k_work_schedule(&config_save_work, K_MSEC(CONFIG_SAVE_DELAY_MS));
+}
+
+static void mark_changed(config_key_t key)
+{
+    mark_dirty(key);
+
+    if (config_entries[key].requires_restart) {
+        atomic_set_bit(&config_restart_pending, key);
+    }
+
+    atomic_set_bit(&config_notify_pending, key);
+    k_work_schedule(&config_notify_work, K_MSEC(CONFIG_NOTIFY_DELAY_MS));
+}
+
+static void config_notify_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint32_t changed = (uint32_t)atomic_clear(&config_notify_pending);
+    uint32_t restart = changed & config_get_restart_pending();
+
+    for (int i = 0; i < CONFIG_KEY_MAX; i++) {
+        if (restart & BIT(i)) {
+            DIAG_INFO(DIAG_CAT_SYSTEM, "Config %s changed, applies after restart",
+                      config_entries[i].name);
+        }
+    }
+
+    for (int i = 0; i < CONFIG_MAX_OBSERVERS; i++) {
+        k_mutex_lock(&config_mutex, K_FOREVER);
+        config_observer_t observer = config_observers[i].observer;
+        uint32_t mask = config_observers[i].key_mask & changed;
+        void *user_data = config_observers[i].user_data;
+        k_mutex_unlock(&config_mutex);
+
+        /* Called unlocked, so observers may read or set configuration */
+        if (observer != NULL && mask != 0U) {
+            observer(mask, user_data);
+        }
+    }
+}
+
+static void config_save_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    if (config_save() == CONFIG_ERROR_STORAGE) {
+        DIAG_WARNING(DIAG_CAT_SYSTEM, "Config autosave failed");
+    }
+}
+
+#ifdef STORE_ENABLED
+/* Persistent storage */
+static int store_mount(void)
+{
+    if (store_mounted) {
+        return 0;
+    }
+
+    const struct device *dev = FIXED_PARTITION_DEVICE(storage_partition);
+    struct flash_pages_info info;
+
+    if (!device_is_ready(dev)) {
+        return -ENODEV;
+    }
+
+    config_fs.flash_device = dev;
+    config_fs.offset = FIXED_PARTITION_OFFSET(storage_partition);
+
+    int ret = flash_get_page_info_by_offs(dev, config_fs.offset, &info);
+    if (ret != 0) {
+        return ret;
+    }
+
+    config_fs.sector_size = info.size;
+    config_fs.sector_count = FIXED_PARTITION_SIZE(storage_partition) / info.size;
+
+    ret = nvs_mount(&config_fs);
+    if (ret != 0) {
+        DIAG_ERROR(DIAG_CAT_SYSTEM, "Config storage mount failed: %d", ret);
+        return ret;
+    }
+
+    store_mounted = true;
+    return 0;
+}
+
+static int store_write_key(config_key_t key)
+{
+    uint16_t id = STORE_ID_KEY_BASE + key;
+    uint8_t record[sizeof(store_header_t) + CONFIG_VALUE_MAX_SIZE];
+    store_header_t header = {.type = (uint8_t)config_entries[key].type};
+    config_value_t current;
+
+    k_mutex_lock(&config_mutex, K_FOREVER);
+    read_value(key, &current);
+    bool is_default = value_equal(&current, &config_entries[key].default_value);
+    if (type_is_scalar(current.type)) {
+        header.size = sizeof(uint32_t);
+        memcpy(&record[sizeof(header)], &config_scalars[key], sizeof(uint32_t));
+    } else {
+        header.size = (uint16_t)current.size;
+        memcpy(&record[sizeof(header)], current.value.blob_val, current.size);
+    }
+    k_mutex_unlock(&config_mutex);
+
+    /* Defaults are not stored, so boot only reads keys that were changed */
+    if (is_default) {
+        int ret = nvs_delete(&config_fs, id);
+        return (ret == 0 || ret == -ENOENT) ? 0 : ret;
+    }
+
+    memcpy(record, &header, sizeof(header));
+
+    /* NVS skips the write when the stored record is identical */
+    ssize_t ret = nvs_write(&config_fs, id, record, sizeof(header) + header.size);
+    return (ret < 0) ? (int)ret : 0;
+}
+
+/* Decodes into a view pointing into record */
+static int store_read_key(config_key_t key, uint8_t *record, size_t record_size,
+                          config_value_t *value)
+{
+    store_header_t header;
+
+    ssize_t len = nvs_read(&config_fs, STORE_ID_KEY_BASE + key, record, record_size);
+    if (len < 0) {
+        return (int)len;
+    }
+
+    if ((size_t)len < sizeof(header) || (size_t)len > record_size) {
+        return -EINVAL;
+    }
+
+    memcpy(&header, record, sizeof(header));
+    if (header.type != config_entries[key].type ||
+        sizeof(header) + header.size != (size_t)len) {
+        return -EINVAL;
+    }
+
+    const uint8_t *data = &record[sizeof(header)];
+
+    memset(value, 0, sizeof(*value));
+    value->type = (config_type_t)header.type;
+    value->size = header.size;
+
+    if (type_is_scalar(value->type)) {
+        uint32_t word;
+
+        if (header.size != sizeof(word)) {
+            return -EINVAL;
+        }
+        memcpy(&word, data, sizeof(word));
+        value_from_scalar(value->type, word, value);
+    } else {
+        value->value.blob_val = data;
+    }
+    return 0;
+}
+#endif
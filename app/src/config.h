@@ -34,7 +34,21 @@ typedef enum {
     CONFIG_TYPE_BLOB
 } config_type_t;
 
-/* Configuration value structure */
+/* Largest string (including terminator) or blob a key may hold */
+#define CONFIG_VALUE_MAX_SIZE   128
+
+/* Storage shared by all string and blob keys */
+#define CONFIG_ARENA_SIZE       160
+
+/* Highest sampling rate allowed while power management is enabled */
+#define CONFIG_POWER_SAVE_MAX_RATE_HZ 250
+
+/*
+ * Configuration value view. Scalars are carried by value; strings and blobs
+ * point at caller memory (for config_set) or into the store (for config_get,
+ * valid until the key is next written - use config_get_string()/
+ * config_get_blob() for a private copy, or check config_read_retry()).
+ */
 typedef struct {
     config_type_t type;
     size_t size;
@@ -42,8 +56,8 @@ typedef struct {
         uint32_t uint32_val;
         float float_val;
         bool bool_val;
-        char string_val[64];
-        uint8_t blob_val[256];
+        const char *string_val;
+        const uint8_t *blob_val;
     } value;
 } config_value_t;
 
@@ -55,12 +69,24 @@ typedef struct {
     config_key_t key;
     const char *name;
     config_type_t type;
+    size_t max_size;                /* Capacity for string and blob keys */
     config_value_t default_value;
     config_validator_t validator;
     bool read_only;
     bool requires_restart;
 } config_entry_t;
 
+/*
+ * Staged batch of changes (see config_begin()). Caller-owned, so building a
+ * transaction holds no lock; values are copied in as they are staged.
+ */
+typedef struct {
+    uint32_t staged;                        /* CONFIG_KEY_BIT() mask */
+    uint32_t scalars[CONFIG_KEY_MAX];
+    uint16_t sizes[CONFIG_KEY_MAX];
+    uint8_t data[CONFIG_ARENA_SIZE];        /* Same layout as the store */
+} config_txn_t;
+
 /* Configuration error codes */
 #define CONFIG_OK                0
 #define CONFIG_ERROR_INVALID    -1
@@ -68,6 +94,23 @@ typedef struct {
 #define CONFIG_ERROR_READ_ONLY  -3
 #define CONFIG_ERROR_VALIDATION -4
 #define CONFIG_ERROR_STORAGE    -5
+#define CONFIG_ERROR_FULL       -6
+
+/* Change notification */
+#define CONFIG_MAX_OBSERVERS    4
+#define CONFIG_NOTIFY_DELAY_MS  50
+
+/* Key mask bit for a configuration key */
+#define CONFIG_KEY_BIT(key)     BIT(key)
+
+/**
+ * @brief Configuration change observer
+ * @details Runs on the system work queue. Changes made within
+ * CONFIG_NOTIFY_DELAY_MS of each other arrive as one call.
+ * @param changed_keys Mask of CONFIG_KEY_BIT() for the keys that changed
+ * @param user_data User data registered with the observer
+ */
+typedef void (*config_observer_t)(uint32_t changed_keys, void *user_data);
 
 /**
  * @brief Initialize configuration system
@@ -75,15 +118,32 @@ typedef struct {
  */
 int config_init(void);
 
+/**
+ * @brief Stop the configuration system, as a reset would
+ * @details Pending autosave and change notifications are dropped, so
+ * changes not yet saved are lost, and observers are unregistered. Stored
+ * records stay: config_init() followed by config_load() mounts the storage
+ * again and brings back what was saved.
+ * @return CONFIG_OK on success, CONFIG_ERROR_INVALID if not initialized
+ */
+int config_deinit(void);
+
+/* Delay between a change and its automatic save, coalescing bursts of sets */
+#define CONFIG_SAVE_DELAY_MS    2000
+
 /**
  * @brief Load configuration from persistent storage
- * @return CONFIG_OK on success, error code otherwise
+ * @details Reads one NVS record per key from the storage partition. Keys
+ * never changed from their default have no record.
+ * @return CONFIG_OK on success, CONFIG_ERROR_STORAGE if no storage is available
  */
 int config_load(void);
 
 /**
  * @brief Save configuration to persistent storage
- * @return CONFIG_OK on success, error code otherwise
+ * @details Writes only the keys changed since the last save. Changes are
+ * also saved automatically CONFIG_SAVE_DELAY_MS after they are made.
+ * @return CONFIG_OK on success, CONFIG_ERROR_STORAGE if a write failed
  */
 int config_save(void);
 
@@ -97,6 +157,9 @@ int config_get(config_key_t key, config_value_t *value);
 
 /**
  * @brief Set configuration value
+ * @details Rejected with CONFIG_ERROR_VALIDATION if the change alone would
+ * break a cross-key constraint; change related keys together with a
+ * transaction (config_begin()).
  * @param key Configuration key
  * @param value Pointer to value to set
  * @return CONFIG_OK on success, error code otherwise
@@ -168,6 +231,101 @@ int config_get_string(config_key_t key, char *value, size_t max_len);
  */
 int config_set_string(config_key_t key, const char *value);
 
+/**
+ * @brief Get blob configuration value
+ * @param key Configuration key
+ * @param data Buffer to store blob
+ * @param max_len Size of buffer
+ * @param len Pointer to store blob size (optional)
+ * @return CONFIG_OK on success, CONFIG_ERROR_INVALID if the buffer is too small
+ */
+int config_get_blob(config_key_t key, void *data, size_t max_len, size_t *len);
+
+/**
+ * @brief Set blob configuration value
+ * @param key Configuration key
+ * @param data Blob to set
+ * @param len Blob size (at most the key's max_size)
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_set_blob(config_key_t key, const void *data, size_t len);
+
+/**
+ * @brief Start a transaction
+ * @details Stage related keys with config_txn_set() and friends, then apply
+ * them together with config_commit(): cross-key constraints are checked once
+ * against the combined result, readers see either none or all of the
+ * changes, and the batch is persisted in one save pass and reported to
+ * observers in one notification.
+ * @param txn Transaction to initialise
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_begin(config_txn_t *txn);
+
+/**
+ * @brief Stage a value in a transaction
+ * @details Type, size and the key's validator are checked here; staging a
+ * key again replaces the earlier value.
+ * @param txn Transaction
+ * @param key Configuration key
+ * @param value Value to stage (copied)
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_txn_set(config_txn_t *txn, config_key_t key, const config_value_t *value);
+
+/**
+ * @brief Stage a uint32 value in a transaction
+ * @param txn Transaction
+ * @param key Configuration key
+ * @param value Value to stage
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_txn_set_uint32(config_txn_t *txn, config_key_t key, uint32_t value);
+
+/**
+ * @brief Stage a float value in a transaction
+ * @param txn Transaction
+ * @param key Configuration key
+ * @param value Value to stage
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_txn_set_float(config_txn_t *txn, config_key_t key, float value);
+
+/**
+ * @brief Stage a boolean value in a transaction
+ * @param txn Transaction
+ * @param key Configuration key
+ * @param value Value to stage
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_txn_set_bool(config_txn_t *txn, config_key_t key, bool value);
+
+/**
+ * @brief Stage a blob value in a transaction
+ * @param txn Transaction
+ * @param key Configuration key
+ * @param data Blob to stage (copied)
+ * @param len Blob size (at most the key's max_size)
+ * @return CONFIG_OK on success, error code otherwise
+ */
+int config_txn_set_blob(config_txn_t *txn, config_key_t key, const void *data, size_t len);
+
+/**
+ * @brief Apply a transaction
+ * @details All or nothing: on error no key is changed. The transaction is
+ * emptied either way and may be reused.
+ * @param txn Transaction
+ * @return CONFIG_OK on success, CONFIG_ERROR_VALIDATION if the combined
+ * configuration breaks a cross-key constraint, error code otherwise
+ */
+int config_commit(config_txn_t *txn);
+
+/**
+ * @brief Discard a transaction's staged values
+ * @param txn Transaction
+ */
+void config_abort(config_txn_t *txn);
+
 /**
  * @brief Reset configuration to defaults
  * @return CONFIG_OK on success, error code otherwise
@@ -199,6 +357,45 @@ int config_validate_all(config_key_t *invalid_keys, size_t max_invalid,
  */
 int config_get_entry_info(config_key_t key, config_entry_t *entry);
 
+/**
+ * @brief Register a configuration change observer
+ * @param observer Callback
+ * @param key_mask Keys of interest (CONFIG_KEY_BIT() mask)
+ * @param user_data User data passed to the callback
+ * @return CONFIG_OK on success, CONFIG_ERROR_FULL if no observer slot is free
+ */
+int config_add_observer(config_observer_t observer, uint32_t key_mask, void *user_data);
+
+/**
+ * @brief Get keys changed since boot that only apply after a restart
+ * @return Mask of CONFIG_KEY_BIT() for entries with requires_restart set
+ */
+uint32_t config_get_restart_pending(void);
+
+/**
+ * @brief Start a lock-free read of one or more keys
+ * @details Never blocks. Read the keys, then call config_read_retry() and
+ * repeat the reads if it returns true; the values are then a consistent set
+ * from a single configuration version. The typed getters do this internally.
+ * @return Sequence to pass to config_read_retry()
+ */
+uint32_t config_read_begin(void);
+
+/**
+ * @brief Check whether a lock-free read must be repeated
+ * @param seq Sequence returned by config_read_begin()
+ * @return true if the configuration changed during the read
+ */
+bool config_read_retry(uint32_t seq);
+
+/**
+ * @brief Get the configuration version
+ * @details Increments on every update, so hot paths can cache derived values
+ * and refresh them only when the version moves.
+ * @return Configuration version
+ */
+uint32_t config_get_version(void);
+
 /**
  * @brief Get configuration key name
  * @param key Configuration key
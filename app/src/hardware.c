@@ -15,16 +15,21 @@
 #include "hardware.h"
 #include "common.h"
 #include "diagnostics.h"
+#include "safe_buffer.h"
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/uart.h>
+#ifdef CONFIG_PWM
+#include <zephyr/drivers/pwm.h>
+#endif
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/gap.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <zephyr/devicetree.h>
 #include <string.h>
 #include <math.h>
@@ -33,16 +38,30 @@
 /* Private Constants and Macros                                               */
 /*============================================================================*/
 
-/** @brief LED pattern timing constants (in milliseconds) */
-#define LED_PATTERN_SLOW_BLINK_PERIOD     1000U
-#define LED_PATTERN_FAST_BLINK_PERIOD     250U
-#define LED_PATTERN_BREATHING_PERIOD       2000U
-#define LED_PATTERN_HEARTBEAT_PERIOD       600U
-#define LED_PATTERN_SOS_PERIOD             100U
-#define LED_PATTERN_DOUBLE_BLINK_PERIOD    200U
+/** @brief Brightness at or above which a GPIO-only LED is switched on */
+#define LED_LEVEL_ON_THRESHOLD             128U
 
-/** @brief Button debounce time in milliseconds */
-#define BUTTON_DEBOUNCE_MS                 500U
+/** @brief Heart rate range mapped onto the heartbeat LED period */
+#define LED_HEARTBEAT_MIN_BPM              20U
+#define LED_HEARTBEAT_MAX_BPM              250U
+
+/** @brief Button debounce time in milliseconds (edges must settle this long) */
+#define BUTTON_DEBOUNCE_MS                 20U
+
+/** @brief Press duration at which a press counts as long */
+#define BUTTON_LONG_PRESS_MS               800U
+
+/** @brief Press duration at which a hold gesture fires */
+#define BUTTON_HOLD_MS                     3000U
+
+/** @brief Maximum release-to-press gap for a double press */
+#define BUTTON_DOUBLE_GAP_MS               300U
+
+/** @brief Depth of the ISR-to-work-queue button edge queue */
+#define BUTTON_EDGE_QUEUE_DEPTH            16U
+
+/** @brief Maximum number of registered button gesture handlers */
+#define BUTTON_MAX_HANDLERS                8U
 
 /** @brief DFU boot timeout in milliseconds */
 #define DFU_BOOT_TIMEOUT_MS                10000U
@@ -50,6 +69,27 @@
 /** @brief Bluetooth advertising interval in milliseconds */
 #define BLE_ADV_INTERVAL_MS                100U
 
+/** @brief Serial Bluetooth transmit ring size in bytes */
+#define UART_BT_TX_RING_SIZE               BUFFER_SIZE_MEDIUM
+
+/** @brief Maximum bytes handed to the UART in one DMA/FIFO transfer */
+#define UART_BT_TX_CHUNK_SIZE              64U
+
+/** @brief Serial Bluetooth transmit flag: transfer in flight */
+#define UART_BT_TX_BUSY                    0
+
+/** @brief Serial Bluetooth receive ring size in bytes (ISR producer) */
+#define UART_BT_RX_RING_SIZE               256U
+
+/** @brief Size of each async receive DMA buffer */
+#define UART_BT_RX_BUF_SIZE                64U
+
+/** @brief Async receive inactivity timeout before partial buffers are flushed */
+#define UART_BT_RX_TIMEOUT_US              1000
+
+/** @brief Receive poll period in polled mode while a receive callback is registered */
+#define UART_BT_RX_POLL_INTERVAL_MS        5
+
 /*============================================================================*/
 /* BLE GATT Service UUIDs                                                     */
 /*============================================================================*/
@@ -96,6 +136,51 @@ static const struct device *gpio_dev;
 /** @brief UART device for serial Bluetooth communication */
 static const struct device *uart_bt_dev;
 
+/** @brief Serial Bluetooth transmit path state */
+static struct {
+    hw_serial_mode_t mode;
+    safe_buffer_t ring;
+    struct k_mutex producer_mutex;
+    struct k_work work;
+    atomic_t flags;
+    uint32_t chunk_len;
+    uint32_t chunk_offset;
+    uint32_t burst_bytes;
+    uint32_t bytes_queued;
+    uint32_t bytes_sent;
+    uint32_t rejected;
+    hw_serial_bt_tx_cb_t done_cb;
+    void *done_cb_user_data;
+} uart_bt_tx;
+
+/** @brief Serial Bluetooth receive path state */
+static struct {
+    struct ring_buf ring;
+    struct k_mutex consumer_mutex;
+    struct k_work work;
+    struct k_work_delayable poll_work;
+    uint8_t next_buf;
+    uint32_t bytes;
+    uint32_t dropped;
+    uint32_t errors;
+    hw_serial_bt_rx_cb_t cb;
+    void *cb_user_data;
+} uart_bt_rx;
+
+/** @brief Serial Bluetooth receive ring storage */
+static uint8_t uart_bt_rx_ring_data[UART_BT_RX_RING_SIZE];
+
+#ifdef CONFIG_UART_ASYNC_API
+/** @brief Double-buffered async receive DMA targets */
+static uint8_t uart_bt_rx_bufs[2][UART_BT_RX_BUF_SIZE];
+#endif
+
+/** @brief Serial Bluetooth transmit ring storage */
+static uint8_t uart_bt_tx_ring_data[UART_BT_TX_RING_SIZE];
+
+/** @brief Staging buffer for the transfer in flight (EasyDMA source) */
+static uint8_t uart_bt_tx_chunk[UART_BT_TX_CHUNK_SIZE];
+
 /** @brief LED GPIO pins */
 static const uint32_t led_pins[HW_LED_COUNT] = {
     HW_LED1_PIN, HW_LED2_PIN, HW_LED3_PIN, HW_LED4_PIN
@@ -104,12 +189,125 @@ static const uint32_t led_pins[HW_LED_COUNT] = {
 /** @brief LED states for pattern management */
 static hw_led_state_t led_states[HW_LED_COUNT];
 
-/** @brief Button state tracking */
+/** @brief Keyframe playback state per LED */
+static struct {
+    const hw_led_keyframe_t *frames;
+    uint8_t count;
+    uint8_t index;
+    bool loop;
+    uint32_t period_ms;     /* 0 = natural sequence length */
+    uint32_t fixed_ms;      /* Sum of all keyframes but the last */
+    struct k_timer timer;
+} led_players[HW_LED_COUNT];
+
+/** @brief Protects led_players/led_states against the timer ISR */
+static struct k_spinlock led_lock;
+
+#ifdef CONFIG_PWM
+/** @brief Optional PWM channels for true brightness (pwm-ledN aliases) */
+static const struct pwm_dt_spec led_pwms[HW_LED_COUNT] = {
+    PWM_DT_SPEC_GET_OR(DT_ALIAS(pwm_led0), {0}),
+    PWM_DT_SPEC_GET_OR(DT_ALIAS(pwm_led1), {0}),
+    PWM_DT_SPEC_GET_OR(DT_ALIAS(pwm_led2), {0}),
+    PWM_DT_SPEC_GET_OR(DT_ALIAS(pwm_led3), {0}),
+};
+
+/** @brief LEDs driven by PWM rather than GPIO (bit per LED) */
+static uint8_t led_pwm_mask;
+#endif
+
+/*
+ * Pattern keyframe tables. Levels are brightness; on GPIO-only LEDs
+ * consecutive keyframes with the same on/off state are merged so the
+ * timer fires only on visible transitions.
+ */
+static const hw_led_keyframe_t led_kf_off[] = {
+    {HW_LED_KEYFRAME_HOLD, 0}
+};
+
+static const hw_led_keyframe_t led_kf_on[] = {
+    {HW_LED_KEYFRAME_HOLD, HW_LED_LEVEL_MAX}
+};
+
+static const hw_led_keyframe_t led_kf_slow_blink[] = {
+    {500, HW_LED_LEVEL_MAX}, {500, 0}
+};
+
+static const hw_led_keyframe_t led_kf_fast_blink[] = {
+    {125, HW_LED_LEVEL_MAX}, {125, 0}
+};
+
+/* 2 s triangle ramp; renders as a 1 Hz blink without PWM */
+static const hw_led_keyframe_t led_kf_breathing[] = {
+    {125, 16},  {125, 48},  {125, 96},  {125, 144},
+    {125, 192}, {125, 232}, {125, 255}, {125, 255},
+    {125, 232}, {125, 192}, {125, 144}, {125, 96},
+    {125, 48},  {125, 16},  {125, 0},   {125, 0}
+};
+
+static const hw_led_keyframe_t led_kf_heartbeat[] = {
+    {100, HW_LED_LEVEL_MAX}, {500, 0}
+};
+
+/* ... --- ... followed by a word gap */
+static const hw_led_keyframe_t led_kf_sos[] = {
+    {100, HW_LED_LEVEL_MAX}, {100, 0}, {100, HW_LED_LEVEL_MAX}, {100, 0},
+    {100, HW_LED_LEVEL_MAX}, {300, 0},
+    {300, HW_LED_LEVEL_MAX}, {100, 0}, {300, HW_LED_LEVEL_MAX}, {100, 0},
+    {300, HW_LED_LEVEL_MAX}, {300, 0},
+    {100, HW_LED_LEVEL_MAX}, {100, 0}, {100, HW_LED_LEVEL_MAX}, {100, 0},
+    {100, HW_LED_LEVEL_MAX}, {700, 0}
+};
+
+static const hw_led_keyframe_t led_kf_double_blink[] = {
+    {50, HW_LED_LEVEL_MAX}, {50, 0}, {50, HW_LED_LEVEL_MAX}, {50, 0}
+};
+
+/** @brief Keyframe sequence for each predefined pattern */
+static const struct {
+    const hw_led_keyframe_t *frames;
+    uint8_t count;
+} led_pattern_table[HW_PULSE_PATTERN_MAX] = {
+    [HW_PULSE_OFF]          = {led_kf_off,          ARRAY_SIZE(led_kf_off)},
+    [HW_PULSE_ON]           = {led_kf_on,           ARRAY_SIZE(led_kf_on)},
+    [HW_PULSE_SLOW_BLINK]   = {led_kf_slow_blink,   ARRAY_SIZE(led_kf_slow_blink)},
+    [HW_PULSE_FAST_BLINK]   = {led_kf_fast_blink,   ARRAY_SIZE(led_kf_fast_blink)},
+    [HW_PULSE_BREATHING]    = {led_kf_breathing,    ARRAY_SIZE(led_kf_breathing)},
+    [HW_PULSE_HEARTBEAT]    = {led_kf_heartbeat,    ARRAY_SIZE(led_kf_heartbeat)},
+    [HW_PULSE_SOS]          = {led_kf_sos,          ARRAY_SIZE(led_kf_sos)},
+    [HW_PULSE_DOUBLE_BLINK] = {led_kf_double_blink, ARRAY_SIZE(led_kf_double_blink)},
+};
+
+/** @brief Timestamped button edge captured by the ISR */
+struct button_edge {
+    uint32_t timestamp_ms;
+};
+
+K_MSGQ_DEFINE(button_edge_queue, sizeof(struct button_edge), BUTTON_EDGE_QUEUE_DEPTH, 4);
+
+/**
+ * @brief Button state tracking
+ * @details Everything except the GPIO callback is owned by the system work
+ * queue; the ISR only queues edges and reschedules settle_work.
+ */
 static struct {
     bool pressed;
     uint32_t press_count;
     uint32_t last_press_time;
     struct gpio_callback callback;
+    struct k_work_delayable settle_work;
+    struct k_work_delayable timeout_work;
+    uint32_t release_time;
+    bool hold_fired;
+    bool await_second;      /* Short press seen, double-press window open */
+    bool second_press;      /* Current press is the second of a double */
+    uint32_t edges_dropped;
+    struct {
+        hw_button_gesture_t gesture;
+        hw_button_handler_t handler;
+        void *user_data;
+    } handlers[BUTTON_MAX_HANDLERS];
+    uint32_t handler_count;
 } button_state;
 
 /** @brief DFU boot state */
@@ -153,9 +351,29 @@ static int init_button(void);
 static int init_uart_bt(void);
 static int init_bluetooth(void);
 static void button_callback(const struct device *dev, struct gpio_callback *cb, uint32_t pins);
-static void update_led_pattern(uint32_t led_id);
-static uint32_t calculate_pattern_state(hw_led_pattern_t pattern, uint32_t elapsed_ms);
+static void button_settle_work_handler(struct k_work *work);
+static void button_timeout_work_handler(struct k_work *work);
+static void button_arm_timeout(void);
+static void button_dispatch(hw_button_gesture_t gesture);
+static void button_dfu_handler(hw_button_gesture_t gesture, void *user_data);
+static int led_apply_level(uint32_t led_id, uint8_t level);
+static uint32_t led_frame_duration(uint32_t led_id, uint8_t index);
+static int led_play_locked(uint32_t led_id);
+static void led_timer_expiry(struct k_timer *timer);
+static int led_start(uint32_t led_id, const hw_led_keyframe_t *frames, uint32_t count, bool loop);
 static int send_uart_data(const uint8_t *data, uint32_t length);
+static void uart_bt_tx_work_handler(struct k_work *work);
+static void uart_bt_tx_chunk_done(uint32_t bytes_sent);
+static void uart_bt_rx_work_handler(struct k_work *work);
+static void uart_bt_rx_poll_work_handler(struct k_work *work);
+static void uart_bt_rx_push(const uint8_t *data, uint32_t length);
+#ifdef CONFIG_UART_ASYNC_API
+static void uart_bt_async_callback(const struct device *dev, struct uart_event *evt,
+                                   void *user_data);
+#endif
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+static void uart_bt_irq_handler(const struct device *dev, void *user_data);
+#endif
 
 /* BLE GATT callbacks */
 static void bt_connected_cb(struct bt_conn *conn, uint8_t err);
@@ -289,6 +507,9 @@ int hw_init(void)
     if (ret != HW_OK) {
         DIAG_WARNING(DIAG_CAT_HARDWARE, "Button interrupt initialization failed: %d", ret);
         /* Non-critical error, continue */
+    } else {
+        /* A short press toggles DFU mode */
+        hw_button_register_handler(HW_BUTTON_GESTURE_SHORT, button_dfu_handler, NULL);
     }
     
     DIAG_INFO(DIAG_CAT_HARDWARE, "Hardware abstraction layer initialized successfully");
@@ -333,8 +554,22 @@ int hw_get_info(hw_info_t *info)
  */
 bool hw_usb_console_ready(void)
 {
-    /* For nRF52840DK, USB console is always available after initialization */
-    return hw_initialized;
+    if (!hw_initialized) {
+        return false;
+    }
+
+#if defined(CONFIG_UART_LINE_CTRL) && DT_HAS_CHOSEN(zephyr_console)
+    /* A CDC-ACM console is ready once the host raises DTR; plain UARTs
+     * (the DK's interface MCU) do not report line state and always are */
+    const struct device *console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+    uint32_t dtr = 0;
+
+    if (uart_line_ctrl_get(console, UART_LINE_CTRL_DTR, &dtr) == 0) {
+        return dtr != 0U;
+    }
+#endif
+
+    return true;
 }
 
 /*============================================================================*/
@@ -350,14 +585,12 @@ int hw_led_set_state(uint32_t led_id, bool state)
         return HW_ERROR_INVALID_PARAM;
     }
 
-    int ret = gpio_pin_set(gpio_dev, led_pins[led_id], state ? 1 : 0);
-    if (ret != 0) {
+    int ret = led_start(led_id, state ? led_kf_on : led_kf_off, 1, false);
+    if (ret != HW_OK) {
         DIAG_ERROR(DIAG_CAT_SYSTEM, "Failed to set LED %u state: %d", led_id, ret);
-        return HW_ERROR_LED;
+        return ret;
     }
 
-    /* Update LED state */
-    led_states[led_id].state = state;
     led_states[led_id].pattern = state ? HW_PULSE_ON : HW_PULSE_OFF;
 
     return HW_OK;
@@ -372,52 +605,84 @@ int hw_led_set_pattern(uint32_t led_id, hw_led_pattern_t pattern)
         return HW_ERROR_INVALID_PARAM;
     }
 
+    int ret = led_start(led_id, led_pattern_table[pattern].frames,
+                        led_pattern_table[pattern].count, true);
     led_states[led_id].pattern = pattern;
-    led_states[led_id].pattern_start_ms = k_uptime_get_32();
-    led_states[led_id].cycle_count = 0;
 
-    /* For static patterns, set immediately */
-    if (pattern == HW_PULSE_OFF) {
-        return hw_led_set_state(led_id, false);
-    } else if (pattern == HW_PULSE_ON) {
-        return hw_led_set_state(led_id, true);
+    return ret;
+}
+
+/**
+ * @brief Play a custom keyframe sequence on an LED
+ */
+int hw_led_play_sequence(uint32_t led_id, const hw_led_keyframe_t *frames, uint32_t count,
+                         bool loop)
+{
+    if (!hw_initialized || led_id >= HW_LED_COUNT || !frames || count == 0 ||
+        count > UINT8_MAX) {
+        return HW_ERROR_INVALID_PARAM;
     }
 
-    return HW_OK;
+    return led_start(led_id, frames, count, loop);
 }
 
 /**
- * @brief Update LED patterns
+ * @brief Show medical pulse on heartbeat LED
  */
-int hw_led_update_patterns(void)
+int hw_show_medical_pulse(uint32_t heart_rate_bpm)
 {
     if (!hw_initialized) {
         return HW_ERROR_NOT_READY;
     }
 
-    for (uint32_t i = 0; i < HW_LED_COUNT; i++) {
-        update_led_pattern(i);
+    /* No detected pulse - nothing to show */
+    if (heart_rate_bpm == 0U) {
+        return hw_led_set_pattern(HW_LED_HEARTBEAT, HW_PULSE_OFF);
     }
 
-    return HW_OK;
+    uint32_t bpm = CLAMP(heart_rate_bpm, LED_HEARTBEAT_MIN_BPM, LED_HEARTBEAT_MAX_BPM);
+    uint32_t heartbeat_period_ms = 60000U / bpm;
+
+    /* Keep the running sequence; restarting it every sample would stutter */
+    if (led_states[HW_LED_HEARTBEAT].pattern != HW_PULSE_HEARTBEAT) {
+        int ret = hw_led_set_pattern(HW_LED_HEARTBEAT, HW_PULSE_HEARTBEAT);
+        if (ret != HW_OK) {
+            return ret;
+        }
+    }
+
+    return hw_led_set_period(HW_LED_HEARTBEAT, heartbeat_period_ms);
 }
 
 /**
- * @brief Show medical pulse on heartbeat LED
+ * @brief Flash the heartbeat LED for one detected beat
  */
-int hw_show_medical_pulse(uint32_t heart_rate_bpm)
+int hw_show_medical_beat(void)
 {
     if (!hw_initialized) {
         return HW_ERROR_NOT_READY;
     }
 
-    /* Calculate heartbeat period based on BPM */
-    uint32_t heartbeat_period_ms = 60000U / heart_rate_bpm;
-    (void)heartbeat_period_ms;  /* Reserved for future dynamic heartbeat timing */
-    
-    /* Update LED pattern timing */
+    /* One pass of the heartbeat sequence; it ends dark and waits for the next beat */
+    int ret = led_start(HW_LED_HEARTBEAT, led_pattern_table[HW_PULSE_HEARTBEAT].frames,
+                        led_pattern_table[HW_PULSE_HEARTBEAT].count, false);
     led_states[HW_LED_HEARTBEAT].pattern = HW_PULSE_HEARTBEAT;
-    led_states[HW_LED_HEARTBEAT].pattern_start_ms = k_uptime_get_32();
+
+    return ret;
+}
+
+/**
+ * @brief Set the repeat period of an LED pattern
+ */
+int hw_led_set_period(uint32_t led_id, uint32_t period_ms)
+{
+    if (!hw_initialized || led_id >= HW_LED_COUNT) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&led_lock);
+    led_players[led_id].period_ms = period_ms;
+    k_spin_unlock(&led_lock, key);
 
     return HW_OK;
 }
@@ -489,6 +754,12 @@ int hw_button_init(void)
     button_state.pressed = false;
     button_state.press_count = 0;
     button_state.last_press_time = 0;
+    button_state.hold_fired = false;
+    button_state.await_second = false;
+    button_state.second_press = false;
+    k_work_init_delayable(&button_state.settle_work, button_settle_work_handler);
+    k_work_init_delayable(&button_state.timeout_work, button_timeout_work_handler);
+    k_msgq_purge(&button_edge_queue);
 
     /* Set up button callback */
     gpio_init_callback(&button_state.callback, button_callback, BIT(HW_BUTTON_PIN));
@@ -498,8 +769,8 @@ int hw_button_init(void)
         return HW_ERROR_GPIO;
     }
 
-    /* Enable button interrupt on falling edge (button press - active low) */
-    ret = gpio_pin_interrupt_configure(gpio_dev, HW_BUTTON_PIN, GPIO_INT_EDGE_FALLING);
+    /* Both edges: press and release timing drive gesture recognition */
+    ret = gpio_pin_interrupt_configure(gpio_dev, HW_BUTTON_PIN, GPIO_INT_EDGE_BOTH);
     if (ret != 0) {
         DIAG_ERROR(DIAG_CAT_HARDWARE, "Failed to enable button interrupt: %d", ret);
         return HW_ERROR_GPIO;
@@ -548,6 +819,32 @@ bool hw_button_wait_press(uint32_t timeout_ms)
     return false;
 }
 
+/**
+ * @brief Register a button gesture handler
+ */
+int hw_button_register_handler(hw_button_gesture_t gesture, hw_button_handler_t handler,
+                               void *user_data)
+{
+    if (gesture >= HW_BUTTON_GESTURE_MAX || !handler) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    if (button_state.handler_count >= BUTTON_MAX_HANDLERS) {
+        return HW_ERROR_BUSY;
+    }
+
+    uint32_t i = button_state.handler_count;
+    button_state.handlers[i].gesture = gesture;
+    button_state.handlers[i].handler = handler;
+    button_state.handlers[i].user_data = user_data;
+
+    /* Publish the entry only once it is complete */
+    compiler_barrier();
+    button_state.handler_count = i + 1U;
+
+    return HW_OK;
+}
+
 /**
  * @brief Get button press count since last reset
  */
@@ -804,6 +1101,44 @@ int hw_serial_bt_send(const uint8_t *data, uint32_t length)
     return send_uart_data(data, length);
 }
 
+/**
+ * @brief Register serial Bluetooth transmit completion callback
+ */
+int hw_serial_bt_set_tx_callback(hw_serial_bt_tx_cb_t cb, void *user_data)
+{
+    if (!uart_bt_dev) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    k_mutex_lock(&uart_bt_tx.producer_mutex, K_FOREVER);
+    uart_bt_tx.done_cb = cb;
+    uart_bt_tx.done_cb_user_data = user_data;
+    k_mutex_unlock(&uart_bt_tx.producer_mutex);
+
+    return HW_OK;
+}
+
+/**
+ * @brief Get serial Bluetooth interface statistics
+ */
+int hw_serial_bt_get_stats(hw_serial_bt_stats_t *stats)
+{
+    if (!stats) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    stats->mode = uart_bt_tx.mode;
+    stats->tx_bytes_queued = uart_bt_tx.bytes_queued;
+    stats->tx_bytes_sent = uart_bt_tx.bytes_sent;
+    stats->tx_rejected = uart_bt_tx.rejected;
+    stats->tx_pending = uart_bt_dev ? (uint32_t)safe_buffer_available(&uart_bt_tx.ring) : 0U;
+    stats->rx_bytes = uart_bt_rx.bytes;
+    stats->rx_dropped = uart_bt_rx.dropped;
+    stats->rx_errors = uart_bt_rx.errors;
+
+    return HW_OK;
+}
+
 /**
  * @brief Receive data via serial Bluetooth interface
  */
@@ -818,17 +1153,54 @@ int hw_serial_bt_receive(uint8_t *buffer, uint32_t max_length, uint32_t *receive
     }
 
     *received_length = 0;
-    
-    /* Simple implementation - in real scenario, this would use UART interrupt */
-    for (uint32_t i = 0; i < max_length; i++) {
-        uint8_t byte;
-        int ret = uart_poll_in(uart_bt_dev, &byte);
-        if (ret == 0) {
+
+    if (uart_bt_tx.mode == HW_SERIAL_MODE_POLL) {
+        if (uart_bt_rx.cb) {
+            return HW_OK; /* The poll work owns the FIFO */
+        }
+
+        /* No background receiver - drain whatever the FIFO holds now */
+        for (uint32_t i = 0; i < max_length; i++) {
+            uint8_t byte;
+            if (uart_poll_in(uart_bt_dev, &byte) != 0) {
+                break;
+            }
             buffer[i] = byte;
             (*received_length)++;
-        } else {
-            break;
         }
+        uart_bt_rx.bytes += *received_length;
+        return HW_OK;
+    }
+
+    k_mutex_lock(&uart_bt_rx.consumer_mutex, K_FOREVER);
+    if (!uart_bt_rx.cb) {
+        *received_length = ring_buf_get(&uart_bt_rx.ring, buffer, max_length);
+    }
+    k_mutex_unlock(&uart_bt_rx.consumer_mutex);
+
+    return HW_OK;
+}
+
+/**
+ * @brief Register serial Bluetooth receive callback
+ */
+int hw_serial_bt_set_rx_callback(hw_serial_bt_rx_cb_t cb, void *user_data)
+{
+    if (!uart_bt_dev) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    k_mutex_lock(&uart_bt_rx.consumer_mutex, K_FOREVER);
+    uart_bt_rx.cb = cb;
+    uart_bt_rx.cb_user_data = user_data;
+    k_mutex_unlock(&uart_bt_rx.consumer_mutex);
+
+    /* Deliver anything that arrived before registration; polled mode has no
+     * receive interrupt, so start polling the FIFO instead */
+    if (cb && uart_bt_tx.mode == HW_SERIAL_MODE_POLL) {
+        k_work_schedule(&uart_bt_rx.poll_work, K_NO_WAIT);
+    } else if (cb) {
+        k_work_submit(&uart_bt_rx.work);
     }
 
     return HW_OK;
@@ -1013,17 +1385,33 @@ static int init_leds(void)
 
     /* Configure all LED pins as outputs */
     for (uint32_t i = 0; i < HW_LED_COUNT; i++) {
-        int ret = gpio_pin_configure(gpio_dev, led_pins[i], GPIO_OUTPUT_INACTIVE);
-        if (ret != 0) {
-            DIAG_ERROR(DIAG_CAT_SYSTEM, "Failed to configure LED %u pin: %d", i, ret);
-            return HW_ERROR_LED;
+#ifdef CONFIG_PWM
+        /* The PWM peripheral owns the pin when a channel is wired */
+        if (led_pwms[i].dev && pwm_is_ready_dt(&led_pwms[i])) {
+            led_pwm_mask |= BIT(i);
+        } else
+#endif
+        {
+            int ret = gpio_pin_configure(gpio_dev, led_pins[i], GPIO_OUTPUT_INACTIVE);
+            if (ret != 0) {
+                DIAG_ERROR(DIAG_CAT_SYSTEM, "Failed to configure LED %u pin: %d", i, ret);
+                return HW_ERROR_LED;
+            }
         }
 
         /* Initialize LED state */
         led_states[i].pattern = HW_PULSE_OFF;
         led_states[i].pattern_start_ms = 0;
         led_states[i].cycle_count = 0;
+        led_states[i].level = 0;
         led_states[i].state = false;
+
+        led_players[i].frames = led_kf_off;
+        led_players[i].count = 1;
+        led_players[i].index = 0;
+        led_players[i].loop = false;
+        k_timer_init(&led_players[i].timer, led_timer_expiry, NULL);
+        k_timer_user_data_set(&led_players[i].timer, (void *)(uintptr_t)i);
     }
 
     DIAG_INFO(DIAG_CAT_SYSTEM, "LEDs initialized");
@@ -1047,11 +1435,60 @@ static int init_uart_bt(void)
     /* Try to get UART device - this might not be available on all boards */
     uart_bt_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(uart1));
     if (!uart_bt_dev || !device_is_ready(uart_bt_dev)) {
+        uart_bt_dev = NULL;
+        uart_bt_tx.mode = HW_SERIAL_MODE_NONE;
         DIAG_WARNING(DIAG_CAT_SYSTEM, "UART Bluetooth device not found");
         return HW_ERROR_USB;
     }
 
-    DIAG_INFO(DIAG_CAT_SYSTEM, "UART Bluetooth initialized");
+    safe_buffer_init(&uart_bt_tx.ring, uart_bt_tx_ring_data, sizeof(uart_bt_tx_ring_data), false);
+    k_mutex_init(&uart_bt_tx.producer_mutex);
+    k_work_init(&uart_bt_tx.work, uart_bt_tx_work_handler);
+    atomic_clear(&uart_bt_tx.flags);
+    uart_bt_tx.mode = HW_SERIAL_MODE_POLL;
+
+    /* Prefer the async API (EasyDMA on nRF52840); UART drivers without it
+     * (e.g. QEMU Stellaris) reject the callback and fall back to IRQ mode */
+#ifdef CONFIG_UART_ASYNC_API
+    if (uart_callback_set(uart_bt_dev, uart_bt_async_callback, NULL) == 0) {
+        uart_bt_tx.mode = HW_SERIAL_MODE_ASYNC;
+    }
+#endif
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+    if (uart_bt_tx.mode == HW_SERIAL_MODE_POLL &&
+        uart_irq_callback_user_data_set(uart_bt_dev, uart_bt_irq_handler, NULL) == 0) {
+        uart_irq_tx_disable(uart_bt_dev);
+        uart_bt_tx.mode = HW_SERIAL_MODE_IRQ;
+    }
+#endif
+
+    ring_buf_init(&uart_bt_rx.ring, sizeof(uart_bt_rx_ring_data), uart_bt_rx_ring_data);
+    k_mutex_init(&uart_bt_rx.consumer_mutex);
+    k_work_init(&uart_bt_rx.work, uart_bt_rx_work_handler);
+    k_work_init_delayable(&uart_bt_rx.poll_work, uart_bt_rx_poll_work_handler);
+
+    switch (uart_bt_tx.mode) {
+#ifdef CONFIG_UART_ASYNC_API
+        case HW_SERIAL_MODE_ASYNC:
+            uart_bt_rx.next_buf = 1U;
+            if (uart_rx_enable(uart_bt_dev, uart_bt_rx_bufs[0], UART_BT_RX_BUF_SIZE,
+                               UART_BT_RX_TIMEOUT_US) != 0) {
+                DIAG_WARNING(DIAG_CAT_SYSTEM, "UART Bluetooth async RX enable failed");
+            }
+            break;
+#endif
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+        case HW_SERIAL_MODE_IRQ:
+            uart_irq_rx_enable(uart_bt_dev);
+            break;
+#endif
+        default:
+            break; /* Polled on demand by hw_serial_bt_receive() */
+    }
+
+    DIAG_INFO(DIAG_CAT_SYSTEM, "UART Bluetooth initialized (mode: %s)",
+              uart_bt_tx.mode == HW_SERIAL_MODE_ASYNC ? "async" :
+              uart_bt_tx.mode == HW_SERIAL_MODE_IRQ ? "interrupt" : "poll");
     return HW_OK;
 }
 
@@ -1261,6 +1698,9 @@ static void ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 
 /**
  * @brief Button callback function
+ * @details ISR context: only timestamps the edge and defers all processing.
+ * Each edge pushes the settle work out by the debounce time, so it runs
+ * once the contact has stopped bouncing.
  */
 static void button_callback(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
 {
@@ -1268,25 +1708,150 @@ static void button_callback(const struct device *dev, struct gpio_callback *cb,
     ARG_UNUSED(cb);
     ARG_UNUSED(pins);
 
-    uint32_t current_time = k_uptime_get_32();
-    
-    /* Debounce check - ignore rapid repeated presses */
-    if (current_time - button_state.last_press_time < BUTTON_DEBOUNCE_MS) {
-        DIAG_DEBUG(DIAG_CAT_SYSTEM, "Button bounce ignored (too fast)");
-        return;
+    struct button_edge edge = {
+        .timestamp_ms = k_uptime_get_32(),
+    };
+
+    if (k_msgq_put(&button_edge_queue, &edge, K_NO_WAIT) != 0) {
+        button_state.edges_dropped++;
     }
 
-    /* Verify button is actually pressed (active low) */
-    if (!hw_button_is_pressed()) {
-        DIAG_DEBUG(DIAG_CAT_SYSTEM, "Button release detected, ignoring");
+    k_work_reschedule(&button_state.settle_work, K_MSEC(BUTTON_DEBOUNCE_MS));
+}
+
+/**
+ * @brief Arm the gesture timeout for the next pending deadline
+ */
+static void button_arm_timeout(void)
+{
+    uint32_t deadline;
+
+    if (button_state.pressed && !button_state.hold_fired) {
+        deadline = button_state.last_press_time + BUTTON_HOLD_MS;
+    } else if (!button_state.pressed && button_state.await_second) {
+        deadline = button_state.release_time + BUTTON_DOUBLE_GAP_MS;
+    } else {
+        k_work_cancel_delayable(&button_state.timeout_work);
         return;
     }
 
-    button_state.pressed = true;
-    button_state.press_count++;
-    button_state.last_press_time = current_time;
+    int32_t remaining = (int32_t)(deadline - k_uptime_get_32());
+    k_work_reschedule(&button_state.timeout_work, K_MSEC(MAX(remaining, 0)));
+}
+
+/**
+ * @brief Debounced edge handler (system work queue)
+ * @details Runs once the line has been quiet for BUTTON_DEBOUNCE_MS. The
+ * first queued edge of the burst dates the transition; the settled pin
+ * level decides its direction.
+ */
+static void button_settle_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    struct button_edge edge;
+    uint32_t burst_time = 0;
+    bool have_edge = false;
+
+    while (k_msgq_get(&button_edge_queue, &edge, K_NO_WAIT) == 0) {
+        if (!have_edge) {
+            burst_time = edge.timestamp_ms;
+            have_edge = true;
+        }
+    }
+
+    bool pressed = hw_button_is_pressed();
+    if (!have_edge || pressed == button_state.pressed) {
+        return; /* Glitch that settled back to the previous level */
+    }
+
+    button_state.pressed = pressed;
+
+    if (pressed) {
+        button_state.press_count++;
+        button_state.last_press_time = burst_time;
+        button_state.hold_fired = false;
+        button_state.second_press = button_state.await_second;
+        button_state.await_second = false;
+        DIAG_DEBUG(DIAG_CAT_HARDWARE, "Button pressed (count: %u)", button_state.press_count);
+    } else {
+        uint32_t duration = burst_time - button_state.last_press_time;
+        bool first_pending = button_state.second_press;
+
+        button_state.second_press = false;
+
+        if (button_state.hold_fired) {
+            /* Hold already reported while the button was down */
+        } else if (duration >= BUTTON_LONG_PRESS_MS) {
+            if (first_pending) {
+                button_dispatch(HW_BUTTON_GESTURE_SHORT);
+            }
+            button_dispatch(HW_BUTTON_GESTURE_LONG);
+        } else if (first_pending) {
+            button_dispatch(HW_BUTTON_GESTURE_DOUBLE);
+        } else {
+            /* Could still become a double - decide when the window closes */
+            button_state.await_second = true;
+            button_state.release_time = burst_time;
+        }
+    }
+
+    button_arm_timeout();
+}
+
+/**
+ * @brief Gesture timeout handler (system work queue)
+ * @details Fires HOLD while the button is down, or SHORT once the
+ * double-press window has closed without a second press.
+ */
+static void button_timeout_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint32_t now = k_uptime_get_32();
+
+    if (button_state.pressed && !button_state.hold_fired &&
+        (now - button_state.last_press_time) >= BUTTON_HOLD_MS) {
+        if (button_state.second_press) {
+            button_state.second_press = false;
+            button_dispatch(HW_BUTTON_GESTURE_SHORT);
+        }
+        button_state.hold_fired = true;
+        button_dispatch(HW_BUTTON_GESTURE_HOLD);
+    } else if (!button_state.pressed && button_state.await_second &&
+               (now - button_state.release_time) >= BUTTON_DOUBLE_GAP_MS) {
+        button_state.await_second = false;
+        button_dispatch(HW_BUTTON_GESTURE_SHORT);
+    }
+
+    button_arm_timeout();
+}
+
+/**
+ * @brief Call every handler registered for a gesture
+ */
+static void button_dispatch(hw_button_gesture_t gesture)
+{
+    static const char *const names[HW_BUTTON_GESTURE_MAX] = {"short", "long", "double", "hold"};
+    uint32_t count = button_state.handler_count;
+
+    DIAG_INFO(DIAG_CAT_HARDWARE, "Button gesture: %s", names[gesture]);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (button_state.handlers[i].gesture == gesture) {
+            button_state.handlers[i].handler(gesture, button_state.handlers[i].user_data);
+        }
+    }
+}
+
+/**
+ * @brief Short press handler toggling DFU mode
+ */
+static void button_dfu_handler(hw_button_gesture_t gesture, void *user_data)
+{
+    ARG_UNUSED(gesture);
+    ARG_UNUSED(user_data);
 
-    DIAG_INFO(DIAG_CAT_SYSTEM, "Button pressed (count: %u)", button_state.press_count);
     printk("\n*** BUTTON 1 PRESS DETECTED (Press #%u) ***\n", button_state.press_count);
 
     /* Toggle DFU mode on button press */
@@ -1303,79 +1868,157 @@ static void button_callback(const struct device *dev, struct gpio_callback *cb,
 }
 
 /**
- * @brief Update LED pattern
+ * @brief Drive an LED to a brightness level
+ * @details Safe to call from the timer ISR.
  */
-static void update_led_pattern(uint32_t led_id)
+static int led_apply_level(uint32_t led_id, uint8_t level)
 {
-    if (led_id >= HW_LED_COUNT) {
-        return;
+    int ret;
+
+#ifdef CONFIG_PWM
+    if (led_pwm_mask & BIT(led_id)) {
+        const struct pwm_dt_spec *spec = &led_pwms[led_id];
+        ret = pwm_set_pulse_dt(spec, (uint32_t)(((uint64_t)spec->period * level) /
+                                                HW_LED_LEVEL_MAX));
+    } else
+#endif
+    {
+        ret = gpio_pin_set(gpio_dev, led_pins[led_id], (level >= LED_LEVEL_ON_THRESHOLD) ? 1 : 0);
     }
 
-    hw_led_pattern_t pattern = led_states[led_id].pattern;
-    
-    /* Handle static patterns */
-    if (pattern == HW_PULSE_OFF || pattern == HW_PULSE_ON) {
-        return; /* Already handled in hw_led_set_pattern */
+    if (ret != 0) {
+        return HW_ERROR_LED;
     }
 
-    uint32_t elapsed_ms = k_uptime_get_32() - led_states[led_id].pattern_start_ms;
-    bool new_state = calculate_pattern_state(pattern, elapsed_ms);
+    led_states[led_id].level = level;
+    led_states[led_id].state = (level >= LED_LEVEL_ON_THRESHOLD);
+    return HW_OK;
+}
 
-    /* Update LED if state changed */
-    if (new_state != led_states[led_id].state) {
-        gpio_pin_set(gpio_dev, led_pins[led_id], new_state ? 1 : 0);
-        led_states[led_id].state = new_state;
+/**
+ * @brief Effective duration of a keyframe
+ * @details With a period set on a looping sequence, the last keyframe
+ * absorbs the difference so one loop takes exactly period_ms (O(1)).
+ */
+static uint32_t led_frame_duration(uint32_t led_id, uint8_t index)
+{
+    uint32_t period_ms = led_players[led_id].period_ms;
+
+    if (period_ms == 0U || !led_players[led_id].loop ||
+        index != led_players[led_id].count - 1U) {
+        return led_players[led_id].frames[index].duration_ms;
     }
+
+    /* Never shorter than 1 ms, or a too-short period would stall the loop */
+    return (period_ms > led_players[led_id].fixed_ms) ?
+           (period_ms - led_players[led_id].fixed_ms) : 1U;
 }
 
 /**
- * @brief Calculate pattern state based on elapsed time
+ * @brief Output the current keyframe and arm the timer for the next one
+ * @details On GPIO-only LEDs, following keyframes that would not change the
+ * pin are folded into the current delay. Caller holds led_lock.
  */
-static uint32_t calculate_pattern_state(hw_led_pattern_t pattern, uint32_t elapsed_ms)
+static int led_play_locked(uint32_t led_id)
 {
-    switch (pattern) {
-        case HW_PULSE_SLOW_BLINK:
-            return (elapsed_ms / LED_PATTERN_SLOW_BLINK_PERIOD) % 2;
+    const hw_led_keyframe_t *frames = led_players[led_id].frames;
+    uint8_t count = led_players[led_id].count;
+    uint8_t index = led_players[led_id].index;
+    uint8_t level = frames[index].level;
+    uint32_t delay_ms = led_frame_duration(led_id, index);
 
-        case HW_PULSE_FAST_BLINK:
-            return (elapsed_ms / LED_PATTERN_FAST_BLINK_PERIOD) % 2;
+    int ret = led_apply_level(led_id, level);
 
-        case HW_PULSE_BREATHING:
-            {
-                uint32_t cycle = elapsed_ms % LED_PATTERN_BREATHING_PERIOD;
-                uint32_t half_period = LED_PATTERN_BREATHING_PERIOD / 2;
-                return (cycle < half_period) ? 1 : 0;
-            }
+    if (delay_ms == HW_LED_KEYFRAME_HOLD) {
+        return ret;
+    }
 
-        case HW_PULSE_HEARTBEAT:
-            {
-                uint32_t cycle = elapsed_ms % LED_PATTERN_HEARTBEAT_PERIOD;
-                return (cycle < 100) ? 1 : 0; /* Short pulse */
-            }
+    bool binary = true;
+#ifdef CONFIG_PWM
+    binary = !(led_pwm_mask & BIT(led_id));
+#endif
 
-        case HW_PULSE_SOS:
-            {
-                uint32_t cycle = elapsed_ms % (LED_PATTERN_SOS_PERIOD * 21); /* SOS pattern */
-                uint32_t pos = cycle / LED_PATTERN_SOS_PERIOD;
-                /* SOS pattern: ... --- ... */
-                return ((pos >= 0 && pos < 3) || (pos >= 4 && pos < 7) || 
-                        (pos >= 8 && pos < 11) || (pos >= 12 && pos < 15) ||
-                        (pos >= 16 && pos < 19) || (pos >= 20 && pos < 21)) ? 1 : 0;
-            }
+    if (binary) {
+        bool on = (level >= LED_LEVEL_ON_THRESHOLD);
 
-        case HW_PULSE_DOUBLE_BLINK:
-            {
-                uint32_t cycle = elapsed_ms % LED_PATTERN_DOUBLE_BLINK_PERIOD;
-                return (cycle < 50 || (cycle >= 100 && cycle < 150)) ? 1 : 0;
+        for (uint8_t n = 1; n < count; n++) {
+            uint8_t next = index + 1U;
+            if (next == count) {
+                if (!led_players[led_id].loop) {
+                    break;
+                }
+                next = 0;
+            }
+            uint32_t next_ms = led_frame_duration(led_id, next);
+            if ((frames[next].level >= LED_LEVEL_ON_THRESHOLD) != on ||
+                next_ms == HW_LED_KEYFRAME_HOLD) {
+                break;
             }
+            index = next;
+            delay_ms += next_ms;
+        }
+        led_players[led_id].index = index;
+    }
 
-        default:
-            return 0;
+    k_timer_start(&led_players[led_id].timer, K_MSEC(delay_ms), K_NO_WAIT);
+    return ret;
+}
+
+/**
+ * @brief LED keyframe timer expiry (ISR context)
+ */
+static void led_timer_expiry(struct k_timer *timer)
+{
+    uint32_t led_id = (uint32_t)(uintptr_t)k_timer_user_data_get(timer);
+    k_spinlock_key_t key = k_spin_lock(&led_lock);
+
+    uint8_t next = led_players[led_id].index + 1U;
+    if (next >= led_players[led_id].count) {
+        if (!led_players[led_id].loop) {
+            k_spin_unlock(&led_lock, key);
+            return; /* Hold the last level */
+        }
+        next = 0;
+        led_states[led_id].cycle_count++;
     }
+
+    led_players[led_id].index = next;
+    (void)led_play_locked(led_id);
+
+    k_spin_unlock(&led_lock, key);
+}
+
+/**
+ * @brief Start a keyframe sequence from its first keyframe
+ */
+static int led_start(uint32_t led_id, const hw_led_keyframe_t *frames, uint32_t count, bool loop)
+{
+    k_spinlock_key_t key = k_spin_lock(&led_lock);
+
+    k_timer_stop(&led_players[led_id].timer);
+
+    led_players[led_id].frames = frames;
+    led_players[led_id].count = (uint8_t)count;
+    led_players[led_id].index = 0;
+    led_players[led_id].loop = loop;
+    led_players[led_id].period_ms = 0;
+    led_players[led_id].fixed_ms = 0;
+    for (uint32_t i = 0; i + 1U < count; i++) {
+        led_players[led_id].fixed_ms += frames[i].duration_ms;
+    }
+    led_states[led_id].pattern_start_ms = k_uptime_get_32();
+    led_states[led_id].cycle_count = 0;
+
+    int ret = led_play_locked(led_id);
+
+    k_spin_unlock(&led_lock, key);
+    return ret;
 }
 
 /**
  * @brief Send UART data
+ * @details Enqueues the whole frame into the transmit ring and kicks the
+ * transmit work item; the caller never waits for the wire.
  */
 static int send_uart_data(const uint8_t *data, uint32_t length)
 {
@@ -1383,9 +2026,231 @@ static int send_uart_data(const uint8_t *data, uint32_t length)
         return HW_ERROR_INVALID_PARAM;
     }
 
-    for (uint32_t i = 0; i < length; i++) {
-        uart_poll_out(uart_bt_dev, data[i]);
+    k_mutex_lock(&uart_bt_tx.producer_mutex, K_FOREVER);
+
+    /* Producers are serialized, so free space can only grow until the write */
+    if (safe_buffer_free_space(&uart_bt_tx.ring) < length) {
+        uart_bt_tx.rejected++;
+        k_mutex_unlock(&uart_bt_tx.producer_mutex);
+        return HW_ERROR_BUSY;
     }
 
+    safe_buffer_write_nb(&uart_bt_tx.ring, data, length, NULL);
+    uart_bt_tx.bytes_queued += length;
+
+    k_mutex_unlock(&uart_bt_tx.producer_mutex);
+
+    k_work_submit(&uart_bt_tx.work);
     return HW_OK;
 }
+
+/**
+ * @brief Transmit work handler
+ * @details Moves the next chunk from the ring into the staging buffer and
+ * starts the transfer. Runs in the system work queue because the ring is
+ * mutex-protected and cannot be touched from the UART ISR.
+ */
+static void uart_bt_tx_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    if (atomic_test_and_set_bit(&uart_bt_tx.flags, UART_BT_TX_BUSY)) {
+        return; /* Transfer in flight; completion resubmits this work */
+    }
+
+    size_t len = 0;
+    safe_buffer_read_nb(&uart_bt_tx.ring, uart_bt_tx_chunk, sizeof(uart_bt_tx_chunk), &len);
+
+    if (len == 0) {
+        atomic_clear_bit(&uart_bt_tx.flags, UART_BT_TX_BUSY);
+
+        /* Ring drained - report completion of the burst */
+        uint32_t burst = uart_bt_tx.burst_bytes;
+        uart_bt_tx.burst_bytes = 0;
+        if (burst > 0 && uart_bt_tx.done_cb) {
+            uart_bt_tx.done_cb(burst, uart_bt_tx.done_cb_user_data);
+        }
+        return;
+    }
+
+    uart_bt_tx.chunk_len = (uint32_t)len;
+    uart_bt_tx.chunk_offset = 0;
+
+    switch (uart_bt_tx.mode) {
+#ifdef CONFIG_UART_ASYNC_API
+        case HW_SERIAL_MODE_ASYNC:
+            if (uart_tx(uart_bt_dev, uart_bt_tx_chunk, len, SYS_FOREVER_US) != 0) {
+                DIAG_WARNING(DIAG_CAT_COMMUNICATION, "UART async TX start failed, dropping %u bytes",
+                             (uint32_t)len);
+                uart_bt_tx_chunk_done(0);
+            }
+            break;
+#endif
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+        case HW_SERIAL_MODE_IRQ:
+            uart_irq_tx_enable(uart_bt_dev);
+            break;
+#endif
+        default:
+            for (size_t i = 0; i < len; i++) {
+                uart_poll_out(uart_bt_dev, uart_bt_tx_chunk[i]);
+            }
+            uart_bt_tx_chunk_done((uint32_t)len);
+            break;
+    }
+}
+
+/**
+ * @brief Finish the transfer in flight and schedule the next chunk
+ * @details Safe to call from ISR context.
+ */
+static void uart_bt_tx_chunk_done(uint32_t bytes_sent)
+{
+    uart_bt_tx.bytes_sent += bytes_sent;
+    uart_bt_tx.burst_bytes += bytes_sent;
+    atomic_clear_bit(&uart_bt_tx.flags, UART_BT_TX_BUSY);
+    k_work_submit(&uart_bt_tx.work);
+}
+
+/**
+ * @brief Push received bytes into the receive ring (ISR context)
+ * @details The ring has a single producer (the UART ISR) and the consumers
+ * are serialized by consumer_mutex, so no further locking is required.
+ */
+static void uart_bt_rx_push(const uint8_t *data, uint32_t length)
+{
+    uint32_t stored = ring_buf_put(&uart_bt_rx.ring, data, length);
+
+    uart_bt_rx.bytes += stored;
+    uart_bt_rx.dropped += length - stored;
+
+    if (uart_bt_rx.cb) {
+        k_work_submit(&uart_bt_rx.work);
+    }
+}
+
+/**
+ * @brief Receive work handler
+ * @details Hands buffered bytes to the registered receive callback.
+ */
+static void uart_bt_rx_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint8_t chunk[UART_BT_RX_BUF_SIZE];
+
+    k_mutex_lock(&uart_bt_rx.consumer_mutex, K_FOREVER);
+    while (uart_bt_rx.cb) {
+        uint32_t len = ring_buf_get(&uart_bt_rx.ring, chunk, sizeof(chunk));
+        if (len == 0) {
+            break;
+        }
+        uart_bt_rx.cb(chunk, len, uart_bt_rx.cb_user_data);
+    }
+    k_mutex_unlock(&uart_bt_rx.consumer_mutex);
+}
+
+/**
+ * @brief Polled receive work handler
+ * @details Stands in for the receive interrupt in polled mode: drains the
+ * UART FIFO into the registered receive callback and re-arms itself for as
+ * long as a callback is registered. Bytes that overrun the FIFO between two
+ * polls are lost, so polled mode only suits low-rate command traffic.
+ */
+static void uart_bt_rx_poll_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint8_t chunk[UART_BT_RX_BUF_SIZE];
+
+    k_mutex_lock(&uart_bt_rx.consumer_mutex, K_FOREVER);
+    while (uart_bt_rx.cb) {
+        uint32_t len = 0;
+
+        while (len < sizeof(chunk) && uart_poll_in(uart_bt_dev, &chunk[len]) == 0) {
+            len++;
+        }
+        if (len == 0) {
+            break;
+        }
+        uart_bt_rx.bytes += len;
+        uart_bt_rx.cb(chunk, len, uart_bt_rx.cb_user_data);
+    }
+
+    if (uart_bt_rx.cb) {
+        k_work_reschedule(&uart_bt_rx.poll_work, K_MSEC(UART_BT_RX_POLL_INTERVAL_MS));
+    }
+    k_mutex_unlock(&uart_bt_rx.consumer_mutex);
+}
+
+#ifdef CONFIG_UART_ASYNC_API
+/**
+ * @brief UART async event callback (ISR context)
+ */
+static void uart_bt_async_callback(const struct device *dev, struct uart_event *evt,
+                                   void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    switch (evt->type) {
+        case UART_TX_DONE:
+        case UART_TX_ABORTED:
+            uart_bt_tx_chunk_done((uint32_t)evt->data.tx.len);
+            break;
+        case UART_RX_RDY:
+            uart_bt_rx_push(&evt->data.rx.buf[evt->data.rx.offset], (uint32_t)evt->data.rx.len);
+            break;
+        case UART_RX_BUF_REQUEST:
+            /* Hand the driver the idle half so reception never pauses */
+            uart_rx_buf_rsp(dev, uart_bt_rx_bufs[uart_bt_rx.next_buf], UART_BT_RX_BUF_SIZE);
+            uart_bt_rx.next_buf ^= 1U;
+            break;
+        case UART_RX_STOPPED:
+            uart_bt_rx.errors++;
+            break;
+        case UART_RX_DISABLED:
+            /* Stopped by an error or buffer starvation - restart reception */
+            uart_bt_rx.next_buf = 1U;
+            uart_rx_enable(dev, uart_bt_rx_bufs[0], UART_BT_RX_BUF_SIZE, UART_BT_RX_TIMEOUT_US);
+            break;
+        default:
+            break;
+    }
+}
+#endif
+
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+/**
+ * @brief UART interrupt handler for FIFO-driven transfers (ISR context)
+ */
+static void uart_bt_irq_handler(const struct device *dev, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (!uart_irq_update(dev)) {
+        return;
+    }
+
+    if (uart_irq_rx_ready(dev)) {
+        uint8_t fifo[16];
+        int len;
+
+        while ((len = uart_fifo_read(dev, fifo, sizeof(fifo))) > 0) {
+            uart_bt_rx_push(fifo, (uint32_t)len);
+        }
+    }
+
+    if (uart_irq_tx_ready(dev)) {
+        if (uart_bt_tx.chunk_offset < uart_bt_tx.chunk_len) {
+            int filled = uart_fifo_fill(dev, &uart_bt_tx_chunk[uart_bt_tx.chunk_offset],
+                                        (int)(uart_bt_tx.chunk_len - uart_bt_tx.chunk_offset));
+            if (filled > 0) {
+                uart_bt_tx.chunk_offset += (uint32_t)filled;
+            }
+        } else {
+            uart_irq_tx_disable(dev);
+            uart_bt_tx_chunk_done(uart_bt_tx.chunk_len);
+        }
+    }
+}
+#endif
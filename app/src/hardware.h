@@ -78,6 +78,23 @@ typedef enum {
     HW_PULSE_PATTERN_MAX           /**< Maximum pattern count */
 } hw_led_pattern_t;
 
+/** @brief Full LED brightness level */
+#define HW_LED_LEVEL_MAX              255U
+
+/** @brief Keyframe duration meaning "hold this level until changed" */
+#define HW_LED_KEYFRAME_HOLD          0U
+
+/**
+ * @brief LED pattern keyframe
+ * @details A pattern is a sequence of keyframes, each holding a brightness
+ * level for a duration. The engine only wakes at keyframe transitions.
+ * LEDs without a PWM channel are switched on at levels >= 128.
+ */
+typedef struct {
+    uint16_t duration_ms;          /**< Time to hold this level (HW_LED_KEYFRAME_HOLD = forever) */
+    uint8_t level;                 /**< Brightness 0..HW_LED_LEVEL_MAX */
+} hw_led_keyframe_t;
+
 /** @} */ /* End of HwLedPatterns group */
 
 /*============================================================================*/
@@ -103,10 +120,70 @@ typedef struct {
 typedef struct {
     hw_led_pattern_t pattern;       /**< Current pattern type */
     uint32_t pattern_start_ms;      /**< Pattern start timestamp */
-    uint32_t cycle_count;           /**< Pattern cycle counter */
+    uint32_t cycle_count;           /**< Completed pattern loops */
+    uint8_t level;                  /**< Current brightness level */
     bool state;                     /**< Current LED state */
 } hw_led_state_t;
 
+/** @brief Button gestures recognized by the debounce state machine */
+typedef enum {
+    HW_BUTTON_GESTURE_SHORT = 0,   /**< Single short press (reported after the double-press window) */
+    HW_BUTTON_GESTURE_LONG,        /**< Press released after the long-press threshold */
+    HW_BUTTON_GESTURE_DOUBLE,      /**< Two short presses in quick succession */
+    HW_BUTTON_GESTURE_HOLD,        /**< Press held past the hold threshold (fires while held) */
+    HW_BUTTON_GESTURE_MAX          /**< Maximum gesture count */
+} hw_button_gesture_t;
+
+/**
+ * @brief Button gesture handler
+ * @details Invoked from the system work queue, never from the GPIO ISR.
+ *
+ * @param gesture Recognized gesture
+ * @param user_data User data registered with the handler
+ */
+typedef void (*hw_button_handler_t)(hw_button_gesture_t gesture, void *user_data);
+
+/** @brief Serial Bluetooth transfer mode selected at initialization */
+typedef enum {
+    HW_SERIAL_MODE_NONE = 0,       /**< UART not available */
+    HW_SERIAL_MODE_POLL,           /**< Polled fallback (transfers run in work queue) */
+    HW_SERIAL_MODE_IRQ,            /**< Interrupt-driven FIFO transfers */
+    HW_SERIAL_MODE_ASYNC           /**< Async API (EasyDMA on nRF52840) */
+} hw_serial_mode_t;
+
+/** @brief Serial Bluetooth interface statistics */
+typedef struct {
+    hw_serial_mode_t mode;          /**< Active transfer mode */
+    uint32_t tx_bytes_queued;       /**< Bytes accepted into the transmit ring */
+    uint32_t tx_bytes_sent;         /**< Bytes handed off by the UART */
+    uint32_t tx_rejected;           /**< Send requests rejected (ring full) */
+    uint32_t tx_pending;            /**< Bytes currently waiting in the ring */
+    uint32_t rx_bytes;              /**< Bytes received into the receive ring */
+    uint32_t rx_dropped;            /**< Bytes dropped (receive ring full) */
+    uint32_t rx_errors;             /**< Receiver errors (overrun, framing, break) */
+} hw_serial_bt_stats_t;
+
+/**
+ * @brief Serial Bluetooth transmit completion callback
+ * @details Invoked from the system work queue once the transmit ring has
+ * drained completely.
+ *
+ * @param bytes_sent Bytes transmitted since the previous completion
+ * @param user_data User data registered with the callback
+ */
+typedef void (*hw_serial_bt_tx_cb_t)(uint32_t bytes_sent, void *user_data);
+
+/**
+ * @brief Serial Bluetooth receive callback
+ * @details Invoked from the system work queue with bytes drained from the
+ * receive ring, in arrival order.
+ *
+ * @param data Received bytes (valid only for the duration of the call)
+ * @param length Number of bytes
+ * @param user_data User data registered with the callback
+ */
+typedef void (*hw_serial_bt_rx_cb_t)(const uint8_t *data, uint32_t length, void *user_data);
+
 /** @} */ /* End of HwInfo group */
 
 /*============================================================================*/
@@ -125,6 +202,7 @@ typedef struct {
 #define HW_ERROR_USB                 -4  /**< USB operation failed */
 #define HW_ERROR_INVALID_PARAM       -5  /**< Invalid parameter */
 #define HW_ERROR_NOT_READY           -6  /**< Hardware not ready */
+#define HW_ERROR_BUSY                -7  /**< Resource busy (e.g. transmit ring full) */
 
 /** @} */ /* End of HwReturnCodes group */
 
@@ -152,7 +230,9 @@ int hw_get_info(hw_info_t *info);
 
 /**
  * @brief Check if USB console is ready
- * @details Determines if USB CDC-ACM console is available and ready for use.
+ * @details A USB CDC-ACM console is ready once the host has opened it
+ * (DTR raised); a console without line state is ready after hw_init().
+ * Does not block.
  * 
  * @return true if USB console is ready, false otherwise
  */
@@ -175,7 +255,7 @@ int hw_led_set_state(uint32_t led_id, bool state);
 /**
  * @brief Set LED pattern
  * @details Sets a predefined pattern for the specified LED. The pattern
- * will be automatically animated by the hardware update thread.
+ * is played by a per-LED timer that fires only at keyframe transitions.
  * 
  * @param led_id LED identifier (HW_LED_STATUS, HW_LED_HEARTBEAT, etc.)
  * @param pattern Pattern type to set
@@ -184,23 +264,51 @@ int hw_led_set_state(uint32_t led_id, bool state);
 int hw_led_set_pattern(uint32_t led_id, hw_led_pattern_t pattern);
 
 /**
- * @brief Update LED patterns
- * @details Updates all active LED patterns. This function should be called
- * periodically (e.g., every 50ms) to maintain smooth pattern animation.
+ * @brief Play a custom keyframe sequence on an LED
+ * @details The sequence is referenced, not copied, and must remain valid
+ * while it plays. A non-looping sequence holds its last level.
  * 
+ * @param led_id LED identifier (HW_LED_STATUS, HW_LED_HEARTBEAT, etc.)
+ * @param frames Keyframe array
+ * @param count Number of keyframes
+ * @param loop true to repeat the sequence
  * @return HW_OK on success, error code on failure
  */
-int hw_led_update_patterns(void);
+int hw_led_play_sequence(uint32_t led_id, const hw_led_keyframe_t *frames, uint32_t count,
+                         bool loop);
+
+/**
+ * @brief Set the repeat period of an LED pattern
+ * @details The last keyframe of the looping sequence is stretched or
+ * shortened so that one loop takes period_ms. Takes effect at the next
+ * transition without restarting the pattern. Setting a new pattern resets
+ * the period to the pattern's natural length.
+ * 
+ * @param led_id LED identifier (HW_LED_STATUS, HW_LED_HEARTBEAT, etc.)
+ * @param period_ms Loop period in milliseconds (0 = natural length)
+ * @return HW_OK on success, error code on failure
+ */
+int hw_led_set_period(uint32_t led_id, uint32_t period_ms);
 
 /**
  * @brief Show medical pulse on heartbeat LED
- * @details Displays a medical pulse pattern synchronized with heart rate data.
+ * @details Runs the heartbeat pattern with a period of 60000 / BPM so the
+ * LED blinks at the measured heart rate. A rate of 0 turns the LED off.
  * 
  * @param heart_rate_bpm Heart rate in beats per minute
  * @return HW_OK on success, error code on failure
  */
 int hw_show_medical_pulse(uint32_t heart_rate_bpm);
 
+/**
+ * @brief Flash the heartbeat LED for one detected beat
+ * @details Plays the heartbeat sequence once, for use from beat-detection
+ * events instead of the periodic hw_show_medical_pulse(). ISR-safe.
+ * 
+ * @return HW_OK on success, error code on failure
+ */
+int hw_show_medical_beat(void);
+
 /**
  * @brief Test LED patterns
  * @details Tests all LED patterns for hardware validation and debugging.
@@ -239,6 +347,20 @@ bool hw_button_is_pressed(void);
  */
 bool hw_button_wait_press(uint32_t timeout_ms);
 
+/**
+ * @brief Register a button gesture handler
+ * @details Several handlers may be registered for the same gesture; they are
+ * called in registration order.
+ * 
+ * @param gesture Gesture to handle
+ * @param handler Handler function
+ * @param user_data User data passed to the handler
+ * @return HW_OK on success, HW_ERROR_BUSY if the handler table is full,
+ *         error code on failure
+ */
+int hw_button_register_handler(hw_button_gesture_t gesture, hw_button_handler_t handler,
+                               void *user_data);
+
 /**
  * @brief Get button press count since last reset
  * @details Returns the number of button presses detected since system reset.
@@ -339,17 +461,52 @@ int hw_serial_bt_init(void);
 
 /**
  * @brief Send data via serial Bluetooth interface
- * @details Sends data through serial interface to Bluetooth module.
+ * @details Enqueues data into the transmit ring and returns immediately.
+ * The UART drains the ring in the background (async/EasyDMA where
+ * available, interrupt-driven otherwise). A frame is either queued
+ * completely or rejected; it is never split.
  * 
  * @param data Pointer to data to send
  * @param length Data length in bytes
- * @return HW_OK on success, error code on failure
+ * @return HW_OK on success, HW_ERROR_BUSY if the ring lacks space,
+ *         error code on failure
  */
 int hw_serial_bt_send(const uint8_t *data, uint32_t length);
 
+/**
+ * @brief Register serial Bluetooth transmit completion callback
+ * @details The callback fires each time the transmit ring drains.
+ * 
+ * @param cb Callback function (NULL to unregister)
+ * @param user_data User data passed to the callback
+ * @return HW_OK on success, error code on failure
+ */
+int hw_serial_bt_set_tx_callback(hw_serial_bt_tx_cb_t cb, void *user_data);
+
+/**
+ * @brief Get serial Bluetooth interface statistics
+ * 
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return HW_OK on success, error code on failure
+ */
+int hw_serial_bt_get_stats(hw_serial_bt_stats_t *stats);
+
+/**
+ * @brief Register serial Bluetooth receive callback
+ * @details While a callback is registered, received bytes are delivered to
+ * it from the system work queue and hw_serial_bt_receive() returns nothing.
+ * In polled mode the work queue polls the UART for it every few milliseconds.
+ * 
+ * @param cb Callback function (NULL to unregister)
+ * @param user_data User data passed to the callback
+ * @return HW_OK on success, error code on failure
+ */
+int hw_serial_bt_set_rx_callback(hw_serial_bt_rx_cb_t cb, void *user_data);
+
 /**
  * @brief Receive data via serial Bluetooth interface
- * @details Receives data from serial interface from Bluetooth module.
+ * @details Drains bytes buffered by the background receiver (async
+ * double-buffered RX or RX interrupts). Never blocks.
  * 
  * @param buffer Pointer to buffer for received data
  * @param max_length Maximum buffer length
@@ -0,0 +1,567 @@
+/**
+ * @file hardware_native.c
+ * @brief Hardware abstraction layer for native_sim host builds
+ * @details Stands in for hardware.c when the application runs as a Linux
+ * process. LEDs keep their pattern state and log changes, the button is
+ * never pressed, and the Bluetooth and serial Bluetooth interfaces report
+ * HW_ERROR_NOT_READY so the application runs its no-radio paths. DFU mode
+ * can still be entered and left through the API.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "hardware.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Constants and Macros                                               */
+/*============================================================================*/
+
+/** @brief Heart rate range mapped onto the heartbeat LED period */
+#define LED_HEARTBEAT_MIN_BPM              20U
+#define LED_HEARTBEAT_MAX_BPM              250U
+
+/** @brief Maximum number of registered button gesture handlers */
+#define BUTTON_MAX_HANDLERS                8U
+
+/** @brief Host device identifier ("NISC" "HOST") */
+static const uint8_t native_device_id[8] = { 'N', 'I', 'S', 'C', 'H', 'O', 'S', 'T' };
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Hardware initialization state */
+static bool hw_initialized;
+
+/** @brief LED states (pattern and last level only; nothing is driven) */
+static hw_led_state_t led_states[HW_LED_COUNT];
+
+/** @brief LED loop periods set with hw_led_set_period() */
+static uint32_t led_periods_ms[HW_LED_COUNT];
+
+/** @brief Registered button handlers (kept for API parity, never called) */
+static struct {
+    uint32_t handler_count;
+} button_state;
+
+/** @brief DFU boot state */
+static struct {
+    bool initialized;
+    bool boot_requested;
+    bool in_boot_mode;
+    uint32_t boot_start_time;
+} dfu_state;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static int led_update(uint32_t led_id, hw_led_pattern_t pattern);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Initialize hardware abstraction layer
+ */
+int hw_init(void)
+{
+    if (hw_initialized) {
+        return HW_OK;
+    }
+
+    memset(led_states, 0, sizeof(led_states));
+    memset(led_periods_ms, 0, sizeof(led_periods_ms));
+    memset(&button_state, 0, sizeof(button_state));
+
+    dfu_state.initialized = true;
+    dfu_state.boot_requested = false;
+    dfu_state.in_boot_mode = false;
+
+    hw_initialized = true;
+
+    DIAG_INFO(DIAG_CAT_HARDWARE, "Host hardware layer initialized (no LEDs, button or radio)");
+    return HW_OK;
+}
+
+/**
+ * @brief Get hardware information
+ */
+int hw_get_info(hw_info_t *info)
+{
+    if (!info) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    if (!hw_initialized) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    memcpy(info->device_id, native_device_id, sizeof(info->device_id));
+    info->reset_cause = 0U;
+    info->usb_console_ready = hw_usb_console_ready();
+    info->leds_initialized = hw_initialized;
+    info->gpio_initialized = false;
+    info->uptime_ms = k_uptime_get_32();
+
+    return HW_OK;
+}
+
+/**
+ * @brief Check if USB console is ready
+ */
+bool hw_usb_console_ready(void)
+{
+    /* The console is the host terminal */
+    return hw_initialized;
+}
+
+/*============================================================================*/
+/* LED Control Functions                                                      */
+/*============================================================================*/
+
+/**
+ * @brief Set LED state (on/off)
+ */
+int hw_led_set_state(uint32_t led_id, bool state)
+{
+    if (!hw_initialized || led_id >= HW_LED_COUNT) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    return led_update(led_id, state ? HW_PULSE_ON : HW_PULSE_OFF);
+}
+
+/**
+ * @brief Set LED pattern
+ */
+int hw_led_set_pattern(uint32_t led_id, hw_led_pattern_t pattern)
+{
+    if (!hw_initialized || led_id >= HW_LED_COUNT || pattern >= HW_PULSE_PATTERN_MAX) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    return led_update(led_id, pattern);
+}
+
+/**
+ * @brief Play a custom keyframe sequence on an LED
+ */
+int hw_led_play_sequence(uint32_t led_id, const hw_led_keyframe_t *frames, uint32_t count,
+                         bool loop)
+{
+    ARG_UNUSED(loop);
+
+    if (!hw_initialized || led_id >= HW_LED_COUNT || !frames || count == 0 ||
+        count > UINT8_MAX) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    /* The sequence is not played; the LED settles on the last keyframe */
+    led_states[led_id].level = frames[count - 1U].level;
+    led_states[led_id].state = (frames[count - 1U].level != 0U);
+    led_states[led_id].pattern_start_ms = k_uptime_get_32();
+
+    return HW_OK;
+}
+
+/**
+ * @brief Show medical pulse on heartbeat LED
+ */
+int hw_show_medical_pulse(uint32_t heart_rate_bpm)
+{
+    if (!hw_initialized) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    if (heart_rate_bpm == 0U) {
+        return hw_led_set_pattern(HW_LED_HEARTBEAT, HW_PULSE_OFF);
+    }
+
+    uint32_t bpm = CLAMP(heart_rate_bpm, LED_HEARTBEAT_MIN_BPM, LED_HEARTBEAT_MAX_BPM);
+
+    if (led_states[HW_LED_HEARTBEAT].pattern != HW_PULSE_HEARTBEAT) {
+        int ret = hw_led_set_pattern(HW_LED_HEARTBEAT, HW_PULSE_HEARTBEAT);
+        if (ret != HW_OK) {
+            return ret;
+        }
+    }
+
+    return hw_led_set_period(HW_LED_HEARTBEAT, 60000U / bpm);
+}
+
+/**
+ * @brief Flash the heartbeat LED for one detected beat
+ */
+int hw_show_medical_beat(void)
+{
+    if (!hw_initialized) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    led_states[HW_LED_HEARTBEAT].pattern = HW_PULSE_HEARTBEAT;
+    led_states[HW_LED_HEARTBEAT].cycle_count++;
+
+    return HW_OK;
+}
+
+/**
+ * @brief Set the repeat period of an LED pattern
+ */
+int hw_led_set_period(uint32_t led_id, uint32_t period_ms)
+{
+    if (!hw_initialized || led_id >= HW_LED_COUNT) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    led_periods_ms[led_id] = period_ms;
+    return HW_OK;
+}
+
+/**
+ * @brief Test LED patterns
+ */
+int hw_led_test_patterns(hw_led_pattern_t pattern)
+{
+    if (!hw_initialized) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    hw_led_pattern_t first = (pattern == HW_PULSE_PATTERN_MAX) ? HW_PULSE_OFF : pattern;
+    hw_led_pattern_t last = (pattern == HW_PULSE_PATTERN_MAX) ? HW_PULSE_PATTERN_MAX - 1 : pattern;
+
+    /* Nothing to look at on a host: walk the patterns without the pauses */
+    for (hw_led_pattern_t p = first; p <= last; p++) {
+        for (uint32_t led = 0; led < HW_LED_COUNT; led++) {
+            hw_led_set_pattern(led, p);
+        }
+    }
+
+    for (uint32_t led = 0; led < HW_LED_COUNT; led++) {
+        hw_led_set_pattern(led, HW_PULSE_OFF);
+    }
+
+    return HW_OK;
+}
+
+/*============================================================================*/
+/* GPIO and Button Functions                                                  */
+/*============================================================================*/
+
+/**
+ * @brief Initialize button for DFU boot process
+ */
+int hw_button_init(void)
+{
+    return hw_initialized ? HW_OK : HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Check if DFU button is pressed
+ */
+bool hw_button_is_pressed(void)
+{
+    return false;
+}
+
+/**
+ * @brief Wait for button press with timeout
+ */
+bool hw_button_wait_press(uint32_t timeout_ms)
+{
+    if (!hw_initialized) {
+        return false;
+    }
+
+    k_sleep(K_MSEC(timeout_ms));
+    return false;
+}
+
+/**
+ * @brief Register a button gesture handler
+ */
+int hw_button_register_handler(hw_button_gesture_t gesture, hw_button_handler_t handler,
+                               void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (gesture >= HW_BUTTON_GESTURE_MAX || !handler) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    if (button_state.handler_count >= BUTTON_MAX_HANDLERS) {
+        return HW_ERROR_BUSY;
+    }
+
+    button_state.handler_count++;
+    return HW_OK;
+}
+
+/**
+ * @brief Get button press count since last reset
+ */
+uint32_t hw_button_get_press_count(void)
+{
+    return 0U;
+}
+
+/*============================================================================*/
+/* DFU Boot Process Functions                                                 */
+/*============================================================================*/
+
+/**
+ * @brief Initialize DFU boot process
+ */
+int hw_dfu_init(void)
+{
+    if (!hw_initialized) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    dfu_state.initialized = true;
+    dfu_state.boot_requested = false;
+    dfu_state.in_boot_mode = false;
+
+    return HW_OK;
+}
+
+/**
+ * @brief Check if DFU boot is requested
+ */
+bool hw_dfu_boot_requested(void)
+{
+    return dfu_state.initialized && dfu_state.boot_requested;
+}
+
+/**
+ * @brief Enter DFU boot mode
+ */
+int hw_dfu_enter_boot_mode(void)
+{
+    if (!dfu_state.initialized) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    dfu_state.in_boot_mode = true;
+    dfu_state.boot_start_time = k_uptime_get_32();
+
+    hw_led_set_pattern(HW_LED_STATUS, HW_PULSE_FAST_BLINK);
+    hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
+
+    DIAG_INFO(DIAG_CAT_SYSTEM, "Entered DFU boot mode");
+    return HW_OK;
+}
+
+/**
+ * @brief Exit DFU boot mode
+ */
+int hw_dfu_exit_boot_mode(void)
+{
+    if (!dfu_state.initialized || !dfu_state.in_boot_mode) {
+        return HW_ERROR_NOT_READY;
+    }
+
+    dfu_state.in_boot_mode = false;
+    dfu_state.boot_requested = false;
+
+    hw_led_set_pattern(HW_LED_STATUS, HW_PULSE_BREATHING);
+    hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_OFF);
+
+    DIAG_INFO(DIAG_CAT_SYSTEM, "Exited DFU boot mode");
+    return HW_OK;
+}
+
+/**
+ * @brief Check if currently in DFU boot mode
+ */
+bool hw_dfu_is_active(void)
+{
+    return dfu_state.in_boot_mode;
+}
+
+/*============================================================================*/
+/* Bluetooth and Serial Communication Functions                               */
+/*============================================================================*/
+
+/**
+ * @brief Initialize Bluetooth Low Energy advertising
+ */
+int hw_ble_advertising_init(void)
+{
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Start Bluetooth advertising
+ */
+int hw_ble_advertising_start(void)
+{
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Stop Bluetooth advertising
+ */
+int hw_ble_advertising_stop(void)
+{
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Set Bluetooth advertising data
+ */
+int hw_ble_set_advertising_data(const char *device_name, const void *medical_data)
+{
+    ARG_UNUSED(device_name);
+    ARG_UNUSED(medical_data);
+
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Initialize serial Bluetooth communication
+ */
+int hw_serial_bt_init(void)
+{
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Send data via serial Bluetooth interface
+ */
+int hw_serial_bt_send(const uint8_t *data, uint32_t length)
+{
+    if (!data || length == 0) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Register the serial Bluetooth transmit completion callback
+ */
+int hw_serial_bt_set_tx_callback(hw_serial_bt_tx_cb_t cb, void *user_data)
+{
+    ARG_UNUSED(cb);
+    ARG_UNUSED(user_data);
+
+    return HW_OK;
+}
+
+/**
+ * @brief Get serial Bluetooth interface statistics
+ */
+int hw_serial_bt_get_stats(hw_serial_bt_stats_t *stats)
+{
+    if (!stats) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->mode = HW_SERIAL_MODE_NONE;
+
+    return HW_OK;
+}
+
+/**
+ * @brief Register the serial Bluetooth receive callback
+ */
+int hw_serial_bt_set_rx_callback(hw_serial_bt_rx_cb_t cb, void *user_data)
+{
+    ARG_UNUSED(cb);
+    ARG_UNUSED(user_data);
+
+    return HW_OK;
+}
+
+/**
+ * @brief Receive data via serial Bluetooth interface
+ */
+int hw_serial_bt_receive(uint8_t *buffer, uint32_t max_length, uint32_t *received_length)
+{
+    if (!buffer || max_length == 0 || !received_length) {
+        return HW_ERROR_INVALID_PARAM;
+    }
+
+    *received_length = 0U;
+    return HW_ERROR_NOT_READY;
+}
+
+/*============================================================================*/
+/* BLE GATT Medical Data Functions                                            */
+/*============================================================================*/
+
+/**
+ * @brief Update medical data for BLE GATT characteristics
+ */
+int hw_ble_update_medical_data(uint16_t heart_rate, int16_t temperature,
+                               uint16_t spo2, uint16_t motion)
+{
+    ARG_UNUSED(heart_rate);
+    ARG_UNUSED(temperature);
+    ARG_UNUSED(spo2);
+    ARG_UNUSED(motion);
+
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Check if a BLE device is connected
+ */
+bool hw_ble_is_connected(void)
+{
+    return false;
+}
+
+/**
+ * @brief Send notification for updated medical data
+ */
+int hw_ble_send_notification(void)
+{
+    return HW_ERROR_NOT_READY;
+}
+
+/**
+ * @brief Send notification for a specific characteristic
+ */
+int hw_ble_notify_characteristic(uint8_t characteristic_index)
+{
+    ARG_UNUSED(characteristic_index);
+
+    return HW_ERROR_NOT_READY;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Record an LED pattern change
+ */
+static int led_update(uint32_t led_id, hw_led_pattern_t pattern)
+{
+    hw_led_state_t *led = &led_states[led_id];
+
+    if (led->pattern != pattern) {
+        DIAG_DEBUG(DIAG_CAT_HARDWARE, "LED %u pattern %d -> %d", led_id, led->pattern, pattern);
+    }
+
+    led->pattern = pattern;
+    led->pattern_start_ms = k_uptime_get_32();
+    led->cycle_count = 0U;
+    led->state = (pattern != HW_PULSE_OFF);
+    led->level = led->state ? HW_LED_LEVEL_MAX : 0U;
+    led_periods_ms[led_id] = 0U;
+
+    return HW_OK;
+}
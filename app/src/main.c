@@ -17,6 +17,7 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/byteorder.h>
 #include <stdio.h>
 
 /* Include our modular components */
@@ -29,6 +30,18 @@
 #include "diagnostics.h"
 #include "config.h"
 #include "hardware.h"
+#include "serial_frame.h"
+#include "vitals_frame.h"
+#include "sensor_hub.h"
+#include "sensor_replay.h"
+#include "power_monitor.h"
+#include "usb_stream.h"
+#include "storage_writer.h"
+#include "vitals_store.h"
+#include "ble_config.h"
+#include "calibration.h"
+#include "boot_profile.h"
+#include "pipeline_bench.h"
 #include "shell_commands.h"
 
 /*============================================================================*/
@@ -50,10 +63,10 @@
 #define SUPERVISOR_CHECK_INTERVAL_MS  20000U
 
 /** @brief Data processing cycle interval in milliseconds */
-#define DATA_PROCESSING_INTERVAL_MS   5000U
+#define DATA_PROCESSING_INTERVAL_MS   100U
 
-/** @brief Communication transmission interval in milliseconds */
-#define COMMUNICATION_INTERVAL_MS     15000U
+/** @brief Watchdog timeout handed to the medical device */
+#define DEVICE_WATCHDOG_TIMEOUT_MS    30000U
 
 /** @brief Full diagnostic check interval in milliseconds */
 #define DIAGNOSTIC_CHECK_INTERVAL_MS  90000U
@@ -64,6 +77,12 @@
 /** @brief Main thread heartbeat interval in seconds */
 #define MAIN_HEARTBEAT_INTERVAL_SEC   30U
 
+/** @brief Poll interval while waiting for a USB host to open the console */
+#define CONSOLE_POLL_INTERVAL_MS      100U
+
+/** @brief Longest wait for the console before the boot profile is logged anyway */
+#define CONSOLE_WAIT_TIMEOUT_MS       30000U
+
 /** @} */ /* End of AppTiming group */
 
 /*============================================================================*/
@@ -108,6 +127,27 @@ static const sensor_simulation_t sensor_simulations[SENSOR_TYPE_MAX] = {
 /** @brief Current sensor reading values for all sensor types */
 static sensor_data_t current_sensor_readings[SENSOR_TYPE_MAX];
 
+/** @brief Latest sensor hub readings in display units (bpm, x10 otherwise) */
+static atomic_t hub_sensor_values[SENSOR_TYPE_MAX];
+
+/** @brief Bit per sensor type with a sensor hub reading available */
+static atomic_t hub_sensor_valid;
+
+/** @brief Paces the sensor queue to the data processing cadence (sink only) */
+static sensor_hub_decimator_t hub_decimator;
+
+/** @brief Set once main has started the sensor hub; rate changes restart it after */
+static atomic_t hub_started;
+
+/** @brief Wakes the communication thread before its interval elapses */
+static K_SEM_DEFINE(comm_wake_sem, 0, 1);
+
+/** @brief Set with comm_wake_sem when the interval is retuned */
+static atomic_t comm_reconfigured;
+
+/** @brief Prints the boot profile once the console host is connected */
+static struct k_work_delayable console_work;
+
 /** @} */ /* End of SensorSim group */
 
 /*============================================================================*/
@@ -121,6 +161,75 @@ static sensor_data_t current_sensor_readings[SENSOR_TYPE_MAX];
  */
 static void init_sensor_readings(void);
 
+/**
+ * @brief Answer a STATUS_REQUEST frame on the serial Bluetooth channel
+ * @details Replies with device state, battery level, uptime, sample and
+ * alert counters (little-endian).
+ */
+static void handle_status_request(const serial_frame_t *frame, void *user_data);
+
+/**
+ * @brief Sensor hub sink
+ * @details Feeds derived readings into the medical device pipeline and keeps
+ * the latest reading per sensor type for display and the uplinks.
+ */
+static void sensor_hub_sink(const sensor_hub_sample_t *samples, size_t count, void *user_data);
+
+/**
+ * @brief Power throttle handler
+ * @details Restarts the sensor hub at the rate allowed by the battery level.
+ */
+static void power_throttle_changed(power_throttle_t throttle, void *user_data);
+
+/**
+ * @brief Vitals batch handler
+ * @details Wakes the communication thread to flush a full batch early.
+ */
+static void vitals_batch_ready(void *user_data);
+
+/**
+ * @brief Build the medical device configuration from the config store
+ * @details Reads sampling rate and alert thresholds as one consistent
+ * configuration version.
+ */
+static void build_device_config(device_config_t *device_config);
+
+/**
+ * @brief Compile the calibration blob from the config store into the sensor hub transform
+ */
+static void load_calibration(void);
+
+/**
+ * @brief Configuration change observer
+ * @details Pushes sampling rate, alert threshold, calibration and
+ * communication interval changes to the running subsystems; one call per
+ * batch of changes.
+ */
+static void config_changed(uint32_t changed_keys, void *user_data);
+
+/**
+ * @brief Sensor hub rate from the configuration, scaled by the power throttle
+ */
+static uint32_t sensor_hub_rate_hz(void);
+
+/**
+ * @brief Communication interval from the configuration, scaled by the power throttle
+ */
+static uint32_t communication_interval_ms(void);
+
+/**
+ * @brief Console wait handler (system work queue)
+ * @details Polls until a USB host opens the console, so start-up never waits
+ * for it, then prints the boot profile.
+ */
+static void console_work_handler(struct k_work *work);
+
+/**
+ * @brief Create the application threads from the startup table
+ * @return SUCCESS, or the thread manager error of the first thread that failed
+ */
+static int start_application_threads(void);
+
 /** @brief Supervisor thread function (implementation below) */
 void supervisor_thread(void *arg1, void *arg2, void *arg3);
 
@@ -136,17 +245,225 @@ void communication_thread(void *arg1, void *arg2, void *arg3);
 /** @brief Diagnostics thread function (implementation below) */
 void diagnostics_thread(void *arg1, void *arg2, void *arg3);
 
-/** @brief Hardware update thread function (implementation below) */
-void hardware_update_thread(void *arg1, void *arg2, void *arg3);
-
 /*============================================================================*/
-/* Public Function Implementations                                            */
+/* Application Thread Table                                                   */
 /*============================================================================*/
 
+/** @brief Application thread description */
+typedef struct {
+    thread_id_t id;
+    thread_entry_t entry;
+    const char *name;
+} app_thread_t;
+
+/**
+ * @brief Application threads, created in this order
+ * @details Every thread runs below main's priority, so none of them starts
+ * until main has created them all; no delays are needed between creations.
+ */
+static const app_thread_t app_threads[] = {
+    { THREAD_ID_SUPERVISOR,       supervisor_thread,       "supervisor" },
+    { THREAD_ID_DATA_ACQUISITION, data_acquisition_thread, "data acquisition" },
+    { THREAD_ID_DATA_PROCESSING,  data_processing_thread,  "data processing" },
+    { THREAD_ID_COMMUNICATION,    communication_thread,    "communication" },
+};
+
 /*============================================================================*/
 /* Private Function Implementations                                           */
 /*============================================================================*/
 
+/**
+ * @brief Answer a STATUS_REQUEST frame on the serial Bluetooth channel
+ */
+static void handle_status_request(const serial_frame_t *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    device_stats_t stats;
+    uint8_t payload[12];
+
+    if (medical_device_get_stats(&stats) != MEDICAL_OK) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    payload[0] = (uint8_t)stats.current_state;
+    payload[1] = stats.battery_level;
+    sys_put_le32(stats.uptime_seconds, &payload[2]);
+    sys_put_le32(stats.total_samples, &payload[6]);
+    sys_put_le16((uint16_t)MIN(stats.alert_count, UINT16_MAX), &payload[10]);
+
+    serial_frame_reply(frame, SERIAL_FRAME_TYPE_STATUS, payload, sizeof(payload));
+}
+
+/**
+ * @brief Sensor hub sink
+ */
+static void sensor_hub_sink(const sensor_hub_sample_t *samples, size_t count, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    /* Raw capture sees every channel, before any conversion */
+    usb_stream_publish(samples, count);
+
+    boot_profile_mark(BOOT_STAGE_FIRST_SAMPLE);
+
+    /* Vital-sign history (derived channels only), written in the background */
+    storage_writer_submit(samples, count);
+
+    for (size_t i = 0; i < count; i++) {
+        sensor_data_t data;
+
+        if (!sensor_hub_to_sensor_data(&samples[i], &data) || data.type >= SENSOR_TYPE_MAX) {
+            continue; /* Raw channel */
+        }
+
+        /* Channel units are milli-units */
+        int32_t divisor = (data.type == SENSOR_TYPE_HEART_RATE) ? 1000 : 100;
+        atomic_set(&hub_sensor_values[data.type], samples[i].value / divisor);
+        atomic_set_bit(&hub_sensor_valid, data.type);
+    }
+
+    /* A FIFO burst holds far more samples than the sensor queue; the
+     * processing thread gets one per type per cycle */
+    sensor_data_t due[SENSOR_TYPE_MAX];
+    size_t due_count = sensor_hub_decimate(&hub_decimator, samples, count, due);
+
+    for (size_t i = 0; i < due_count; i++) {
+        medical_device_add_sensor_data(&due[i]);
+    }
+}
+
+/**
+ * @brief Power throttle handler
+ */
+static void power_throttle_changed(power_throttle_t throttle, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    uint32_t rate_hz = sensor_hub_rate_hz();
+
+    sensor_hub_stop();
+    sensor_hub_start(rate_hz);
+
+    /* Commit buffered history while there is still power to program flash */
+    if (throttle == POWER_THROTTLE_CRITICAL) {
+        storage_writer_flush();
+    }
+
+    DIAG_INFO(DIAG_CAT_POWER, "Throttle level %d: sensor rate %u Hz", throttle, rate_hz);
+}
+
+/**
+ * @brief Vitals batch handler
+ */
+static void vitals_batch_ready(void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    k_sem_give(&comm_wake_sem);
+}
+
+/**
+ * @brief Build the medical device configuration from the config store
+ */
+static void build_device_config(device_config_t *device_config)
+{
+    uint8_t thresholds[SENSOR_TYPE_MAX * sizeof(uint32_t)];
+    size_t len;
+    uint32_t seq;
+
+    memset(device_config, 0, sizeof(*device_config));
+    device_config->safety_monitoring_enabled = true;
+    device_config->watchdog_timeout_ms = DEVICE_WATCHDOG_TIMEOUT_MS;
+
+    do {
+        seq = config_read_begin();
+        config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &device_config->sampling_rate_hz);
+        if (config_get_blob(CONFIG_KEY_ALERT_THRESHOLDS, thresholds, sizeof(thresholds),
+                            &len) != CONFIG_OK) {
+            len = 0;
+        }
+    } while (config_read_retry(seq));
+
+    /* Blob layout: one little-endian uint32 per sensor type (HR, Temp, Motion, SpO2) */
+    for (size_t i = 0; i < SENSOR_TYPE_MAX && (i + 1U) * sizeof(uint32_t) <= len; i++) {
+        device_config->alert_thresholds[i] = sys_get_le32(&thresholds[i * sizeof(uint32_t)]);
+    }
+}
+
+/**
+ * @brief Compile the calibration blob into the sensor hub transform
+ */
+static void load_calibration(void)
+{
+    uint8_t blob[CALIBRATION_BLOB_MAX_SIZE];
+    size_t len;
+    uint32_t seq;
+    int ret;
+
+    do {
+        seq = config_read_begin();
+        ret = config_get_blob(CONFIG_KEY_CALIBRATION_DATA, blob, sizeof(blob), &len);
+    } while (config_read_retry(seq));
+
+    /* The config validator only admits blobs that load */
+    if (ret == CONFIG_OK) {
+        calibration_load(blob, len);
+    }
+}
+
+/**
+ * @brief Configuration change observer
+ */
+static void config_changed(uint32_t changed_keys, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (changed_keys & (CONFIG_KEY_BIT(CONFIG_KEY_SAMPLING_RATE) |
+                        CONFIG_KEY_BIT(CONFIG_KEY_ALERT_THRESHOLDS))) {
+        device_config_t device_config;
+
+        build_device_config(&device_config);
+        medical_device_reconfigure(&device_config);
+    }
+
+    if ((changed_keys & CONFIG_KEY_BIT(CONFIG_KEY_SAMPLING_RATE)) && atomic_get(&hub_started)) {
+        sensor_hub_stop();
+        sensor_hub_start(sensor_hub_rate_hz());
+    }
+
+    if (changed_keys & CONFIG_KEY_BIT(CONFIG_KEY_CALIBRATION_DATA)) {
+        load_calibration();
+    }
+
+    if (changed_keys & CONFIG_KEY_BIT(CONFIG_KEY_COMMUNICATION_INTERVAL)) {
+        atomic_set(&comm_reconfigured, 1);
+        k_sem_give(&comm_wake_sem);
+    }
+}
+
+/**
+ * @brief Sensor hub rate from the configuration, scaled by the power throttle
+ */
+static uint32_t sensor_hub_rate_hz(void)
+{
+    uint32_t rate_hz = 0U;
+
+    config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &rate_hz);
+    return power_monitor_scale_rate(rate_hz);
+}
+
+/**
+ * @brief Communication interval from the configuration, scaled by the power throttle
+ */
+static uint32_t communication_interval_ms(void)
+{
+    uint32_t interval_ms = 0U;
+
+    config_get_uint32(CONFIG_KEY_COMMUNICATION_INTERVAL, &interval_ms);
+    return power_monitor_scale_interval(interval_ms);
+}
+
 /**
  * @brief Initialize sensor readings with baseline values
  * @details Sets up initial sensor readings with clinically appropriate
@@ -165,12 +482,59 @@ static void init_sensor_readings(void)
     DIAG_DEBUG(DIAG_CAT_SENSOR, "Sensor readings initialized with baseline values");
 }
 
+/**
+ * @brief Console wait handler (system work queue)
+ */
+static void console_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    bool ready = hw_usb_console_ready();
+
+    /* Give the pipeline its first sample too, unless the host never shows */
+    if (k_uptime_get() < CONSOLE_WAIT_TIMEOUT_MS &&
+        (!ready || boot_profile_get_us(BOOT_STAGE_FIRST_SAMPLE) == 0U)) {
+        k_work_schedule(&console_work, K_MSEC(CONSOLE_POLL_INTERVAL_MS));
+        return;
+    }
+
+    if (ready) {
+        printk("USB Console detected - Enhanced logging enabled\n");
+    }
+    boot_profile_report();
+}
+
+/**
+ * @brief Create the application threads from the startup table
+ */
+static int start_application_threads(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(app_threads); i++) {
+        int ret = thread_manager_create_thread(app_threads[i].id, app_threads[i].entry,
+                                               NULL, NULL, NULL);
+        if (ret != SUCCESS) {
+            char message[48];
+
+            snprintf(message, sizeof(message), "Failed to create %s thread", app_threads[i].name);
+            system_handle_error(SYSTEM_ERROR_THREAD, message);
+            return ret;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
 /**
  * @brief Main application entry point
  * @details Initializes all system components, creates application threads,
  * and enters the main system monitoring loop. Follows medical device
  * software initialization patterns for safety and reliability.
- * Includes DFU boot process with button press wait and Bluetooth advertising.
+ * Includes DFU boot process (button state at reset with CONFIG_APP_FAST_BOOT,
+ * otherwise a button press window) and Bluetooth advertising.
  * 
  * @note This function does not return - it runs the main system loop indefinitely
  */
@@ -178,6 +542,8 @@ void main(void)
 {
     int ret;
 
+    boot_profile_mark(BOOT_STAGE_MAIN);
+
     printk("\n=== NISC Medical Wearable Device Starting ===\n");
     printk("Firmware Version: %s\n", APP_VERSION_STRING);
     printk("Device Model: %s\n", DEVICE_MODEL);
@@ -192,6 +558,7 @@ void main(void)
         hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
         return;
     }
+    boot_profile_mark(BOOT_STAGE_HARDWARE);
 
     /* Show hardware information */
     hw_info_t hw_info;
@@ -217,6 +584,16 @@ void main(void)
         printk("DFU mode ready - Press Button 1 anytime to enter DFU mode\n");
     }
 
+#ifdef CONFIG_APP_FAST_BOOT
+    /* DFU entry is decided by Button 1's state at reset - no entry window */
+    if (hw_dfu_boot_requested() && hw_dfu_enter_boot_mode() == HW_OK) {
+        printk("\nDFU mode active - Press Button 1 to exit and continue\n");
+        while (hw_dfu_is_active()) {
+            k_sleep(K_MSEC(100));
+        }
+        hw_led_set_pattern(HW_LED_STATUS, HW_PULSE_OFF);
+    }
+#else
     /* Optional DFU entry at startup */
     printk("\n=== Startup Options ===\n");
     printk("Press Button 1 within 5 seconds to enter DFU mode\n");
@@ -237,12 +614,11 @@ void main(void)
     
     printk("\nContinuing to normal operation...\n");
     hw_led_set_pattern(HW_LED_STATUS, HW_PULSE_OFF);
+#endif
 
-    /* Wait for USB console to be ready for better log output */
-    if (hw_usb_console_ready()) {
-        printk("USB Console detected - Enhanced logging enabled\n");
-        k_sleep(K_MSEC(500)); /* Give host time to open console */
-    }
+    /* The boot profile goes out once a host has the console open */
+    k_work_init_delayable(&console_work, console_work_handler);
+    k_work_schedule(&console_work, K_NO_WAIT);
 
     /* Initialize sensor simulation */
     init_sensor_readings();
@@ -263,14 +639,10 @@ void main(void)
         return;
     }
 
-    /* Initialize medical device with default configuration */
-    device_config_t device_config = {
-        .sampling_rate_hz = 100U,
-        .alert_thresholds = {80U, 100U, 150U, 95U}, /* HR, Temp, Motion, SpO2 */
-        .safety_monitoring_enabled = true,
-        .watchdog_timeout_ms = 30000U
-    };
+    /* Initialize medical device from the (persisted) configuration */
+    device_config_t device_config;
 
+    build_device_config(&device_config);
     ret = medical_device_init(&device_config);
     if (ret != MEDICAL_OK) {
         system_handle_error(SYSTEM_ERROR_INIT, "Medical device initialization failed");
@@ -278,6 +650,77 @@ void main(void)
         return;
     }
 
+    boot_profile_mark(BOOT_STAGE_SYSTEM);
+
+    /* Battery telemetry feeds the safety checks before monitoring starts */
+    power_monitor_init();
+
+    /* Per-sensor correction, applied by the sensor hub from its first sample */
+    load_calibration();
+
+    ret = medical_device_start_monitoring();
+    if (ret != MEDICAL_OK) {
+        DIAG_WARNING(DIAG_CAT_SYSTEM, "Medical monitoring not started: %d", ret);
+    }
+
+#ifdef CONFIG_APP_PIPELINE_BENCH
+    /* Benchmark image: a synthetic source replaces the sensor hub, the
+     * transports are stubbed and the stages run on the application threads */
+    vitals_frame_init();
+    serial_frame_init();
+    ret = pipeline_bench_run();
+    if (ret < 0) {
+        system_handle_error(SYSTEM_ERROR_INIT, "Pipeline benchmark failed");
+        hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
+    }
+    return;
+#endif
+
+    /* Sensor parts described in devicetree (real or emulated); started once
+     * the data processing thread exists to drain them */
+    bool sensors_ready = false;
+
+    if (sensor_hub_init() == SENSOR_HUB_OK) {
+        sensor_hub_stats_t hub_stats;
+
+        /* No parts fitted: replay a recording through the same pipeline */
+        if (sensor_hub_get_stats(&hub_stats) == SENSOR_HUB_OK && hub_stats.backends == 0U) {
+            /* Rate 0: follow the hub, so the configured rate and the power
+             * throttle load the pipeline as live parts would */
+            const sensor_replay_config_t replay_config = {
+                .rate_hz = 0U,
+                .seed = 1U,
+            };
+            sensor_replay_init(&replay_config);
+        }
+
+        /* Binary capture interface for lab validation (boards with cdc_acm_uart1) */
+        if (usb_stream_init() == USB_STREAM_OK) {
+            printk("USB capture stream available on the second CDC-ACM port\n");
+        }
+
+        /* Vital-sign history on the vitals_partition, kept across reboots */
+        ret = storage_writer_init(VITALS_STORE_CHANNELS_VITALS);
+        if (ret == STORAGE_WRITER_OK) {
+            thread_manager_create_thread(THREAD_ID_STORAGE, storage_writer_thread,
+                                         NULL, NULL, NULL);
+        } else if (ret != STORAGE_WRITER_ERROR_NO_STORAGE) {
+            DIAG_WARNING(DIAG_CAT_SYSTEM, "Vitals store unavailable: %d", ret);
+        }
+
+        sensor_hub_decimator_init(&hub_decimator, DATA_PROCESSING_INTERVAL_MS);
+        sensor_hub_set_sink(sensor_hub_sink, NULL);
+        sensors_ready = true;
+    }
+
+    /* Apply rate, threshold, calibration and interval changes without a reboot */
+    config_add_observer(config_changed,
+                        CONFIG_KEY_BIT(CONFIG_KEY_SAMPLING_RATE) |
+                        CONFIG_KEY_BIT(CONFIG_KEY_ALERT_THRESHOLDS) |
+                        CONFIG_KEY_BIT(CONFIG_KEY_CALIBRATION_DATA) |
+                        CONFIG_KEY_BIT(CONFIG_KEY_COMMUNICATION_INTERVAL),
+                        NULL);
+
     /* Shell disabled - uncomment if you re-enable CONFIG_SHELL in prj.conf */
     /* ret = shell_commands_init();
     if (ret != SHELL_OK) {
@@ -290,6 +733,11 @@ void main(void)
     if (ret != HW_OK) {
         DIAG_WARNING(DIAG_CAT_SYSTEM, "Bluetooth advertising initialization failed: %d", ret);
     } else {
+        /* Field tuning of the configuration table over GATT */
+        if (ble_config_init() != BLE_CONFIG_OK) {
+            DIAG_WARNING(DIAG_CAT_SYSTEM, "BLE configuration service unavailable");
+        }
+
         /* Start Bluetooth advertising */
         ret = hw_ble_advertising_start();
         if (ret == HW_OK) {
@@ -300,6 +748,10 @@ void main(void)
         }
     }
 
+    /* Vitals uplink batches samples between communication cycles */
+    vitals_frame_init();
+    vitals_frame_set_batch_handler(vitals_batch_ready, NULL);
+
     /* Initialize serial Bluetooth communication */
     ret = hw_serial_bt_init();
     if (ret != HW_OK) {
@@ -307,6 +759,12 @@ void main(void)
     } else {
         printk("Serial Bluetooth communication ready\n");
         DIAG_INFO(DIAG_CAT_SYSTEM, "Serial Bluetooth interface initialized");
+
+        /* Framed command channel on top of the async receive path */
+        if (serial_frame_init() == FRAME_OK) {
+            serial_frame_register_handler(SERIAL_FRAME_TYPE_STATUS_REQUEST,
+                                          handle_status_request, NULL);
+        }
     }
 
     DIAG_INFO(DIAG_CAT_SYSTEM, "All subsystems initialized successfully");
@@ -314,68 +772,32 @@ void main(void)
     /* Set status LED to indicate system is ready */
     hw_led_set_pattern(HW_LED_STATUS, HW_PULSE_BREATHING);
 
-    /* Create application threads with delays to avoid race conditions */
+    /* Create application threads */
     printk("Creating application threads...\n");
-
-    /* Start supervisor thread first - highest priority for safety */
-    ret = thread_manager_create_thread(THREAD_ID_SUPERVISOR, supervisor_thread, 
-                                      NULL, NULL, NULL);
+    ret = start_application_threads();
     if (ret != SUCCESS) {
-        system_handle_error(SYSTEM_ERROR_THREAD, "Failed to create supervisor thread");
         hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
         return;
     }
-    k_sleep(K_MSEC(100)); /* Small delay to let supervisor start */
-
-    /* Start hardware update thread for LED patterns */
-    ret = thread_manager_create_thread(THREAD_ID_DIAGNOSTICS, hardware_update_thread, 
-                                      NULL, NULL, NULL);
-    if (ret != SUCCESS) {
-        system_handle_error(SYSTEM_ERROR_THREAD, "Failed to create hardware update thread");
-        hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
-        return;
-    }
-    k_sleep(K_MSEC(100)); /* Small delay */
-
-    /* Start data acquisition thread */
-    ret = thread_manager_create_thread(THREAD_ID_DATA_ACQUISITION, data_acquisition_thread,
-                                      NULL, NULL, NULL);
-    if (ret != SUCCESS) {
-        system_handle_error(SYSTEM_ERROR_THREAD, "Failed to create data acquisition thread");
-        hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
-        return;
-    }
-    k_sleep(K_MSEC(100)); /* Small delay */
-
-    /* Start data processing thread */
-    ret = thread_manager_create_thread(THREAD_ID_DATA_PROCESSING, data_processing_thread,
-                                      NULL, NULL, NULL);
-    if (ret != SUCCESS) {
-        system_handle_error(SYSTEM_ERROR_THREAD, "Failed to create data processing thread");
-        hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
-        return;
-    }
-    k_sleep(K_MSEC(100)); /* Small delay */
-
-    /* Start communication thread */
-    ret = thread_manager_create_thread(THREAD_ID_COMMUNICATION, communication_thread,
-                                      NULL, NULL, NULL);
-    if (ret != SUCCESS) {
-        system_handle_error(SYSTEM_ERROR_THREAD, "Failed to create communication thread");
-        hw_led_set_pattern(HW_LED_ERROR, HW_PULSE_SOS);
-        return;
+    boot_profile_mark(BOOT_STAGE_THREADS);
+
+    /* The first watermark now has a consumer; the throttle handler restarts
+     * the hub, so it is only installed once the hub runs */
+    if (sensors_ready) {
+        uint32_t rate_hz = sensor_hub_rate_hz();
+
+        ret = sensor_hub_start(rate_hz);
+        atomic_set(&hub_started, 1);
+        if (ret > 0) {
+            boot_profile_mark(BOOT_STAGE_SENSORS);
+            printk("Sensor hub started: %d part(s) at %u Hz\n", ret, rate_hz);
+        }
+        power_monitor_set_throttle_handler(power_throttle_changed, NULL);
     }
 
     DIAG_INFO(DIAG_CAT_SYSTEM, "Medical wearable device startup complete");
     printk("=== System Ready - All LEDs Active ===\n");
 
-    /* Show system ready indication - single synchronized flash */
-    hw_led_set_state(HW_LED_STATUS, true);
-    hw_led_set_state(HW_LED_HEARTBEAT, true);  
-    hw_led_set_state(HW_LED_COMMUNICATION, true);
-    hw_led_set_state(HW_LED_ERROR, true);
-    k_sleep(K_MSEC(300));
-    
     /* Set final LED patterns for normal operation */
     hw_led_set_pattern(HW_LED_STATUS, HW_PULSE_BREATHING);      /* Breathing = system OK */
     hw_led_set_pattern(HW_LED_HEARTBEAT, HW_PULSE_HEARTBEAT);   /* Medical pulse */
@@ -434,33 +856,9 @@ void supervisor_thread(void *arg1, void *arg2, void *arg3)
     }
 }
 
-/** @brief Simple sensor readings array for QEMU testing */
+/** @brief Latest readings shown and uplinked: HR, Temp*10, Motion*10, SpO2*10 */
 static int simple_sensor_values[SENSOR_TYPE_MAX] = {72, 366, 10, 980}; // HR, Temp*10, Motion*10, SpO2*10
 
-/** @brief Hardware update thread to maintain LED patterns */
-void hardware_update_thread(void *arg1, void *arg2, void *arg3)
-{
-    ARG_UNUSED(arg1);
-    ARG_UNUSED(arg2);
-    ARG_UNUSED(arg3);
-
-    printk("Hardware update thread started - LED pattern management\n");
-
-    while (1) {
-        /* Update LED patterns every 50ms for smooth animation */
-        hw_led_update_patterns();
-        
-        /* Update thread heartbeat every few cycles */
-        static uint32_t heartbeat_counter = 0;
-        heartbeat_counter++;
-        if (heartbeat_counter % 100 == 0) {  /* Every 5 seconds */
-            thread_manager_heartbeat(THREAD_ID_DIAGNOSTICS);
-        }
-
-        k_sleep(K_MSEC(50));
-    }
-}
-
 /** @brief Enhanced data acquisition thread with hardware integration */
 void data_acquisition_thread(void *arg1, void *arg2, void *arg3)
 {
@@ -476,36 +874,14 @@ void data_acquisition_thread(void *arg1, void *arg2, void *arg3)
     while (1) {
         thread_manager_heartbeat(THREAD_ID_DATA_ACQUISITION);
 
-        /* Generate realistic medical data with integer arithmetic only */
         uint32_t uptime_sec = k_uptime_get_32() / 1000U;
-        
-        /* Heart Rate: 60-100 bpm with simple variation */
-        int hr_base = 72;
-        int hr_variation = (int)((uptime_sec % 20U) - 10); /* ±10 bpm variation */
-        simple_sensor_values[0] = hr_base + hr_variation;
-        if (simple_sensor_values[0] < 60) simple_sensor_values[0] = 60;
-        if (simple_sensor_values[0] > 100) simple_sensor_values[0] = 100;
-        
-        /* Body Temperature: 36.0-37.5°C (stored as temp*10) */
-        int temp_base = 366; // 36.6°C * 10
-        int temp_variation = (int)((uptime_sec % 15U) - 7); /* ±0.7°C variation */
-        simple_sensor_values[1] = temp_base + temp_variation;
-        if (simple_sensor_values[1] < 360) simple_sensor_values[1] = 360;
-        if (simple_sensor_values[1] > 375) simple_sensor_values[1] = 375;
-        
-        /* Motion Activity: 0-5g (stored as motion*10) */
-        int motion_base = 2; // 0.2g * 10
-        int motion_burst = ((uptime_sec % 7U) == 0 ? 30 : 0); /* Activity bursts */
-        int motion_random = (int)((uptime_sec * 3U) % 10U); /* Small random motion */
-        simple_sensor_values[2] = motion_base + motion_burst + motion_random;
-        if (simple_sensor_values[2] > 50) simple_sensor_values[2] = 50;
-        
-        /* Blood Oxygen: 95-100% (stored as SpO2*10) */
-        int spo2_base = 980; // 98.0% * 10
-        int spo2_variation = (int)((uptime_sec % 12U) - 6) * 2; /* ±1.2% variation */
-        simple_sensor_values[3] = spo2_base + spo2_variation;
-        if (simple_sensor_values[3] < 950) simple_sensor_values[3] = 950;
-        if (simple_sensor_values[3] > 1000) simple_sensor_values[3] = 1000;
+
+        /* Latest readings from the sensor hub (parts or replay) */
+        for (int i = 0; i < SENSOR_TYPE_MAX; i++) {
+            if (atomic_test_bit(&hub_sensor_valid, i)) {
+                simple_sensor_values[i] = (int)atomic_get(&hub_sensor_values[i]);
+            }
+        }
 
         /* Update heartbeat LED with current heart rate */
         hw_show_medical_pulse((uint32_t)simple_sensor_values[0]);
@@ -540,6 +916,16 @@ void data_acquisition_thread(void *arg1, void *arg2, void *arg3)
             }
         }
 
+        /* Queue the sample for the next serial Bluetooth uplink batch */
+        vitals_sample_t sample = {
+            .timestamp_ms = k_uptime_get_32(),
+            .heart_rate_bpm = (uint8_t)simple_sensor_values[0],
+            .temperature_x10 = (int16_t)simple_sensor_values[1],
+            .motion_x10 = (uint16_t)simple_sensor_values[2],
+            .spo2_x10 = (uint16_t)simple_sensor_values[3],
+        };
+        vitals_frame_add_sample(&sample);
+
         /* Update BLE GATT data immediately after sensor reading */
         hw_ble_update_medical_data(
             (uint16_t)simple_sensor_values[0],  /* Heart rate */
@@ -574,7 +960,7 @@ void data_acquisition_thread(void *arg1, void *arg2, void *arg3)
 
         cycle_count++;
 
-        k_sleep(K_MSEC(SENSOR_SAMPLING_INTERVAL_MS));
+        k_sleep(K_MSEC(power_monitor_scale_interval(SENSOR_SAMPLING_INTERVAL_MS)));
     }
 }
 
@@ -589,6 +975,9 @@ void data_processing_thread(void *arg1, void *arg2, void *arg3)
 
     while (1) {
         thread_manager_heartbeat(THREAD_ID_DATA_PROCESSING);
+
+        /* Drain everything queued by the sensor hub sink since the last cycle */
+        medical_device_process_sensor_data(UINT32_MAX);
         k_sleep(K_MSEC(DATA_PROCESSING_INTERVAL_MS));
     }
 }
@@ -600,7 +989,8 @@ void communication_thread(void *arg1, void *arg2, void *arg3)
     ARG_UNUSED(arg2);
     ARG_UNUSED(arg3);
 
-    printk("Communication thread started - transmitting data every 15 seconds\n");
+    printk("Communication thread started - transmitting data every %u ms\n",
+           communication_interval_ms());
 
     uint32_t transmission_count = 0U;
 
@@ -634,15 +1024,8 @@ void communication_thread(void *arg1, void *arg2, void *arg3)
             printk("+-------------------------------------+\n");
         }
         
-        /* Also send via serial Bluetooth for legacy support */
-        char bt_data[64];
-        snprintf(bt_data, sizeof(bt_data), "HR:%d,T:%d.%d,M:%d.%d,SpO2:%d.%d",
-                simple_sensor_values[0],
-                simple_sensor_values[1] / 10, simple_sensor_values[1] % 10,
-                simple_sensor_values[2] / 10, simple_sensor_values[2] % 10,
-                simple_sensor_values[3] / 10, simple_sensor_values[3] % 10);
-        
-        hw_serial_bt_send((const uint8_t *)bt_data, strlen(bt_data));
+        /* Also send batched binary vitals via serial Bluetooth */
+        int samples_sent = vitals_frame_flush();
         
         /* Show transmission protocol with LED indication */
         uint32_t protocol = transmission_count % 3U;
@@ -665,7 +1048,7 @@ void communication_thread(void *arg1, void *arg2, void *arg3)
                 break;
             case 1U:
                 printk("Via: Serial Bluetooth Module\n");
-                printk("Data: %s\n", bt_data);
+                printk("Data: %d samples in binary vitals batches\n", MAX(samples_sent, 0));
                 /* Longer on pattern for serial */
                 hw_led_set_state(HW_LED_COMMUNICATION, true);
                 k_sleep(K_MSEC(500));
@@ -684,7 +1067,18 @@ void communication_thread(void *arg1, void *arg2, void *arg3)
         /* Turn off communication LED after transmission */
         hw_led_set_pattern(HW_LED_COMMUNICATION, HW_PULSE_OFF);
 
-        k_sleep(K_MSEC(COMMUNICATION_INTERVAL_MS));
+        /* A full vitals batch is flushed as soon as it fills, so the 1 Hz
+         * samples never outrun the pending queue on long or throttled
+         * intervals; a retuned interval ends the wait so a shorter one
+         * applies now */
+        int64_t cycle_end = k_uptime_get() + communication_interval_ms();
+        int64_t remaining;
+
+        while ((remaining = cycle_end - k_uptime_get()) > 0 &&
+               k_sem_take(&comm_wake_sem, K_MSEC(remaining)) == 0 &&
+               !atomic_clear(&comm_reconfigured)) {
+            vitals_frame_flush();
+        }
     }
 }
 
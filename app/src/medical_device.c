@@ -16,6 +16,7 @@
 
 #include "medical_device.h"
 #include "diagnostics.h"
+#include "calibration.h"
 #include "common.h"
 #include <string.h>
 
@@ -26,9 +27,6 @@
 /** @brief Maximum number of concurrent medical alerts */
 #define MAX_ALERTS               8U
 
-/** @brief Sensor queue capacity for buffering sensor data */
-#define SENSOR_QUEUE_CAPACITY    16U
-
 /** @brief Default battery level on initialization */
 #define DEFAULT_BATTERY_LEVEL    100U
 
@@ -60,8 +58,26 @@ static safe_queue_t alert_queue;
 /** @brief Mutex for thread-safe device operations */
 static struct k_mutex device_mutex;
 
-/** @brief Storage for medical alerts */
-static medical_alert_t alert_storage[MAX_ALERTS] __attribute__((unused));
+/**
+ * @brief Backing storage for queued sensor samples
+ * @details safe_queue holds pointers only, so each enqueued sample is copied
+ * into a slot here first. Twice the queue capacity means a slot is reused
+ * only after its sample left the queue a full capacity earlier, by which time
+ * the (single) consumer has copied it out.
+ */
+static sensor_data_t sensor_storage[MEDICAL_SENSOR_QUEUE_CAPACITY * 2U];
+
+/** @brief Next sensor_storage slot */
+static uint32_t sensor_storage_next;
+
+/** @brief Backing storage for queued medical alerts (same scheme) */
+static medical_alert_t alert_storage[MAX_ALERTS * 2U];
+
+/** @brief Next alert_storage slot */
+static uint32_t alert_storage_next;
+
+/** @brief Samples rejected since the last accepted one (throttles the warning) */
+static uint32_t sensor_drop_run;
 
 /** @brief Next alert ID for unique alert identification */
 static uint32_t next_alert_id = 1U;
@@ -102,7 +118,7 @@ int medical_device_init(const device_config_t *config)
     DIAG_INFO(DIAG_CAT_SYSTEM, "Initializing medical device subsystem");
 
     /* Initialize sensor data queue with specified capacity */
-    int ret = safe_queue_init(&sensor_queue, SENSOR_QUEUE_CAPACITY);
+    int ret = safe_queue_init(&sensor_queue, MEDICAL_SENSOR_QUEUE_CAPACITY);
     if (ret != QUEUE_OK) {
         DIAG_ERROR(DIAG_CAT_SYSTEM, "Failed to initialize sensor queue (error: %d)", ret);
         k_mutex_lock(&device_mutex, K_FOREVER);
@@ -150,14 +166,14 @@ int medical_device_init(const device_config_t *config)
 
 /**
  * @brief Start medical monitoring operations
- * @details Initiates medical device monitoring including sensor calibration,
- * safety checks, and transition to active monitoring state. This function
+ * @details Initiates medical device monitoring including a calibration
+ * status report, safety checks, and transition to active monitoring state. This function
  * performs critical safety validations before enabling monitoring.
  * 
  * @return MEDICAL_OK on successful monitoring start
  * @retval MEDICAL_ERROR_SAFETY if device is in error state or safety checks fail
  * 
- * @note This function includes mandatory calibration and safety verification
+ * @note This function includes mandatory safety verification
  * @warning Device must be initialized before calling this function
  */
 int medical_device_start_monitoring(void)
@@ -185,11 +201,10 @@ int medical_device_start_monitoring(void)
     device_statistics.current_state = device_state;
     k_mutex_unlock(&device_mutex);
 
-    DIAG_INFO(DIAG_CAT_SYSTEM, "Performing sensor calibration...");
-    
-    /* Simulate calibration sequence - in real implementation this would 
-     * perform actual sensor calibration procedures */
-    k_sleep(K_MSEC(1000U)); /* Simulate calibration time */
+    /* Calibration was compiled from the CRC-checked config blob at load time
+     * and is applied per sample by the sensor hub; nothing to wait for here */
+    DIAG_INFO(DIAG_CAT_SYSTEM, "Sensor calibration active on channel mask 0x%03x",
+              calibration_get_channels());
 
     /* Mandatory safety check before enabling monitoring */
     int safety_result = medical_device_safety_check();
@@ -248,15 +263,27 @@ int medical_device_add_sensor_data(const sensor_data_t *data)
         return MEDICAL_ERROR_SAFETY;
     }
 
-    /* Add to processing queue */
-    int ret = safe_queue_enqueue_nb(&sensor_queue, data, sizeof(sensor_data_t));
+    k_mutex_lock(&device_mutex, K_FOREVER);
+
+    /* Copy into a storage slot; the queue only carries the pointer */
+    sensor_data_t *slot = &sensor_storage[sensor_storage_next % ARRAY_SIZE(sensor_storage)];
+    *slot = *data;
+
+    int ret = safe_queue_enqueue_nb(&sensor_queue, slot, sizeof(sensor_data_t));
     if (ret != QUEUE_OK) {
-        DIAG_WARNING(DIAG_CAT_SENSOR, "Sensor queue full, dropping data");
+        device_statistics.dropped_samples++;
+        /* Warn once per run of drops so a saturated pipeline does not flood the log */
+        if (sensor_drop_run++ == 0U) {
+            DIAG_WARNING(DIAG_CAT_SENSOR, "Sensor queue full, dropping data");
+        }
+        k_mutex_unlock(&device_mutex);
         return MEDICAL_ERROR_SENSOR;
     }
 
+    sensor_storage_next++;
+    sensor_drop_run = 0;
+
     /* Update statistics */
-    k_mutex_lock(&device_mutex, K_FOREVER);
     device_statistics.total_samples++;
     
     /* Check for alerts based on sensor data */
@@ -272,7 +299,12 @@ int medical_device_add_sensor_data(const sensor_data_t *data)
             alert.alert_id = next_alert_id++;
             
             /* Add to alert queue */
-            safe_queue_enqueue_nb(&alert_queue, &alert, sizeof(medical_alert_t));
+            medical_alert_t *alert_slot =
+                &alert_storage[alert_storage_next % ARRAY_SIZE(alert_storage)];
+            *alert_slot = alert;
+            if (safe_queue_enqueue_nb(&alert_queue, alert_slot, sizeof(medical_alert_t)) == QUEUE_OK) {
+                alert_storage_next++;
+            }
             device_statistics.alert_count++;
         }
     }
@@ -341,6 +373,39 @@ int medical_device_get_stats(device_stats_t *stats)
     return MEDICAL_OK;
 }
 
+int medical_device_set_battery_level(uint8_t level_percent)
+{
+    if (level_percent > 100U) {
+        return MEDICAL_ERROR_INIT;
+    }
+
+    k_mutex_lock(&device_mutex, K_FOREVER);
+    device_statistics.battery_level = level_percent;
+    k_mutex_unlock(&device_mutex);
+
+    return MEDICAL_OK;
+}
+
+int medical_device_reconfigure(const device_config_t *config)
+{
+    if (config == NULL || config->sampling_rate_hz == 0U || config->sampling_rate_hz > 1000U) {
+        return MEDICAL_ERROR_INIT;
+    }
+
+    /* The alert check reads the thresholds under the same lock, per sample */
+    k_mutex_lock(&device_mutex, K_FOREVER);
+    device_configuration = *config;
+    k_mutex_unlock(&device_mutex);
+
+    DIAG_INFO(DIAG_CAT_SYSTEM, "Device reconfigured: %u Hz, thresholds %u/%u/%u/%u",
+              config->sampling_rate_hz,
+              config->alert_thresholds[SENSOR_TYPE_HEART_RATE],
+              config->alert_thresholds[SENSOR_TYPE_TEMPERATURE],
+              config->alert_thresholds[SENSOR_TYPE_MOTION],
+              config->alert_thresholds[SENSOR_TYPE_BLOOD_OXYGEN]);
+    return MEDICAL_OK;
+}
+
 int medical_device_get_sensor_data(sensor_data_t *data)
 {
     if (data == NULL) {
@@ -437,7 +502,10 @@ void medical_device_emergency_shutdown(void)
     safe_queue_clear(&alert_queue);
 
     /* Add critical alert */
-    medical_alert_t emergency_alert = {
+    k_mutex_lock(&device_mutex, K_FOREVER);
+    medical_alert_t *emergency_alert =
+        &alert_storage[alert_storage_next % ARRAY_SIZE(alert_storage)];
+    *emergency_alert = (medical_alert_t) {
         .level = ALERT_LEVEL_EMERGENCY,
         .sensor_type = SENSOR_TYPE_MAX, /* System alert */
         .message = "Emergency shutdown",
@@ -445,7 +513,10 @@ void medical_device_emergency_shutdown(void)
         .alert_id = next_alert_id++
     };
 
-    safe_queue_enqueue_nb(&alert_queue, &emergency_alert, sizeof(medical_alert_t));
+    if (safe_queue_enqueue_nb(&alert_queue, emergency_alert, sizeof(medical_alert_t)) == QUEUE_OK) {
+        alert_storage_next++;
+    }
+    k_mutex_unlock(&device_mutex);
 
     DIAG_CRITICAL(DIAG_CAT_SAFETY, "Emergency shutdown complete");
 }
\ No newline at end of file
@@ -22,6 +22,9 @@
 #define MEDICAL_ERROR_SAFETY         -4
 #define MEDICAL_ERROR_COMMUNICATION  -5
 
+/* Sensor queue depth; further samples are dropped until it drains */
+#define MEDICAL_SENSOR_QUEUE_CAPACITY 16U
+
 /* Device states */
 typedef enum {
     DEVICE_STATE_OFF = 0,
@@ -84,6 +87,7 @@ typedef struct {
     uint32_t total_samples;
     uint32_t alert_count;
     uint32_t error_count;
+    uint32_t dropped_samples;  /* Samples rejected because the sensor queue was full */
     uint8_t battery_level;
     uint8_t signal_quality;
 } device_stats_t;
@@ -140,6 +144,22 @@ int medical_device_safety_check(void);
  */
 int medical_device_get_stats(device_stats_t *stats);
 
+/**
+ * @brief Update the battery level used by the safety checks
+ * @param level_percent Battery state of charge (0-100)
+ * @return MEDICAL_OK on success, error code otherwise
+ */
+int medical_device_set_battery_level(uint8_t level_percent);
+
+/**
+ * @brief Apply a new configuration to a running device
+ * @details Sampling rate and alert thresholds take effect for the next
+ * sample; no restart or queue flush is needed.
+ * @param config Pointer to device configuration
+ * @return MEDICAL_OK on success, MEDICAL_ERROR_INIT if the configuration is invalid
+ */
+int medical_device_reconfigure(const device_config_t *config);
+
 /**
  * @brief Get next sensor data from processing queue (consumes data)
  * @param data Pointer to sensor_data_t structure to fill
@@ -0,0 +1,577 @@
+/**
+ * @file pipeline_bench.c
+ * @brief End-to-end pipeline throughput benchmark
+ * @details The source stamps each sample with the hardware cycle counter in
+ * sensor_data_t.timestamp (milliseconds everywhere else) so the stamp rides
+ * through sensor_queue unchanged. The vitals uplink does not carry it, so
+ * the processing stage keeps the stamps in a ring that mirrors the uplink's
+ * pending queue: same capacity, same drop-oldest policy, and both updated
+ * under one mutex, so the first N stamps always belong to the N samples a
+ * flush sends.
+ *
+ * Only the communication stage runs application code end to end: the
+ * uplink's vitals_frame_flush() encodes real frames, and the build wraps
+ * hw_serial_bt_send() so they stop at __wrap_hw_serial_bt_send() below
+ * instead of the UART. The processing stage is synthetic. The
+ * application's data_processing_thread() drains sensor_queue through
+ * medical_device_process_sensor_data(), which consumes the samples and
+ * forwards nothing; here each drained sample is turned into a
+ * vitals_sample_t and queued on the uplink directly, so that its source
+ * stamp can be followed to the transport. Its CPU share is that of this
+ * stand-in, not of the application's analysis.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "pipeline_bench.h"
+#include "medical_device.h"
+#include "vitals_frame.h"
+#include "thread_manager.h"
+#include "boot_profile.h"
+#include "diagnostics.h"
+#include "hardware.h"
+#include "common.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Pipeline stages, one thread each */
+typedef enum {
+    PIPELINE_STAGE_ACQUISITION = 0,
+    PIPELINE_STAGE_PROCESSING,
+    PIPELINE_STAGE_COMMUNICATION,
+    PIPELINE_STAGE_MAX
+} pipeline_stage_t;
+
+/** @brief Runtime statistics at one point in time */
+typedef struct {
+    uint64_t stage_cycles[PIPELINE_STAGE_MAX];
+    uint64_t all_cycles;
+    uint64_t idle_cycles;
+} cpu_snapshot_t;
+
+/** @brief Result of one rate step */
+typedef struct {
+    uint32_t rate_hz;
+    uint32_t offered;               /* Samples that fell due */
+    uint32_t queued;                /* Accepted by medical_device_add_sensor_data() */
+    uint32_t overruns;              /* Rejected because sensor_queue was full */
+    uint32_t uplink_drops;          /* Dropped by the uplink before a flush */
+    uint32_t delivered;             /* Handed to the transport */
+    uint32_t share_x10[PIPELINE_STAGE_MAX];
+    uint32_t idle_x10;
+    uint32_t other_x10;
+    uint32_t latency_us[4];         /* p50, p90, p99, max */
+    bool sustained;
+} step_result_t;
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Rates swept, lowest first */
+static const uint32_t sweep_rates_hz[] = {
+    10U, 20U, 50U, 100U, 200U, 500U, 1000U, 2000U, 5000U, 10000U
+};
+
+/** @brief Thread carrying each stage */
+static const thread_id_t stage_threads[PIPELINE_STAGE_MAX] = {
+    [PIPELINE_STAGE_ACQUISITION] = THREAD_ID_DATA_ACQUISITION,
+    [PIPELINE_STAGE_PROCESSING] = THREAD_ID_DATA_PROCESSING,
+    [PIPELINE_STAGE_COMMUNICATION] = THREAD_ID_COMMUNICATION,
+};
+
+/** @brief Synthetic readings per sensor type (resting adult) */
+static const float source_values[SENSOR_TYPE_MAX] = {
+    [SENSOR_TYPE_HEART_RATE] = 72.0f,
+    [SENSOR_TYPE_TEMPERATURE] = 36.6f,
+    [SENSOR_TYPE_MOTION] = 1.0f,
+    [SENSOR_TYPE_BLOOD_OXYGEN] = 98.0f,
+};
+
+/** @brief Benchmark state */
+static struct {
+    k_tid_t stage_tids[PIPELINE_STAGE_MAX];
+
+    /* Step control: main sets the rate and starts the source */
+    uint32_t rate_hz;
+    struct k_sem start_sem;
+    struct k_sem done_sem;
+    struct k_sem process_sem;
+    struct k_sem comm_sem;
+    struct k_timer source_timer;
+    uint32_t offered;
+    uint32_t source_seq;
+
+    /* Latest value per sensor type, owned by the processing stage */
+    float latest[SENSOR_TYPE_MAX];
+
+    /* Source stamps of the samples pending in the vitals uplink */
+    struct k_mutex uplink_mutex;
+    uint32_t stamps[VITALS_PENDING_MAX];
+    size_t stamp_head;
+    size_t stamp_count;
+    uint32_t uplink_drops;
+    uint32_t delivered;
+
+    /* Decimated latency record of the current step */
+    uint32_t latency_us[PIPELINE_BENCH_LATENCY_SAMPLES];
+    uint32_t latency_count;
+    uint32_t latency_stride;
+    uint32_t latency_seen;
+    uint32_t latency_max_us;
+} bench;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void source_thread(void *arg1, void *arg2, void *arg3);
+static void processing_thread(void *arg1, void *arg2, void *arg3);
+static void communication_thread(void *arg1, void *arg2, void *arg3);
+static void run_step(uint32_t rate_hz, step_result_t *result);
+static void source_emit(void);
+static void process_pending(void);
+static void record_latency(uint32_t latency_us);
+static void take_snapshot(cpu_snapshot_t *snapshot);
+static void print_step(const step_result_t *result);
+static int compare_u32(const void *a, const void *b);
+
+int __wrap_hw_serial_bt_send(const uint8_t *data, uint32_t length);
+
+/** @brief Stage thread entry points */
+static const thread_entry_t stage_entries[PIPELINE_STAGE_MAX] = {
+    [PIPELINE_STAGE_ACQUISITION] = source_thread,
+    [PIPELINE_STAGE_PROCESSING] = processing_thread,
+    [PIPELINE_STAGE_COMMUNICATION] = communication_thread,
+};
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Run the rate sweep and print the report
+ */
+int pipeline_bench_run(void)
+{
+    if (medical_device_get_state() != DEVICE_STATE_MONITORING) {
+        DIAG_ERROR(DIAG_CAT_PERFORMANCE, "Pipeline benchmark needs a monitoring device");
+        return PIPELINE_BENCH_ERROR_STATE;
+    }
+
+    k_sem_init(&bench.start_sem, 0, 1);
+    k_sem_init(&bench.done_sem, 0, 1);
+    k_sem_init(&bench.process_sem, 0, 1);
+    k_sem_init(&bench.comm_sem, 0, 1);
+    k_timer_init(&bench.source_timer, NULL, NULL);
+    k_mutex_init(&bench.uplink_mutex);
+
+    for (int i = 0; i < SENSOR_TYPE_MAX; i++) {
+        bench.latest[i] = source_values[i];
+    }
+
+    /* Main outranks the stages, so all of them are up before the first step */
+    for (int i = 0; i < PIPELINE_STAGE_MAX; i++) {
+        if (thread_manager_create_thread(stage_threads[i], stage_entries[i],
+                                         NULL, NULL, NULL) != SUCCESS) {
+            DIAG_ERROR(DIAG_CAT_PERFORMANCE, "Pipeline benchmark: no %s thread",
+                       thread_manager_get_name(stage_threads[i]));
+            return PIPELINE_BENCH_ERROR_THREAD;
+        }
+    }
+    k_sleep(K_MSEC(PIPELINE_BENCH_SETTLE_MS));
+
+    printk("\n=== Pipeline Benchmark ===\n");
+    printk("Step: %u ms, source period: %u us, drain: ",
+           CONFIG_APP_PIPELINE_BENCH_STEP_MS, PIPELINE_BENCH_SOURCE_PERIOD_US);
+    if (CONFIG_APP_PIPELINE_BENCH_DRAIN_INTERVAL_MS > 0) {
+        printk("every %u ms\n", CONFIG_APP_PIPELINE_BENCH_DRAIN_INTERVAL_MS);
+    } else {
+        printk("per source batch\n");
+    }
+    printk("Processing: synthetic (drained samples go straight to the uplink)\n");
+    printk("Transport: stubbed (frames encoded, not sent)\n");
+    printk("rate_hz,offered,queued,overruns,uplink_drops,delivered,"
+           "acq_pct,proc_pct,comm_pct,other_pct,idle_pct,"
+           "lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us,sustained\n");
+
+    uint32_t max_sustained_hz = 0U;
+    bool saturated = false;
+
+    /* Higher rates still run once one fails, but only the unbroken run counts */
+    for (size_t i = 0; i < ARRAY_SIZE(sweep_rates_hz); i++) {
+        step_result_t result;
+
+        run_step(sweep_rates_hz[i], &result);
+        print_step(&result);
+
+        if (!result.sustained) {
+            saturated = true;
+        } else if (!saturated) {
+            max_sustained_hz = result.rate_hz;
+        }
+    }
+
+    printk("Max sustainable rate: %u Hz\n", max_sustained_hz);
+    printk("==========================\n\n");
+
+    DIAG_INFO(DIAG_CAT_PERFORMANCE, "Pipeline benchmark: %u Hz sustained", max_sustained_hz);
+    return (int)max_sustained_hz;
+}
+
+/**
+ * @brief Serial transport of the benchmark image
+ * @details Linked in place of hw_serial_bt_send() (-Wl,--wrap), so
+ * serial_frame.c is built unchanged and its frames end here: the cost of
+ * encoding is measured, the UART's is not.
+ */
+int __wrap_hw_serial_bt_send(const uint8_t *data, uint32_t length)
+{
+    ARG_UNUSED(data);
+    ARG_UNUSED(length);
+
+    return HW_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Run one rate step and collect its result
+ */
+static void run_step(uint32_t rate_hz, step_result_t *result)
+{
+    device_stats_t before;
+    device_stats_t after;
+    cpu_snapshot_t cpu_start;
+    cpu_snapshot_t cpu_end;
+
+    memset(result, 0, sizeof(*result));
+    result->rate_hz = rate_hz;
+
+    k_mutex_lock(&bench.uplink_mutex, K_FOREVER);
+    bench.uplink_drops = 0U;
+    bench.delivered = 0U;
+    bench.latency_count = 0U;
+    bench.latency_stride = 1U;
+    bench.latency_seen = 0U;
+    bench.latency_max_us = 0U;
+    k_mutex_unlock(&bench.uplink_mutex);
+
+    bench.rate_hz = rate_hz;
+    bench.offered = 0U;
+
+    medical_device_get_stats(&before);
+    take_snapshot(&cpu_start);
+
+    k_sem_give(&bench.start_sem);
+    k_sem_take(&bench.done_sem, K_FOREVER);
+
+    /* Let the last batch reach the transport */
+    k_sleep(K_MSEC(CONFIG_APP_PIPELINE_BENCH_DRAIN_INTERVAL_MS + PIPELINE_BENCH_SETTLE_MS));
+
+    take_snapshot(&cpu_end);
+    medical_device_get_stats(&after);
+
+    result->offered = bench.offered;
+    result->queued = after.total_samples - before.total_samples;
+    result->overruns = after.dropped_samples - before.dropped_samples;
+
+    uint64_t all = MAX(cpu_end.all_cycles - cpu_start.all_cycles, 1U);
+    uint64_t busy = 0U;
+
+    for (int i = 0; i < PIPELINE_STAGE_MAX; i++) {
+        uint64_t cycles = cpu_end.stage_cycles[i] - cpu_start.stage_cycles[i];
+
+        result->share_x10[i] = (uint32_t)(cycles * 1000U / all);
+        busy += cycles;
+    }
+    uint64_t idle = cpu_end.idle_cycles - cpu_start.idle_cycles;
+
+    result->idle_x10 = (uint32_t)(idle * 1000U / all);
+    result->other_x10 = (busy + idle < all) ? (uint32_t)((all - busy - idle) * 1000U / all) : 0U;
+
+    k_mutex_lock(&bench.uplink_mutex, K_FOREVER);
+    result->uplink_drops = bench.uplink_drops;
+    result->delivered = bench.delivered;
+    if (bench.latency_count > 0U) {
+        uint32_t n = bench.latency_count;
+
+        qsort(bench.latency_us, n, sizeof(bench.latency_us[0]), compare_u32);
+        result->latency_us[0] = bench.latency_us[(n - 1U) * 50U / 100U];
+        result->latency_us[1] = bench.latency_us[(n - 1U) * 90U / 100U];
+        result->latency_us[2] = bench.latency_us[(n - 1U) * 99U / 100U];
+        result->latency_us[3] = bench.latency_max_us;
+    }
+    k_mutex_unlock(&bench.uplink_mutex);
+
+    uint64_t expected = (uint64_t)rate_hz * CONFIG_APP_PIPELINE_BENCH_STEP_MS / 1000U;
+
+    result->sustained = result->overruns == 0U && result->uplink_drops == 0U &&
+                        result->delivered == result->queued &&
+                        (uint64_t)result->offered * 100U >= expected * PIPELINE_BENCH_MIN_OFFERED_PCT;
+}
+
+/**
+ * @brief Data acquisition stage: synthetic source, one step per start
+ */
+static void source_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    bench.stage_tids[PIPELINE_STAGE_ACQUISITION] = k_current_get();
+
+    while (1) {
+        thread_manager_heartbeat(THREAD_ID_DATA_ACQUISITION);
+
+        if (k_sem_take(&bench.start_sem, K_MSEC(PIPELINE_BENCH_IDLE_POLL_MS)) == 0) {
+            source_emit();
+            k_sem_give(&bench.done_sem);
+        }
+    }
+}
+
+/**
+ * @brief Queue samples at bench.rate_hz for one step
+ * @details Wakes every PIPELINE_BENCH_SOURCE_PERIOD_US and queues every
+ * sample that fell due since the step started, so a late wake-up catches up
+ * in one burst the way a sensor FIFO would.
+ */
+static void source_emit(void)
+{
+    uint64_t step_samples = (uint64_t)bench.rate_hz * CONFIG_APP_PIPELINE_BENCH_STEP_MS / 1000U;
+    int64_t start = k_uptime_ticks();
+    int64_t step_ticks = k_ms_to_ticks_ceil64(CONFIG_APP_PIPELINE_BENCH_STEP_MS);
+    uint32_t offered = 0U;
+
+    k_timer_start(&bench.source_timer, K_USEC(PIPELINE_BENCH_SOURCE_PERIOD_US),
+                  K_USEC(PIPELINE_BENCH_SOURCE_PERIOD_US));
+
+    int64_t elapsed;
+
+    do {
+        k_timer_status_sync(&bench.source_timer);
+
+        elapsed = MIN(k_uptime_ticks() - start, step_ticks);
+        uint64_t due = (uint64_t)bench.rate_hz * (uint64_t)elapsed / CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+
+        due = MIN(due, step_samples);
+        while (offered < due) {
+            sensor_type_t type = (sensor_type_t)(bench.source_seq++ % SENSOR_TYPE_MAX);
+            sensor_data_t data = {
+                .type = type,
+                .value = source_values[type],
+                .timestamp = k_cycle_get_32(),
+                .quality = 95U,
+                .flags = 0U,
+            };
+
+            medical_device_add_sensor_data(&data);
+            offered++;
+        }
+
+        if (CONFIG_APP_PIPELINE_BENCH_DRAIN_INTERVAL_MS == 0) {
+            k_sem_give(&bench.process_sem);
+        }
+    } while (elapsed < step_ticks);
+
+    k_timer_stop(&bench.source_timer);
+    bench.offered = offered;
+
+    if (offered > 0U) {
+        boot_profile_mark(BOOT_STAGE_FIRST_SAMPLE);
+    }
+}
+
+/**
+ * @brief Data processing stage (synthetic): drain sensor_queue into the vitals uplink
+ */
+static void processing_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    bench.stage_tids[PIPELINE_STAGE_PROCESSING] = k_current_get();
+
+    while (1) {
+        thread_manager_heartbeat(THREAD_ID_DATA_PROCESSING);
+
+        /* Either the application's fixed cadence or woken per source batch */
+        if (CONFIG_APP_PIPELINE_BENCH_DRAIN_INTERVAL_MS > 0) {
+            k_sleep(K_MSEC(CONFIG_APP_PIPELINE_BENCH_DRAIN_INTERVAL_MS));
+        } else {
+            k_sem_take(&bench.process_sem, K_MSEC(PIPELINE_BENCH_IDLE_POLL_MS));
+        }
+
+        process_pending();
+    }
+}
+
+/**
+ * @brief Move every queued sample into the uplink, waking the sender per batch
+ */
+static void process_pending(void)
+{
+    sensor_data_t data;
+    uint32_t batched = 0U;
+
+    while (medical_device_get_sensor_data(&data) == MEDICAL_OK) {
+        if (data.type < SENSOR_TYPE_MAX) {
+            bench.latest[data.type] = data.value;
+        }
+
+        vitals_sample_t sample = {
+            .timestamp_ms = k_uptime_get_32(),
+            .heart_rate_bpm = (uint8_t)bench.latest[SENSOR_TYPE_HEART_RATE],
+            .temperature_x10 = (int16_t)(bench.latest[SENSOR_TYPE_TEMPERATURE] * 10.0f),
+            .motion_x10 = (uint16_t)(bench.latest[SENSOR_TYPE_MOTION] * 10.0f),
+            .spo2_x10 = (uint16_t)(bench.latest[SENSOR_TYPE_BLOOD_OXYGEN] * 10.0f),
+        };
+
+        k_mutex_lock(&bench.uplink_mutex, K_FOREVER);
+        vitals_frame_add_sample(&sample);
+
+        /* Mirror the uplink's drop-oldest policy */
+        if (bench.stamp_count == VITALS_PENDING_MAX) {
+            bench.stamp_head = (bench.stamp_head + 1U) % VITALS_PENDING_MAX;
+            bench.stamp_count--;
+            bench.uplink_drops++;
+        }
+        bench.stamps[(bench.stamp_head + bench.stamp_count) % VITALS_PENDING_MAX] = data.timestamp;
+        bench.stamp_count++;
+        k_mutex_unlock(&bench.uplink_mutex);
+
+        if (++batched == VITALS_BATCH_MAX_SAMPLES) {
+            k_sem_give(&bench.comm_sem);
+            batched = 0U;
+        }
+    }
+
+    if (batched > 0U) {
+        k_sem_give(&bench.comm_sem);
+    }
+}
+
+/**
+ * @brief Communication stage: flush the uplink through the stubbed transport
+ */
+static void communication_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    bench.stage_tids[PIPELINE_STAGE_COMMUNICATION] = k_current_get();
+
+    while (1) {
+        thread_manager_heartbeat(THREAD_ID_COMMUNICATION);
+
+        if (k_sem_take(&bench.comm_sem, K_MSEC(PIPELINE_BENCH_IDLE_POLL_MS)) != 0) {
+            continue;
+        }
+
+        k_mutex_lock(&bench.uplink_mutex, K_FOREVER);
+
+        int sent = vitals_frame_flush();
+        uint32_t now = k_cycle_get_32();
+
+        for (int i = 0; i < sent && bench.stamp_count > 0U; i++) {
+            record_latency(k_cyc_to_us_floor32(now - bench.stamps[bench.stamp_head]));
+            bench.stamp_head = (bench.stamp_head + 1U) % VITALS_PENDING_MAX;
+            bench.stamp_count--;
+            bench.delivered++;
+        }
+
+        k_mutex_unlock(&bench.uplink_mutex);
+    }
+}
+
+/**
+ * @brief Keep an evenly spread subset of the step's latencies
+ * @details Once the record is full every other entry is dropped and the
+ * stride doubles, so the record always spans the whole step. Called with
+ * uplink_mutex held.
+ */
+static void record_latency(uint32_t latency_us)
+{
+    bench.latency_max_us = MAX(bench.latency_max_us, latency_us);
+
+    if (bench.latency_seen++ % bench.latency_stride != 0U) {
+        return;
+    }
+
+    if (bench.latency_count == PIPELINE_BENCH_LATENCY_SAMPLES) {
+        for (uint32_t i = 0; i < PIPELINE_BENCH_LATENCY_SAMPLES / 2U; i++) {
+            bench.latency_us[i] = bench.latency_us[i * 2U];
+        }
+        bench.latency_count = PIPELINE_BENCH_LATENCY_SAMPLES / 2U;
+        bench.latency_stride *= 2U;
+    }
+
+    bench.latency_us[bench.latency_count++] = latency_us;
+}
+
+/**
+ * @brief Read the stage, idle and total runtime counters
+ */
+static void take_snapshot(cpu_snapshot_t *snapshot)
+{
+    k_thread_runtime_stats_t stats;
+
+    for (int i = 0; i < PIPELINE_STAGE_MAX; i++) {
+        snapshot->stage_cycles[i] = 0U;
+        if (bench.stage_tids[i] != NULL &&
+            k_thread_runtime_stats_get(bench.stage_tids[i], &stats) == 0) {
+            snapshot->stage_cycles[i] = stats.execution_cycles;
+        }
+    }
+
+    snapshot->all_cycles = 0U;
+    snapshot->idle_cycles = 0U;
+    if (k_thread_runtime_stats_all_get(&stats) == 0) {
+        snapshot->all_cycles = stats.execution_cycles;
+        snapshot->idle_cycles = stats.idle_cycles;
+    }
+}
+
+/**
+ * @brief Print one step as a CSV row
+ */
+static void print_step(const step_result_t *result)
+{
+    printk("%u,%u,%u,%u,%u,%u,", result->rate_hz, result->offered, result->queued,
+           result->overruns, result->uplink_drops, result->delivered);
+
+    for (int i = 0; i < PIPELINE_STAGE_MAX; i++) {
+        printk("%u.%u,", result->share_x10[i] / 10U, result->share_x10[i] % 10U);
+    }
+    printk("%u.%u,%u.%u,", result->other_x10 / 10U, result->other_x10 % 10U,
+           result->idle_x10 / 10U, result->idle_x10 % 10U);
+
+    printk("%u,%u,%u,%u,%s\n", result->latency_us[0], result->latency_us[1],
+           result->latency_us[2], result->latency_us[3], result->sustained ? "yes" : "no");
+}
+
+/**
+ * @brief qsort() comparison for uint32_t
+ */
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
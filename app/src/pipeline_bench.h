@@ -0,0 +1,82 @@
+/**
+ * @file pipeline_bench.h
+ * @brief End-to-end pipeline throughput benchmark (CONFIG_APP_PIPELINE_BENCH)
+ * @details Replaces the sensor hub with a synthetic source that feeds
+ * medical_device_add_sensor_data() at a sweep of rates. Each sample is
+ * dequeued by a processing stage, batched into the vitals uplink and sent by
+ * a communication stage whose serial transport is stubbed out (frames are
+ * encoded, not transmitted). The stages run on the application's data
+ * acquisition, data processing and communication threads, so stacks and
+ * priorities are those of the real pipeline.
+ *
+ * Every rate step reports sensor_queue overruns, the CPU share of each stage
+ * (thread runtime statistics) and end-to-end latency percentiles, from the
+ * source handing a sample to the medical device until the frame carrying it
+ * has been handed to the transport.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef PIPELINE_BENCH_H
+#define PIPELINE_BENCH_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/*============================================================================*/
+/* Pipeline Benchmark Constants                                               */
+/*============================================================================*/
+
+/** @defgroup PipelineBenchConfig Pipeline Benchmark Configuration
+ * @{
+ */
+
+/** @brief Source wake-up period; each wake queues every sample that fell due */
+#define PIPELINE_BENCH_SOURCE_PERIOD_US   1000U
+
+/** @brief Grace period after a step for the queues to drain before sampling stats */
+#define PIPELINE_BENCH_SETTLE_MS          50U
+
+/** @brief Longest stage wait without work, so heartbeats keep coming */
+#define PIPELINE_BENCH_IDLE_POLL_MS       100U
+
+/** @brief Latencies kept per step for the percentiles (decimated beyond that) */
+#define PIPELINE_BENCH_LATENCY_SAMPLES    1024U
+
+/** @brief Share of the offered samples the source must queue for a step to count */
+#define PIPELINE_BENCH_MIN_OFFERED_PCT    99U
+
+/** @} */ /* End of PipelineBenchConfig group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup PipelineBenchReturnCodes Pipeline Benchmark Return Codes
+ * @{
+ */
+
+#define PIPELINE_BENCH_OK              0   /**< Sweep completed */
+#define PIPELINE_BENCH_ERROR_STATE    -1   /**< Medical device not monitoring */
+#define PIPELINE_BENCH_ERROR_THREAD   -2   /**< Stage thread could not be created */
+
+/** @} */ /* End of PipelineBenchReturnCodes group */
+
+/*============================================================================*/
+/* Pipeline Benchmark API                                                     */
+/*============================================================================*/
+
+/**
+ * @brief Run the rate sweep and print the report
+ * @details Call from main() once the medical device is monitoring and the
+ * vitals uplink and serial frame channel are initialized, instead of starting
+ * the sensor hub and the application threads. Blocks for the whole sweep.
+ *
+ * @return Highest rate in Hz sustained without a sensor_queue overrun (0 if
+ * none), or a negative PIPELINE_BENCH_ERROR_* code
+ */
+int pipeline_bench_run(void);
+
+#endif /* PIPELINE_BENCH_H */
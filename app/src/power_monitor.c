@@ -0,0 +1,472 @@
+/**
+ * @file power_monitor.c
+ * @brief Battery and power telemetry implementation
+ * @details The battery channel is the first io-channels entry of the
+ * devicetree zephyr,user node. Without a voltage divider it measures VDD
+ * directly (coin cell on the nRF52840 DK); with battery-output-ohms /
+ * battery-full-ohms it measures a divided Li-Po cell. Each interval:
+ * - the voltage is read, load-compensated and smoothed by an EMA filter
+ * - a per-chemistry discharge table maps it to a state of charge
+ * - per-subsystem currents are estimated from CPU, radio and sensor duty
+ * - the level is published to medical_device and the throttle is updated
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "power_monitor.h"
+#include "medical_device.h"
+#include "hardware.h"
+#include "sensor_hub.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/adc.h>
+#include <string.h>
+
+#if defined(CONFIG_ADC_EMUL)
+#include <zephyr/drivers/adc/adc_emul.h>
+#endif
+
+/*============================================================================*/
+/* Private Constants and Definitions                                          */
+/*============================================================================*/
+
+#define ZEPHYR_USER_NODE            DT_PATH(zephyr_user)
+
+#if DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, io_channels)
+#define POWER_HAS_BATTERY_ADC       1
+#define BATTERY_OUTPUT_OHMS         DT_PROP_OR(ZEPHYR_USER_NODE, battery_output_ohms, 1)
+#define BATTERY_FULL_OHMS           DT_PROP_OR(ZEPHYR_USER_NODE, battery_full_ohms, 1)
+#define BATTERY_IS_LIPO             DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, battery_full_ohms)
+#else
+#define POWER_HAS_BATTERY_ADC       0
+#define BATTERY_IS_LIPO             0
+#endif
+
+/** @brief EMA filter: new = old + (sample - old) / 2^POWER_EMA_SHIFT */
+#define POWER_EMA_SHIFT             3U
+
+/** @brief Fixed-point fraction bits of the filtered voltage */
+#define POWER_EMA_FRAC_BITS         4U
+
+/** @brief Cell internal resistance for load compensation (milliohm) */
+#define BATTERY_RESISTANCE_MOHM     (BATTERY_IS_LIPO ? 150U : 15000U)
+
+/* Current model (uA), nRF52840 datasheet figures at 3 V with DC/DC */
+#define CURRENT_CPU_ACTIVE_UA       3300U   /* 64 MHz, cache enabled */
+#define CURRENT_CPU_IDLE_UA         3U      /* System ON, RTC running */
+#define CURRENT_BLE_CONNECTED_UA    400U    /* 30-50 ms connection interval */
+#define CURRENT_BLE_ADVERTISING_UA  150U    /* 100 ms advertising interval */
+#define CURRENT_UART_ENABLED_UA     550U    /* UARTE RX armed, HFCLK on */
+#define CURRENT_UART_PER_BPS_NA     2000U   /* Module TX energy per byte/s (nA) */
+#define CURRENT_SENSOR_PER_SPS_NA   3000U   /* LED/ADC charge per sample/s (nA) */
+
+/** @brief Discharge curve point */
+typedef struct {
+    uint16_t mv;
+    uint8_t percent;
+} soc_point_t;
+
+/** @brief CR2032 coin cell measured at VDD (descending voltage) */
+static const soc_point_t coin_cell_curve[] = {
+    {3000, 100}, {2900, 80}, {2800, 60}, {2700, 40},
+    {2600, 30}, {2500, 20}, {2400, 10}, {2000, 0},
+};
+
+/** @brief Single Li-Po cell, open-circuit voltage (descending voltage) */
+static const soc_point_t lipo_curve[] = {
+    {4200, 100}, {4100, 90}, {4000, 78}, {3900, 65}, {3800, 50}, {3750, 40},
+    {3700, 30}, {3650, 20}, {3600, 10}, {3500, 5}, {3300, 0},
+};
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Power monitor state */
+static struct {
+    struct k_work_delayable work;
+    struct k_spinlock lock;
+    power_stats_t stats;
+    uint32_t filtered_mv_q;         /* EMA state, POWER_EMA_FRAC_BITS fraction */
+    uint64_t last_cycles_total;
+    uint64_t last_cycles_active;
+    uint32_t last_uart_bytes;
+    uint32_t last_sensor_samples;
+    uint32_t last_sample_ms;
+    power_throttle_handler_t handler;
+    void *handler_user_data;
+    bool adc_ready;
+    bool initialized;
+} power;
+
+#if POWER_HAS_BATTERY_ADC
+static const struct adc_dt_spec battery_adc = ADC_DT_SPEC_GET_BY_IDX(ZEPHYR_USER_NODE, 0);
+#endif
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void power_work_handler(struct k_work *work);
+static int battery_measure_mv(uint32_t *mv);
+static uint8_t soc_from_mv(uint32_t mv);
+static void estimate_currents(power_stats_t *stats, uint32_t interval_ms);
+static power_throttle_t throttle_for_soc(uint8_t soc, power_throttle_t current);
+
+#if defined(CONFIG_ADC_EMUL) && POWER_HAS_BATTERY_ADC
+static int battery_emul_init(void);
+#endif
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Initialize the power monitor and start periodic sampling
+ */
+int power_monitor_init(void)
+{
+    if (power.initialized) {
+        return POWER_OK;
+    }
+
+    memset(&power, 0, sizeof(power));
+    k_work_init_delayable(&power.work, power_work_handler);
+    power.stats.soc_percent = 100U;
+    power.last_sample_ms = k_uptime_get_32();
+
+#if POWER_HAS_BATTERY_ADC
+    if (adc_is_ready_dt(&battery_adc) && adc_channel_setup_dt(&battery_adc) == 0) {
+        power.adc_ready = true;
+#if defined(CONFIG_ADC_EMUL)
+        battery_emul_init();
+#endif
+    }
+#endif
+
+    power.initialized = true;
+    k_work_schedule(&power.work, K_NO_WAIT);
+
+    if (!power.adc_ready) {
+        DIAG_WARNING(DIAG_CAT_POWER, "No battery ADC channel - battery level not measured");
+        return POWER_ERROR_ADC;
+    }
+
+    DIAG_INFO(DIAG_CAT_POWER, "Power monitor initialized (%s)",
+              BATTERY_IS_LIPO ? "Li-Po via divider" : "VDD");
+    return POWER_OK;
+}
+
+/**
+ * @brief Register the throttle change handler
+ */
+int power_monitor_set_throttle_handler(power_throttle_handler_t handler, void *user_data)
+{
+    k_spinlock_key_t key = k_spin_lock(&power.lock);
+    power.handler = handler;
+    power.handler_user_data = user_data;
+    k_spin_unlock(&power.lock, key);
+
+    return POWER_OK;
+}
+
+/**
+ * @brief Get the current throttle level
+ */
+power_throttle_t power_monitor_get_throttle(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&power.lock);
+    power_throttle_t throttle = power.stats.throttle;
+    k_spin_unlock(&power.lock, key);
+
+    return throttle;
+}
+
+/**
+ * @brief Scale an interval by the current throttle level
+ */
+uint32_t power_monitor_scale_interval(uint32_t interval_ms)
+{
+    return interval_ms << (uint32_t)power_monitor_get_throttle();
+}
+
+/**
+ * @brief Scale a rate by the current throttle level
+ */
+uint32_t power_monitor_scale_rate(uint32_t rate_hz)
+{
+    return MAX(1U, rate_hz >> (uint32_t)power_monitor_get_throttle());
+}
+
+/**
+ * @brief Get power telemetry
+ */
+int power_monitor_get_stats(power_stats_t *stats)
+{
+    if (stats == NULL) {
+        return POWER_ERROR_INVALID;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&power.lock);
+    *stats = power.stats;
+    k_spin_unlock(&power.lock, key);
+
+    return POWER_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Periodic measurement, estimation and policy update
+ */
+static void power_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    power_stats_t next;
+    uint32_t now = k_uptime_get_32();
+    uint32_t interval_ms = MAX(1U, now - power.last_sample_ms);
+
+    power.last_sample_ms = now;
+    (void)power_monitor_get_stats(&next);
+
+    estimate_currents(&next, interval_ms);
+
+    uint32_t raw_mv;
+    if (power.adc_ready && battery_measure_mv(&raw_mv) == POWER_OK) {
+        /* Compensate the IR drop so the table sees open-circuit voltage */
+        uint32_t ocv_mv = raw_mv + (next.total_current_ua * BATTERY_RESISTANCE_MOHM) / 1000000U;
+        uint32_t sample_q = ocv_mv << POWER_EMA_FRAC_BITS;
+
+        if (next.samples == 0U) {
+            power.filtered_mv_q = sample_q;
+        } else {
+            power.filtered_mv_q += (uint32_t)(((int32_t)sample_q - (int32_t)power.filtered_mv_q) >>
+                                              POWER_EMA_SHIFT);
+        }
+
+        next.raw_mv = raw_mv;
+        next.battery_mv = power.filtered_mv_q >> POWER_EMA_FRAC_BITS;
+        next.soc_percent = soc_from_mv(next.battery_mv);
+        next.samples++;
+
+        medical_device_set_battery_level(next.soc_percent);
+    } else if (power.adc_ready) {
+        next.adc_errors++;
+    }
+
+    power_throttle_t previous = next.throttle;
+    next.throttle = throttle_for_soc(next.soc_percent, previous);
+
+    k_spinlock_key_t key = k_spin_lock(&power.lock);
+    power.stats = next;
+    power_throttle_handler_t handler = power.handler;
+    void *user_data = power.handler_user_data;
+    k_spin_unlock(&power.lock, key);
+
+    if (next.throttle != previous) {
+        DIAG_WARNING(DIAG_CAT_POWER, "Battery %u%% (%u mV): throttle level %d -> %d",
+                     next.soc_percent, next.battery_mv, previous, next.throttle);
+        if (handler) {
+            handler(next.throttle, user_data);
+        }
+    }
+
+    k_work_schedule(&power.work, K_MSEC(POWER_SAMPLE_INTERVAL_MS));
+}
+
+/**
+ * @brief Read the battery voltage at the cell (before the divider)
+ */
+static int battery_measure_mv(uint32_t *mv)
+{
+#if POWER_HAS_BATTERY_ADC
+    int16_t sample = 0;
+    struct adc_sequence sequence = {
+        .buffer = &sample,
+        .buffer_size = sizeof(sample),
+    };
+
+    if (adc_sequence_init_dt(&battery_adc, &sequence) != 0 ||
+        adc_read(battery_adc.dev, &sequence) != 0) {
+        return POWER_ERROR_ADC;
+    }
+
+    int32_t value = sample;
+    if (adc_raw_to_millivolts_dt(&battery_adc, &value) != 0 || value < 0) {
+        return POWER_ERROR_ADC;
+    }
+
+    *mv = (uint32_t)(((uint64_t)value * BATTERY_FULL_OHMS) / BATTERY_OUTPUT_OHMS);
+    return POWER_OK;
+#else
+    ARG_UNUSED(mv);
+    return POWER_ERROR_ADC;
+#endif
+}
+
+/**
+ * @brief Interpolate the discharge curve
+ */
+static uint8_t soc_from_mv(uint32_t mv)
+{
+    const soc_point_t *curve = BATTERY_IS_LIPO ? lipo_curve : coin_cell_curve;
+    size_t points = BATTERY_IS_LIPO ? ARRAY_SIZE(lipo_curve) : ARRAY_SIZE(coin_cell_curve);
+
+    if (mv >= curve[0].mv) {
+        return curve[0].percent;
+    }
+
+    for (size_t i = 1; i < points; i++) {
+        if (mv >= curve[i].mv) {
+            uint32_t span_mv = curve[i - 1].mv - curve[i].mv;
+            uint32_t span_pct = curve[i - 1].percent - curve[i].percent;
+            return (uint8_t)(curve[i].percent + ((mv - curve[i].mv) * span_pct) / span_mv);
+        }
+    }
+
+    return 0U;
+}
+
+/**
+ * @brief Estimate per-subsystem current from duty over the last interval
+ */
+static void estimate_currents(power_stats_t *stats, uint32_t interval_ms)
+{
+    /* CPU: share of cycles spent outside the idle thread */
+    uint32_t duty = stats->cpu_duty_permille;
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+    k_thread_runtime_stats_t rt;
+    if (k_thread_runtime_stats_all_get(&rt) == 0) {
+        uint64_t total = rt.execution_cycles - power.last_cycles_total;
+        uint64_t active = rt.total_cycles - power.last_cycles_active;
+        power.last_cycles_total = rt.execution_cycles;
+        power.last_cycles_active = rt.total_cycles;
+        if (total > 0U) {
+            duty = (uint32_t)MIN((active * 1000U) / total, 1000U);
+        }
+    }
+#endif
+    stats->cpu_duty_permille = duty;
+    stats->current_ua[POWER_SUBSYS_CPU] =
+        (CURRENT_CPU_ACTIVE_UA * duty + CURRENT_CPU_IDLE_UA * (1000U - duty)) / 1000U;
+
+    /* BLE: advertising until a central connects */
+    stats->current_ua[POWER_SUBSYS_BLE] = hw_ble_is_connected() ?
+        CURRENT_BLE_CONNECTED_UA : CURRENT_BLE_ADVERTISING_UA;
+
+    /* Serial Bluetooth: UART armed plus transmit volume */
+    hw_serial_bt_stats_t serial;
+    if (hw_serial_bt_get_stats(&serial) == HW_OK) {
+        uint32_t bytes = serial.tx_bytes_sent - power.last_uart_bytes;
+        power.last_uart_bytes = serial.tx_bytes_sent;
+        stats->current_ua[POWER_SUBSYS_SERIAL_BT] = CURRENT_UART_ENABLED_UA +
+            (uint32_t)(((uint64_t)bytes * 1000U / interval_ms) * CURRENT_UART_PER_BPS_NA / 1000U);
+    } else {
+        stats->current_ua[POWER_SUBSYS_SERIAL_BT] = 0U;
+    }
+
+    /* Sensors: charge per delivered sample */
+    sensor_hub_stats_t hub;
+    if (sensor_hub_get_stats(&hub) == SENSOR_HUB_OK) {
+        uint32_t samples = hub.samples - power.last_sensor_samples;
+        power.last_sensor_samples = hub.samples;
+        stats->current_ua[POWER_SUBSYS_SENSORS] =
+            (uint32_t)(((uint64_t)samples * 1000U / interval_ms) * CURRENT_SENSOR_PER_SPS_NA / 1000U);
+    }
+
+    stats->total_current_ua = 0U;
+    for (size_t i = 0; i < POWER_SUBSYS_MAX; i++) {
+        stats->total_current_ua += stats->current_ua[i];
+    }
+}
+
+/**
+ * @brief Throttle policy with hysteresis on the way back up
+ */
+static power_throttle_t throttle_for_soc(uint8_t soc, power_throttle_t current)
+{
+    power_throttle_t target = POWER_THROTTLE_NONE;
+
+    if (soc < POWER_CRITICAL_SOC_PERCENT) {
+        target = POWER_THROTTLE_CRITICAL;
+    } else if (soc < POWER_ECONOMY_SOC_PERCENT) {
+        target = POWER_THROTTLE_ECONOMY;
+    }
+
+    if (target >= current) {
+        return target;
+    }
+
+    /* Recovering (charger, load drop): release one level once clear of its threshold */
+    uint32_t release = (current == POWER_THROTTLE_CRITICAL) ?
+                       POWER_CRITICAL_SOC_PERCENT : POWER_ECONOMY_SOC_PERCENT;
+
+    return (soc >= release + POWER_HYSTERESIS_PERCENT) ? (power_throttle_t)(current - 1) : current;
+}
+
+/*============================================================================*/
+/* Emulated Battery (QEMU)                                                    */
+/*============================================================================*/
+
+#if defined(CONFIG_ADC_EMUL) && POWER_HAS_BATTERY_ADC
+
+/** @brief Emulated cell capacity (CONFIG_APP_BATTERY_EMUL_CAPACITY_MAH) */
+#define BATTERY_EMUL_CAPACITY_UAH   ((uint32_t)CONFIG_APP_BATTERY_EMUL_CAPACITY_MAH * 1000U)
+
+/** @brief Charge drawn from the emulated cell so far (uA*ms) */
+static uint64_t battery_emul_used_ua_ms;
+static uint32_t battery_emul_last_ms;
+
+/**
+ * @brief Emulated cell: voltage from remaining charge under the estimated load
+ */
+static int battery_emul_value(const struct device *dev, unsigned int chan, void *data,
+                              uint32_t *result_mv)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(chan);
+    ARG_UNUSED(data);
+
+    const soc_point_t *curve = BATTERY_IS_LIPO ? lipo_curve : coin_cell_curve;
+    size_t points = BATTERY_IS_LIPO ? ARRAY_SIZE(lipo_curve) : ARRAY_SIZE(coin_cell_curve);
+    uint32_t now = k_uptime_get_32();
+    uint32_t load_ua = power.stats.total_current_ua;
+
+    battery_emul_used_ua_ms += (uint64_t)load_ua * (now - battery_emul_last_ms);
+    battery_emul_last_ms = now;
+
+    uint64_t capacity_ua_ms = (uint64_t)BATTERY_EMUL_CAPACITY_UAH * 3600U * 1000U;
+    uint32_t soc_permille = (battery_emul_used_ua_ms >= capacity_ua_ms) ? 0U :
+        (uint32_t)(1000U - (battery_emul_used_ua_ms * 1000U) / capacity_ua_ms);
+
+    /* Inverse of soc_from_mv() */
+    uint32_t ocv_mv = curve[points - 1U].mv;
+    for (size_t i = 1; i < points; i++) {
+        if (soc_permille >= curve[i].percent * 10U) {
+            uint32_t span_pct = (curve[i - 1].percent - curve[i].percent) * 10U;
+            uint32_t span_mv = curve[i - 1].mv - curve[i].mv;
+            ocv_mv = curve[i].mv + ((soc_permille - curve[i].percent * 10U) * span_mv) / span_pct;
+            break;
+        }
+    }
+
+    uint32_t cell_mv = ocv_mv - MIN(ocv_mv, (load_ua * BATTERY_RESISTANCE_MOHM) / 1000000U);
+    *result_mv = (uint32_t)(((uint64_t)cell_mv * BATTERY_OUTPUT_OHMS) / BATTERY_FULL_OHMS);
+    return 0;
+}
+
+static int battery_emul_init(void)
+{
+    battery_emul_last_ms = k_uptime_get_32();
+    return adc_emul_value_func_set(battery_adc.dev, battery_adc.channel_id,
+                                   battery_emul_value, NULL);
+}
+
+#endif /* CONFIG_ADC_EMUL && POWER_HAS_BATTERY_ADC */
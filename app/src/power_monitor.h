@@ -0,0 +1,156 @@
+/**
+ * @file power_monitor.h
+ * @brief Battery and power telemetry for the medical wearable
+ * @details Samples the battery voltage with the SAADC (an emulated ADC on
+ * QEMU), filters it into a state-of-charge estimate, estimates the current
+ * drawn by each subsystem from its duty cycle, and publishes the battery
+ * level to device_stats_t. A throttle level derived from the state of charge
+ * lets the application slow sampling and radio traffic as the battery falls.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef POWER_MONITOR_H
+#define POWER_MONITOR_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================*/
+/* Power Monitor Constants                                                    */
+/*============================================================================*/
+
+/** @defgroup PowerMonitorConfig Power Monitor Configuration
+ * @{
+ */
+
+/** @brief Battery sampling interval */
+#define POWER_SAMPLE_INTERVAL_MS       1000U
+
+/** @brief State of charge below which the economy throttle applies */
+#define POWER_ECONOMY_SOC_PERCENT      30U
+
+/** @brief State of charge below which the critical throttle applies */
+#define POWER_CRITICAL_SOC_PERCENT     15U
+
+/** @brief Recovery margin before a throttle level is released */
+#define POWER_HYSTERESIS_PERCENT       5U
+
+/** @} */ /* End of PowerMonitorConfig group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup PowerMonitorReturnCodes Power Monitor Return Codes
+ * @{
+ */
+
+#define POWER_OK                       0   /**< Operation successful */
+#define POWER_ERROR_INVALID           -1   /**< Invalid parameter */
+#define POWER_ERROR_ADC               -2   /**< Battery measurement unavailable */
+
+/** @} */ /* End of PowerMonitorReturnCodes group */
+
+/*============================================================================*/
+/* Power Monitor Types                                                        */
+/*============================================================================*/
+
+/** @defgroup PowerMonitorTypes Power Monitor Types
+ * @{
+ */
+
+/** @brief Throttle levels, each halving sampling and radio rates */
+typedef enum {
+    POWER_THROTTLE_NONE = 0,        /**< Full rates */
+    POWER_THROTTLE_ECONOMY,         /**< Half rates */
+    POWER_THROTTLE_CRITICAL,        /**< Quarter rates */
+} power_throttle_t;
+
+/** @brief Subsystems with a current estimate */
+typedef enum {
+    POWER_SUBSYS_CPU = 0,           /**< CPU (active vs idle) */
+    POWER_SUBSYS_BLE,               /**< BLE radio */
+    POWER_SUBSYS_SERIAL_BT,         /**< Serial Bluetooth module link */
+    POWER_SUBSYS_SENSORS,           /**< Sensor parts */
+    POWER_SUBSYS_MAX                /**< Subsystem count */
+} power_subsys_t;
+
+/** @brief Power telemetry snapshot */
+typedef struct {
+    uint32_t battery_mv;            /**< Filtered battery voltage */
+    uint32_t raw_mv;                /**< Last raw measurement */
+    uint8_t soc_percent;            /**< State-of-charge estimate */
+    power_throttle_t throttle;      /**< Current throttle level */
+    uint32_t cpu_duty_permille;     /**< CPU active time over the last interval */
+    uint32_t current_ua[POWER_SUBSYS_MAX]; /**< Estimated current per subsystem */
+    uint32_t total_current_ua;      /**< Sum of the subsystem estimates */
+    uint32_t samples;               /**< Battery measurements taken */
+    uint32_t adc_errors;            /**< Failed measurements */
+} power_stats_t;
+
+/**
+ * @brief Throttle change handler
+ * @details Called from the system work queue when the throttle level changes.
+ *
+ * @param throttle New throttle level
+ * @param user_data User data registered with the handler
+ */
+typedef void (*power_throttle_handler_t)(power_throttle_t throttle, void *user_data);
+
+/** @} */ /* End of PowerMonitorTypes group */
+
+/*============================================================================*/
+/* Power Monitor API                                                          */
+/*============================================================================*/
+
+/**
+ * @brief Initialize the power monitor and start periodic sampling
+ * @return POWER_OK on success, POWER_ERROR_ADC if no battery channel exists
+ * (estimates still run; the battery level stays at its default)
+ */
+int power_monitor_init(void);
+
+/**
+ * @brief Register the throttle change handler
+ *
+ * @param handler Handler (NULL to remove)
+ * @param user_data User data passed to the handler
+ * @return POWER_OK on success
+ */
+int power_monitor_set_throttle_handler(power_throttle_handler_t handler, void *user_data);
+
+/**
+ * @brief Get the current throttle level
+ * @return Throttle level
+ */
+power_throttle_t power_monitor_get_throttle(void);
+
+/**
+ * @brief Scale an interval by the current throttle level
+ *
+ * @param interval_ms Interval at full rate
+ * @return Interval to use now
+ */
+uint32_t power_monitor_scale_interval(uint32_t interval_ms);
+
+/**
+ * @brief Scale a rate by the current throttle level
+ *
+ * @param rate_hz Rate at full speed
+ * @return Rate to use now (at least 1)
+ */
+uint32_t power_monitor_scale_rate(uint32_t rate_hz);
+
+/**
+ * @brief Get power telemetry
+ *
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return POWER_OK on success, error code on failure
+ */
+int power_monitor_get_stats(power_stats_t *stats);
+
+#endif /* POWER_MONITOR_H */
@@ -198,6 +198,48 @@ int safe_buffer_read(safe_buffer_t *buffer, void *data, size_t size,
     return safe_buffer_read_nb(buffer, data, size, read_bytes);
 }
 
+int safe_buffer_peek_span(safe_buffer_t *buffer, const uint8_t **span, size_t *length)
+{
+    if (buffer == NULL || span == NULL || length == NULL || buffer->overwrite_on_full) {
+        return BUFFER_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&buffer->mutex, K_FOREVER);
+
+    size_t head_to_end = buffer->size - buffer->head;
+    *span = &buffer->data[buffer->head];
+    *length = (buffer->count < head_to_end) ? buffer->count : head_to_end;
+
+    k_mutex_unlock(&buffer->mutex);
+    return (*length == 0) ? BUFFER_ERROR_EMPTY : BUFFER_OK;
+}
+
+int safe_buffer_consume(safe_buffer_t *buffer, size_t length)
+{
+    if (buffer == NULL || buffer->overwrite_on_full) {
+        return BUFFER_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&buffer->mutex, K_FOREVER);
+
+    if (length > buffer->count || length > buffer->size - buffer->head) {
+        k_mutex_unlock(&buffer->mutex);
+        return BUFFER_ERROR_INVALID;
+    }
+
+    if (length > 0) {
+        buffer->head = (buffer->head + length) % buffer->size;
+        buffer->count -= length;
+        buffer->read_count++;
+
+        /* Signal waiting writers */
+        k_condvar_signal(&buffer->not_full);
+    }
+
+    k_mutex_unlock(&buffer->mutex);
+    return BUFFER_OK;
+}
+
 size_t safe_buffer_available(safe_buffer_t *buffer)
 {
     if (buffer == NULL) {
@@ -93,6 +93,27 @@ int safe_buffer_read_nb(safe_buffer_t *buffer, void *data, size_t size, size_t *
 int safe_buffer_read(safe_buffer_t *buffer, void *data, size_t size, 
                     k_timeout_t timeout, size_t *read);
 
+/**
+ * @brief Get the contiguous readable span at the head of the buffer
+ * @details Lets a consumer hand buffer memory straight to a driver without
+ * an intermediate copy. The span stays valid until safe_buffer_consume();
+ * only buffers without overwrite_on_full support spans, since an
+ * overwriting writer could move the head underneath the consumer.
+ * @param buffer Pointer to buffer structure
+ * @param span Pointer to store the span start
+ * @param length Pointer to store the span length (0 if empty)
+ * @return BUFFER_OK on success, BUFFER_ERROR_EMPTY if empty, error code otherwise
+ */
+int safe_buffer_peek_span(safe_buffer_t *buffer, const uint8_t **span, size_t *length);
+
+/**
+ * @brief Release bytes previously obtained with safe_buffer_peek_span()
+ * @param buffer Pointer to buffer structure
+ * @param length Number of bytes consumed (at most the span length)
+ * @return BUFFER_OK on success, error code otherwise
+ */
+int safe_buffer_consume(safe_buffer_t *buffer, size_t length);
+
 /**
  * @brief Get available data size in buffer
  * @param buffer Pointer to buffer structure
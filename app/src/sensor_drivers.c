@@ -0,0 +1,568 @@
+/**
+ * @file sensor_drivers.c
+ * @brief Devicetree-described sensor parts for the sensor hub
+ * @details Bulk FIFO readers for the wearable's sensor parts:
+ * - nisc,max30101-fifo: PPG front end (I2C), red + IR, 32-sample FIFO
+ * - nisc,lis2dh-fifo: accelerometer (SPI), 32-sample FIFO, motion derived
+ * - nisc,max30205: body temperature (I2C), polled
+ *
+ * Each FIFO part raises its watermark interrupt on the node's int-gpios
+ * line. When no line is wired (emulated parts), a timer paced at the
+ * watermark fill time stands in. Every drain moves the whole FIFO in a
+ * single I2C/SPI transaction (EasyDMA on nRF52840 TWIM/SPIM).
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_hub.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/sys/byteorder.h>
+#include <math.h>
+#include <stdlib.h>
+
+/*============================================================================*/
+/* Watermark Trigger Helper                                                   */
+/*============================================================================*/
+
+/** @brief Watermark interrupt line with timer fallback */
+struct fifo_trigger {
+    struct gpio_dt_spec irq;
+    struct gpio_callback cb;
+    struct k_timer timer;
+    const sensor_hub_backend_t *backend;
+    bool use_irq;
+};
+
+static void fifo_trigger_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(pins);
+
+    struct fifo_trigger *trigger = CONTAINER_OF(cb, struct fifo_trigger, cb);
+    sensor_hub_notify(trigger->backend);
+}
+
+static void fifo_trigger_timer(struct k_timer *timer)
+{
+    struct fifo_trigger *trigger = k_timer_user_data_get(timer);
+    sensor_hub_notify(trigger->backend);
+}
+
+static int fifo_trigger_init(struct fifo_trigger *trigger, const sensor_hub_backend_t *backend)
+{
+    trigger->backend = backend;
+    trigger->use_irq = false;
+    k_timer_init(&trigger->timer, fifo_trigger_timer, NULL);
+    k_timer_user_data_set(&trigger->timer, trigger);
+
+    if (trigger->irq.port == NULL) {
+        return SENSOR_HUB_OK; /* No line wired - timer pacing */
+    }
+
+    if (!gpio_is_ready_dt(&trigger->irq) ||
+        gpio_pin_configure_dt(&trigger->irq, GPIO_INPUT) != 0) {
+        return SENSOR_HUB_ERROR_NOT_FOUND;
+    }
+
+    gpio_init_callback(&trigger->cb, fifo_trigger_isr, BIT(trigger->irq.pin));
+    if (gpio_add_callback(trigger->irq.port, &trigger->cb) != 0) {
+        return SENSOR_HUB_ERROR_NOT_FOUND;
+    }
+
+    trigger->use_irq = true;
+    return SENSOR_HUB_OK;
+}
+
+static void fifo_trigger_start(struct fifo_trigger *trigger, uint32_t period_ms)
+{
+    if (trigger->use_irq) {
+        gpio_pin_interrupt_configure_dt(&trigger->irq, GPIO_INT_EDGE_TO_ACTIVE);
+    } else {
+        k_timer_start(&trigger->timer, K_MSEC(period_ms), K_MSEC(period_ms));
+    }
+}
+
+static void fifo_trigger_stop(struct fifo_trigger *trigger)
+{
+    if (trigger->use_irq) {
+        gpio_pin_interrupt_configure_dt(&trigger->irq, GPIO_INT_DISABLE);
+    } else {
+        k_timer_stop(&trigger->timer);
+    }
+}
+
+/**
+ * @brief Timestamp of sample i of n read at now_ms, spaced by the sample period
+ */
+static inline uint32_t fifo_sample_time(uint32_t now_ms, uint32_t i, uint32_t n, uint32_t rate_hz)
+{
+    return now_ms - (uint32_t)(((uint64_t)(n - 1U - i) * 1000U) / rate_hz);
+}
+
+/*============================================================================*/
+/* MAX30101 PPG Front End (I2C)                                               */
+/*============================================================================*/
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_max30101_fifo)
+
+#define PPG_NODE                    DT_COMPAT_GET_ANY_STATUS_OKAY(nisc_max30101_fifo)
+
+#define MAX30101_REG_INT_STATUS1    0x00U
+#define MAX30101_REG_INT_ENABLE1    0x02U
+#define MAX30101_REG_FIFO_WR_PTR    0x04U
+#define MAX30101_REG_OVF_COUNTER    0x05U
+#define MAX30101_REG_FIFO_RD_PTR    0x06U
+#define MAX30101_REG_FIFO_DATA      0x07U
+#define MAX30101_REG_FIFO_CONFIG    0x08U
+#define MAX30101_REG_MODE_CONFIG    0x09U
+#define MAX30101_REG_SPO2_CONFIG    0x0AU
+#define MAX30101_REG_LED1_PA        0x0CU
+#define MAX30101_REG_LED2_PA        0x0DU
+#define MAX30101_REG_PART_ID        0xFFU
+
+#define MAX30101_PART_ID            0x15U
+#define MAX30101_MODE_RESET         0x40U
+#define MAX30101_MODE_SHDN          0x80U
+#define MAX30101_MODE_SPO2          0x03U
+#define MAX30101_INT_A_FULL         BIT(7)
+#define MAX30101_FIFO_ROLLOVER      BIT(4)
+#define MAX30101_ADC_RGE_16384NA    (0x03U << 5)
+#define MAX30101_LED_PW_411US       0x03U
+#define MAX30101_LED_PA_DEFAULT     0x24U   /* ~7 mA */
+#define MAX30101_BYTES_PER_SAMPLE   6U      /* Red + IR, 3 bytes each */
+#define MAX30101_SAMPLE_MASK        0x3FFFFU
+#define MAX30101_FULL_SCALE         MAX30101_SAMPLE_MASK
+
+/** @brief Supported sample rates, indexed by SPO2_SR code */
+static const uint16_t max30101_rates[] = {50, 100, 200, 400, 800, 1000, 1600, 3200};
+
+static struct {
+    struct i2c_dt_spec bus;
+    struct fifo_trigger trigger;
+    uint32_t rate_hz;
+    uint8_t fifo[SENSOR_HUB_FIFO_DEPTH * MAX30101_BYTES_PER_SAMPLE];
+    sensor_hub_sample_t samples[SENSOR_HUB_FIFO_DEPTH * 2U];
+} ppg = {
+    .bus = I2C_DT_SPEC_GET(PPG_NODE),
+    .trigger = { .irq = GPIO_DT_SPEC_GET_OR(PPG_NODE, int_gpios, {0}) },
+};
+
+static const sensor_hub_backend_t ppg_backend;
+
+static int ppg_init(void)
+{
+    uint8_t part_id = 0;
+
+    if (!i2c_is_ready_dt(&ppg.bus) ||
+        i2c_reg_read_byte_dt(&ppg.bus, MAX30101_REG_PART_ID, &part_id) != 0 ||
+        part_id != MAX30101_PART_ID) {
+        return SENSOR_HUB_ERROR_NOT_FOUND;
+    }
+
+    if (i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_MODE_CONFIG, MAX30101_MODE_RESET) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+    k_busy_wait(1000); /* Reset completes in < 1 ms */
+
+    return fifo_trigger_init(&ppg.trigger, &ppg_backend);
+}
+
+static int ppg_start(uint32_t rate_hz)
+{
+    uint8_t sr = 0;
+
+    /* Slowest supported rate that is not below the request */
+    while (sr < ARRAY_SIZE(max30101_rates) - 1U && max30101_rates[sr] < rate_hz) {
+        sr++;
+    }
+    ppg.rate_hz = max30101_rates[sr];
+
+    /* A_FULL = empty slots left when the interrupt fires */
+    uint32_t watermark = DT_PROP_OR(PPG_NODE, fifo_watermark, 30);
+    uint8_t a_full = (uint8_t)(SENSOR_HUB_FIFO_DEPTH - CLAMP(watermark, 17U, 32U));
+
+    int ret = i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_FIFO_CONFIG,
+                                    MAX30101_FIFO_ROLLOVER | a_full);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_SPO2_CONFIG,
+                                 MAX30101_ADC_RGE_16384NA | (uint8_t)(sr << 2) |
+                                 MAX30101_LED_PW_411US);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_LED1_PA, MAX30101_LED_PA_DEFAULT);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_LED2_PA, MAX30101_LED_PA_DEFAULT);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_FIFO_WR_PTR, 0);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_OVF_COUNTER, 0);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_FIFO_RD_PTR, 0);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_INT_ENABLE1, MAX30101_INT_A_FULL);
+    ret |= i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_MODE_CONFIG, MAX30101_MODE_SPO2);
+    if (ret != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    fifo_trigger_start(&ppg.trigger, (watermark * 1000U) / ppg.rate_hz);
+    return SENSOR_HUB_OK;
+}
+
+static int ppg_stop(void)
+{
+    fifo_trigger_stop(&ppg.trigger);
+    return i2c_reg_write_byte_dt(&ppg.bus, MAX30101_REG_MODE_CONFIG, MAX30101_MODE_SHDN) == 0 ?
+           SENSOR_HUB_OK : SENSOR_HUB_ERROR_BUS;
+}
+
+static int ppg_drain(void)
+{
+    uint8_t ptrs[3]; /* WR_PTR, OVF_COUNTER, RD_PTR are contiguous */
+    uint8_t status;
+
+    /* Pointers first: reading INT_STATUS1 afterwards releases the interrupt
+     * line and clears any A_FULL latched by samples this drain will read */
+    if (i2c_burst_read_dt(&ppg.bus, MAX30101_REG_FIFO_WR_PTR, ptrs, sizeof(ptrs)) != 0 ||
+        i2c_reg_read_byte_dt(&ppg.bus, MAX30101_REG_INT_STATUS1, &status) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    bool overflow = (ptrs[1] != 0U);
+    uint32_t count = (uint32_t)(ptrs[0] - ptrs[2]) & (SENSOR_HUB_FIFO_DEPTH - 1U);
+
+    /* WR_PTR == RD_PTR is both empty and exactly full (OVF_COUNTER stays 0
+     * until a sample is lost); A_FULL tells the two apart */
+    if (overflow || (count == 0U && (status & MAX30101_INT_A_FULL))) {
+        count = SENSOR_HUB_FIFO_DEPTH;
+    }
+    if (count == 0U) {
+        return SENSOR_HUB_OK;
+    }
+
+    /* One burst for the whole FIFO; the data register does not auto-increment */
+    if (i2c_burst_read_dt(&ppg.bus, MAX30101_REG_FIFO_DATA, ppg.fifo,
+                          count * MAX30101_BYTES_PER_SAMPLE) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    uint32_t now = k_uptime_get_32();
+    size_t n = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *raw = &ppg.fifo[i * MAX30101_BYTES_PER_SAMPLE];
+        uint32_t ts = fifo_sample_time(now, i, count, ppg.rate_hz);
+        uint8_t flags = (overflow && i == 0U) ? SENSOR_HUB_FLAG_OVERFLOW : 0U;
+
+        for (uint32_t led = 0; led < 2U; led++) {
+            int32_t value = (int32_t)(sys_get_be24(&raw[led * 3U]) & MAX30101_SAMPLE_MASK);
+            ppg.samples[n].timestamp_ms = ts;
+            ppg.samples[n].value = value;
+            ppg.samples[n].channel = (led == 0U) ? SENSOR_HUB_CH_PPG_RED : SENSOR_HUB_CH_PPG_IR;
+            ppg.samples[n].flags = flags |
+                ((value >= (int32_t)MAX30101_FULL_SCALE) ? SENSOR_HUB_FLAG_SATURATED : 0U);
+            n++;
+        }
+    }
+
+    sensor_hub_publish(ppg.samples, n);
+    return SENSOR_HUB_OK;
+}
+
+static const sensor_hub_backend_t ppg_backend = {
+    .name = "max30101",
+    .init = ppg_init,
+    .start = ppg_start,
+    .stop = ppg_stop,
+    .drain = ppg_drain,
+};
+
+#endif /* nisc_max30101_fifo */
+
+/*============================================================================*/
+/* LIS2DH Accelerometer (SPI)                                                 */
+/*============================================================================*/
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_lis2dh_fifo)
+
+#define IMU_NODE                    DT_COMPAT_GET_ANY_STATUS_OKAY(nisc_lis2dh_fifo)
+
+#define LIS2DH_REG_WHO_AM_I         0x0FU
+#define LIS2DH_REG_CTRL1            0x20U
+#define LIS2DH_REG_CTRL3            0x22U
+#define LIS2DH_REG_CTRL4            0x23U
+#define LIS2DH_REG_CTRL5            0x24U
+#define LIS2DH_REG_OUT_X_L          0x28U
+#define LIS2DH_REG_FIFO_CTRL        0x2EU
+#define LIS2DH_REG_FIFO_SRC         0x2FU
+
+#define LIS2DH_WHO_AM_I             0x33U
+#define LIS2DH_SPI_READ             BIT(7)
+#define LIS2DH_SPI_AUTOINC          BIT(6)
+#define LIS2DH_CTRL1_XYZ_EN         0x07U
+#define LIS2DH_CTRL3_I1_WTM         BIT(2)
+#define LIS2DH_CTRL4_BDU_HR         (BIT(7) | BIT(3))   /* +/-2 g, 12-bit, 1 mg/digit */
+#define LIS2DH_CTRL5_FIFO_EN        BIT(6)
+#define LIS2DH_FIFO_MODE_STREAM     (0x02U << 6)
+#define LIS2DH_FIFO_SRC_OVRN        BIT(6)
+#define LIS2DH_FIFO_SRC_FSS_MASK    0x1FU
+#define LIS2DH_BYTES_PER_SAMPLE     6U
+#define LIS2DH_FULL_SCALE_MG        2000
+
+/** @brief Output data rates and their ODR codes */
+static const struct {
+    uint16_t rate_hz;
+    uint8_t odr;
+} lis2dh_rates[] = {
+    {10, 2}, {25, 3}, {50, 4}, {100, 5}, {200, 6}, {400, 7}, {1344, 9}
+};
+
+static struct {
+    struct spi_dt_spec bus;
+    struct fifo_trigger trigger;
+    uint32_t rate_hz;
+    uint8_t fifo[SENSOR_HUB_FIFO_DEPTH * LIS2DH_BYTES_PER_SAMPLE];
+    sensor_hub_sample_t samples[SENSOR_HUB_FIFO_DEPTH * 4U];
+} imu = {
+    .bus = SPI_DT_SPEC_GET(IMU_NODE, SPI_OP_MODE_MASTER | SPI_WORD_SET(8) | SPI_TRANSFER_MSB |
+                           SPI_MODE_CPOL | SPI_MODE_CPHA, 0),
+    .trigger = { .irq = GPIO_DT_SPEC_GET_OR(IMU_NODE, int_gpios, {0}) },
+};
+
+static const sensor_hub_backend_t imu_backend;
+
+static int lis2dh_read(uint8_t reg, uint8_t *data, size_t len)
+{
+    uint8_t cmd = reg | LIS2DH_SPI_READ | ((len > 1U) ? LIS2DH_SPI_AUTOINC : 0U);
+    const struct spi_buf tx_buf = { .buf = &cmd, .len = 1 };
+    const struct spi_buf rx_bufs[] = {
+        { .buf = NULL, .len = 1 },      /* Clocked out during the command byte */
+        { .buf = data, .len = len },
+    };
+    const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
+    const struct spi_buf_set rx = { .buffers = rx_bufs, .count = ARRAY_SIZE(rx_bufs) };
+
+    return spi_transceive_dt(&imu.bus, &tx, &rx);
+}
+
+static int lis2dh_write(uint8_t reg, uint8_t value)
+{
+    uint8_t buf[2] = { reg, value };
+    const struct spi_buf tx_buf = { .buf = buf, .len = sizeof(buf) };
+    const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
+
+    return spi_transceive_dt(&imu.bus, &tx, NULL);
+}
+
+static int imu_init(void)
+{
+    uint8_t who = 0;
+
+    if (!spi_is_ready_dt(&imu.bus) ||
+        lis2dh_read(LIS2DH_REG_WHO_AM_I, &who, 1) != 0 || who != LIS2DH_WHO_AM_I) {
+        return SENSOR_HUB_ERROR_NOT_FOUND;
+    }
+
+    return fifo_trigger_init(&imu.trigger, &imu_backend);
+}
+
+static int imu_start(uint32_t rate_hz)
+{
+    size_t i = 0;
+
+    while (i < ARRAY_SIZE(lis2dh_rates) - 1U && lis2dh_rates[i].rate_hz < rate_hz) {
+        i++;
+    }
+    imu.rate_hz = lis2dh_rates[i].rate_hz;
+
+    uint32_t watermark = CLAMP(DT_PROP_OR(IMU_NODE, fifo_watermark, 28), 1U, 31U);
+
+    int ret = lis2dh_write(LIS2DH_REG_CTRL4, LIS2DH_CTRL4_BDU_HR);
+    ret |= lis2dh_write(LIS2DH_REG_CTRL5, LIS2DH_CTRL5_FIFO_EN);
+    ret |= lis2dh_write(LIS2DH_REG_FIFO_CTRL, LIS2DH_FIFO_MODE_STREAM | (uint8_t)watermark);
+    ret |= lis2dh_write(LIS2DH_REG_CTRL3, LIS2DH_CTRL3_I1_WTM);
+    ret |= lis2dh_write(LIS2DH_REG_CTRL1, (uint8_t)(lis2dh_rates[i].odr << 4) | LIS2DH_CTRL1_XYZ_EN);
+    if (ret != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    fifo_trigger_start(&imu.trigger, (watermark * 1000U) / imu.rate_hz);
+    return SENSOR_HUB_OK;
+}
+
+static int imu_stop(void)
+{
+    fifo_trigger_stop(&imu.trigger);
+    return lis2dh_write(LIS2DH_REG_CTRL1, 0) == 0 ? SENSOR_HUB_OK : SENSOR_HUB_ERROR_BUS;
+}
+
+static int imu_drain(void)
+{
+    uint8_t src;
+
+    if (lis2dh_read(LIS2DH_REG_FIFO_SRC, &src, 1) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    uint32_t count = src & LIS2DH_FIFO_SRC_FSS_MASK;
+    if (count == 0U) {
+        return SENSOR_HUB_OK;
+    }
+
+    /* With the FIFO enabled the output registers wrap, so one burst pops count samples */
+    if (lis2dh_read(LIS2DH_REG_OUT_X_L, imu.fifo, count * LIS2DH_BYTES_PER_SAMPLE) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    uint32_t now = k_uptime_get_32();
+    bool overflow = (src & LIS2DH_FIFO_SRC_OVRN) != 0U;
+    size_t n = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *raw = &imu.fifo[i * LIS2DH_BYTES_PER_SAMPLE];
+        uint32_t ts = fifo_sample_time(now, i, count, imu.rate_hz);
+        uint8_t flags = (overflow && i == 0U) ? SENSOR_HUB_FLAG_OVERFLOW : 0U;
+        int32_t axis[3];
+
+        for (uint32_t a = 0; a < 3U; a++) {
+            /* 12-bit left-justified, 1 mg/digit */
+            axis[a] = (int32_t)((int16_t)sys_get_le16(&raw[a * 2U]) >> 4);
+            imu.samples[n].timestamp_ms = ts;
+            imu.samples[n].value = axis[a];
+            imu.samples[n].channel = (uint8_t)(SENSOR_HUB_CH_ACCEL_X + a);
+            imu.samples[n].flags = flags |
+                ((abs(axis[a]) >= LIS2DH_FULL_SCALE_MG - 1) ? SENSOR_HUB_FLAG_SATURATED : 0U);
+            n++;
+        }
+
+        /* Motion activity: deviation of |a| from 1 g */
+        float magnitude = sqrtf((float)(axis[0] * axis[0] + axis[1] * axis[1] +
+                                        axis[2] * axis[2]));
+        imu.samples[n].timestamp_ms = ts;
+        imu.samples[n].value = (int32_t)fabsf(magnitude - 1000.0f);
+        imu.samples[n].channel = SENSOR_HUB_CH_MOTION;
+        imu.samples[n].flags = flags;
+        n++;
+    }
+
+    sensor_hub_publish(imu.samples, n);
+    return SENSOR_HUB_OK;
+}
+
+static const sensor_hub_backend_t imu_backend = {
+    .name = "lis2dh",
+    .init = imu_init,
+    .start = imu_start,
+    .stop = imu_stop,
+    .drain = imu_drain,
+};
+
+#endif /* nisc_lis2dh_fifo */
+
+/*============================================================================*/
+/* MAX30205 Body Temperature (I2C)                                            */
+/*============================================================================*/
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_max30205)
+
+#define TEMP_NODE                   DT_COMPAT_GET_ANY_STATUS_OKAY(nisc_max30205)
+
+#define MAX30205_REG_TEMP           0x00U
+#define MAX30205_REG_CONFIG         0x01U
+#define MAX30205_CONFIG_SHUTDOWN    BIT(0)
+
+static struct {
+    struct i2c_dt_spec bus;
+    struct fifo_trigger trigger;
+} temp = {
+    .bus = I2C_DT_SPEC_GET(TEMP_NODE),
+};
+
+static const sensor_hub_backend_t temp_backend;
+
+static int temp_init(void)
+{
+    uint8_t config;
+
+    if (!i2c_is_ready_dt(&temp.bus) ||
+        i2c_reg_read_byte_dt(&temp.bus, MAX30205_REG_CONFIG, &config) != 0) {
+        return SENSOR_HUB_ERROR_NOT_FOUND;
+    }
+
+    /* Temperature changes slowly; always timer-paced, independent of rate_hz */
+    return fifo_trigger_init(&temp.trigger, &temp_backend);
+}
+
+static int temp_start(uint32_t rate_hz)
+{
+    ARG_UNUSED(rate_hz);
+
+    if (i2c_reg_write_byte_dt(&temp.bus, MAX30205_REG_CONFIG, 0) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    fifo_trigger_start(&temp.trigger, DT_PROP_OR(TEMP_NODE, poll_interval_ms, 1000));
+    return SENSOR_HUB_OK;
+}
+
+static int temp_stop(void)
+{
+    fifo_trigger_stop(&temp.trigger);
+    return i2c_reg_write_byte_dt(&temp.bus, MAX30205_REG_CONFIG, MAX30205_CONFIG_SHUTDOWN) == 0 ?
+           SENSOR_HUB_OK : SENSOR_HUB_ERROR_BUS;
+}
+
+static int temp_drain(void)
+{
+    uint8_t raw[2];
+
+    if (i2c_burst_read_dt(&temp.bus, MAX30205_REG_TEMP, raw, sizeof(raw)) != 0) {
+        return SENSOR_HUB_ERROR_BUS;
+    }
+
+    /* 1/256 degC per LSB */
+    sensor_hub_sample_t sample = {
+        .timestamp_ms = k_uptime_get_32(),
+        .value = ((int32_t)(int16_t)sys_get_be16(raw) * 1000) / 256,
+        .channel = SENSOR_HUB_CH_TEMPERATURE,
+        .flags = 0,
+    };
+
+    sensor_hub_publish(&sample, 1);
+    return SENSOR_HUB_OK;
+}
+
+static const sensor_hub_backend_t temp_backend = {
+    .name = "max30205",
+    .init = temp_init,
+    .start = temp_start,
+    .stop = temp_stop,
+    .drain = temp_drain,
+};
+
+#endif /* nisc_max30205 */
+
+/*============================================================================*/
+/* Registration                                                               */
+/*============================================================================*/
+
+/**
+ * @brief Register the devicetree-described sensor parts
+ */
+int sensor_drivers_register(void)
+{
+    int found = 0;
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_max30101_fifo)
+    found += (sensor_hub_register_backend(&ppg_backend) == SENSOR_HUB_OK) ? 1 : 0;
+#endif
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_lis2dh_fifo)
+    found += (sensor_hub_register_backend(&imu_backend) == SENSOR_HUB_OK) ? 1 : 0;
+#endif
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_max30205)
+    found += (sensor_hub_register_backend(&temp_backend) == SENSOR_HUB_OK) ? 1 : 0;
+#endif
+
+    return found;
+}
@@ -0,0 +1,444 @@
+/**
+ * @file sensor_emul.c
+ * @brief Emulated sensor parts for QEMU and native_sim
+ * @details Register-level emulators for the parts read by sensor_drivers.c,
+ * attached to Zephyr's I2C/SPI emulation controllers. Each FIFO fills in real
+ * time at the configured output data rate, so the drivers exercise the same
+ * watermark, burst-read and overflow paths as on hardware.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <math.h>
+#include <string.h>
+
+/*
+ * The emulation controllers bind to the devices of their child nodes. The
+ * sensor hub talks to the parts through i2c_dt_spec/spi_dt_spec rather than
+ * device drivers, so each emulated node gets a placeholder device.
+ */
+#define SENSOR_EMUL_PLACEHOLDER(node_id) \
+    DEVICE_DT_DEFINE(node_id, NULL, NULL, NULL, NULL, POST_KERNEL, \
+                     CONFIG_APPLICATION_INIT_PRIORITY, NULL)
+
+#define SENSOR_EMUL_FIFO_DEPTH      32U
+
+/** @brief Real-time FIFO fill model shared by the FIFO parts */
+struct emul_fifo {
+    uint32_t start_ms;
+    uint32_t rate_hz;
+    uint32_t consumed;
+    uint32_t lost;
+    bool running;
+};
+
+static void emul_fifo_start(struct emul_fifo *fifo, uint32_t rate_hz)
+{
+    fifo->start_ms = k_uptime_get_32();
+    fifo->rate_hz = rate_hz;
+    fifo->consumed = 0;
+    fifo->lost = 0;
+    fifo->running = (rate_hz != 0U);
+}
+
+/** @brief Samples waiting in the FIFO; older samples beyond its depth are lost */
+static uint32_t emul_fifo_level(struct emul_fifo *fifo)
+{
+    if (!fifo->running) {
+        return 0;
+    }
+
+    uint32_t produced = (uint32_t)(((uint64_t)(k_uptime_get_32() - fifo->start_ms) *
+                                    fifo->rate_hz) / 1000U);
+    uint32_t level = produced - fifo->consumed;
+
+    if (level > SENSOR_EMUL_FIFO_DEPTH) {
+        fifo->lost += level - SENSOR_EMUL_FIFO_DEPTH;
+        fifo->consumed = produced - SENSOR_EMUL_FIFO_DEPTH;
+        level = SENSOR_EMUL_FIFO_DEPTH;
+    }
+
+    return level;
+}
+
+/** @brief Seconds since start of sample index n */
+static inline float emul_fifo_time(const struct emul_fifo *fifo, uint32_t n)
+{
+    return (float)n / (float)fifo->rate_hz;
+}
+
+/*============================================================================*/
+/* MAX30101 PPG Front End                                                     */
+/*============================================================================*/
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_max30101_fifo)
+
+#define PPG_EMUL_NODE               DT_COMPAT_GET_ANY_STATUS_OKAY(nisc_max30101_fifo)
+
+#define MAX30101_REG_INT_STATUS1    0x00U
+#define MAX30101_REG_FIFO_WR_PTR    0x04U
+#define MAX30101_REG_OVF_COUNTER    0x05U
+#define MAX30101_REG_FIFO_RD_PTR    0x06U
+#define MAX30101_REG_FIFO_DATA      0x07U
+#define MAX30101_REG_FIFO_CONFIG    0x08U
+#define MAX30101_REG_MODE_CONFIG    0x09U
+#define MAX30101_REG_SPO2_CONFIG    0x0AU
+#define MAX30101_REG_PART_ID        0xFFU
+#define MAX30101_PART_ID            0x15U
+#define MAX30101_MODE_RESET         0x40U
+#define MAX30101_MODE_MASK          0x07U
+#define MAX30101_OVF_MAX            0x1FU
+#define MAX30101_INT_A_FULL         BIT(7)
+#define MAX30101_A_FULL_MASK        0x0FU
+
+#define PPG_EMUL_PULSE_HZ           1.2f    /* 72 bpm */
+
+static const uint16_t max30101_emul_rates[] = {50, 100, 200, 400, 800, 1000, 1600, 3200};
+
+static struct {
+    uint8_t regs[256];
+    uint8_t byte_in_sample;
+    bool a_full;                    /* Latched until INT_STATUS1 is read */
+    struct emul_fifo fifo;
+} ppg_emul;
+
+static void ppg_emul_reset(void)
+{
+    memset(&ppg_emul, 0, sizeof(ppg_emul));
+    ppg_emul.regs[MAX30101_REG_PART_ID] = MAX30101_PART_ID;
+}
+
+static void ppg_emul_write(uint8_t reg, uint8_t value)
+{
+    if (reg == MAX30101_REG_MODE_CONFIG && (value & MAX30101_MODE_RESET)) {
+        ppg_emul_reset();
+        return;
+    }
+
+    ppg_emul.regs[reg] = value;
+
+    if (reg == MAX30101_REG_MODE_CONFIG) {
+        uint8_t sr = (ppg_emul.regs[MAX30101_REG_SPO2_CONFIG] >> 2) & 0x07U;
+        bool on = (value & MAX30101_MODE_MASK) != 0U && !(value & BIT(7));
+        emul_fifo_start(&ppg_emul.fifo, on ? max30101_emul_rates[sr] : 0U);
+        ppg_emul.byte_in_sample = 0;
+    }
+}
+
+/** @brief Next FIFO data byte: red then IR, 3 bytes big-endian each */
+static uint8_t ppg_emul_fifo_byte(void)
+{
+    uint32_t n = ppg_emul.fifo.consumed;
+    float phase = 2.0f * 3.14159265f * PPG_EMUL_PULSE_HZ * emul_fifo_time(&ppg_emul.fifo, n);
+    bool ir = ppg_emul.byte_in_sample >= 3U;
+    uint32_t value = ir ? (uint32_t)(120000.0f + 2500.0f * sinf(phase)) :
+                          (uint32_t)(100000.0f + 2000.0f * sinf(phase));
+    uint8_t shift = (uint8_t)(16U - 8U * (ppg_emul.byte_in_sample % 3U));
+
+    if (++ppg_emul.byte_in_sample == 6U) {
+        ppg_emul.byte_in_sample = 0;
+        ppg_emul.fifo.consumed++;
+        ppg_emul.fifo.lost = 0;     /* OVF_COUNTER clears on a popped sample */
+    }
+
+    return (uint8_t)(value >> shift);
+}
+
+static uint8_t ppg_emul_read(uint8_t reg)
+{
+    uint32_t level = emul_fifo_level(&ppg_emul.fifo);
+    uint32_t a_full_level = SENSOR_EMUL_FIFO_DEPTH -
+                            (ppg_emul.regs[MAX30101_REG_FIFO_CONFIG] & MAX30101_A_FULL_MASK);
+
+    if (level >= a_full_level) {
+        ppg_emul.a_full = true;
+    }
+
+    switch (reg) {
+        case MAX30101_REG_INT_STATUS1: {
+            uint8_t status = ppg_emul.a_full ? MAX30101_INT_A_FULL : 0U;
+            ppg_emul.a_full = false;
+            return status;
+        }
+        case MAX30101_REG_FIFO_WR_PTR:
+            return (uint8_t)((ppg_emul.fifo.consumed + level) & (SENSOR_EMUL_FIFO_DEPTH - 1U));
+        case MAX30101_REG_OVF_COUNTER:
+            return (uint8_t)MIN(ppg_emul.fifo.lost, MAX30101_OVF_MAX);
+        case MAX30101_REG_FIFO_RD_PTR:
+            return (uint8_t)(ppg_emul.fifo.consumed & (SENSOR_EMUL_FIFO_DEPTH - 1U));
+        case MAX30101_REG_FIFO_DATA:
+            return (level > 0U || ppg_emul.byte_in_sample != 0U) ? ppg_emul_fifo_byte() : 0U;
+        default:
+            return ppg_emul.regs[reg];
+    }
+}
+
+static int ppg_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+                             int addr)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(addr);
+
+    if (num_msgs < 1 || (msgs[0].flags & I2C_MSG_READ) || msgs[0].len < 1U) {
+        return -EIO;
+    }
+
+    uint8_t reg = msgs[0].buf[0];
+
+    /* Register write: [reg][value...] with address auto-increment */
+    for (uint32_t i = 1; i < msgs[0].len; i++) {
+        ppg_emul_write(reg++, msgs[0].buf[i]);
+    }
+
+    /* Register read: the FIFO data register does not auto-increment */
+    for (int m = 1; m < num_msgs; m++) {
+        if (!(msgs[m].flags & I2C_MSG_READ)) {
+            return -EIO;
+        }
+        for (uint32_t i = 0; i < msgs[m].len; i++) {
+            msgs[m].buf[i] = ppg_emul_read(reg);
+            if (reg != MAX30101_REG_FIFO_DATA) {
+                reg++;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int ppg_emul_init(const struct emul *target, const struct device *parent)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(parent);
+
+    ppg_emul_reset();
+    return 0;
+}
+
+static const struct i2c_emul_api ppg_emul_api = {
+    .transfer = ppg_emul_transfer,
+};
+
+SENSOR_EMUL_PLACEHOLDER(PPG_EMUL_NODE);
+EMUL_DT_DEFINE(PPG_EMUL_NODE, ppg_emul_init, NULL, NULL, &ppg_emul_api, NULL);
+
+#endif /* nisc_max30101_fifo */
+
+/*============================================================================*/
+/* MAX30205 Body Temperature                                                  */
+/*============================================================================*/
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_max30205)
+
+#define TEMP_EMUL_NODE              DT_COMPAT_GET_ANY_STATUS_OKAY(nisc_max30205)
+
+static struct {
+    uint8_t config;
+} temp_emul;
+
+static int temp_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+                              int addr)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(addr);
+
+    if (num_msgs < 1 || (msgs[0].flags & I2C_MSG_READ) || msgs[0].len < 1U) {
+        return -EIO;
+    }
+
+    uint8_t reg = msgs[0].buf[0];
+
+    if (reg == 0x01U && msgs[0].len > 1U) {
+        temp_emul.config = msgs[0].buf[1];
+    }
+
+    if (num_msgs < 2) {
+        return 0;
+    }
+
+    uint8_t out[2] = { temp_emul.config, 0 };
+
+    if (reg == 0x00U) {
+        /* 36.6 degC with a slow +/-0.3 degC drift, 1/256 degC per LSB */
+        float t = (float)k_uptime_get_32() / 1000.0f;
+        float celsius = 36.6f + 0.3f * sinf(2.0f * 3.14159265f * t / 120.0f);
+        sys_put_be16((uint16_t)(int16_t)(celsius * 256.0f), out);
+    }
+
+    memcpy(msgs[1].buf, out, MIN(msgs[1].len, sizeof(out)));
+    return 0;
+}
+
+static int temp_emul_init(const struct emul *target, const struct device *parent)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(parent);
+
+    temp_emul.config = 0;
+    return 0;
+}
+
+static const struct i2c_emul_api temp_emul_api = {
+    .transfer = temp_emul_transfer,
+};
+
+SENSOR_EMUL_PLACEHOLDER(TEMP_EMUL_NODE);
+EMUL_DT_DEFINE(TEMP_EMUL_NODE, temp_emul_init, NULL, NULL, &temp_emul_api, NULL);
+
+#endif /* nisc_max30205 */
+
+/*============================================================================*/
+/* LIS2DH Accelerometer                                                       */
+/*============================================================================*/
+
+#if DT_HAS_COMPAT_STATUS_OKAY(nisc_lis2dh_fifo)
+
+#define IMU_EMUL_NODE               DT_COMPAT_GET_ANY_STATUS_OKAY(nisc_lis2dh_fifo)
+
+#define LIS2DH_REG_WHO_AM_I         0x0FU
+#define LIS2DH_REG_CTRL1            0x20U
+#define LIS2DH_REG_OUT_X_L          0x28U
+#define LIS2DH_REG_OUT_Z_H          0x2DU
+#define LIS2DH_REG_FIFO_SRC         0x2FU
+#define LIS2DH_WHO_AM_I             0x33U
+#define LIS2DH_SPI_READ             BIT(7)
+#define LIS2DH_SPI_AUTOINC          BIT(6)
+#define LIS2DH_REG_MASK             0x3FU
+
+/** @brief Output data rate by CTRL1 ODR code */
+static const uint16_t lis2dh_emul_rates[16] = {
+    0, 1, 10, 25, 50, 100, 200, 400, 1620, 1344
+};
+
+static struct {
+    uint8_t regs[64];
+    uint8_t byte_in_sample;
+    struct emul_fifo fifo;
+} imu_emul;
+
+/** @brief Next output byte of the FIFO head sample: X, Y, Z, 12-bit left-justified */
+static uint8_t imu_emul_fifo_byte(void)
+{
+    uint32_t n = imu_emul.fifo.consumed;
+    float t = emul_fifo_time(&imu_emul.fifo, n);
+    /* Wrist at rest with a 2 Hz arm-swing burst every 10 s */
+    float swing = (fmodf(t, 10.0f) < 2.0f) ? 400.0f * sinf(2.0f * 3.14159265f * 2.0f * t) : 0.0f;
+    float mg[3] = { 20.0f + swing, -15.0f, 1000.0f + swing * 0.5f };
+    uint8_t axis = imu_emul.byte_in_sample / 2U;
+    uint16_t raw = (uint16_t)((int16_t)mg[axis] * 16);
+    uint8_t byte = (imu_emul.byte_in_sample & 1U) ? (uint8_t)(raw >> 8) : (uint8_t)raw;
+
+    if (++imu_emul.byte_in_sample == 6U) {
+        imu_emul.byte_in_sample = 0;
+        imu_emul.fifo.consumed++;
+    }
+
+    return byte;
+}
+
+static uint8_t imu_emul_read(uint8_t reg)
+{
+    if (reg >= LIS2DH_REG_OUT_X_L && reg <= LIS2DH_REG_OUT_Z_H) {
+        return imu_emul_fifo_byte();
+    }
+
+    if (reg == LIS2DH_REG_FIFO_SRC) {
+        uint32_t level = emul_fifo_level(&imu_emul.fifo);
+        uint8_t src = (uint8_t)MIN(level, 31U);
+
+        if (imu_emul.fifo.lost != 0U) {
+            src |= BIT(6);
+            imu_emul.fifo.lost = 0;
+        }
+        return src;
+    }
+
+    return imu_emul.regs[reg & LIS2DH_REG_MASK];
+}
+
+static int imu_emul_io(const struct emul *target, const struct spi_config *config,
+                       const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(config);
+
+    if (tx_bufs == NULL || tx_bufs->count < 1U || tx_bufs->buffers[0].len < 1U) {
+        return -EIO;
+    }
+
+    const uint8_t *tx = tx_bufs->buffers[0].buf;
+    uint8_t cmd = tx[0];
+    uint8_t reg = cmd & LIS2DH_REG_MASK;
+    bool autoinc = (cmd & LIS2DH_SPI_AUTOINC) != 0U;
+
+    if (!(cmd & LIS2DH_SPI_READ)) {
+        for (size_t i = 1; i < tx_bufs->buffers[0].len; i++) {
+            imu_emul.regs[reg & LIS2DH_REG_MASK] = tx[i];
+            if (reg == LIS2DH_REG_CTRL1) {
+                emul_fifo_start(&imu_emul.fifo, lis2dh_emul_rates[tx[i] >> 4]);
+                imu_emul.byte_in_sample = 0;
+            }
+            reg = autoinc ? (uint8_t)(reg + 1U) : reg;
+        }
+        return 0;
+    }
+
+    if (rx_bufs == NULL) {
+        return 0;
+    }
+
+    /* The first byte clocked in overlaps the command byte */
+    size_t position = 0;
+
+    for (size_t b = 0; b < rx_bufs->count; b++) {
+        uint8_t *rx = rx_bufs->buffers[b].buf;
+
+        for (size_t i = 0; i < rx_bufs->buffers[b].len; i++, position++) {
+            if (position == 0U) {
+                continue;
+            }
+
+            uint8_t value = imu_emul_read(reg);
+            if (rx != NULL) {
+                rx[i] = value;
+            }
+
+            /* Output registers wrap X_L..Z_H while the FIFO is read */
+            if (autoinc) {
+                reg = (reg == LIS2DH_REG_OUT_Z_H) ? LIS2DH_REG_OUT_X_L : (uint8_t)(reg + 1U);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int imu_emul_init(const struct emul *target, const struct device *parent)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(parent);
+
+    memset(&imu_emul, 0, sizeof(imu_emul));
+    imu_emul.regs[LIS2DH_REG_WHO_AM_I] = LIS2DH_WHO_AM_I;
+    return 0;
+}
+
+static const struct spi_emul_api imu_emul_api = {
+    .io = imu_emul_io,
+};
+
+SENSOR_EMUL_PLACEHOLDER(IMU_EMUL_NODE);
+EMUL_DT_DEFINE(IMU_EMUL_NODE, imu_emul_init, NULL, NULL, &imu_emul_api, NULL);
+
+#endif /* nisc_lis2dh_fifo */
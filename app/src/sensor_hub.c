@@ -0,0 +1,371 @@
+/**
+ * @file sensor_hub.c
+ * @brief Sensor driver layer implementation
+ * @details Keeps the backend table, turns watermark notifications into
+ * deferred FIFO drains and forwards the samples to the registered sink.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_hub.h"
+#include "calibration.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Sensor hub state */
+static struct {
+    const sensor_hub_backend_t *backends[SENSOR_HUB_MAX_BACKENDS];
+    atomic_t backend_count;
+    atomic_t pending;               /* Bit per backend with samples waiting */
+    struct k_work drain_work;
+    struct k_work_delayable prime_work; /* One drain of everything after start */
+    sensor_hub_sink_t sink;
+    void *sink_user_data;
+    sensor_hub_sample_t calibrated[SENSOR_HUB_MAX_BATCH]; /* Publishers share the work queue */
+    sensor_hub_stats_t stats;
+    bool initialized;
+} hub;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void drain_work_handler(struct k_work *work);
+static void prime_work_handler(struct k_work *work);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Initialize the sensor hub and probe the devicetree parts
+ */
+int sensor_hub_init(void)
+{
+    if (hub.initialized) {
+        return SENSOR_HUB_OK;
+    }
+
+    memset(&hub, 0, sizeof(hub));
+    k_work_init(&hub.drain_work, drain_work_handler);
+    k_work_init_delayable(&hub.prime_work, prime_work_handler);
+    hub.initialized = true;
+
+    int found = sensor_drivers_register();
+    DIAG_INFO(DIAG_CAT_SENSOR, "Sensor hub initialized: %d hardware part(s)", found);
+
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Register a backend
+ */
+int sensor_hub_register_backend(const sensor_hub_backend_t *backend)
+{
+    if (!hub.initialized || backend == NULL || backend->drain == NULL) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    if (atomic_get(&hub.backend_count) >= (atomic_val_t)SENSOR_HUB_MAX_BACKENDS) {
+        return SENSOR_HUB_ERROR_FULL;
+    }
+
+    if (backend->init) {
+        int ret = backend->init();
+        if (ret != SENSOR_HUB_OK) {
+            DIAG_DEBUG(DIAG_CAT_SENSOR, "Sensor backend %s not available: %d",
+                       backend->name, ret);
+            return ret;
+        }
+    }
+
+    /* Publish the slot before the count so sensor_hub_notify() never sees a hole */
+    atomic_val_t index = atomic_get(&hub.backend_count);
+    hub.backends[index] = backend;
+    atomic_inc(&hub.backend_count);
+    hub.stats.backends++;
+
+    DIAG_INFO(DIAG_CAT_SENSOR, "Sensor backend registered: %s", backend->name);
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Set the sample sink
+ */
+int sensor_hub_set_sink(sensor_hub_sink_t sink, void *user_data)
+{
+    if (!hub.initialized) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    /* Swap under the work queue's feet is harmless: both fields are read once per drain */
+    hub.sink_user_data = user_data;
+    hub.sink = sink;
+
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Start all backends
+ */
+int sensor_hub_start(uint32_t rate_hz)
+{
+    if (!hub.initialized || rate_hz == 0U) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    int started = 0;
+    atomic_val_t count = atomic_get(&hub.backend_count);
+
+    for (atomic_val_t i = 0; i < count; i++) {
+        const sensor_hub_backend_t *backend = hub.backends[i];
+        int ret = backend->start ? backend->start(rate_hz) : SENSOR_HUB_OK;
+
+        if (ret == SENSOR_HUB_OK) {
+            started++;
+        } else {
+            DIAG_WARNING(DIAG_CAT_SENSOR, "Sensor backend %s failed to start: %d",
+                         backend->name, ret);
+        }
+    }
+
+    if (started > 0) {
+        k_work_reschedule(&hub.prime_work, K_MSEC(SENSOR_HUB_PRIME_DRAIN_MS));
+    }
+
+    return started;
+}
+
+/**
+ * @brief Stop all backends
+ */
+int sensor_hub_stop(void)
+{
+    if (!hub.initialized) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    atomic_val_t count = atomic_get(&hub.backend_count);
+
+    for (atomic_val_t i = 0; i < count; i++) {
+        if (hub.backends[i]->stop) {
+            hub.backends[i]->stop();
+        }
+    }
+
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Signal that a backend has samples pending (ISR-safe)
+ */
+void sensor_hub_notify(const sensor_hub_backend_t *backend)
+{
+    atomic_val_t count = atomic_get(&hub.backend_count);
+
+    for (atomic_val_t i = 0; i < count; i++) {
+        if (hub.backends[i] == backend) {
+            atomic_set_bit(&hub.pending, (int)i);
+            k_work_submit(&hub.drain_work);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Deliver samples to the sink
+ */
+void sensor_hub_publish(const sensor_hub_sample_t *samples, size_t count)
+{
+    if (samples == NULL || count == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (samples[i].flags & SENSOR_HUB_FLAG_OVERFLOW) {
+            hub.stats.overflows++;
+        }
+    }
+
+    hub.stats.samples += (uint32_t)count;
+
+    sensor_hub_sink_t sink = hub.sink;
+    if (!sink) {
+        return;
+    }
+
+    if (calibration_get_channels() == 0U) {
+        sink(samples, count, hub.sink_user_data);
+        return;
+    }
+
+    /* Calibrated copies, at most SENSOR_HUB_MAX_BATCH at a time */
+    for (size_t done = 0; done < count; ) {
+        size_t n = MIN(count - done, SENSOR_HUB_MAX_BATCH);
+
+        memcpy(hub.calibrated, &samples[done], n * sizeof(samples[0]));
+        calibration_apply_samples(hub.calibrated, n);
+        sink(hub.calibrated, n, hub.sink_user_data);
+        done += n;
+    }
+}
+
+/**
+ * @brief Convert a derived-channel sample to medical sensor data
+ */
+bool sensor_hub_to_sensor_data(const sensor_hub_sample_t *sample, sensor_data_t *data)
+{
+    if (sample == NULL || data == NULL) {
+        return false;
+    }
+
+    switch (sample->channel) {
+        case SENSOR_HUB_CH_HEART_RATE:
+            data->type = SENSOR_TYPE_HEART_RATE;
+            break;
+        case SENSOR_HUB_CH_TEMPERATURE:
+            data->type = SENSOR_TYPE_TEMPERATURE;
+            break;
+        case SENSOR_HUB_CH_MOTION:
+            data->type = SENSOR_TYPE_MOTION;
+            break;
+        case SENSOR_HUB_CH_SPO2:
+            data->type = SENSOR_TYPE_BLOOD_OXYGEN;
+            break;
+        default:
+            return false; /* Raw channel - needs a processing stage first */
+    }
+
+    data->value = (float)sample->value / 1000.0f;
+    data->timestamp = sample->timestamp_ms;
+    data->flags = sample->flags;
+
+    /* Quality reflects the worst artifact flagged on the sample */
+    if (sample->flags & SENSOR_HUB_FLAG_SATURATED) {
+        data->quality = 20U;
+    } else if (sample->flags & SENSOR_HUB_FLAG_MOTION) {
+        data->quality = 50U;
+    } else if (sample->flags & SENSOR_HUB_FLAG_OVERFLOW) {
+        data->quality = 70U;
+    } else {
+        data->quality = 100U;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Initialize a derived-channel decimator
+ */
+void sensor_hub_decimator_init(sensor_hub_decimator_t *decimator, uint32_t interval_ms)
+{
+    memset(decimator, 0, sizeof(*decimator));
+    decimator->interval_ms = interval_ms;
+}
+
+/**
+ * @brief Reduce derived-channel samples to at most one per type per interval
+ */
+size_t sensor_hub_decimate(sensor_hub_decimator_t *decimator, const sensor_hub_sample_t *samples,
+                           size_t count, sensor_data_t out[SENSOR_TYPE_MAX])
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        sensor_data_t data;
+
+        if (!sensor_hub_to_sensor_data(&samples[i], &data) || data.type >= SENSOR_TYPE_MAX) {
+            continue;
+        }
+
+        if (!(decimator->held & BIT(data.type)) ||
+            data.value > decimator->peak[data.type].value) {
+            decimator->peak[data.type] = data;
+        }
+        decimator->held |= BIT(data.type);
+        decimator->newest_ms[data.type] = samples[i].timestamp_ms;
+    }
+
+    for (int type = 0; type < SENSOR_TYPE_MAX; type++) {
+        if (!(decimator->held & BIT(type))) {
+            continue;
+        }
+
+        /* Wrap-safe: sample times are 32-bit uptime */
+        if ((decimator->started & BIT(type)) &&
+            (int32_t)(decimator->newest_ms[type] - decimator->last_ms[type]) <
+            (int32_t)decimator->interval_ms) {
+            continue;
+        }
+
+        out[n++] = decimator->peak[type];
+        decimator->last_ms[type] = decimator->newest_ms[type];
+        decimator->held &= (uint8_t)~BIT(type);
+        decimator->started |= (uint8_t)BIT(type);
+    }
+
+    return n;
+}
+
+/**
+ * @brief Get sensor hub statistics
+ */
+int sensor_hub_get_stats(sensor_hub_stats_t *stats)
+{
+    if (stats == NULL) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    *stats = hub.stats;
+    return SENSOR_HUB_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Drain every backend flagged by sensor_hub_notify()
+ */
+static void drain_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    atomic_val_t count = atomic_get(&hub.backend_count);
+
+    for (atomic_val_t i = 0; i < count; i++) {
+        if (!atomic_test_and_clear_bit(&hub.pending, (int)i)) {
+            continue;
+        }
+
+        hub.stats.drains++;
+        if (hub.backends[i]->drain() != SENSOR_HUB_OK) {
+            hub.stats.bus_errors++;
+        }
+    }
+}
+
+/**
+ * @brief Drain every backend once, whatever its FIFO level
+ */
+static void prime_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    atomic_val_t count = atomic_get(&hub.backend_count);
+
+    for (atomic_val_t i = 0; i < count; i++) {
+        atomic_set_bit(&hub.pending, (int)i);
+    }
+
+    drain_work_handler(&hub.drain_work);
+}
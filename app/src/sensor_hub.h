@@ -0,0 +1,269 @@
+/**
+ * @file sensor_hub.h
+ * @brief Sensor driver layer for the medical wearable
+ * @details Collects samples from sensor backends (real parts on I2C/SPI,
+ * emulated parts, replay sources) and delivers them in batches to a single
+ * sink. Backends read their hardware FIFOs in bulk when the hub is notified
+ * of a FIFO watermark, so one bus transaction moves up to 32 samples.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_HUB_H
+#define SENSOR_HUB_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "medical_device.h"
+
+/*============================================================================*/
+/* Sensor Hub Constants                                                       */
+/*============================================================================*/
+
+/** @defgroup SensorHubConfig Sensor Hub Configuration
+ * @{
+ */
+
+/** @brief Maximum number of registered backends */
+#define SENSOR_HUB_MAX_BACKENDS        6U
+
+/** @brief Hardware FIFO depth assumed by the bulk readers (samples) */
+#define SENSOR_HUB_FIFO_DEPTH          32U
+
+/** @brief Maximum samples delivered to the sink in one call */
+#define SENSOR_HUB_MAX_BATCH           64U
+
+/** @brief Delay before the start-up drain that reads the first samples
+ * without waiting for a full watermark */
+#define SENSOR_HUB_PRIME_DRAIN_MS      20U
+
+/** @} */ /* End of SensorHubConfig group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup SensorHubReturnCodes Sensor Hub Return Codes
+ * @{
+ */
+
+#define SENSOR_HUB_OK                  0   /**< Operation successful */
+#define SENSOR_HUB_ERROR_INVALID      -1   /**< Invalid parameter */
+#define SENSOR_HUB_ERROR_NOT_FOUND    -2   /**< Part not present or not responding */
+#define SENSOR_HUB_ERROR_BUS          -3   /**< I2C/SPI transfer failed */
+#define SENSOR_HUB_ERROR_FULL         -4   /**< Backend table full */
+
+/** @} */ /* End of SensorHubReturnCodes group */
+
+/*============================================================================*/
+/* Sensor Hub Types                                                           */
+/*============================================================================*/
+
+/** @defgroup SensorHubTypes Sensor Hub Types
+ * @{
+ */
+
+/**
+ * @brief Sample channels
+ * @details Raw channels come straight from a part's FIFO; derived channels
+ * are physiological quantities that map onto sensor_type_t.
+ */
+typedef enum {
+    SENSOR_HUB_CH_PPG_RED = 0,      /**< Raw PPG red LED count */
+    SENSOR_HUB_CH_PPG_IR,           /**< Raw PPG infrared LED count */
+    SENSOR_HUB_CH_ACCEL_X,          /**< Acceleration X in milli-g */
+    SENSOR_HUB_CH_ACCEL_Y,          /**< Acceleration Y in milli-g */
+    SENSOR_HUB_CH_ACCEL_Z,          /**< Acceleration Z in milli-g */
+    SENSOR_HUB_CH_HEART_RATE,       /**< Heart rate in milli-bpm */
+    SENSOR_HUB_CH_TEMPERATURE,      /**< Body temperature in milli-degC */
+    SENSOR_HUB_CH_MOTION,           /**< Motion activity in milli-g */
+    SENSOR_HUB_CH_SPO2,             /**< Blood oxygen in milli-percent */
+    SENSOR_HUB_CH_MAX               /**< Channel count */
+} sensor_hub_channel_t;
+
+/** @brief Sample flag: value clipped at the part's full scale */
+#define SENSOR_HUB_FLAG_SATURATED      BIT(0)
+
+/** @brief Sample flag: FIFO overflowed, samples were lost before this one */
+#define SENSOR_HUB_FLAG_OVERFLOW       BIT(1)
+
+/** @brief Sample flag: value affected by motion artifact */
+#define SENSOR_HUB_FLAG_MOTION         BIT(2)
+
+/** @brief One sample (fixed-point, channel units) */
+typedef struct {
+    uint32_t timestamp_ms;          /**< Sample time (uptime) */
+    int32_t value;                  /**< Value in channel units */
+    uint8_t channel;                /**< sensor_hub_channel_t */
+    uint8_t flags;                  /**< SENSOR_HUB_FLAG_* */
+} sensor_hub_sample_t;
+
+/**
+ * @brief Sample sink
+ * @details Called from the system work queue with the samples of one
+ * backend drain, in time order per channel.
+ *
+ * @param samples Samples (valid only for the duration of the call)
+ * @param count Number of samples
+ * @param user_data User data registered with the sink
+ */
+typedef void (*sensor_hub_sink_t)(const sensor_hub_sample_t *samples, size_t count,
+                                  void *user_data);
+
+/**
+ * @brief Sensor backend operations
+ * @details init() probes the part. start() configures the sampling rate and
+ * enables the watermark interrupt (or a timer where no interrupt line is
+ * wired); the backend then calls sensor_hub_notify(). drain() runs in the
+ * work queue, reads the FIFO in bulk and calls sensor_hub_publish().
+ */
+typedef struct {
+    const char *name;                               /**< Backend name for diagnostics */
+    int (*init)(void);                              /**< Probe and reset the part */
+    int (*start)(uint32_t rate_hz);                 /**< Start sampling */
+    int (*stop)(void);                              /**< Stop sampling */
+    int (*drain)(void);                             /**< Read pending samples */
+} sensor_hub_backend_t;
+
+/** @brief Sensor hub statistics */
+typedef struct {
+    uint32_t backends;              /**< Registered backends */
+    uint32_t drains;                /**< Backend drain calls */
+    uint32_t samples;               /**< Samples delivered to the sink */
+    uint32_t bus_errors;            /**< Failed drains */
+    uint32_t overflows;             /**< Samples flagged with SENSOR_HUB_FLAG_OVERFLOW */
+} sensor_hub_stats_t;
+
+/**
+ * @brief Derived-channel decimator state (see sensor_hub_decimate())
+ */
+typedef struct {
+    uint32_t interval_ms;                   /**< Minimum spacing per sensor type */
+    uint32_t last_ms[SENSOR_TYPE_MAX];      /**< Newest sample time at the last output */
+    uint32_t newest_ms[SENSOR_TYPE_MAX];    /**< Newest sample time seen */
+    sensor_data_t peak[SENSOR_TYPE_MAX];    /**< Highest sample since the last output */
+    uint8_t held;                           /**< Bit per type with a peak pending */
+    uint8_t started;                        /**< Bit per type output at least once */
+} sensor_hub_decimator_t;
+
+/** @} */ /* End of SensorHubTypes group */
+
+/*============================================================================*/
+/* Sensor Hub API                                                             */
+/*============================================================================*/
+
+/**
+ * @brief Initialize the sensor hub and probe the devicetree parts
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_hub_init(void);
+
+/**
+ * @brief Register a backend
+ * @details Probes the backend; parts that are absent are not registered.
+ *
+ * @param backend Backend operations (must remain valid)
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_hub_register_backend(const sensor_hub_backend_t *backend);
+
+/**
+ * @brief Set the sample sink
+ *
+ * @param sink Sink function (NULL to discard samples)
+ * @param user_data User data passed to the sink
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_hub_set_sink(sensor_hub_sink_t sink, void *user_data);
+
+/**
+ * @brief Start all backends
+ * @details Once a backend has started, every backend is drained after
+ * SENSOR_HUB_PRIME_DRAIN_MS, so the first samples reach the sink without
+ * waiting for a FIFO watermark.
+ *
+ * @param rate_hz Requested per-channel sampling rate
+ * @return Number of backends started, or negative error code
+ */
+int sensor_hub_start(uint32_t rate_hz);
+
+/**
+ * @brief Stop all backends
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_hub_stop(void);
+
+/**
+ * @brief Signal that a backend has samples pending
+ * @details ISR-safe. Called from watermark interrupts or backend timers;
+ * schedules the backend's drain() in the system work queue.
+ *
+ * @param backend Backend with pending samples
+ */
+void sensor_hub_notify(const sensor_hub_backend_t *backend);
+
+/**
+ * @brief Deliver samples to the sink
+ * @details Called by backends from drain(). Channels with an active
+ * calibration (see calibration.h) reach the sink corrected.
+ *
+ * @param samples Samples to deliver
+ * @param count Number of samples
+ */
+void sensor_hub_publish(const sensor_hub_sample_t *samples, size_t count);
+
+/**
+ * @brief Convert a derived-channel sample to medical sensor data
+ *
+ * @param sample Sample to convert
+ * @param[out] data Sensor data to fill
+ * @return true if the channel maps to a sensor_type_t, false for raw channels
+ */
+bool sensor_hub_to_sensor_data(const sensor_hub_sample_t *sample, sensor_data_t *data);
+
+/**
+ * @brief Initialize a derived-channel decimator
+ *
+ * @param decimator Decimator to initialize
+ * @param interval_ms Minimum spacing of the outputs of one sensor type
+ */
+void sensor_hub_decimator_init(sensor_hub_decimator_t *decimator, uint32_t interval_ms);
+
+/**
+ * @brief Reduce derived-channel samples to at most one per type per interval
+ * @details A part delivers a whole FIFO watermark per drain, far more than
+ * a consumer polling every interval_ms can queue. Each type's output is the
+ * highest sample since its previous output (peak hold, so a reading above
+ * an alert threshold is never decimated away); a type is output once the
+ * newest sample is interval_ms past the previous output. Raw channels are
+ * skipped.
+ *
+ * @param decimator Decimator state
+ * @param samples Samples of one sink call
+ * @param count Number of samples
+ * @param[out] out Sensor data due now, at most SENSOR_TYPE_MAX entries
+ * @return Number of entries written to out
+ */
+size_t sensor_hub_decimate(sensor_hub_decimator_t *decimator, const sensor_hub_sample_t *samples,
+                           size_t count, sensor_data_t out[SENSOR_TYPE_MAX]);
+
+/**
+ * @brief Get sensor hub statistics
+ *
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_hub_get_stats(sensor_hub_stats_t *stats);
+
+/**
+ * @brief Register the devicetree-described sensor parts
+ * @details Implemented by sensor_drivers.c.
+ *
+ * @return Number of parts found
+ */
+int sensor_drivers_register(void);
+
+#endif /* SENSOR_HUB_H */
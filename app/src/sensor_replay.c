@@ -0,0 +1,638 @@
+/**
+ * @file sensor_replay.c
+ * @brief Replay sensor backend implementation
+ * @details Interpolates the recording at the replay rate, adds artifacts
+ * from a counter-based hash of (seed, sample index, channel) and publishes
+ * the samples in batches every SENSOR_REPLAY_DRAIN_MS.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_replay.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(CONFIG_ARCH_POSIX)
+#include <cmdline.h>
+#include <posix_native_task.h>
+#include <nsi_host_trampolines.h>
+#endif
+
+/*============================================================================*/
+/* Private Constants and Definitions                                          */
+/*============================================================================*/
+
+/** @brief Channels generated per sample index (4 vitals + raw PPG) */
+#define REPLAY_CHANNELS             5U
+
+/** @brief Fall this far behind real time and the backlog is skipped */
+#define REPLAY_MAX_LAG_MS           1000U
+
+/* Full-scale values used for saturation artifacts (channel units) */
+#define REPLAY_FULL_SCALE_HR        250000
+#define REPLAY_FULL_SCALE_TEMP      50000
+#define REPLAY_FULL_SCALE_MOTION    16000
+#define REPLAY_FULL_SCALE_SPO2      100000
+#define REPLAY_FULL_SCALE_PPG       262143
+
+/* Raw PPG IR waveform: DC level and pulse amplitude in counts */
+#define REPLAY_PPG_DC               120000
+#define REPLAY_PPG_AC               3
+
+/* Hash salts per artifact kind */
+#define SALT_DROPOUT                0x44U
+#define SALT_SATURATION             0x53U
+#define SALT_NOISE                  0x4EU
+
+/**
+ * @brief Resting recording with an activity burst, one row per second
+ */
+static const sensor_replay_row_t default_recording[] = {
+    { 72000, 36600,   80, 98000 }, { 73000, 36600,   90, 98100 },
+    { 71000, 36600,   70, 98200 }, { 70000, 36610,   60, 98100 },
+    { 72000, 36610,  110, 98000 }, { 74000, 36620,  130, 97900 },
+    { 73000, 36620,  100, 98000 }, { 71000, 36620,   80, 98100 },
+    { 70000, 36630,   70, 98200 }, { 72000, 36630,   90, 98100 },
+    { 78000, 36630,  900, 97800 }, { 86000, 36640, 1800, 97500 },
+    { 92000, 36650, 2400, 97200 }, { 95000, 36660, 2200, 97100 },
+    { 94000, 36670, 1900, 97200 }, { 90000, 36680, 1200, 97400 },
+    { 85000, 36680,  600, 97600 }, { 81000, 36690,  300, 97800 },
+    { 78000, 36690,  150, 97900 }, { 76000, 36690,  100, 98000 },
+    { 74000, 36680,   90, 98100 }, { 73000, 36680,   80, 98100 },
+    { 72000, 36670,   70, 98200 }, { 71000, 36660,   80, 98200 },
+    { 71000, 36650,   90, 98100 }, { 72000, 36640,   80, 98100 },
+    { 73000, 36630,   70, 98000 }, { 72000, 36620,   90, 98000 },
+    { 71000, 36610,  100, 98100 }, { 72000, 36600,   80, 98100 },
+};
+
+/**
+ * @brief One cardiac cycle of a PPG pulse (per-mille of pulse amplitude)
+ */
+static const uint16_t ppg_pulse_shape[32] = {
+      0,  80, 310, 620, 880, 1000, 970, 880, 760, 640, 540, 470, 440, 450, 470, 480,
+    470, 440, 400, 350, 300, 250, 210, 170, 140, 110,  85,  60,  40,  25,  12,   4
+};
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Replay state */
+static struct {
+    sensor_replay_config_t config;
+    const sensor_replay_row_t *rows;
+    size_t row_count;
+    uint32_t row_period_ms;
+    uint32_t rate_hz;
+    uint32_t start_ms;
+    uint32_t next_index;            /* Next sample index to generate */
+    uint32_t dropout_until;         /* First sample index after the current dropout */
+    uint32_t ppg_phase;             /* Cardiac phase, full circle = 2^32 */
+    struct k_timer timer;
+    sensor_hub_sample_t batch[SENSOR_HUB_MAX_BATCH];
+    sensor_replay_stats_t stats;
+    bool initialized;
+} replay;
+
+#if defined(CONFIG_ARCH_POSIX)
+/** @brief Path given with --replay-file, NULL for the built-in recording */
+static const char *sensor_replay_host_file;
+#endif
+
+static const sensor_replay_config_t default_config = {
+    .rate_hz = 0,
+    .seed = 1,
+    .dropout_permille = 0,
+    .dropout_ms = 0,
+    .saturation_permille = 0,
+    .motion_noise_mg = 0,
+    .raw_ppg = false,
+};
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static int replay_start(uint32_t rate_hz);
+static int replay_stop(void);
+static int replay_drain(void);
+static void replay_timer_handler(struct k_timer *timer);
+static uint32_t replay_hash(uint32_t index, uint32_t channel, uint32_t salt);
+static void replay_generate(uint32_t index, sensor_hub_sample_t *out, size_t *count);
+
+#if defined(CONFIG_ARCH_POSIX)
+static int replay_load_host_file(const char *path);
+#endif
+
+static const sensor_hub_backend_t replay_backend = {
+    .name = "replay",
+    .init = NULL,
+    .start = replay_start,
+    .stop = replay_stop,
+    .drain = replay_drain,
+};
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Register the replay backend with the sensor hub
+ */
+int sensor_replay_init(const sensor_replay_config_t *config)
+{
+    if (replay.initialized) {
+        return SENSOR_HUB_OK;
+    }
+
+    replay.config = default_config;
+    replay.rows = default_recording;
+    replay.row_count = ARRAY_SIZE(default_recording);
+    replay.row_period_ms = 1000U;
+    k_timer_init(&replay.timer, replay_timer_handler, NULL);
+
+    int ret = sensor_replay_configure(config ? config : &default_config);
+    if (ret != SENSOR_HUB_OK) {
+        return ret;
+    }
+
+#if defined(CONFIG_ARCH_POSIX)
+    if (sensor_replay_host_file != NULL && replay_load_host_file(sensor_replay_host_file) < 0) {
+        DIAG_WARNING(DIAG_CAT_SENSOR, "Replay file %s unusable, using built-in recording",
+                     sensor_replay_host_file);
+    }
+#endif
+
+    ret = sensor_hub_register_backend(&replay_backend);
+    if (ret == SENSOR_HUB_OK) {
+        replay.initialized = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Change the replay configuration
+ */
+int sensor_replay_configure(const sensor_replay_config_t *config)
+{
+    if (config == NULL || config->rate_hz > SENSOR_REPLAY_MAX_RATE_HZ ||
+        config->dropout_permille > 1000U || config->saturation_permille > 1000U) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    replay.config = *config;
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Replace the recording
+ */
+int sensor_replay_load(const sensor_replay_row_t *rows, size_t count, uint32_t row_period_ms)
+{
+    if (rows == NULL || count == 0U || row_period_ms == 0U) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    replay.rows = rows;
+    replay.row_count = count;
+    replay.row_period_ms = row_period_ms;
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Get replay statistics
+ */
+int sensor_replay_get_stats(sensor_replay_stats_t *stats)
+{
+    if (stats == NULL) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    *stats = replay.stats;
+    return SENSOR_HUB_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+static int replay_start(uint32_t rate_hz)
+{
+    replay.rate_hz = replay.config.rate_hz ? replay.config.rate_hz :
+                     MIN(rate_hz, SENSOR_REPLAY_MAX_RATE_HZ);
+    if (replay.rate_hz == 0U) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    replay.start_ms = k_uptime_get_32();
+    replay.next_index = 0;
+    replay.dropout_until = 0;
+    replay.ppg_phase = 0;
+    memset(&replay.stats, 0, sizeof(replay.stats));
+
+    k_timer_start(&replay.timer, K_MSEC(SENSOR_REPLAY_DRAIN_MS), K_MSEC(SENSOR_REPLAY_DRAIN_MS));
+    return SENSOR_HUB_OK;
+}
+
+static int replay_stop(void)
+{
+    k_timer_stop(&replay.timer);
+    return SENSOR_HUB_OK;
+}
+
+static void replay_timer_handler(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+    sensor_hub_notify(&replay_backend);
+}
+
+/**
+ * @brief Publish every sample due since the last drain
+ */
+static int replay_drain(void)
+{
+    uint32_t elapsed = k_uptime_get_32() - replay.start_ms;
+    uint32_t due = (uint32_t)(((uint64_t)elapsed * replay.rate_hz) / 1000U);
+    uint32_t max_lag = (uint32_t)(((uint64_t)REPLAY_MAX_LAG_MS * replay.rate_hz) / 1000U);
+
+    /* Too far behind (debugger, overloaded sink): drop the backlog */
+    if (due - replay.next_index > max_lag) {
+        replay.stats.skipped += due - replay.next_index;
+        replay.next_index = due;
+        replay.dropout_until = 0;
+        return SENSOR_HUB_OK;
+    }
+
+    size_t n = 0;
+
+    while (replay.next_index < due) {
+        if (n + REPLAY_CHANNELS > ARRAY_SIZE(replay.batch)) {
+            sensor_hub_publish(replay.batch, n);
+            n = 0;
+        }
+
+        size_t generated = 0;
+        replay_generate(replay.next_index, &replay.batch[n], &generated);
+        n += generated;
+        replay.next_index++;
+    }
+
+    if (n > 0U) {
+        sensor_hub_publish(replay.batch, n);
+    }
+
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Counter-based hash (lowbias32) so artifacts depend only on the inputs
+ */
+static uint32_t replay_hash(uint32_t index, uint32_t channel, uint32_t salt)
+{
+    uint32_t x = replay.config.seed ^ (index * 0x9E3779B9U) ^ (channel << 24) ^ (salt << 16);
+
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Field of a recorded row (0 = HR, 1 = temperature, 2 = motion, 3 = SpO2)
+ */
+static int32_t replay_row_field(const sensor_replay_row_t *row, size_t field)
+{
+    switch (field) {
+        case 0:  return row->heart_rate;
+        case 1:  return row->temperature;
+        case 2:  return row->motion;
+        default: return row->spo2;
+    }
+}
+
+/**
+ * @brief Recording value interpolated at time t_ms (loops over the recording)
+ */
+static int32_t replay_row_value(uint32_t t_ms, size_t field)
+{
+    uint32_t span = (uint32_t)replay.row_count * replay.row_period_ms;
+    uint32_t pos = t_ms % span;
+    size_t row = pos / replay.row_period_ms;
+    int64_t frac = (int64_t)(pos % replay.row_period_ms);
+    int32_t a = replay_row_field(&replay.rows[row], field);
+    int32_t b = replay_row_field(&replay.rows[(row + 1U) % replay.row_count], field);
+
+    return a + (int32_t)(((int64_t)(b - a) * frac) / (int64_t)replay.row_period_ms);
+}
+
+/**
+ * @brief Generate all channel samples for one sample index
+ */
+static void replay_generate(uint32_t index, sensor_hub_sample_t *out, size_t *count)
+{
+    static const uint8_t channels[REPLAY_CHANNELS - 1U] = {
+        SENSOR_HUB_CH_HEART_RATE, SENSOR_HUB_CH_TEMPERATURE,
+        SENSOR_HUB_CH_MOTION, SENSOR_HUB_CH_SPO2
+    };
+    static const int32_t full_scale[REPLAY_CHANNELS - 1U] = {
+        REPLAY_FULL_SCALE_HR, REPLAY_FULL_SCALE_TEMP,
+        REPLAY_FULL_SCALE_MOTION, REPLAY_FULL_SCALE_SPO2
+    };
+    const sensor_replay_config_t *cfg = &replay.config;
+    uint32_t t_ms = (uint32_t)(((uint64_t)index * 1000U) / replay.rate_hz);
+    uint32_t timestamp = replay.start_ms + t_ms;
+    size_t n = 0;
+
+    /* Cardiac phase advances with the replayed heart rate */
+    int32_t hr = replay_row_value(t_ms, 0);
+    replay.ppg_phase += (uint32_t)(((uint64_t)MAX(hr, 0) << 32) / (60000ULL * replay.rate_hz));
+
+    /* Dropout: contact lost, nothing is produced for dropout_ms */
+    if (index < replay.dropout_until) {
+        replay.stats.dropped += cfg->raw_ppg ? REPLAY_CHANNELS : REPLAY_CHANNELS - 1U;
+        *count = 0;
+        return;
+    }
+    if (cfg->dropout_permille > 0U &&
+        replay_hash(index, 0, SALT_DROPOUT) % 1000U < cfg->dropout_permille) {
+        replay.dropout_until = index + MAX(1U, (cfg->dropout_ms * replay.rate_hz) / 1000U);
+        replay.stats.dropped += cfg->raw_ppg ? REPLAY_CHANNELS : REPLAY_CHANNELS - 1U;
+        *count = 0;
+        return;
+    }
+
+    /* Motion noise: shared by all channels of this sample */
+    int32_t noise = 0;
+    bool motion_artifact = false;
+    if (cfg->motion_noise_mg > 0U) {
+        uint32_t span = 2U * cfg->motion_noise_mg + 1U;
+        noise = (int32_t)(replay_hash(index, 0, SALT_NOISE) % span) - (int32_t)cfg->motion_noise_mg;
+        motion_artifact = (uint32_t)abs(noise) > cfg->motion_noise_mg / 2U;
+    }
+
+    for (size_t ch = 0; ch < REPLAY_CHANNELS - 1U; ch++) {
+        int32_t value = replay_row_value(t_ms, ch);
+        uint8_t flags = 0;
+
+        switch (channels[ch]) {
+            case SENSOR_HUB_CH_MOTION:
+                value += abs(noise);
+                break;
+            case SENSOR_HUB_CH_HEART_RATE:
+                value += noise * 10;            /* +/-1 bpm per 100 mg */
+                flags = motion_artifact ? SENSOR_HUB_FLAG_MOTION : 0U;
+                break;
+            case SENSOR_HUB_CH_SPO2:
+                value -= abs(noise) * 2;        /* Motion reads low */
+                flags = motion_artifact ? SENSOR_HUB_FLAG_MOTION : 0U;
+                break;
+            default:
+                break;
+        }
+
+        if (cfg->saturation_permille > 0U &&
+            replay_hash(index, ch + 1U, SALT_SATURATION) % 1000U < cfg->saturation_permille) {
+            value = full_scale[ch];
+            flags |= SENSOR_HUB_FLAG_SATURATED;
+            replay.stats.saturated++;
+        }
+
+        if (flags & SENSOR_HUB_FLAG_MOTION) {
+            replay.stats.motion_flagged++;
+        }
+
+        out[n].timestamp_ms = timestamp;
+        out[n].value = CLAMP(value, 0, full_scale[ch]);
+        out[n].channel = channels[ch];
+        out[n].flags = flags;
+        n++;
+    }
+
+    if (cfg->raw_ppg) {
+        uint16_t shape = ppg_pulse_shape[replay.ppg_phase >> 27];
+        int32_t value = REPLAY_PPG_DC + (int32_t)shape * REPLAY_PPG_AC + noise * 4;
+        uint8_t flags = motion_artifact ? SENSOR_HUB_FLAG_MOTION : 0U;
+
+        if (cfg->saturation_permille > 0U &&
+            replay_hash(index, REPLAY_CHANNELS, SALT_SATURATION) % 1000U <
+            cfg->saturation_permille) {
+            value = REPLAY_FULL_SCALE_PPG;
+            flags |= SENSOR_HUB_FLAG_SATURATED;
+            replay.stats.saturated++;
+        }
+
+        out[n].timestamp_ms = timestamp;
+        out[n].value = CLAMP(value, 0, REPLAY_FULL_SCALE_PPG);
+        out[n].channel = SENSOR_HUB_CH_PPG_IR;
+        out[n].flags = flags;
+        n++;
+    }
+
+    replay.stats.samples += (uint32_t)n;
+    *count = n;
+}
+
+/*============================================================================*/
+/* Host File Input (native_sim)                                               */
+/*============================================================================*/
+
+#if defined(CONFIG_ARCH_POSIX)
+
+static sensor_replay_row_t host_rows[SENSOR_REPLAY_MAX_ROWS];
+
+/**
+ * @brief Parse a decimal number ("-36.65") into milli-units
+ */
+static bool parse_milli(const char **cursor, int32_t *out)
+{
+    const char *p = *cursor;
+    int32_t sign = 1;
+    int32_t whole = 0;
+    int32_t frac = 0;
+    int32_t scale = 1000;
+    bool digits = false;
+
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p == '-') {
+        sign = -1;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        whole = whole * 10 + (*p++ - '0');
+        digits = true;
+    }
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            if (scale > 1) {
+                scale /= 10;
+                frac += (*p - '0') * scale;
+            }
+            p++;
+            digits = true;
+        }
+    }
+
+    *cursor = p;
+    *out = sign * (whole * 1000 + frac);
+    return digits;
+}
+
+/**
+ * @brief Parse an unsigned decimal integer ("123456"), rejecting overflow
+ */
+static bool parse_uint32(const char **cursor, uint32_t *out)
+{
+    const char *p = *cursor;
+    uint64_t value = 0;
+    bool digits = false;
+
+    while (*p == ' ') {
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10U + (uint64_t)(*p++ - '0');
+        if (value > UINT32_MAX) {
+            return false;
+        }
+        digits = true;
+    }
+
+    *cursor = p;
+    *out = (uint32_t)value;
+    return digits;
+}
+
+/**
+ * @brief Parse one CSV line as written by scripts/vitals_decode.py
+ * @details Accepts "timestamp_ms,hr,temp,motion,spo2" with an optional
+ * leading batch_seq column; other lines (headers) are ignored. The integer
+ * columns are not parsed as milli-units, which would overflow int32_t for
+ * timestamps past ~35 minutes.
+ */
+static bool parse_row(const char *line, uint32_t *timestamp_ms, sensor_replay_row_t *row)
+{
+    int32_t values[4];
+    size_t columns = 1;
+    const char *p = line;
+
+    for (const char *c = line; *c != '\0'; c++) {
+        if (*c == ',') {
+            columns++;
+        }
+    }
+    if (columns != 5U && columns != 6U) {
+        return false;
+    }
+
+    if (columns == 6U) {
+        uint32_t batch_seq;
+
+        if (!parse_uint32(&p, &batch_seq) || *p++ != ',') {
+            return false;
+        }
+    }
+
+    if (!parse_uint32(&p, timestamp_ms)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+        if (*p++ != ',' || !parse_milli(&p, &values[i])) {
+            return false;
+        }
+    }
+
+    if (*p != '\0' && *p != '\r') {
+        return false;
+    }
+
+    row->heart_rate = values[0];
+    row->temperature = values[1];
+    row->motion = values[2];
+    row->spo2 = values[3];
+    return true;
+}
+
+static int replay_load_host_file(const char *path)
+{
+    int fd = nsi_host_open(path, 0 /* O_RDONLY */);
+    if (fd < 0) {
+        return SENSOR_HUB_ERROR_NOT_FOUND;
+    }
+
+    char chunk[256];
+    char line[128];
+    size_t line_len = 0;
+    size_t rows = 0;
+    uint32_t first_ts = 0;
+    uint32_t second_ts = 0;
+    long got;
+
+    while (rows < ARRAY_SIZE(host_rows) && (got = nsi_host_read(fd, chunk, sizeof(chunk))) > 0) {
+        for (long i = 0; i < got && rows < ARRAY_SIZE(host_rows); i++) {
+            if (chunk[i] != '\n') {
+                if (line_len < sizeof(line) - 1U) {
+                    line[line_len++] = chunk[i];
+                }
+                continue;
+            }
+
+            line[line_len] = '\0';
+            line_len = 0;
+
+            uint32_t ts;
+            if (parse_row(line, &ts, &host_rows[rows])) {
+                if (rows == 0U) {
+                    first_ts = ts;
+                } else if (rows == 1U) {
+                    second_ts = ts;
+                }
+                rows++;
+            }
+        }
+    }
+
+    nsi_host_close(fd);
+
+    if (rows == 0U) {
+        return SENSOR_HUB_ERROR_INVALID;
+    }
+
+    uint32_t period = (rows > 1U && second_ts > first_ts) ? second_ts - first_ts : 1000U;
+    DIAG_INFO(DIAG_CAT_SENSOR, "Replay file %s: %u rows every %u ms",
+              path, (unsigned int)rows, period);
+
+    return sensor_replay_load(host_rows, rows, period);
+}
+
+static struct args_struct_t replay_args[] = {
+    {
+        .option = "replay-file",
+        .name = "path",
+        .type = 's',
+        .dest = (void *)&sensor_replay_host_file,
+        .descript = "CSV vitals recording for the replay sensor backend "
+                    "(scripts/vitals_decode.py output)",
+    },
+    ARG_TABLE_ENDMARKER
+};
+
+static void replay_register_args(void)
+{
+    native_add_command_line_opts(replay_args);
+}
+
+NATIVE_TASK(replay_register_args, PRE_BOOT_1, 10);
+
+#endif /* CONFIG_ARCH_POSIX */
@@ -0,0 +1,121 @@
+/**
+ * @file sensor_replay.h
+ * @brief Replay sensor backend for deterministic load testing
+ * @details A sensor hub backend that streams vitals from a recorded table
+ * (compiled in, or loaded from a host file on native_sim) at a configurable
+ * per-channel rate, with injectable dropouts, saturation and motion noise.
+ * Sample content depends only on the sample index and the seed, so a run
+ * is reproducible regardless of scheduling.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_REPLAY_H
+#define SENSOR_REPLAY_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_hub.h"
+
+/*============================================================================*/
+/* Sensor Replay Constants                                                    */
+/*============================================================================*/
+
+/** @defgroup SensorReplayConfig Sensor Replay Configuration
+ * @{
+ */
+
+/** @brief Maximum per-channel replay rate */
+#define SENSOR_REPLAY_MAX_RATE_HZ      5000U
+
+/** @brief Interval at which generated samples are handed to the hub */
+#define SENSOR_REPLAY_DRAIN_MS         10U
+
+/** @brief Maximum rows loaded from a recording */
+#define SENSOR_REPLAY_MAX_ROWS         2048U
+
+/** @} */ /* End of SensorReplayConfig group */
+
+/*============================================================================*/
+/* Sensor Replay Types                                                        */
+/*============================================================================*/
+
+/** @defgroup SensorReplayTypes Sensor Replay Types
+ * @{
+ */
+
+/** @brief One recorded vitals row (milli-units, as sensor hub channels) */
+typedef struct {
+    int32_t heart_rate;             /**< milli-bpm */
+    int32_t temperature;            /**< milli-degC */
+    int32_t motion;                 /**< milli-g */
+    int32_t spo2;                   /**< milli-percent */
+} sensor_replay_row_t;
+
+/** @brief Replay configuration */
+typedef struct {
+    uint32_t rate_hz;               /**< Per-channel rate (0 = hub rate) */
+    uint32_t seed;                  /**< Artifact generator seed */
+    uint16_t dropout_permille;      /**< Chance per sample that a dropout starts */
+    uint16_t dropout_ms;            /**< Dropout length */
+    uint16_t saturation_permille;   /**< Chance per sample of a saturated value */
+    uint16_t motion_noise_mg;       /**< Motion noise amplitude (0 = none) */
+    bool raw_ppg;                   /**< Also stream the raw PPG IR waveform */
+} sensor_replay_config_t;
+
+/** @brief Replay statistics */
+typedef struct {
+    uint32_t samples;               /**< Samples published */
+    uint32_t dropped;               /**< Samples suppressed by dropouts */
+    uint32_t saturated;             /**< Samples clipped to full scale */
+    uint32_t motion_flagged;        /**< Samples flagged with motion artifact */
+    uint32_t skipped;               /**< Samples skipped to catch up with real time */
+} sensor_replay_stats_t;
+
+/** @} */ /* End of SensorReplayTypes group */
+
+/*============================================================================*/
+/* Sensor Replay API                                                          */
+/*============================================================================*/
+
+/**
+ * @brief Register the replay backend with the sensor hub
+ * @details Uses the compiled-in recording unless a host file was given with
+ * --replay-file on native_sim.
+ *
+ * @param config Replay configuration (NULL for defaults)
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_replay_init(const sensor_replay_config_t *config);
+
+/**
+ * @brief Change the replay configuration
+ * @details Takes effect at the next sensor_hub_start().
+ *
+ * @param config Replay configuration
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_replay_configure(const sensor_replay_config_t *config);
+
+/**
+ * @brief Replace the recording
+ *
+ * @param rows Recorded rows (must remain valid)
+ * @param count Number of rows
+ * @param row_period_ms Time between rows
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_replay_load(const sensor_replay_row_t *rows, size_t count, uint32_t row_period_ms);
+
+/**
+ * @brief Get replay statistics
+ *
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return SENSOR_HUB_OK on success, error code on failure
+ */
+int sensor_replay_get_stats(sensor_replay_stats_t *stats);
+
+#endif /* SENSOR_REPLAY_H */
@@ -0,0 +1,367 @@
+#include "serial_frame.h"
+#include "hardware.h"
+#include "diagnostics.h"
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+/* SLIP special characters (RFC 1055) */
+#define SLIP_END        0xC0U
+#define SLIP_ESC        0xDBU
+#define SLIP_ESC_END    0xDCU
+#define SLIP_ESC_ESC    0xDDU
+
+/* CRC-16/CCITT-FALSE seed */
+#define FRAME_CRC_SEED  0xFFFFU
+
+/* Serial Bluetooth command channel state */
+static struct {
+    serial_frame_parser_t parser;
+    serial_frame_handler_entry_t handlers[SERIAL_FRAME_MAX_HANDLERS];
+    size_t handler_count;
+    struct k_mutex tx_mutex;
+    uint8_t tx_buf[SERIAL_FRAME_MAX_ENCODED];
+    uint8_t tx_seq;
+    uint32_t frames_tx;
+    uint32_t tx_errors;
+    bool initialized;
+} channel;
+
+static size_t slip_put(uint8_t *out, size_t pos, uint8_t byte)
+{
+    if (byte == SLIP_END) {
+        out[pos++] = SLIP_ESC;
+        out[pos++] = SLIP_ESC_END;
+    } else if (byte == SLIP_ESC) {
+        out[pos++] = SLIP_ESC;
+        out[pos++] = SLIP_ESC_ESC;
+    } else {
+        out[pos++] = byte;
+    }
+    return pos;
+}
+
+int serial_frame_encode(uint8_t type, uint8_t seq, const uint8_t *payload, size_t length,
+                        uint8_t *out, size_t out_size, size_t *out_len)
+{
+    if (out == NULL || out_len == NULL || length > SERIAL_FRAME_MAX_PAYLOAD ||
+        (payload == NULL && length > 0)) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    uint8_t header[SERIAL_FRAME_HEADER_SIZE] = {
+        SERIAL_FRAME_VERSION, type, seq, (uint8_t)length
+    };
+    uint8_t trailer[SERIAL_FRAME_CRC_SIZE];
+
+    uint16_t crc = crc16_itu_t(FRAME_CRC_SEED, header, sizeof(header));
+    if (length > 0) {
+        crc = crc16_itu_t(crc, payload, length);
+    }
+    sys_put_le16(crc, trailer);
+
+    /* Size check against the worst case of this frame keeps the loop unchecked */
+    if (out_size < 2U * (sizeof(header) + length + sizeof(trailer)) + 2U) {
+        return FRAME_ERROR_NO_SPACE;
+    }
+
+    size_t pos = 0;
+    out[pos++] = SLIP_END; /* Flush any line noise at the receiver */
+
+    for (size_t i = 0; i < sizeof(header); i++) {
+        pos = slip_put(out, pos, header[i]);
+    }
+    for (size_t i = 0; i < length; i++) {
+        pos = slip_put(out, pos, payload[i]);
+    }
+    for (size_t i = 0; i < sizeof(trailer); i++) {
+        pos = slip_put(out, pos, trailer[i]);
+    }
+
+    out[pos++] = SLIP_END;
+    *out_len = pos;
+
+    return FRAME_OK;
+}
+
+int serial_frame_parser_init(serial_frame_parser_t *parser,
+                             const serial_frame_handler_entry_t *handlers,
+                             size_t handler_count)
+{
+    if (parser == NULL || (handlers == NULL && handler_count > 0)) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    memset(parser, 0, sizeof(serial_frame_parser_t));
+    parser->handlers = handlers;
+    parser->handler_count = handler_count;
+
+    return FRAME_OK;
+}
+
+void serial_frame_parser_set_unhandled(serial_frame_parser_t *parser,
+                                       serial_frame_handler_t handler, void *user_data)
+{
+    if (parser == NULL) {
+        return;
+    }
+
+    parser->unhandled = handler;
+    parser->unhandled_user_data = user_data;
+}
+
+/* Validate the accumulated frame and dispatch it; returns true if valid */
+static bool parser_complete(serial_frame_parser_t *parser)
+{
+    if (parser->len < SERIAL_FRAME_HEADER_SIZE + SERIAL_FRAME_CRC_SIZE ||
+        parser->len != SERIAL_FRAME_HEADER_SIZE + parser->buf[3] + SERIAL_FRAME_CRC_SIZE) {
+        parser->length_errors++;
+        return false;
+    }
+
+    size_t body_len = parser->len - SERIAL_FRAME_CRC_SIZE;
+    if (crc16_itu_t(FRAME_CRC_SEED, parser->buf, body_len) != sys_get_le16(&parser->buf[body_len])) {
+        parser->crc_errors++;
+        return false;
+    }
+
+    serial_frame_t frame = {
+        .version = parser->buf[0],
+        .type = parser->buf[1],
+        .seq = parser->buf[2],
+        .length = parser->buf[3],
+        .payload = &parser->buf[SERIAL_FRAME_HEADER_SIZE],
+    };
+
+    /* A frame of another protocol version must not reach a type handler:
+     * its payload layout is unknown. The fallback handler rejects it. */
+    if (frame.version != SERIAL_FRAME_VERSION) {
+        parser->version_errors++;
+        if (parser->unhandled) {
+            parser->unhandled(&frame, parser->unhandled_user_data);
+        }
+        return false;
+    }
+
+    parser->frames_ok++;
+
+    for (size_t i = 0; i < parser->handler_count; i++) {
+        if (parser->handlers[i].type == frame.type && parser->handlers[i].handler) {
+            parser->handlers[i].handler(&frame, parser->handlers[i].user_data);
+            return true;
+        }
+    }
+
+    parser->unhandled_count++;
+    if (parser->unhandled) {
+        parser->unhandled(&frame, parser->unhandled_user_data);
+    }
+
+    return true;
+}
+
+int serial_frame_parser_feed(serial_frame_parser_t *parser, const uint8_t *data, size_t length)
+{
+    if (parser == NULL || data == NULL) {
+        return 0;
+    }
+
+    int dispatched = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+
+        if (byte == SLIP_END) {
+            /* Back-to-back END bytes delimit empty frames; ignore them */
+            if (parser->len > 0 && !parser->discard && parser_complete(parser)) {
+                dispatched++;
+            }
+            parser->len = 0;
+            parser->escaped = false;
+            parser->discard = false;
+            continue;
+        }
+
+        if (parser->discard) {
+            continue; /* Resynchronize on the next END */
+        }
+
+        if (byte == SLIP_ESC) {
+            parser->escaped = true;
+            continue;
+        }
+
+        if (parser->escaped) {
+            parser->escaped = false;
+            if (byte == SLIP_ESC_END) {
+                byte = SLIP_END;
+            } else if (byte == SLIP_ESC_ESC) {
+                byte = SLIP_ESC;
+            } else {
+                /* Protocol violation - drop the frame */
+                parser->length_errors++;
+                parser->discard = true;
+                continue;
+            }
+        }
+
+        if (parser->len >= sizeof(parser->buf)) {
+            parser->overflow_errors++;
+            parser->discard = true;
+            continue;
+        }
+
+        parser->buf[parser->len++] = byte;
+    }
+
+    return dispatched;
+}
+
+/* Serial Bluetooth receive callback (system work queue) */
+static void channel_rx(const uint8_t *data, uint32_t length, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    serial_frame_parser_feed(&channel.parser, data, length);
+}
+
+static void handle_ping(const serial_frame_t *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    serial_frame_reply(frame, SERIAL_FRAME_TYPE_ACK, frame->payload, frame->length);
+}
+
+static void handle_unhandled(const serial_frame_t *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    uint8_t reason[2] = {
+        (frame->version != SERIAL_FRAME_VERSION) ? SERIAL_FRAME_NACK_BAD_VERSION
+                                                 : SERIAL_FRAME_NACK_UNKNOWN_TYPE,
+        frame->type
+    };
+
+    /* Never answer ACK/NACK frames, or two peers could loop forever */
+    if (frame->type != SERIAL_FRAME_TYPE_ACK && frame->type != SERIAL_FRAME_TYPE_NACK) {
+        serial_frame_reply(frame, SERIAL_FRAME_TYPE_NACK, reason, sizeof(reason));
+    }
+}
+
+static int send_frame(uint8_t type, uint8_t seq, const uint8_t *payload, size_t length)
+{
+    size_t encoded_len = 0;
+
+    k_mutex_lock(&channel.tx_mutex, K_FOREVER);
+
+    int ret = serial_frame_encode(type, seq, payload, length,
+                                  channel.tx_buf, sizeof(channel.tx_buf), &encoded_len);
+    if (ret == FRAME_OK) {
+        /* hw_serial_bt_send() copies the frame into its ring before returning */
+        if (hw_serial_bt_send(channel.tx_buf, (uint32_t)encoded_len) == HW_OK) {
+            channel.frames_tx++;
+        } else {
+            channel.tx_errors++;
+            ret = FRAME_ERROR_TX;
+        }
+    }
+
+    k_mutex_unlock(&channel.tx_mutex);
+    return ret;
+}
+
+int serial_frame_init(void)
+{
+    if (channel.initialized) {
+        return FRAME_OK;
+    }
+
+    k_mutex_init(&channel.tx_mutex);
+    channel.tx_seq = 0;
+    channel.frames_tx = 0;
+    channel.tx_errors = 0;
+
+    serial_frame_parser_init(&channel.parser, channel.handlers, 0);
+    serial_frame_parser_set_unhandled(&channel.parser, handle_unhandled, NULL);
+
+    /* The parser reads handler_count live, so later registrations take effect */
+    channel.initialized = true;
+    serial_frame_register_handler(SERIAL_FRAME_TYPE_PING, handle_ping, NULL);
+
+    if (hw_serial_bt_set_rx_callback(channel_rx, NULL) != HW_OK) {
+        DIAG_WARNING(DIAG_CAT_COMMUNICATION, "Serial frame channel: UART not ready");
+        return FRAME_ERROR_TX;
+    }
+
+    DIAG_INFO(DIAG_CAT_COMMUNICATION, "Serial frame channel ready (v%u)", SERIAL_FRAME_VERSION);
+    return FRAME_OK;
+}
+
+int serial_frame_register_handler(uint8_t type, serial_frame_handler_t handler, void *user_data)
+{
+    if (!channel.initialized || handler == NULL) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    for (size_t i = 0; i < channel.handler_count; i++) {
+        if (channel.handlers[i].type == type) {
+            channel.handlers[i].handler = handler;
+            channel.handlers[i].user_data = user_data;
+            return FRAME_OK;
+        }
+    }
+
+    if (channel.handler_count >= SERIAL_FRAME_MAX_HANDLERS) {
+        return FRAME_ERROR_FULL;
+    }
+
+    channel.handlers[channel.handler_count].type = type;
+    channel.handlers[channel.handler_count].handler = handler;
+    channel.handlers[channel.handler_count].user_data = user_data;
+    channel.handler_count++;
+    channel.parser.handler_count = channel.handler_count;
+
+    return FRAME_OK;
+}
+
+int serial_frame_send(uint8_t type, const uint8_t *payload, size_t length)
+{
+    if (!channel.initialized) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&channel.tx_mutex, K_FOREVER);
+    uint8_t seq = channel.tx_seq++;
+    int ret = send_frame(type, seq, payload, length);
+    k_mutex_unlock(&channel.tx_mutex);
+
+    return ret;
+}
+
+int serial_frame_reply(const serial_frame_t *request, uint8_t type,
+                       const uint8_t *payload, size_t length)
+{
+    if (!channel.initialized || request == NULL) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    return send_frame(type, request->seq, payload, length);
+}
+
+int serial_frame_get_stats(serial_frame_stats_t *stats)
+{
+    if (stats == NULL) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    stats->frames_rx = channel.parser.frames_ok;
+    stats->frames_tx = channel.frames_tx;
+    stats->crc_errors = channel.parser.crc_errors;
+    stats->length_errors = channel.parser.length_errors;
+    stats->overflow_errors = channel.parser.overflow_errors;
+    stats->unhandled = channel.parser.unhandled_count;
+    stats->version_errors = channel.parser.version_errors;
+    stats->tx_errors = channel.tx_errors;
+
+    return FRAME_OK;
+}
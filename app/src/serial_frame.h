@@ -0,0 +1,192 @@
+#ifndef SERIAL_FRAME_H
+#define SERIAL_FRAME_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @file serial_frame.h
+ * @brief SLIP framing with CRC for the serial Bluetooth command channel
+ * @details Frames are SLIP-delimited (RFC 1055). Each decoded frame carries
+ * a fixed header, a payload and a CRC-16/CCITT trailer:
+ *
+ *   [version][type][seq][len][payload (len bytes)][crc16 LE]
+ *
+ * The CRC covers header and payload. The parser is incremental: it accepts
+ * bytes in arbitrary chunks and dispatches each valid frame to the handler
+ * registered for its type. Frames of another protocol version go to the
+ * unhandled-frame handler only, never to a type handler.
+ */
+
+/* Frame error codes */
+#define FRAME_OK                0
+#define FRAME_ERROR_INVALID    -1
+#define FRAME_ERROR_NO_SPACE   -2
+#define FRAME_ERROR_FULL       -3
+#define FRAME_ERROR_TX         -4
+
+/* Protocol constants */
+#define SERIAL_FRAME_VERSION        1U
+#define SERIAL_FRAME_HEADER_SIZE    4U
+#define SERIAL_FRAME_CRC_SIZE       2U
+#define SERIAL_FRAME_MAX_PAYLOAD    128U
+#define SERIAL_FRAME_MAX_DECODED    (SERIAL_FRAME_HEADER_SIZE + SERIAL_FRAME_MAX_PAYLOAD + \
+                                     SERIAL_FRAME_CRC_SIZE)
+/* Worst case: every byte escaped plus leading and trailing END */
+#define SERIAL_FRAME_MAX_ENCODED    (2U * SERIAL_FRAME_MAX_DECODED + 2U)
+#define SERIAL_FRAME_MAX_HANDLERS   8U
+
+/* Frame types */
+#define SERIAL_FRAME_TYPE_ACK             0x01U
+#define SERIAL_FRAME_TYPE_NACK            0x02U
+#define SERIAL_FRAME_TYPE_PING            0x03U
+#define SERIAL_FRAME_TYPE_STATUS_REQUEST  0x10U
+#define SERIAL_FRAME_TYPE_STATUS          0x11U
+
+/* NACK reason codes (first payload byte of a NACK frame) */
+#define SERIAL_FRAME_NACK_UNKNOWN_TYPE    0x01U
+#define SERIAL_FRAME_NACK_BAD_VERSION     0x02U
+
+/* Decoded frame (payload points into parser storage) */
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint8_t seq;
+    uint8_t length;
+    const uint8_t *payload;
+} serial_frame_t;
+
+/* Frame handler, called once per valid frame */
+typedef void (*serial_frame_handler_t)(const serial_frame_t *frame, void *user_data);
+
+/* Handler table entry */
+typedef struct {
+    uint8_t type;
+    serial_frame_handler_t handler;
+    void *user_data;
+} serial_frame_handler_entry_t;
+
+/* Incremental parser state */
+typedef struct {
+    uint8_t buf[SERIAL_FRAME_MAX_DECODED];
+    size_t len;
+    bool escaped;
+    bool discard;
+    const serial_frame_handler_entry_t *handlers;
+    size_t handler_count;
+    serial_frame_handler_t unhandled;
+    void *unhandled_user_data;
+    uint32_t frames_ok;
+    uint32_t crc_errors;
+    uint32_t length_errors;
+    uint32_t overflow_errors;
+    uint32_t unhandled_count;
+    uint32_t version_errors;
+} serial_frame_parser_t;
+
+/* Command channel statistics */
+typedef struct {
+    uint32_t frames_rx;
+    uint32_t frames_tx;
+    uint32_t crc_errors;
+    uint32_t length_errors;
+    uint32_t overflow_errors;
+    uint32_t unhandled;
+    uint32_t version_errors;
+    uint32_t tx_errors;
+} serial_frame_stats_t;
+
+/**
+ * @brief Encode a frame
+ * @param type Frame type
+ * @param seq Sequence number
+ * @param payload Payload bytes (may be NULL when length is 0)
+ * @param length Payload length (<= SERIAL_FRAME_MAX_PAYLOAD)
+ * @param out Output buffer
+ * @param out_size Output buffer size
+ * @param[out] out_len Encoded length
+ * @return FRAME_OK on success, error code otherwise
+ */
+int serial_frame_encode(uint8_t type, uint8_t seq, const uint8_t *payload, size_t length,
+                        uint8_t *out, size_t out_size, size_t *out_len);
+
+/**
+ * @brief Initialize a parser
+ * @param parser Pointer to parser structure
+ * @param handlers Handler table (may be NULL)
+ * @param handler_count Number of entries in the table
+ * @return FRAME_OK on success, error code otherwise
+ */
+int serial_frame_parser_init(serial_frame_parser_t *parser,
+                             const serial_frame_handler_entry_t *handlers,
+                             size_t handler_count);
+
+/**
+ * @brief Set the handler for valid frames without a table entry
+ * @details Also receives CRC-valid frames with an unsupported version,
+ * which are not counted as received and never reach a type handler.
+ * @param parser Pointer to parser structure
+ * @param handler Fallback handler (NULL to drop silently)
+ * @param user_data User data passed to the handler
+ */
+void serial_frame_parser_set_unhandled(serial_frame_parser_t *parser,
+                                       serial_frame_handler_t handler, void *user_data);
+
+/**
+ * @brief Feed received bytes to a parser
+ * @details Handlers run synchronously from this call. Frames with an
+ * unsupported version are not counted in the return value.
+ * @param parser Pointer to parser structure
+ * @param data Received bytes
+ * @param length Number of bytes
+ * @return Number of complete, valid frames dispatched
+ */
+int serial_frame_parser_feed(serial_frame_parser_t *parser, const uint8_t *data, size_t length);
+
+/**
+ * @brief Bind the command channel to the serial Bluetooth interface
+ * @details Registers the receive callback and the built-in PING handler.
+ * Call after hw_serial_bt_init().
+ * @return FRAME_OK on success, error code otherwise
+ */
+int serial_frame_init(void);
+
+/**
+ * @brief Register a command handler on the serial Bluetooth channel
+ * @details Handlers run in the system work queue. Register during
+ * initialization, before traffic is expected.
+ * @param type Frame type to handle
+ * @param handler Handler function
+ * @param user_data User data passed to the handler
+ * @return FRAME_OK on success, FRAME_ERROR_FULL if the table is full
+ */
+int serial_frame_register_handler(uint8_t type, serial_frame_handler_t handler, void *user_data);
+
+/**
+ * @brief Send a frame on the serial Bluetooth channel
+ * @param type Frame type
+ * @param payload Payload bytes (may be NULL when length is 0)
+ * @param length Payload length
+ * @return FRAME_OK on success, error code otherwise
+ */
+int serial_frame_send(uint8_t type, const uint8_t *payload, size_t length);
+
+/**
+ * @brief Reply to a received frame, echoing its sequence number
+ * @param request Frame being answered
+ * @param type Reply frame type
+ * @param payload Payload bytes (may be NULL when length is 0)
+ * @param length Payload length
+ * @return FRAME_OK on success, error code otherwise
+ */
+int serial_frame_reply(const serial_frame_t *request, uint8_t type,
+                       const uint8_t *payload, size_t length);
+
+/**
+ * @brief Get command channel statistics
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return FRAME_OK on success, error code otherwise
+ */
+int serial_frame_get_stats(serial_frame_stats_t *stats);
+
+#endif /* SERIAL_FRAME_H */
@@ -0,0 +1,216 @@
+/**
+ * @file storage_writer.c
+ * @brief Background flash writer for the vital-sign history
+ * @details The queue is the only state shared with the producers; the store
+ * is written by the writer thread alone, so flash erase and program time
+ * never lands on the sensor hub's work queue.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "storage_writer.h"
+#include "vitals_store.h"
+#include "thread_manager.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+K_MSGQ_DEFINE(storage_writer_queue, sizeof(sensor_hub_sample_t), STORAGE_WRITER_QUEUE_DEPTH, 4);
+
+/** @brief Writer state */
+static struct {
+    uint32_t channel_mask;
+    atomic_t flush_requested;
+
+    /* Statistics (producers and the thread both update these) */
+    atomic_t submitted;
+    atomic_t dropped;
+    atomic_t written;
+    atomic_t store_errors;
+    atomic_t queue_peak;
+
+    /* Backpressure reporting, owned by the thread */
+    uint32_t reported_dropped;
+    int64_t last_report_ms;
+
+    bool initialized;
+} writer;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void report_backpressure(void);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Mount the vitals store behind the writer
+ */
+int storage_writer_init(uint32_t channel_mask)
+{
+    if (writer.initialized) {
+        return STORAGE_WRITER_OK;
+    }
+
+    int ret = vitals_store_init(channel_mask);
+    if (ret == VITALS_STORE_ERROR_NO_STORAGE) {
+        return STORAGE_WRITER_ERROR_NO_STORAGE;
+    }
+    if (ret != VITALS_STORE_OK) {
+        DIAG_ERROR(DIAG_CAT_SYSTEM, "Vitals store mount failed: %d", ret);
+        return STORAGE_WRITER_ERROR_STORE;
+    }
+
+    writer.channel_mask = channel_mask;
+    writer.initialized = true;
+    return STORAGE_WRITER_OK;
+}
+
+/**
+ * @brief Queue samples for storage without blocking
+ */
+int storage_writer_submit(const sensor_hub_sample_t *samples, size_t count)
+{
+    if (!writer.initialized || (samples == NULL && count > 0)) {
+        return STORAGE_WRITER_ERROR_INVALID;
+    }
+
+    uint32_t queued = 0U;
+    uint32_t dropped = 0U;
+
+    for (size_t i = 0; i < count; i++) {
+        if (samples[i].channel >= SENSOR_HUB_CH_MAX ||
+            !(writer.channel_mask & BIT(samples[i].channel))) {
+            continue;
+        }
+
+        if (k_msgq_put(&storage_writer_queue, &samples[i], K_NO_WAIT) == 0) {
+            queued++;
+        } else {
+            dropped++;
+        }
+    }
+
+    if (queued > 0U) {
+        atomic_add(&writer.submitted, (atomic_val_t)queued);
+
+        atomic_val_t level = (atomic_val_t)k_msgq_num_used_get(&storage_writer_queue);
+        if (level > atomic_get(&writer.queue_peak)) {
+            atomic_set(&writer.queue_peak, level);
+        }
+    }
+
+    if (dropped > 0U) {
+        atomic_add(&writer.dropped, (atomic_val_t)dropped);
+        return STORAGE_WRITER_ERROR_FULL;
+    }
+
+    return STORAGE_WRITER_OK;
+}
+
+/**
+ * @brief Ask the writer to commit the open page once the queue is drained
+ */
+void storage_writer_flush(void)
+{
+    atomic_set(&writer.flush_requested, 1);
+}
+
+/**
+ * @brief Storage writer thread entry point
+ */
+void storage_writer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    sensor_hub_sample_t batch[STORAGE_WRITER_BATCH];
+
+    writer.last_report_ms = k_uptime_get();
+
+    while (1) {
+        thread_manager_heartbeat(THREAD_ID_STORAGE);
+
+        size_t count = 0;
+
+        if (k_msgq_get(&storage_writer_queue, &batch[0], K_MSEC(STORAGE_WRITER_POLL_MS)) == 0) {
+            count = 1;
+            while (count < STORAGE_WRITER_BATCH &&
+                   k_msgq_get(&storage_writer_queue, &batch[count], K_NO_WAIT) == 0) {
+                count++;
+            }
+        }
+
+        if (count > 0) {
+            if (vitals_store_append(batch, count) != VITALS_STORE_OK) {
+                atomic_inc(&writer.store_errors);
+            }
+            atomic_add(&writer.written, (atomic_val_t)count);
+        }
+
+        /* Commit only once everything queued before the request is in the page */
+        if (k_msgq_num_used_get(&storage_writer_queue) == 0U &&
+            atomic_cas(&writer.flush_requested, 1, 0)) {
+            if (vitals_store_flush() != VITALS_STORE_OK) {
+                atomic_inc(&writer.store_errors);
+            }
+        }
+
+        report_backpressure();
+    }
+}
+
+/**
+ * @brief Get storage writer statistics
+ */
+int storage_writer_get_stats(storage_writer_stats_t *stats)
+{
+    if (stats == NULL) {
+        return STORAGE_WRITER_ERROR_INVALID;
+    }
+
+    stats->submitted = (uint32_t)atomic_get(&writer.submitted);
+    stats->dropped = (uint32_t)atomic_get(&writer.dropped);
+    stats->written = (uint32_t)atomic_get(&writer.written);
+    stats->store_errors = (uint32_t)atomic_get(&writer.store_errors);
+    stats->queue_peak = (uint32_t)atomic_get(&writer.queue_peak);
+
+    return STORAGE_WRITER_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Report samples dropped since the last report
+ */
+static void report_backpressure(void)
+{
+    int64_t now = k_uptime_get();
+
+    if (now - writer.last_report_ms < STORAGE_WRITER_REPORT_INTERVAL_MS) {
+        return;
+    }
+    writer.last_report_ms = now;
+
+    uint32_t dropped = (uint32_t)atomic_get(&writer.dropped);
+
+    if (dropped != writer.reported_dropped) {
+        DIAG_WARNING(DIAG_CAT_SYSTEM, "Storage writer dropped %u sample(s), queue peak %u/%u",
+                     dropped - writer.reported_dropped,
+                     (uint32_t)atomic_get(&writer.queue_peak), STORAGE_WRITER_QUEUE_DEPTH);
+        writer.reported_dropped = dropped;
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file storage_writer.h
+ * @brief Background flash writer for the vital-sign history
+ * @details Decouples the sensor pipeline from flash: the sensor hub sink
+ * submits samples to a message queue without blocking, and a low-priority
+ * thread drains the queue into the vitals store, which compresses them into
+ * its RAM page buffer and erases and programs whole pages from this thread.
+ * When the queue is full (flash busy for longer than the queue covers)
+ * samples are dropped at submission and counted; drops are reported to
+ * diagnostics every STORAGE_WRITER_REPORT_INTERVAL_MS.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef STORAGE_WRITER_H
+#define STORAGE_WRITER_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include "sensor_hub.h"
+
+/*============================================================================*/
+/* Storage Writer Constants                                                   */
+/*============================================================================*/
+
+/** @defgroup StorageWriterConfig Storage Writer Configuration
+ * @{
+ */
+
+/** @brief Queue depth in samples (over 30 s of the 1 Hz vitals channels) */
+#define STORAGE_WRITER_QUEUE_DEPTH     128U
+
+/** @brief Samples handed to the store per append */
+#define STORAGE_WRITER_BATCH           16U
+
+/** @brief Longest wait for samples before the thread reports a heartbeat */
+#define STORAGE_WRITER_POLL_MS         1000U
+
+/** @brief Interval between backpressure reports */
+#define STORAGE_WRITER_REPORT_INTERVAL_MS 10000U
+
+/** @} */ /* End of StorageWriterConfig group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup StorageWriterReturnCodes Storage Writer Return Codes
+ * @{
+ */
+
+#define STORAGE_WRITER_OK              0   /**< Operation successful */
+#define STORAGE_WRITER_ERROR_INVALID  -1   /**< Invalid parameter or not initialized */
+#define STORAGE_WRITER_ERROR_FULL     -2   /**< Queue full, samples dropped */
+#define STORAGE_WRITER_ERROR_NO_STORAGE -3 /**< No vitals_partition on this board */
+#define STORAGE_WRITER_ERROR_STORE    -4   /**< The vitals store failed to mount */
+
+/** @} */ /* End of StorageWriterReturnCodes group */
+
+/*============================================================================*/
+/* Storage Writer Types                                                       */
+/*============================================================================*/
+
+/** @brief Storage writer statistics */
+typedef struct {
+    uint32_t submitted;             /**< Samples queued */
+    uint32_t dropped;               /**< Samples dropped on a full queue */
+    uint32_t written;               /**< Samples handed to the store */
+    uint32_t store_errors;          /**< Appends or flushes the store failed */
+    uint32_t queue_peak;            /**< Highest queue fill seen */
+} storage_writer_stats_t;
+
+/*============================================================================*/
+/* Storage Writer API                                                         */
+/*============================================================================*/
+
+/**
+ * @brief Mount the vitals store behind the writer
+ *
+ * @param channel_mask Channels to keep (BIT(sensor_hub_channel_t) mask)
+ * @return STORAGE_WRITER_OK on success, STORAGE_WRITER_ERROR_NO_STORAGE
+ * without a vitals_partition, STORAGE_WRITER_ERROR_STORE if mounting failed
+ */
+int storage_writer_init(uint32_t channel_mask);
+
+/**
+ * @brief Queue samples for storage without blocking
+ * @details Samples outside the channel mask are skipped before queuing.
+ * Safe to call from the system work queue.
+ *
+ * @param samples Samples to store
+ * @param count Number of samples
+ * @return STORAGE_WRITER_OK if all were queued, STORAGE_WRITER_ERROR_FULL if
+ * any were dropped, STORAGE_WRITER_ERROR_INVALID if not initialized
+ */
+int storage_writer_submit(const sensor_hub_sample_t *samples, size_t count);
+
+/**
+ * @brief Ask the writer to commit the open page once the queue is drained
+ * @details For when buffered samples are about to be lost (critical battery).
+ */
+void storage_writer_flush(void);
+
+/**
+ * @brief Storage writer thread entry point
+ * @details Create with thread_manager_create_thread(THREAD_ID_STORAGE, ...)
+ * after storage_writer_init() succeeds.
+ */
+void storage_writer_thread(void *arg1, void *arg2, void *arg3);
+
+/**
+ * @brief Get storage writer statistics
+ *
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return STORAGE_WRITER_OK on success, error code on failure
+ */
+int storage_writer_get_stats(storage_writer_stats_t *stats);
+
+#endif /* STORAGE_WRITER_H */
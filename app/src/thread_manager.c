@@ -13,6 +13,7 @@ K_THREAD_STACK_DEFINE(data_acq_stack, THREAD_STACK_DATA_ACQ);
 K_THREAD_STACK_DEFINE(communication_stack, THREAD_STACK_COMMUNICATION);
 K_THREAD_STACK_DEFINE(data_proc_stack, THREAD_STACK_DATA_PROC);
 K_THREAD_STACK_DEFINE(diagnostics_stack, THREAD_STACK_DIAGNOSTICS);
+K_THREAD_STACK_DEFINE(storage_stack, THREAD_STACK_STORAGE);
 
 /* Thread stack pointers */
 static k_thread_stack_t *thread_stacks[THREAD_ID_MAX] = {
@@ -20,7 +21,8 @@ static k_thread_stack_t *thread_stacks[THREAD_ID_MAX] = {
     data_acq_stack,
     communication_stack,
     data_proc_stack,
-    diagnostics_stack
+    diagnostics_stack,
+    storage_stack
 };
 
 /* Thread stack sizes */
@@ -29,7 +31,8 @@ static size_t thread_stack_sizes[THREAD_ID_MAX] = {
     THREAD_STACK_DATA_ACQ,
     THREAD_STACK_COMMUNICATION,
     THREAD_STACK_DATA_PROC,
-    THREAD_STACK_DIAGNOSTICS
+    THREAD_STACK_DIAGNOSTICS,
+    THREAD_STACK_STORAGE
 };
 
 /* Thread priorities */
@@ -38,7 +41,8 @@ static int thread_priorities[THREAD_ID_MAX] = {
     THREAD_PRIO_DATA_ACQ,
     THREAD_PRIO_COMMUNICATION,
     THREAD_PRIO_DATA_PROC,
-    THREAD_PRIO_DIAGNOSTICS
+    THREAD_PRIO_DIAGNOSTICS,
+    THREAD_PRIO_STORAGE
 };
 
 /* Thread names */
@@ -47,7 +51,8 @@ static const char *thread_names[THREAD_ID_MAX] = {
     "data_acquisition",
     "data_processing",
     "communication",
-    "diagnostics"
+    "diagnostics",
+    "storage"
 };
 
 /* Mutex for thread manager */
@@ -43,6 +43,7 @@ typedef enum {
     THREAD_ID_DATA_PROCESSING,    /**< Data processing and analysis thread */
     THREAD_ID_COMMUNICATION,      /**< External communication thread */
     THREAD_ID_DIAGNOSTICS,        /**< System diagnostics and maintenance thread */
+    THREAD_ID_STORAGE,            /**< Flash storage writer thread */
     THREAD_ID_MAX                 /**< Maximum thread ID (used for bounds checking) */
 } thread_id_t;
 
@@ -100,6 +101,9 @@ typedef enum {
 /** @brief Diagnostics thread priority (low - background task) */
 #define THREAD_PRIO_DIAGNOSTICS      5U
 
+/** @brief Storage writer thread priority (lowest - flash erase/program) */
+#define THREAD_PRIO_STORAGE          6U
+
 /** @brief Supervisor thread stack size in bytes */
 #define THREAD_STACK_SUPERVISOR      2048U
 
@@ -115,6 +119,9 @@ typedef enum {
 /** @brief Diagnostics thread stack size in bytes (hardware/LED updates) */
 #define THREAD_STACK_DIAGNOSTICS     1536U
 
+/** @brief Storage writer thread stack size in bytes */
+#define THREAD_STACK_STORAGE         1536U
+
 /** @} */ /* End of ThreadConfig group */
 
 /*============================================================================*/
@@ -0,0 +1,256 @@
+/**
+ * @file usb_stream.c
+ * @brief Binary sensor capture over a second USB CDC-ACM interface
+ * @details The sensor hub sink packs samples into the ring; the CDC-ACM
+ * interrupt callback feeds the USB driver directly from the ring's
+ * contiguous spans and releases what the driver accepted. The CDC-ACM driver
+ * delivers its "interrupt" callbacks from the system work queue, so the
+ * mutex-based safe_buffer is safe to use on both sides.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "usb_stream.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+BUILD_ASSERT(sizeof(usb_stream_record_t) == USB_STREAM_RECORD_SIZE,
+             "usb_stream_record_t must match the capture script");
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Records encoded per ring write */
+#define USB_STREAM_BATCH               16U
+
+#if DT_NODE_EXISTS(DT_NODELABEL(cdc_acm_uart1))
+#define USB_STREAM_DEVICE              DEVICE_DT_GET(DT_NODELABEL(cdc_acm_uart1))
+#else
+#define USB_STREAM_DEVICE              NULL
+#endif
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Ring storage */
+static uint8_t stream_storage[USB_STREAM_BUFFER_SIZE];
+
+/** @brief USB stream state */
+static struct {
+    const struct device *dev;
+    safe_buffer_t ring;
+    struct k_work_delayable dtr_work;
+    atomic_t connected;
+    uint8_t seq;                    /* Producer side only */
+    atomic_t records_queued;
+    atomic_t records_dropped;
+    atomic_t bytes_sent;
+    atomic_t high_water;
+    bool initialized;
+} stream;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void uart_callback(const struct device *dev, void *user_data);
+static void dtr_work_handler(struct k_work *work);
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+/**
+ * @brief Initialize the capture interface
+ */
+int usb_stream_init(void)
+{
+    if (stream.initialized) {
+        return USB_STREAM_OK;
+    }
+
+    const struct device *dev = USB_STREAM_DEVICE;
+
+    if (dev == NULL || !device_is_ready(dev)) {
+        return USB_STREAM_ERROR_NO_DEVICE;
+    }
+
+    memset(&stream, 0, sizeof(stream));
+    stream.dev = dev;
+
+    /* No overwrite: the span being transmitted must stay put */
+    if (safe_buffer_init(&stream.ring, stream_storage, sizeof(stream_storage), false) != BUFFER_OK) {
+        return USB_STREAM_ERROR_INVALID;
+    }
+
+    k_work_init_delayable(&stream.dtr_work, dtr_work_handler);
+    uart_irq_callback_user_data_set(dev, uart_callback, NULL);
+    stream.initialized = true;
+
+    k_work_schedule(&stream.dtr_work, K_NO_WAIT);
+
+    DIAG_INFO(DIAG_CAT_COMMUNICATION, "USB capture stream ready on %s", dev->name);
+    return USB_STREAM_OK;
+}
+
+/**
+ * @brief Queue sensor hub samples for capture
+ */
+void usb_stream_publish(const sensor_hub_sample_t *samples, size_t count)
+{
+    if (!stream.initialized || samples == NULL || count == 0) {
+        return;
+    }
+
+    if (!atomic_get(&stream.connected)) {
+        atomic_add(&stream.records_dropped, (atomic_val_t)count);
+        return;
+    }
+
+    /* The transmit side only frees space, so this bound cannot shrink */
+    size_t fit = safe_buffer_free_space(&stream.ring) / USB_STREAM_RECORD_SIZE;
+    size_t queued = MIN(count, fit);
+    usb_stream_record_t batch[USB_STREAM_BATCH];
+
+    for (size_t done = 0; done < queued; ) {
+        size_t n = MIN(queued - done, USB_STREAM_BATCH);
+
+        for (size_t i = 0; i < n; i++) {
+            const sensor_hub_sample_t *sample = &samples[done + i];
+
+            batch[i].sync = USB_STREAM_SYNC;
+            batch[i].channel = sample->channel;
+            batch[i].flags = sample->flags;
+            batch[i].seq = stream.seq++;
+            batch[i].timestamp_ms = sys_cpu_to_le32(sample->timestamp_ms);
+            batch[i].value = (int32_t)sys_cpu_to_le32((uint32_t)sample->value);
+        }
+
+        safe_buffer_write_nb(&stream.ring, batch, n * sizeof(batch[0]), NULL);
+        done += n;
+    }
+
+    if (queued < count) {
+        atomic_add(&stream.records_dropped, (atomic_val_t)(count - queued));
+    }
+
+    if (queued > 0) {
+        atomic_add(&stream.records_queued, (atomic_val_t)queued);
+
+        atomic_val_t level = (atomic_val_t)safe_buffer_available(&stream.ring);
+        if (level > atomic_get(&stream.high_water)) {
+            atomic_set(&stream.high_water, level);
+        }
+
+        uart_irq_tx_enable(stream.dev);
+    }
+}
+
+/**
+ * @brief Check whether a host is capturing
+ */
+bool usb_stream_is_connected(void)
+{
+    return atomic_get(&stream.connected) != 0;
+}
+
+/**
+ * @brief Get USB stream statistics
+ */
+int usb_stream_get_stats(usb_stream_stats_t *stats)
+{
+    if (stats == NULL) {
+        return USB_STREAM_ERROR_INVALID;
+    }
+
+    stats->host_connected = usb_stream_is_connected();
+    stats->records_queued = (uint32_t)atomic_get(&stream.records_queued);
+    stats->records_dropped = (uint32_t)atomic_get(&stream.records_dropped);
+    stats->bytes_sent = (uint32_t)atomic_get(&stream.bytes_sent);
+    stats->buffer_high_water = (uint32_t)atomic_get(&stream.high_water);
+
+    return USB_STREAM_OK;
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief CDC-ACM interrupt callback (system work queue)
+ */
+static void uart_callback(const struct device *dev, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+        if (uart_irq_rx_ready(dev)) {
+            uint8_t discard[16];
+
+            /* Capture is one-way; drop anything the host sends */
+            while (uart_fifo_read(dev, discard, sizeof(discard)) > 0) {
+            }
+        }
+
+        if (!uart_irq_tx_ready(dev)) {
+            continue;
+        }
+
+        const uint8_t *span;
+        size_t length;
+
+        if (safe_buffer_peek_span(&stream.ring, &span, &length) != BUFFER_OK) {
+            uart_irq_tx_disable(dev);
+            break;
+        }
+
+        int sent = uart_fifo_fill(dev, span, (int)length);
+        if (sent <= 0) {
+            break;
+        }
+
+        safe_buffer_consume(&stream.ring, (size_t)sent);
+        atomic_add(&stream.bytes_sent, sent);
+    }
+}
+
+/**
+ * @brief Track the host opening and closing the port
+ */
+static void dtr_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    uint32_t dtr = 0;
+    bool was_connected = usb_stream_is_connected();
+
+    if (uart_line_ctrl_get(stream.dev, UART_LINE_CTRL_DTR, &dtr) != 0) {
+        dtr = 0;
+    }
+
+    if (dtr && !was_connected) {
+        /* Start each capture on a record boundary */
+        safe_buffer_clear(&stream.ring);
+        atomic_set(&stream.connected, 1);
+        uart_irq_rx_enable(stream.dev);
+        DIAG_INFO(DIAG_CAT_COMMUNICATION, "USB capture host connected");
+    } else if (!dtr && was_connected) {
+        atomic_set(&stream.connected, 0);
+        uart_irq_tx_disable(stream.dev);
+        uart_irq_rx_disable(stream.dev);
+        DIAG_INFO(DIAG_CAT_COMMUNICATION, "USB capture host disconnected");
+    }
+
+    k_work_schedule(&stream.dtr_work, K_MSEC(USB_STREAM_DTR_POLL_MS));
+}
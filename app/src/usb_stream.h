@@ -0,0 +1,131 @@
+/**
+ * @file usb_stream.h
+ * @brief Binary sensor capture over a second USB CDC-ACM interface
+ * @details Streams every sensor hub sample, raw FIFO channels included, to
+ * the cdc_acm_uart1 interface for lab validation. Samples are packed into
+ * fixed-size records in a ring buffer and handed to the USB driver straight
+ * from the ring's contiguous spans, keeping high-rate data off the printk
+ * console and the logging path. scripts/usb_capture.py decodes the stream.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef USB_STREAM_H
+#define USB_STREAM_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "safe_buffer.h"
+#include "sensor_hub.h"
+
+/*============================================================================*/
+/* USB Stream Constants                                                       */
+/*============================================================================*/
+
+/** @defgroup UsbStreamConfig USB Stream Configuration
+ * @{
+ */
+
+/** @brief Ring buffer size (about 100 ms of raw data at full USB FS rate) */
+#define USB_STREAM_BUFFER_SIZE         (2U * BUFFER_SIZE_LARGE)
+
+/** @brief First byte of every record, used by the host to resynchronise */
+#define USB_STREAM_SYNC                0xA5U
+
+/** @brief Encoded record size in bytes */
+#define USB_STREAM_RECORD_SIZE         12U
+
+/** @brief Interval at which the host's DTR line is polled */
+#define USB_STREAM_DTR_POLL_MS         100U
+
+/** @} */ /* End of UsbStreamConfig group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup UsbStreamReturnCodes USB Stream Return Codes
+ * @{
+ */
+
+#define USB_STREAM_OK                  0   /**< Operation successful */
+#define USB_STREAM_ERROR_INVALID      -1   /**< Invalid parameter */
+#define USB_STREAM_ERROR_NO_DEVICE    -2   /**< No capture interface on this board */
+
+/** @} */ /* End of UsbStreamReturnCodes group */
+
+/*============================================================================*/
+/* USB Stream Types                                                           */
+/*============================================================================*/
+
+/** @defgroup UsbStreamTypes USB Stream Types
+ * @{
+ */
+
+/**
+ * @brief Wire record, little-endian
+ * @details seq increments per record so the host can count records lost to
+ * a full ring.
+ */
+typedef struct __packed {
+    uint8_t sync;                   /**< USB_STREAM_SYNC */
+    uint8_t channel;                /**< sensor_hub_channel_t */
+    uint8_t flags;                  /**< SENSOR_HUB_FLAG_* */
+    uint8_t seq;                    /**< Record sequence number */
+    uint32_t timestamp_ms;          /**< Sample time (uptime) */
+    int32_t value;                  /**< Value in channel units */
+} usb_stream_record_t;
+
+/** @brief USB stream statistics */
+typedef struct {
+    bool host_connected;            /**< Host has the interface open (DTR) */
+    uint32_t records_queued;        /**< Records written to the ring */
+    uint32_t records_dropped;       /**< Records lost to a full ring or closed port */
+    uint32_t bytes_sent;            /**< Bytes accepted by the USB driver */
+    uint32_t buffer_high_water;     /**< Highest ring fill level in bytes */
+} usb_stream_stats_t;
+
+/** @} */ /* End of UsbStreamTypes group */
+
+/*============================================================================*/
+/* USB Stream API                                                             */
+/*============================================================================*/
+
+/**
+ * @brief Initialize the capture interface
+ * @details Waits for the host to open the port before streaming; samples
+ * published while it is closed are counted as dropped.
+ *
+ * @return USB_STREAM_OK on success, USB_STREAM_ERROR_NO_DEVICE if the board
+ * has no cdc_acm_uart1 node
+ */
+int usb_stream_init(void);
+
+/**
+ * @brief Queue sensor hub samples for capture
+ * @details Thread context (the sensor hub sink). Never blocks: records that
+ * do not fit in the ring are dropped whole.
+ *
+ * @param samples Samples to queue
+ * @param count Number of samples
+ */
+void usb_stream_publish(const sensor_hub_sample_t *samples, size_t count);
+
+/**
+ * @brief Check whether a host is capturing
+ * @return true if the host has the interface open
+ */
+bool usb_stream_is_connected(void);
+
+/**
+ * @brief Get USB stream statistics
+ *
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return USB_STREAM_OK on success, error code on failure
+ */
+int usb_stream_get_stats(usb_stream_stats_t *stats);
+
+#endif /* USB_STREAM_H */
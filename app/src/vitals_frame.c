@@ -0,0 +1,241 @@
+#include "vitals_frame.h"
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+/* Room for a full batch plus the samples taken while it is being flushed */
+BUILD_ASSERT(VITALS_PENDING_MAX >= 2U * VITALS_BATCH_MAX_SAMPLES,
+             "pending queue must hold two batches");
+
+/* Pending sample queue (oldest first) */
+static struct {
+    vitals_sample_t pending[VITALS_PENDING_MAX];
+    size_t head;
+    size_t count;
+    uint32_t removed;               /* Samples ever taken off the head */
+    struct k_mutex mutex;           /* Guards the queue and stats */
+    struct k_mutex flush_mutex;     /* Serializes flushers, held across sends */
+    bool initialized;
+    vitals_frame_batch_handler_t batch_handler;
+    void *batch_user_data;
+    vitals_frame_stats_t stats;
+} uplink;
+
+int vitals_frame_encode(const vitals_sample_t *samples, size_t count, uint16_t batch_seq,
+                        uint8_t *out, size_t out_size, size_t *out_len, size_t *encoded)
+{
+    if (samples == NULL || count == 0 || out == NULL || out_len == NULL || encoded == NULL) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    if (out_size < VITALS_BATCH_HEADER_SIZE + VITALS_SAMPLE_SIZE) {
+        return FRAME_ERROR_NO_SPACE;
+    }
+
+    size_t capacity = (out_size - VITALS_BATCH_HEADER_SIZE) / VITALS_SAMPLE_SIZE;
+    capacity = MIN(capacity, (size_t)UINT8_MAX);
+
+    uint32_t prev_ts = samples[0].timestamp_ms;
+    uint8_t *p = &out[VITALS_BATCH_HEADER_SIZE];
+    size_t n = 0;
+
+    while (n < count && n < capacity) {
+        uint32_t dt = samples[n].timestamp_ms - prev_ts;
+        if (dt > UINT16_MAX) {
+            break; /* Gap too large - start the next batch from this sample */
+        }
+
+        sys_put_le16((uint16_t)dt, &p[0]);
+        p[2] = samples[n].heart_rate_bpm;
+        sys_put_le16((uint16_t)samples[n].temperature_x10, &p[3]);
+        sys_put_le16(samples[n].motion_x10, &p[5]);
+        sys_put_le16(samples[n].spo2_x10, &p[7]);
+
+        prev_ts = samples[n].timestamp_ms;
+        p += VITALS_SAMPLE_SIZE;
+        n++;
+    }
+
+    out[0] = (uint8_t)n;
+    sys_put_le16(batch_seq, &out[1]);
+    sys_put_le32(samples[0].timestamp_ms, &out[3]);
+
+    *out_len = VITALS_BATCH_HEADER_SIZE + n * VITALS_SAMPLE_SIZE;
+    *encoded = n;
+
+    return FRAME_OK;
+}
+
+int vitals_frame_decode(const uint8_t *payload, size_t length, vitals_sample_t *samples,
+                        size_t max_samples, size_t *count, uint16_t *batch_seq)
+{
+    if (payload == NULL || samples == NULL || count == NULL ||
+        length < VITALS_BATCH_HEADER_SIZE) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    size_t n = payload[0];
+    if (length != VITALS_BATCH_HEADER_SIZE + n * VITALS_SAMPLE_SIZE) {
+        return FRAME_ERROR_INVALID;
+    }
+    if (n > max_samples) {
+        return FRAME_ERROR_NO_SPACE;
+    }
+
+    if (batch_seq) {
+        *batch_seq = sys_get_le16(&payload[1]);
+    }
+
+    uint32_t ts = sys_get_le32(&payload[3]);
+    const uint8_t *p = &payload[VITALS_BATCH_HEADER_SIZE];
+
+    for (size_t i = 0; i < n; i++) {
+        ts += sys_get_le16(&p[0]);
+        samples[i].timestamp_ms = ts;
+        samples[i].heart_rate_bpm = p[2];
+        samples[i].temperature_x10 = (int16_t)sys_get_le16(&p[3]);
+        samples[i].motion_x10 = sys_get_le16(&p[5]);
+        samples[i].spo2_x10 = sys_get_le16(&p[7]);
+        p += VITALS_SAMPLE_SIZE;
+    }
+
+    *count = n;
+    return FRAME_OK;
+}
+
+int vitals_frame_init(void)
+{
+    memset(&uplink, 0, sizeof(uplink));
+    k_mutex_init(&uplink.mutex);
+    k_mutex_init(&uplink.flush_mutex);
+    uplink.initialized = true;
+
+    return FRAME_OK;
+}
+
+int vitals_frame_set_batch_handler(vitals_frame_batch_handler_t handler, void *user_data)
+{
+    if (!uplink.initialized) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&uplink.mutex, K_FOREVER);
+    uplink.batch_handler = handler;
+    uplink.batch_user_data = user_data;
+    k_mutex_unlock(&uplink.mutex);
+
+    return FRAME_OK;
+}
+
+int vitals_frame_add_sample(const vitals_sample_t *sample)
+{
+    vitals_frame_batch_handler_t handler = NULL;
+    void *user_data = NULL;
+
+    if (sample == NULL || !uplink.initialized) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&uplink.mutex, K_FOREVER);
+
+    if (uplink.count == VITALS_PENDING_MAX) {
+        uplink.head = (uplink.head + 1) % VITALS_PENDING_MAX;
+        uplink.count--;
+        uplink.removed++;
+        uplink.stats.samples_dropped++;
+    }
+
+    uplink.pending[(uplink.head + uplink.count) % VITALS_PENDING_MAX] = *sample;
+    uplink.count++;
+    uplink.stats.samples_queued++;
+
+    /* Only on reaching a batch: a flush that keeps failing is not re-signalled
+     * per sample, the regular uplink cycle retries it */
+    if (uplink.count == VITALS_BATCH_MAX_SAMPLES) {
+        handler = uplink.batch_handler;
+        user_data = uplink.batch_user_data;
+    }
+
+    k_mutex_unlock(&uplink.mutex);
+
+    if (handler != NULL) {
+        handler(user_data);
+    }
+    return FRAME_OK;
+}
+
+int vitals_frame_flush(void)
+{
+    vitals_sample_t batch[VITALS_BATCH_MAX_SAMPLES];
+    uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD];
+    int ret = FRAME_OK;
+    int sent = 0;
+
+    if (!uplink.initialized) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    /* Producers only wait for the copy, never for the transmit path */
+    k_mutex_lock(&uplink.flush_mutex, K_FOREVER);
+
+    for (;;) {
+        k_mutex_lock(&uplink.mutex, K_FOREVER);
+        size_t take = MIN(uplink.count, (size_t)VITALS_BATCH_MAX_SAMPLES);
+        for (size_t i = 0; i < take; i++) {
+            batch[i] = uplink.pending[(uplink.head + i) % VITALS_PENDING_MAX];
+        }
+        uint32_t first = uplink.removed;
+        uint16_t batch_seq = uplink.stats.next_batch_seq;
+        k_mutex_unlock(&uplink.mutex);
+
+        if (take == 0) {
+            break;
+        }
+
+        size_t payload_len = 0;
+        size_t encoded = 0;
+        ret = vitals_frame_encode(batch, take, batch_seq,
+                                  payload, sizeof(payload), &payload_len, &encoded);
+        if (ret == FRAME_OK) {
+            ret = serial_frame_send(SERIAL_FRAME_TYPE_VITALS_BATCH, payload, payload_len);
+        }
+
+        k_mutex_lock(&uplink.mutex, K_FOREVER);
+        if (ret != FRAME_OK) {
+            uplink.stats.batch_errors++;
+            k_mutex_unlock(&uplink.mutex);
+            break;
+        }
+
+        /* A producer may have dropped some of the sent samples as oldest while
+         * the frame was in flight; they were delivered, so they are not drops */
+        uint32_t dropped = MIN(uplink.removed - first, (uint32_t)encoded);
+        size_t remaining = encoded - dropped;
+
+        uplink.stats.samples_dropped -= dropped;
+        uplink.head = (uplink.head + remaining) % VITALS_PENDING_MAX;
+        uplink.count -= remaining;
+        uplink.removed += remaining;
+        uplink.stats.samples_sent += encoded;
+        uplink.stats.batches_sent++;
+        uplink.stats.next_batch_seq++;
+        k_mutex_unlock(&uplink.mutex);
+
+        sent += (int)encoded;
+    }
+
+    k_mutex_unlock(&uplink.flush_mutex);
+    return (ret != FRAME_OK && sent == 0) ? ret : sent;
+}
+
+int vitals_frame_get_stats(vitals_frame_stats_t *stats)
+{
+    if (stats == NULL || !uplink.initialized) {
+        return FRAME_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&uplink.mutex, K_FOREVER);
+    *stats = uplink.stats;
+    k_mutex_unlock(&uplink.mutex);
+
+    return FRAME_OK;
+}
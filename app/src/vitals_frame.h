@@ -0,0 +1,136 @@
+#ifndef VITALS_FRAME_H
+#define VITALS_FRAME_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include "serial_frame.h"
+
+/**
+ * @file vitals_frame.h
+ * @brief Binary vitals batch payload for the serial Bluetooth uplink
+ * @details Samples are batched and sent as SERIAL_FRAME_TYPE_VITALS_BATCH
+ * frames. All fields are little-endian:
+ *
+ *   [count u8][batch_seq u16][base_ts_ms u32]
+ *   count x [dt_ms u16][hr u8][temp_x10 i16][motion_x10 u16][spo2_x10 u16]
+ *
+ * dt_ms is relative to the previous sample (the first sample to base_ts_ms).
+ * A sample costs 9 bytes versus ~30 bytes for the former ASCII line.
+ * batch_seq increments per frame so the host can detect lost batches.
+ */
+
+/* Frame type carrying a vitals batch */
+#define SERIAL_FRAME_TYPE_VITALS_BATCH    0x20U
+
+/* Payload layout */
+#define VITALS_BATCH_HEADER_SIZE    7U
+#define VITALS_SAMPLE_SIZE          9U
+#define VITALS_BATCH_MAX_SAMPLES    ((SERIAL_FRAME_MAX_PAYLOAD - VITALS_BATCH_HEADER_SIZE) / \
+                                     VITALS_SAMPLE_SIZE)
+
+/* Pending samples held between uplink cycles. A full batch wakes the
+ * uplink through the batch handler, so the ring only has to absorb the
+ * samples taken while that flush is scheduled and sent; drop-oldest is
+ * reserved for a transmit path that keeps rejecting frames. */
+#define VITALS_PENDING_MAX          32U
+
+/* One vitals sample in wire units */
+typedef struct {
+    uint32_t timestamp_ms;
+    uint8_t heart_rate_bpm;
+    int16_t temperature_x10;
+    uint16_t motion_x10;
+    uint16_t spo2_x10;
+} vitals_sample_t;
+
+/* Uplink statistics */
+typedef struct {
+    uint32_t samples_queued;
+    uint32_t samples_sent;
+    uint32_t samples_dropped;
+    uint32_t batches_sent;
+    uint32_t batch_errors;
+    uint16_t next_batch_seq;
+} vitals_frame_stats_t;
+
+/**
+ * @brief Batch-ready callback
+ * @details Called from vitals_frame_add_sample() in the producer's context,
+ * without the queue lock held. Must not block.
+ * @param user_data User data pointer
+ */
+typedef void (*vitals_frame_batch_handler_t)(void *user_data);
+
+/**
+ * @brief Encode a batch payload
+ * @details Encodes samples in order until the payload is full, the input is
+ * exhausted, or the gap to the next sample does not fit in dt_ms.
+ * @param samples Samples in timestamp order
+ * @param count Number of samples available
+ * @param batch_seq Batch sequence number
+ * @param out Output buffer
+ * @param out_size Output buffer size
+ * @param[out] out_len Payload length
+ * @param[out] encoded Number of samples consumed
+ * @return FRAME_OK on success, error code otherwise
+ */
+int vitals_frame_encode(const vitals_sample_t *samples, size_t count, uint16_t batch_seq,
+                        uint8_t *out, size_t out_size, size_t *out_len, size_t *encoded);
+
+/**
+ * @brief Decode a batch payload
+ * @param payload Payload bytes
+ * @param length Payload length
+ * @param[out] samples Output sample array
+ * @param max_samples Capacity of the output array
+ * @param[out] count Number of samples decoded
+ * @param[out] batch_seq Batch sequence number (may be NULL)
+ * @return FRAME_OK on success, error code otherwise
+ */
+int vitals_frame_decode(const uint8_t *payload, size_t length, vitals_sample_t *samples,
+                        size_t max_samples, size_t *count, uint16_t *batch_seq);
+
+/**
+ * @brief Initialize the vitals uplink
+ * @return FRAME_OK on success, error code otherwise
+ */
+int vitals_frame_init(void);
+
+/**
+ * @brief Register the batch-ready callback
+ * @details The handler runs once each time the pending queue fills a batch
+ * (VITALS_BATCH_MAX_SAMPLES), so the uplink can flush before its interval
+ * elapses instead of letting the queue overflow. Cleared by
+ * vitals_frame_init().
+ * @param handler Callback, or NULL to remove it
+ * @param user_data User data passed to the callback
+ * @return FRAME_OK on success, error code otherwise
+ */
+int vitals_frame_set_batch_handler(vitals_frame_batch_handler_t handler, void *user_data);
+
+/**
+ * @brief Queue a sample for the next uplink
+ * @details Calls the batch handler when the queue reaches a full batch.
+ * When the pending queue is full the oldest sample is dropped.
+ * @param sample Sample to queue
+ * @return FRAME_OK on success, error code otherwise
+ */
+int vitals_frame_add_sample(const vitals_sample_t *sample);
+
+/**
+ * @brief Send all pending samples as batch frames
+ * @details Samples stay queued if the transmit path rejects a frame. Frames
+ * are sent without the queue lock held, so vitals_frame_add_sample() never
+ * waits for the transmit path.
+ * @return Number of samples sent, or negative error code
+ */
+int vitals_frame_flush(void);
+
+/**
+ * @brief Get uplink statistics
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return FRAME_OK on success, error code otherwise
+ */
+int vitals_frame_get_stats(vitals_frame_stats_t *stats);
+
+#endif /* VITALS_FRAME_H */
@@ -0,0 +1,714 @@
+/**
+ * @file vitals_store.c
+ * @brief On-flash time-series store for sensor hub samples
+ * @details Page layout (one flash erase page):
+ *
+ *   [page header][payload][erased fill][page trailer]
+ *
+ * The header gives the payload length, sample count and time range; each
+ * payload sample is:
+ *
+ *   [zigzag varint time delta][channel | flags << 4][zigzag varint value delta]
+ *
+ * with the time delta taken from the previous sample (the first from the
+ * page's base time) and the value delta from the previous sample on the
+ * same channel, so every page decodes on its own. The trailer holds the
+ * page sequence number (higher is newer), the page's lifetime erase count
+ * and a CRC-32 of everything before it. The page is programmed in a single
+ * write, low address first, so the trailer is the commit record: a page
+ * with a valid trailer magic was written completely. Mount only indexes
+ * pages whose CRC also checks; a page that fails it, like a page whose
+ * commit failed, is a hole in the ring that queries step over.
+ *
+ * @author NISC Medical Devices
+ * @version 2.0.0
+ * @date 2024
+ */
+
+#include "vitals_store.h"
+#include "common.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#if defined(CONFIG_FLASH_MAP)
+#include <zephyr/drivers/flash.h>
+#include <zephyr/storage/flash_map.h>
+#if FIXED_PARTITION_EXISTS(vitals_partition)
+#define STORE_ENABLED 1
+#endif
+#endif
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Trailer magic ("VST2", format 2); format 1 pages read as free */
+#define PAGE_MAGIC                     0x32545356U
+
+/** @brief Worst-case encoded sample: 10-byte time delta, channel, 5-byte value delta */
+#define SAMPLE_MAX_ENCODED             16U
+
+/** @brief Index time of a page without a committed payload */
+#define PAGE_EMPTY                     UINT64_MAX
+
+/** @brief Page header */
+typedef struct __packed {
+    uint16_t length;                /* Payload bytes */
+    uint16_t count;                 /* Samples */
+    uint32_t back_ms;               /* base_ms minus the earliest sample time */
+    uint64_t base_ms;               /* Time of the first sample */
+    uint32_t span_ms;               /* Latest sample time minus base_ms */
+    uint32_t reserved;
+} page_header_t;
+
+/** @brief Page trailer, the last bytes of the page */
+typedef struct __packed {
+    uint32_t seq;                   /* Page sequence, 0 = never used */
+    uint32_t erase_count;
+    uint32_t magic;
+    uint32_t crc;                   /* CRC-32 of the page up to this field */
+} page_trailer_t;
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+#ifdef STORE_ENABLED
+
+/** @brief Store state */
+static struct {
+    const struct flash_area *fa;
+    struct k_mutex lock;
+    uint32_t page_size;
+    uint32_t page_count;
+    uint32_t channel_mask;
+
+    /* Ring */
+    uint32_t last;                  /* Newest committed page */
+    uint32_t next_seq;
+    struct {
+        uint32_t seq;
+        uint32_t erase_count;
+        uint64_t first_ms;          /* Earliest sample, or PAGE_EMPTY */
+    } index[VITALS_STORE_MAX_PAGES];
+    uint64_t time_offset;           /* Log time minus uptime */
+
+    /* Open page, laid out as it will be written */
+    uint8_t page[VITALS_STORE_PAGE_MAX];
+    size_t length;
+    uint16_t count;
+    uint64_t base_ms;
+    uint64_t min_ms;
+    uint64_t max_ms;
+    uint64_t last_ms;
+    int32_t last_value[SENSOR_HUB_CH_MAX];
+
+    /* Page buffer for queries */
+    uint8_t read_buf[VITALS_STORE_PAGE_MAX];
+
+    vitals_store_stats_t stats;
+    bool initialized;
+} store;
+
+#endif
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+#ifdef STORE_ENABLED
+static int mount(void);
+static int commit_page(void);
+static void reset_page(void);
+static size_t payload_capacity(void);
+static uint32_t page_at(uint32_t position);
+static uint32_t prev_committed(uint32_t position);
+static uint64_t position_key(uint32_t position);
+static int decode_page(const uint8_t *page, uint64_t from_ms, uint64_t to_ms,
+                       vitals_store_visitor_t visitor, void *user_data, int *visited);
+static size_t put_varint(uint8_t *out, uint64_t value);
+static bool get_varint(const uint8_t **in, const uint8_t *end, uint64_t *value);
+#endif
+
+/*============================================================================*/
+/* Public Function Implementations                                            */
+/*============================================================================*/
+
+#ifdef STORE_ENABLED
+
+/**
+ * @brief Mount the store
+ */
+int vitals_store_init(uint32_t channel_mask)
+{
+    if (store.initialized) {
+        return VITALS_STORE_OK;
+    }
+
+    k_mutex_init(&store.lock);
+    store.channel_mask = channel_mask;
+
+    int ret = mount();
+    if (ret != VITALS_STORE_OK) {
+        return ret;
+    }
+
+    reset_page();
+    store.initialized = true;
+
+    DIAG_INFO(DIAG_CAT_SYSTEM, "Vitals store: %u x %u B pages, log time %u s",
+              store.page_count, store.page_size, (uint32_t)(store.time_offset / 1000U));
+    return VITALS_STORE_OK;
+}
+
+/**
+ * @brief Append samples
+ */
+int vitals_store_append(const sensor_hub_sample_t *samples, size_t count)
+{
+    if (!store.initialized || (samples == NULL && count > 0)) {
+        return VITALS_STORE_ERROR_INVALID;
+    }
+
+    int ret = VITALS_STORE_OK;
+
+    k_mutex_lock(&store.lock, K_FOREVER);
+
+    for (size_t i = 0; i < count; i++) {
+        const sensor_hub_sample_t *sample = &samples[i];
+
+        if (sample->channel >= SENSOR_HUB_CH_MAX || !(store.channel_mask & BIT(sample->channel))) {
+            continue;
+        }
+
+        /* A failed commit has already dropped the page: keep buffering */
+        if (store.length + SAMPLE_MAX_ENCODED > payload_capacity() &&
+            commit_page() != VITALS_STORE_OK) {
+            ret = VITALS_STORE_ERROR_FLASH;
+        }
+
+        uint64_t time_ms = store.time_offset + sample->timestamp_ms;
+        uint8_t *out = &store.page[sizeof(page_header_t) + store.length];
+        size_t n = 0;
+
+        if (store.count == 0U) {
+            store.base_ms = store.min_ms = store.max_ms = store.last_ms = time_ms;
+        }
+
+        int64_t dt = (int64_t)(time_ms - store.last_ms);
+        int64_t dv = (int64_t)sample->value - store.last_value[sample->channel];
+
+        n += put_varint(&out[n], ((uint64_t)dt << 1) ^ (uint64_t)(dt >> 63));
+        out[n++] = (uint8_t)(sample->channel | (sample->flags << 4));
+        n += put_varint(&out[n], ((uint64_t)dv << 1) ^ (uint64_t)(dv >> 63));
+
+        store.length += n;
+        store.count++;
+        store.last_ms = time_ms;
+        store.min_ms = MIN(store.min_ms, time_ms);
+        store.max_ms = MAX(store.max_ms, time_ms);
+        store.last_value[sample->channel] = sample->value;
+        store.stats.newest_ms = MAX(store.stats.newest_ms, time_ms);
+    }
+
+    k_mutex_unlock(&store.lock);
+    return ret;
+}
+
+/**
+ * @brief Commit the open page even if it is not full
+ */
+int vitals_store_flush(void)
+{
+    if (!store.initialized) {
+        return VITALS_STORE_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&store.lock, K_FOREVER);
+    int ret = commit_page();
+    k_mutex_unlock(&store.lock);
+
+    return ret;
+}
+
+/**
+ * @brief Visit stored samples in a time range
+ */
+int vitals_store_query(uint64_t from_ms, uint64_t to_ms,
+                       vitals_store_visitor_t visitor, void *user_data)
+{
+    if (!store.initialized || visitor == NULL || from_ms > to_ms) {
+        return VITALS_STORE_ERROR_INVALID;
+    }
+
+    int visited = 0;
+    int ret = VITALS_STORE_OK;
+
+    k_mutex_lock(&store.lock, K_FOREVER);
+
+    /* Last position (in ring order, oldest first) keyed at or before from_ms */
+    uint32_t lo = 0;
+    uint32_t hi = store.page_count;
+
+    while (hi - lo > 1U) {
+        uint32_t mid = lo + (hi - lo) / 2U;
+
+        if (position_key(mid) <= from_ms) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    /* Back to the committed page that key came from, then to the one before
+     * it: sensor skew can put samples of the previous page past from_ms */
+    uint32_t start = prev_committed(lo + 1U);
+
+    if (start < store.page_count) {
+        start = prev_committed(start);
+    }
+    if (start >= store.page_count) {
+        start = 0U;
+    }
+
+    for (uint32_t pos = start; pos < store.page_count && ret == VITALS_STORE_OK; pos++) {
+        uint32_t page = page_at(pos);
+        page_header_t header;
+        page_trailer_t trailer;
+
+        if (store.index[page].first_ms == PAGE_EMPTY) {
+            continue;
+        }
+        if (store.index[page].first_ms > to_ms) {
+            break;
+        }
+
+        if (flash_area_read(store.fa, page * store.page_size, store.read_buf,
+                            store.page_size) != 0) {
+            ret = VITALS_STORE_ERROR_FLASH;
+            break;
+        }
+
+        memcpy(&header, store.read_buf, sizeof(header));
+        memcpy(&trailer, &store.read_buf[store.page_size - sizeof(trailer)], sizeof(trailer));
+
+        if (header.base_ms + header.span_ms < from_ms) {
+            continue;
+        }
+
+        if (crc32_ieee(store.read_buf, store.page_size - sizeof(uint32_t)) != trailer.crc ||
+            header.length > payload_capacity()) {
+            store.stats.corrupt_pages++;
+            continue;
+        }
+
+        ret = decode_page(store.read_buf, from_ms, to_ms, visitor, user_data, &visited);
+    }
+
+    k_mutex_unlock(&store.lock);
+
+    return (ret < 0) ? ret : visited;
+}
+
+/**
+ * @brief Current log time
+ */
+uint64_t vitals_store_now(void)
+{
+    return store.time_offset + (uint64_t)k_uptime_get();
+}
+
+/**
+ * @brief Get vitals store statistics
+ */
+int vitals_store_get_stats(vitals_store_stats_t *stats)
+{
+    if (stats == NULL || !store.initialized) {
+        return VITALS_STORE_ERROR_INVALID;
+    }
+
+    k_mutex_lock(&store.lock, K_FOREVER);
+
+    *stats = store.stats;
+    stats->pages = store.page_count;
+    stats->page_size = store.page_size;
+    stats->open_samples = store.count;
+    stats->min_erase_count = UINT32_MAX;
+    stats->max_erase_count = 0U;
+    stats->oldest_ms = 0U;
+
+    for (uint32_t pos = 0; pos < store.page_count; pos++) {
+        uint32_t page = page_at(pos);
+
+        if (store.index[page].seq == 0U) {
+            continue;
+        }
+        stats->min_erase_count = MIN(stats->min_erase_count, store.index[page].erase_count);
+        stats->max_erase_count = MAX(stats->max_erase_count, store.index[page].erase_count);
+        if (stats->oldest_ms == 0U) {
+            stats->oldest_ms = store.index[page].first_ms;
+        }
+    }
+
+    if (stats->min_erase_count == UINT32_MAX) {
+        stats->min_erase_count = 0U;
+    }
+
+    k_mutex_unlock(&store.lock);
+    return VITALS_STORE_OK;
+}
+
+#else /* !STORE_ENABLED */
+
+int vitals_store_init(uint32_t channel_mask)
+{
+    ARG_UNUSED(channel_mask);
+    return VITALS_STORE_ERROR_NO_STORAGE;
+}
+
+int vitals_store_append(const sensor_hub_sample_t *samples, size_t count)
+{
+    ARG_UNUSED(samples);
+    ARG_UNUSED(count);
+    return VITALS_STORE_ERROR_INVALID;
+}
+
+int vitals_store_flush(void)
+{
+    return VITALS_STORE_ERROR_INVALID;
+}
+
+int vitals_store_query(uint64_t from_ms, uint64_t to_ms,
+                       vitals_store_visitor_t visitor, void *user_data)
+{
+    ARG_UNUSED(from_ms);
+    ARG_UNUSED(to_ms);
+    ARG_UNUSED(visitor);
+    ARG_UNUSED(user_data);
+    return VITALS_STORE_ERROR_INVALID;
+}
+
+uint64_t vitals_store_now(void)
+{
+    return (uint64_t)k_uptime_get();
+}
+
+int vitals_store_get_stats(vitals_store_stats_t *stats)
+{
+    ARG_UNUSED(stats);
+    return VITALS_STORE_ERROR_INVALID;
+}
+
+#endif /* STORE_ENABLED */
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+#ifdef STORE_ENABLED
+
+/**
+ * @brief Open the partition and rebuild the index from the page trailers
+ */
+static int mount(void)
+{
+    struct flash_pages_info info;
+
+    if (flash_area_open(FIXED_PARTITION_ID(vitals_partition), &store.fa) != 0) {
+        return VITALS_STORE_ERROR_NO_STORAGE;
+    }
+
+    const struct device *dev = flash_area_get_device(store.fa);
+
+    if (dev == NULL || !device_is_ready(dev) ||
+        flash_get_page_info_by_offs(dev, store.fa->fa_off, &info) != 0) {
+        return VITALS_STORE_ERROR_FLASH;
+    }
+
+    store.page_size = info.size;
+    store.page_count = MIN(store.fa->fa_size / info.size, VITALS_STORE_MAX_PAGES);
+    if (store.page_count < 2U || store.page_size > VITALS_STORE_PAGE_MAX ||
+        store.page_size % flash_area_align(store.fa) != 0U ||
+        payload_capacity() < SAMPLE_MAX_ENCODED) {
+        return VITALS_STORE_ERROR_NO_STORAGE;
+    }
+
+    uint32_t newest = UINT32_MAX;
+    uint32_t max_erase_count = 0U;
+
+    for (uint32_t page = 0; page < store.page_count; page++) {
+        page_trailer_t trailer;
+        page_header_t header;
+
+        memset(&store.index[page], 0, sizeof(store.index[page]));
+        store.index[page].first_ms = PAGE_EMPTY;
+
+        if (flash_area_read(store.fa, page * store.page_size, store.read_buf,
+                            store.page_size) != 0) {
+            return VITALS_STORE_ERROR_FLASH;
+        }
+
+        memcpy(&header, store.read_buf, sizeof(header));
+        memcpy(&trailer, &store.read_buf[store.page_size - sizeof(trailer)], sizeof(trailer));
+
+        /* Uncommitted: erased, torn by a power failure, or an older format */
+        if (trailer.magic != PAGE_MAGIC || trailer.seq == 0U) {
+            continue;
+        }
+
+        /* Committed but damaged since: leave it out, as a hole in the ring */
+        if (crc32_ieee(store.read_buf, store.page_size - sizeof(uint32_t)) != trailer.crc ||
+            header.length > payload_capacity()) {
+            store.stats.corrupt_pages++;
+            continue;
+        }
+
+        store.index[page].seq = trailer.seq;
+        store.index[page].erase_count = trailer.erase_count;
+        store.index[page].first_ms = header.base_ms - header.back_ms;
+        max_erase_count = MAX(max_erase_count, trailer.erase_count);
+
+        if (newest == UINT32_MAX || trailer.seq > store.index[newest].seq) {
+            newest = page;
+        }
+    }
+
+    uint64_t last_ms = 0U;
+
+    if (newest == UINT32_MAX) {
+        /* Empty store: the first page goes to page 0 */
+        store.last = store.page_count - 1U;
+        store.next_seq = 1U;
+    } else {
+        page_header_t header;
+
+        if (flash_area_read(store.fa, newest * store.page_size, &header, sizeof(header)) != 0) {
+            return VITALS_STORE_ERROR_FLASH;
+        }
+        store.last = newest;
+        store.next_seq = store.index[newest].seq + 1U;
+        last_ms = header.base_ms + header.span_ms;
+    }
+
+    /* Pages erased but never committed lost their count: assume the worst */
+    for (uint32_t page = 0; page < store.page_count; page++) {
+        if (store.index[page].seq == 0U) {
+            store.index[page].erase_count = max_erase_count;
+        }
+    }
+
+    store.time_offset = (last_ms > 0U) ? last_ms + 1U : 0U;
+    store.stats.newest_ms = last_ms;
+    return VITALS_STORE_OK;
+}
+
+/**
+ * @brief Erase the oldest page, then write and commit the open page to it
+ * (caller holds the lock)
+ */
+static int commit_page(void)
+{
+    if (store.count == 0U) {
+        return VITALS_STORE_OK;
+    }
+
+    uint32_t page = (store.last + 1U) % store.page_count;
+    off_t off = page * store.page_size;
+    page_header_t header = {
+        .length = (uint16_t)store.length,
+        .count = store.count,
+        .back_ms = (uint32_t)(store.base_ms - store.min_ms),
+        .base_ms = store.base_ms,
+        .span_ms = (uint32_t)(store.max_ms - store.base_ms),
+    };
+    page_trailer_t trailer = {
+        .seq = store.next_seq,
+        .erase_count = store.index[page].erase_count + 1U,
+        .magic = PAGE_MAGIC,
+    };
+    uint8_t *tail = &store.page[store.page_size - sizeof(trailer)];
+
+    memcpy(store.page, &header, sizeof(header));
+    memset(&store.page[sizeof(header) + store.length], 0xFF, payload_capacity() - store.length);
+    memcpy(tail, &trailer, sizeof(trailer));
+    trailer.crc = crc32_ieee(store.page, store.page_size - sizeof(uint32_t));
+    memcpy(tail, &trailer, sizeof(trailer));
+
+    /* The oldest page leaves the index before it is erased */
+    store.index[page].seq = 0U;
+    store.index[page].first_ms = PAGE_EMPTY;
+
+    int ret = VITALS_STORE_OK;
+
+    if (flash_area_erase(store.fa, off, store.page_size) != 0 ||
+        flash_area_write(store.fa, off, store.page, store.page_size) != 0) {
+        ret = VITALS_STORE_ERROR_FLASH;
+    }
+
+    /* Move on either way, so a failing page is not retried forever */
+    store.last = page;
+    store.next_seq++;
+    store.index[page].erase_count = trailer.erase_count;
+
+    if (ret == VITALS_STORE_OK) {
+        store.index[page].seq = trailer.seq;
+        store.index[page].first_ms = store.min_ms;
+        store.stats.pages_written++;
+        store.stats.samples_written += store.count;
+        store.stats.payload_bytes += store.length;
+    } else {
+        DIAG_ERROR(DIAG_CAT_SYSTEM, "Vitals store page %u write failed, %u sample(s) lost",
+                   page, store.count);
+    }
+
+    reset_page();
+    return ret;
+}
+
+/**
+ * @brief Start a new open page
+ */
+static void reset_page(void)
+{
+    store.length = 0U;
+    store.count = 0U;
+    memset(store.last_value, 0, sizeof(store.last_value));
+}
+
+/**
+ * @brief Payload bytes per page
+ */
+static size_t payload_capacity(void)
+{
+    return store.page_size - sizeof(page_header_t) - sizeof(page_trailer_t);
+}
+
+/**
+ * @brief Page at a ring position (0 = oldest)
+ */
+static uint32_t page_at(uint32_t position)
+{
+    return (store.last + 1U + position) % store.page_count;
+}
+
+/**
+ * @brief Ring position of the newest committed page before a position
+ * @return The position, or page_count if there is none
+ */
+static uint32_t prev_committed(uint32_t position)
+{
+    while (position > 0U) {
+        position--;
+        if (store.index[page_at(position)].first_ms != PAGE_EMPTY) {
+            return position;
+        }
+    }
+    return store.page_count;
+}
+
+/**
+ * @brief Binary search key of a ring position
+ * @details Unused pages sit before the used ones in ring order, but a failed
+ * commit or a corrupt page also leaves one between them. An unused page takes
+ * the key of the nearest committed page before it (0 if none), so the keys
+ * stay sorted across such holes.
+ */
+static uint64_t position_key(uint32_t position)
+{
+    uint32_t pos = prev_committed(position + 1U);
+
+    return (pos < store.page_count) ? store.index[page_at(pos)].first_ms : 0U;
+}
+
+/**
+ * @brief Decode a page and visit the samples in range
+ * @return VITALS_STORE_OK to continue, 1 if the visitor stopped the query
+ */
+static int decode_page(const uint8_t *page, uint64_t from_ms, uint64_t to_ms,
+                       vitals_store_visitor_t visitor, void *user_data, int *visited)
+{
+    page_header_t header;
+
+    memcpy(&header, page, sizeof(header));
+
+    const uint8_t *in = page + sizeof(header);
+    const uint8_t *end = in + header.length;
+    int32_t last_value[SENSOR_HUB_CH_MAX] = {0};
+    uint64_t time_ms = header.base_ms;
+
+    for (uint16_t i = 0; i < header.count; i++) {
+        uint64_t dt;
+        uint64_t dv;
+        vitals_store_sample_t sample;
+
+        if (!get_varint(&in, end, &dt) || in >= end) {
+            break;
+        }
+
+        sample.channel = *in & 0x0FU;
+        sample.flags = *in++ >> 4;
+
+        if (sample.channel >= SENSOR_HUB_CH_MAX || !get_varint(&in, end, &dv)) {
+            break;
+        }
+
+        time_ms += (uint64_t)((int64_t)(dt >> 1) ^ -(int64_t)(dt & 1U));
+        last_value[sample.channel] += (int32_t)((int64_t)(dv >> 1) ^ -(int64_t)(dv & 1U));
+        sample.time_ms = time_ms;
+        sample.value = last_value[sample.channel];
+
+        if (time_ms < from_ms || time_ms > to_ms) {
+            continue;
+        }
+
+        (*visited)++;
+        if (!visitor(&sample, user_data)) {
+            return 1;
+        }
+    }
+
+    return VITALS_STORE_OK;
+}
+
+/**
+ * @brief Encode an unsigned LEB128 varint
+ * @return Bytes written
+ */
+static size_t put_varint(uint8_t *out, uint64_t value)
+{
+    size_t n = 0;
+
+    while (value >= 0x80U) {
+        out[n++] = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+
+    return n;
+}
+
+/**
+ * @brief Decode an unsigned LEB128 varint
+ * @return false if the input ends inside the varint or it is over-long
+ */
+static bool get_varint(const uint8_t **in, const uint8_t *end, uint64_t *value)
+{
+    uint64_t result = 0U;
+
+    for (unsigned int shift = 0; shift < 64U && *in < end; shift += 7U) {
+        uint8_t byte = *(*in)++;
+
+        result |= (uint64_t)(byte & 0x7FU) << shift;
+        if (!(byte & 0x80U)) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif /* STORE_ENABLED */
@@ -0,0 +1,182 @@
+/**
+ * @file vitals_store.h
+ * @brief On-flash time-series store for sensor hub samples
+ * @details An append-only log on the vitals_partition, used as a ring of
+ * erase pages. Samples are compressed (per-sample timestamp and per-channel
+ * value deltas, zigzag varint coded) into a RAM page buffer; a full page is
+ * written to flash in one go and committed by a trailer carrying its
+ * sequence number and CRC, programmed last. A page without a valid trailer
+ * is ignored at mount, so a brown-out loses at most the open page. A RAM
+ * index of each page's first timestamp turns a range query into a binary
+ * search. When the log is full the oldest page is erased and reused, so
+ * every page is erased once per lap of the ring.
+ *
+ * Timestamps are in log time: milliseconds of uptime offset by the end of
+ * the log found at boot, so they keep increasing across reboots.
+ *
+ * On-flash format 2 (page trailer magic "VST2") replaced the per-record
+ * format 1 of version 1.0.0. Format 1 pages are not migrated: mount reads
+ * them as free, so history recorded before the upgrade is not queryable
+ * and its pages are reused as the ring advances.
+ *
+ * @author NISC Medical Devices
+ * @version 2.0.0
+ * @date 2024
+ */
+
+#ifndef VITALS_STORE_H
+#define VITALS_STORE_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_hub.h"
+
+/*============================================================================*/
+/* Vitals Store Constants                                                     */
+/*============================================================================*/
+
+/** @defgroup VitalsStoreConfig Vitals Store Configuration
+ * @{
+ */
+
+/** @brief Largest flash erase page the RAM page buffer can hold */
+#define VITALS_STORE_PAGE_MAX          4096U
+
+/** @brief Largest number of pages the index can hold (the rest of a bigger partition is unused) */
+#define VITALS_STORE_MAX_PAGES         64U
+
+/** @brief Channel mask for the derived (1 Hz vitals) channels */
+#define VITALS_STORE_CHANNELS_VITALS   (BIT(SENSOR_HUB_CH_HEART_RATE) | \
+                                        BIT(SENSOR_HUB_CH_TEMPERATURE) | \
+                                        BIT(SENSOR_HUB_CH_MOTION) | \
+                                        BIT(SENSOR_HUB_CH_SPO2))
+
+/** @brief Channel mask for every channel, raw waveforms included */
+#define VITALS_STORE_CHANNELS_ALL      (BIT(SENSOR_HUB_CH_MAX) - 1U)
+
+/** @} */ /* End of VitalsStoreConfig group */
+
+/*============================================================================*/
+/* Function Return Codes                                                      */
+/*============================================================================*/
+
+/** @defgroup VitalsStoreReturnCodes Vitals Store Return Codes
+ * @{
+ */
+
+#define VITALS_STORE_OK                0   /**< Operation successful */
+#define VITALS_STORE_ERROR_INVALID    -1   /**< Invalid parameter or not initialized */
+#define VITALS_STORE_ERROR_NO_STORAGE -2   /**< No vitals_partition on this board */
+#define VITALS_STORE_ERROR_FLASH      -3   /**< Flash read, write or erase failed */
+
+/** @} */ /* End of VitalsStoreReturnCodes group */
+
+/*============================================================================*/
+/* Vitals Store Types                                                         */
+/*============================================================================*/
+
+/** @defgroup VitalsStoreTypes Vitals Store Types
+ * @{
+ */
+
+/** @brief Sample read back from the store */
+typedef struct {
+    uint64_t time_ms;               /**< Log time */
+    int32_t value;                  /**< Value in channel units */
+    uint8_t channel;                /**< sensor_hub_channel_t */
+    uint8_t flags;                  /**< SENSOR_HUB_FLAG_* */
+} vitals_store_sample_t;
+
+/**
+ * @brief Query visitor
+ * @param sample Sample in the requested range
+ * @param user_data User data passed to vitals_store_query()
+ * @return true to continue, false to stop the query
+ */
+typedef bool (*vitals_store_visitor_t)(const vitals_store_sample_t *sample, void *user_data);
+
+/** @brief Vitals store statistics */
+typedef struct {
+    uint32_t pages;                 /**< Erase pages in the ring */
+    uint32_t page_size;             /**< Bytes per page */
+    uint32_t pages_written;         /**< Pages committed since boot */
+    uint32_t samples_written;       /**< Samples committed since boot */
+    uint32_t payload_bytes;         /**< Compressed sample bytes committed since boot */
+    uint32_t min_erase_count;       /**< Lowest lifetime erase count of any page */
+    uint32_t max_erase_count;       /**< Highest lifetime erase count of any page */
+    uint32_t corrupt_pages;         /**< Committed pages skipped on a CRC mismatch */
+    uint32_t open_samples;          /**< Samples buffered in the open page */
+    uint64_t oldest_ms;             /**< Log time of the oldest stored sample */
+    uint64_t newest_ms;             /**< Log time of the newest written sample */
+} vitals_store_stats_t;
+
+/** @} */ /* End of VitalsStoreTypes group */
+
+/*============================================================================*/
+/* Vitals Store API                                                           */
+/*============================================================================*/
+
+/**
+ * @brief Mount the store
+ * @details Reads the page trailers to rebuild the index and find the end
+ * of the log. Pages whose write was cut short by a power failure have no
+ * trailer and are reused.
+ *
+ * @param channel_mask Channels to keep (BIT(sensor_hub_channel_t) mask)
+ * @return VITALS_STORE_OK on success, VITALS_STORE_ERROR_NO_STORAGE if the
+ * board has no vitals_partition, error code on failure
+ */
+int vitals_store_init(uint32_t channel_mask);
+
+/**
+ * @brief Append samples
+ * @details Samples on channels outside the mask are skipped. Samples are
+ * compressed into the RAM page buffer; when it is full the page is erased,
+ * written and committed before this returns, so call it from a thread that
+ * can block on flash (see storage_writer.h), not from a work queue.
+ *
+ * @param samples Samples (timestamps in uptime milliseconds)
+ * @param count Number of samples
+ * @return VITALS_STORE_OK on success, error code on failure
+ */
+int vitals_store_append(const sensor_hub_sample_t *samples, size_t count);
+
+/**
+ * @brief Commit the open page even if it is not full
+ * @details The rest of the page is left unused, so call this only when the
+ * buffered samples are about to be lost (critical battery, shutdown).
+ *
+ * @return VITALS_STORE_OK on success, error code on failure
+ */
+int vitals_store_flush(void);
+
+/**
+ * @brief Visit stored samples in a time range
+ * @details Samples are visited in log order. The open page is not
+ * included.
+ *
+ * @param from_ms Start of the range (log time, inclusive)
+ * @param to_ms End of the range (log time, inclusive)
+ * @param visitor Called for each sample in the range
+ * @param user_data User data passed to the visitor
+ * @return Number of samples visited, or negative error code
+ */
+int vitals_store_query(uint64_t from_ms, uint64_t to_ms,
+                       vitals_store_visitor_t visitor, void *user_data);
+
+/**
+ * @brief Current log time
+ * @return Log time in milliseconds
+ */
+uint64_t vitals_store_now(void);
+
+/**
+ * @brief Get vitals store statistics
+ *
+ * @param[out] stats Pointer to statistics structure to fill
+ * @return VITALS_STORE_OK on success, error code on failure
+ */
+int vitals_store_get_stats(vitals_store_stats_t *stats);
+
+#endif /* VITALS_STORE_H */
@@ -0,0 +1,103 @@
+/**
+ * @file stress.h
+ * @brief Randomized preemption helpers shared by the ztest suites
+ * @details Stress threads run at one preemptible priority with time slicing
+ * enabled and call stress_perturb() between operations. That randomly
+ * yields, spins across a slice boundary or sleeps for a tick, so the
+ * interleavings change from operation to operation instead of settling
+ * into the hand-over pattern of cooperative equal-priority threads.
+ *
+ * Every thread draws from its own xorshift32 generator seeded from
+ * STRESS_SEED and the thread index, so a failing interleaving can be
+ * replayed by building with the seed printed at the start of the run.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef STRESS_H
+#define STRESS_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/*============================================================================*/
+/* Stress Test Constants                                                      */
+/*============================================================================*/
+
+/** @defgroup StressConfig Stress Test Configuration
+ * @{
+ */
+
+/** @brief Base seed; override with -DSTRESS_SEED=... to replay a run */
+#ifndef STRESS_SEED
+#define STRESS_SEED                0x5EED1234U
+#endif
+
+/** @brief Stack size of each stress thread */
+#define STRESS_STACK_SIZE          2048U
+
+/** @brief Priority of the stress threads (all equal, so time slicing applies) */
+#define STRESS_THREAD_PRIORITY     K_PRIO_PREEMPT(5)
+
+/** @brief Longest spin of a perturbation, long enough to cross a slice */
+#define STRESS_MAX_SPIN_US         1500U
+
+/** @} */ /* End of StressConfig group */
+
+/*============================================================================*/
+/* Stress Test Helpers                                                        */
+/*============================================================================*/
+
+/**
+ * @brief Seed for one stress thread
+ */
+static inline uint32_t stress_seed(uint32_t index)
+{
+    uint32_t seed = STRESS_SEED ^ ((index + 1U) * 0x9E3779B9U);
+
+    return (seed != 0U) ? seed : 1U;
+}
+
+/**
+ * @brief Next value of a thread's xorshift32 generator
+ */
+static inline uint32_t stress_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+/**
+ * @brief Randomly give up the CPU between two operations
+ * @details About half the calls return at once; the rest yield, spin for
+ * up to STRESS_MAX_SPIN_US (so the time slice may expire mid-operation of
+ * the next call) or, rarely, sleep for one tick.
+ */
+static inline void stress_perturb(uint32_t *state)
+{
+    uint32_t r = stress_rand(state);
+
+    switch (r & 0x3FU) {
+    case 0:
+        k_sleep(K_TICKS(1));
+        break;
+    case 1 ... 15:
+        k_yield();
+        break;
+    case 16 ... 27:
+        k_busy_wait((r >> 8) % STRESS_MAX_SPIN_US);
+        break;
+    default:
+        break;
+    }
+}
+
+#endif /* STRESS_H */
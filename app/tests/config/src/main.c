@@ -0,0 +1,549 @@
+/**
+ * @file main.c
+ * @brief config test suite
+ * @details Covers per-key validation, the power-management/sampling-rate
+ * constraint, all-or-nothing transactions and coalesced change
+ * notification, then stresses the store with writers committing linked
+ * keys and lock-free readers under randomized preemption. A reader that
+ * brackets its reads with config_read_begin()/config_read_retry() must
+ * never see the keys of two different commits, nor a rejected commit.
+ *
+ * The default scenario has no NVS, so config_load()/config_save() report
+ * CONFIG_ERROR_STORAGE and the persistence test is skipped. The .nvs
+ * scenario (nvs.conf) stores the keys on a simulated flash partition and
+ * checks that saved values, and only those, survive a re-init.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "config.h"
+#include "diagnostics.h"
+#include "stress.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+#define WRITERS                2U
+#define READERS                3U
+#define COMMITS_PER_WRITER     400U
+#define READS_PER_READER       3000U
+#define MAX_THREADS            (WRITERS + READERS + 1U)
+
+/** @brief Size of the alert threshold blob */
+#define THRESHOLDS_SIZE        16U
+
+/*
+ * Every commit of the stress writers sets the sampling rate and derives the
+ * communication interval and every alert threshold from it, so one read of
+ * all three tells whether they came from the same commit. The thresholds
+ * stay inside each sensor's range (HR, Temp, Motion, SpO2).
+ */
+#define LINKED_INTERVAL(rate)  (1000U + (rate) * 100U)
+#define LINKED_HR(rate)        (30U + (rate) % 221U)
+#define LINKED_TEMP(rate)      (34U + (rate) % 10U)
+#define LINKED_MOTION(rate)    (1U + (rate) % 16U)
+#define LINKED_SPO2(rate)      (70U + (rate) % 31U)
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+K_THREAD_STACK_ARRAY_DEFINE(stress_stacks, MAX_THREADS, STRESS_STACK_SIZE);
+static struct k_thread stress_threads[MAX_THREADS];
+
+/** @brief What the observer has been told since the last reset */
+static struct {
+    atomic_t calls;
+    atomic_t keys;
+} notified;
+
+/** @brief Shared state of a stress run */
+static struct {
+    atomic_t writers_done;
+    atomic_t commits;               /* Accepted commits */
+    atomic_t rejected;              /* Commits refused by the cross-key check */
+    atomic_t failures;              /* Calls that returned an unexpected code */
+    atomic_t torn;                  /* Reads mixing two commits */
+    atomic_t violations;            /* Reads showing a rejected configuration */
+    atomic_t retries;
+} run;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void observer(uint32_t changed_keys, void *user_data);
+static void wait_notified(void);
+static void writer_thread(void *arg1, void *arg2, void *arg3);
+static void rejected_writer_thread(void *arg1, void *arg2, void *arg3);
+static void reader_thread(void *arg1, void *arg2, void *arg3);
+static void put_thresholds(uint8_t *blob, uint32_t hr, uint32_t temp, uint32_t motion,
+                           uint32_t spo2);
+static void linked_thresholds(uint32_t rate, uint8_t *blob);
+
+/*============================================================================*/
+/* Fixtures                                                                   */
+/*============================================================================*/
+
+static void *config_suite_setup(void)
+{
+    diagnostics_init();
+    /* Without storage, autosave warns on every batch */
+    diagnostics_set_log_level(LOG_LEVEL_ERROR);
+
+    zassert_equal(config_init(), CONFIG_OK);
+    zassert_equal(config_add_observer(observer, 0xFFFFFFFFU, NULL), CONFIG_OK);
+
+    return NULL;
+}
+
+static void config_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_equal(config_reset_to_defaults(), CONFIG_OK);
+
+    /* Let the reset's own notification go out before counting */
+    wait_notified();
+    atomic_clear(&notified.calls);
+    atomic_clear(&notified.keys);
+}
+
+/*============================================================================*/
+/* Single-Thread Tests                                                        */
+/*============================================================================*/
+
+ZTEST(config, test_defaults_and_key_checks)
+{
+    uint32_t value;
+    bool enabled;
+
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &value), CONFIG_OK);
+    zassert_equal(value, 100);
+    zassert_equal(config_get_bool(CONFIG_KEY_POWER_MANAGEMENT, &enabled), CONFIG_OK);
+    zassert_true(enabled);
+
+    zassert_equal(config_set_uint32(CONFIG_KEY_DEVICE_ID, 1), CONFIG_ERROR_READ_ONLY);
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 0), CONFIG_ERROR_VALIDATION);
+    zassert_equal(config_set_uint32(CONFIG_KEY_COMMUNICATION_INTERVAL, 999),
+                  CONFIG_ERROR_VALIDATION);
+    zassert_equal(config_set_bool(CONFIG_KEY_SAMPLING_RATE, true), CONFIG_ERROR_INVALID,
+                  "type mismatch");
+    zassert_equal(config_get_uint32(CONFIG_KEY_POWER_MANAGEMENT, &value), CONFIG_ERROR_INVALID);
+
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 200), CONFIG_OK);
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &value), CONFIG_OK);
+    zassert_equal(value, 200);
+}
+
+ZTEST(config, test_power_save_caps_sampling_rate)
+{
+    uint32_t value;
+
+    /* Power management is on by default */
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, CONFIG_POWER_SAVE_MAX_RATE_HZ),
+                  CONFIG_OK);
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, CONFIG_POWER_SAVE_MAX_RATE_HZ + 1),
+                  CONFIG_ERROR_VALIDATION);
+
+    zassert_equal(config_set_bool(CONFIG_KEY_POWER_MANAGEMENT, false), CONFIG_OK);
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 1000), CONFIG_OK);
+
+    /* Turning it back on would now break the cap */
+    zassert_equal(config_set_bool(CONFIG_KEY_POWER_MANAGEMENT, true), CONFIG_ERROR_VALIDATION);
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &value), CONFIG_OK);
+    zassert_equal(value, 1000);
+
+    zassert_true(config_get_restart_pending() & CONFIG_KEY_BIT(CONFIG_KEY_POWER_MANAGEMENT),
+                 "power management applies after restart");
+}
+
+ZTEST(config, test_transaction_all_or_nothing)
+{
+    config_txn_t txn;
+    uint32_t version = config_get_version();
+    uint32_t rate, interval;
+
+    /* Each value is valid alone; together with power management on they conflict */
+    zassert_equal(config_begin(&txn), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_COMMUNICATION_INTERVAL, 2000), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_SAMPLING_RATE, 500), CONFIG_OK);
+    zassert_equal(config_commit(&txn), CONFIG_ERROR_VALIDATION);
+
+    zassert_equal(config_get_uint32(CONFIG_KEY_COMMUNICATION_INTERVAL, &interval), CONFIG_OK);
+    zassert_equal(interval, 15000, "part of a rejected transaction was applied");
+    zassert_equal(config_get_version(), version, "a rejected commit moved the version");
+
+    /* The same batch with the constraint lifted goes in as one update */
+    zassert_equal(config_begin(&txn), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_COMMUNICATION_INTERVAL, 2000), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_SAMPLING_RATE, 500), CONFIG_OK);
+    zassert_equal(config_txn_set_bool(&txn, CONFIG_KEY_POWER_MANAGEMENT, false), CONFIG_OK);
+    zassert_equal(config_commit(&txn), CONFIG_OK);
+
+    zassert_equal(config_get_version(), version + 1U);
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &rate), CONFIG_OK);
+    zassert_equal(config_get_uint32(CONFIG_KEY_COMMUNICATION_INTERVAL, &interval), CONFIG_OK);
+    zassert_equal(rate, 500);
+    zassert_equal(interval, 2000);
+
+    /* Staging checks each key on its own; an aborted batch leaves no trace */
+    zassert_equal(config_begin(&txn), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_DEVICE_ID, 1), CONFIG_ERROR_READ_ONLY);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_SAMPLING_RATE, 1001),
+                  CONFIG_ERROR_VALIDATION);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_SAMPLING_RATE, 10), CONFIG_OK);
+    config_abort(&txn);
+    zassert_equal(config_commit(&txn), CONFIG_OK);
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &rate), CONFIG_OK);
+    zassert_equal(rate, 500);
+}
+
+ZTEST(config, test_blob_round_trip)
+{
+    uint8_t blob[THRESHOLDS_SIZE];
+    uint8_t out[THRESHOLDS_SIZE + 4];
+    size_t len;
+
+    put_thresholds(blob, 130U, 39U, 0U, 90U);
+
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, 8), CONFIG_ERROR_VALIDATION,
+                  "thresholds need four words");
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)), CONFIG_OK);
+
+    zassert_equal(config_get_blob(CONFIG_KEY_ALERT_THRESHOLDS, out, sizeof(out), &len), CONFIG_OK);
+    zassert_equal(len, sizeof(blob));
+    zassert_mem_equal(out, blob, sizeof(blob));
+
+    zassert_equal(config_get_blob(CONFIG_KEY_ALERT_THRESHOLDS, out, 4, &len),
+                  CONFIG_ERROR_INVALID, "destination too small");
+    zassert_equal(len, sizeof(blob));
+}
+
+ZTEST(config, test_alert_threshold_ranges)
+{
+    uint8_t blob[THRESHOLDS_SIZE];
+
+    put_thresholds(blob, 0U, 0U, 0U, 0U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)), CONFIG_OK,
+                  "0 disables an alert");
+
+    put_thresholds(blob, 250U, 43U, 16U, 100U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)), CONFIG_OK);
+
+    put_thresholds(blob, 251U, 43U, 16U, 100U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)),
+                  CONFIG_ERROR_VALIDATION, "heart rate above range");
+
+    put_thresholds(blob, 120U, 100U, 16U, 100U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)),
+                  CONFIG_ERROR_VALIDATION, "temperature above range");
+
+    put_thresholds(blob, 120U, 38U, 150U, 100U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)),
+                  CONFIG_ERROR_VALIDATION, "motion above range");
+
+    put_thresholds(blob, 120U, 38U, 8U, 101U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)),
+                  CONFIG_ERROR_VALIDATION, "SpO2 above 100%");
+
+    put_thresholds(blob, 120U, 38U, 8U, 50U);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)),
+                  CONFIG_ERROR_VALIDATION, "SpO2 below range");
+}
+
+ZTEST(config, test_observer_coalesces_changes)
+{
+    config_txn_t txn;
+
+    /* Changes well inside the notify delay of each other: one call */
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 10), CONFIG_OK);
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 20), CONFIG_OK);
+    zassert_equal(config_begin(&txn), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_COMMUNICATION_INTERVAL, 5000), CONFIG_OK);
+    zassert_equal(config_txn_set_uint32(&txn, CONFIG_KEY_DIAGNOSTIC_LEVEL, 3), CONFIG_OK);
+    zassert_equal(config_commit(&txn), CONFIG_OK);
+
+    wait_notified();
+    zassert_equal(atomic_get(&notified.calls), 1);
+    zassert_equal((uint32_t)atomic_get(&notified.keys),
+                  CONFIG_KEY_BIT(CONFIG_KEY_SAMPLING_RATE) |
+                  CONFIG_KEY_BIT(CONFIG_KEY_COMMUNICATION_INTERVAL) |
+                  CONFIG_KEY_BIT(CONFIG_KEY_DIAGNOSTIC_LEVEL));
+
+    /* Writing the current value is not a change */
+    atomic_clear(&notified.calls);
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 20), CONFIG_OK);
+    wait_notified();
+    zassert_equal(atomic_get(&notified.calls), 0);
+}
+
+ZTEST(config, test_persistence_across_reinit)
+{
+    uint8_t blob[THRESHOLDS_SIZE];
+    uint8_t out[THRESHOLDS_SIZE];
+    size_t len;
+    uint32_t rate;
+
+    Z_TEST_SKIP_IFNDEF(CONFIG_NVS);
+
+    /* As at boot: stamps the format version the next load checks */
+    zassert_equal(config_load(), CONFIG_OK);
+
+    put_thresholds(blob, 120U, 39U, 4U, 92U);
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 200), CONFIG_OK);
+    zassert_equal(config_set_blob(CONFIG_KEY_ALERT_THRESHOLDS, blob, sizeof(blob)), CONFIG_OK);
+    zassert_equal(config_save(), CONFIG_OK);
+
+    /* Its autosave is still CONFIG_SAVE_DELAY_MS away when the re-init drops it */
+    zassert_equal(config_set_uint32(CONFIG_KEY_SAMPLING_RATE, 150), CONFIG_OK);
+
+    zassert_equal(config_deinit(), CONFIG_OK);
+    zassert_equal(config_init(), CONFIG_OK);
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &rate), CONFIG_OK);
+    zassert_equal(rate, 100, "init starts from the defaults");
+
+    zassert_equal(config_load(), CONFIG_OK);
+    zassert_equal(config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &rate), CONFIG_OK);
+    zassert_equal(rate, 200, "the saved value, not the unsaved one, comes back");
+    zassert_equal(config_get_blob(CONFIG_KEY_ALERT_THRESHOLDS, out, sizeof(out), &len), CONFIG_OK);
+    zassert_equal(len, sizeof(blob));
+    zassert_mem_equal(out, blob, sizeof(blob));
+
+    /* The re-init dropped the suite's observer */
+    zassert_equal(config_add_observer(observer, 0xFFFFFFFFU, NULL), CONFIG_OK);
+
+    /* Defaults have no record: leave the partition clean for the next run */
+    zassert_equal(config_reset_to_defaults(), CONFIG_OK);
+    zassert_equal(config_save(), CONFIG_OK);
+}
+
+/*============================================================================*/
+/* Stress Tests                                                               */
+/*============================================================================*/
+
+/**
+ * @brief Linked commits against lock-free readers: no torn or rejected state
+ */
+ZTEST(config, test_stress_seqlock_readers)
+{
+    uint32_t version = config_get_version();
+
+    memset(&run, 0, sizeof(run));
+
+    TC_PRINT("seed 0x%08x, %u writers, %u readers\n", STRESS_SEED, WRITERS, READERS);
+
+    for (uint32_t i = 0; i < MAX_THREADS; i++) {
+        k_thread_entry_t entry = (i < WRITERS) ? writer_thread :
+                                 (i == WRITERS) ? rejected_writer_thread : reader_thread;
+
+        k_thread_create(&stress_threads[i], stress_stacks[i],
+                        K_THREAD_STACK_SIZEOF(stress_stacks[i]), entry,
+                        (void *)(uintptr_t)i, NULL, NULL,
+                        STRESS_THREAD_PRIORITY, 0, K_NO_WAIT);
+    }
+
+    for (uint32_t i = 0; i < MAX_THREADS; i++) {
+        k_thread_join(&stress_threads[i], K_FOREVER);
+    }
+
+    TC_PRINT("%u commits, %u rejected, %u reader retries\n",
+             (uint32_t)atomic_get(&run.commits), (uint32_t)atomic_get(&run.rejected),
+             (uint32_t)atomic_get(&run.retries));
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(atomic_get(&run.torn), 0, "reads mixing two commits");
+    zassert_equal(atomic_get(&run.violations), 0, "reads showing a rejected commit");
+    zassert_equal(atomic_get(&run.commits), WRITERS * COMMITS_PER_WRITER);
+    zassert_equal(atomic_get(&run.rejected), COMMITS_PER_WRITER);
+
+    /* One version step per accepted commit, none for the rejected ones */
+    zassert_equal(config_get_version() - version, WRITERS * COMMITS_PER_WRITER);
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+static void observer(uint32_t changed_keys, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    atomic_inc(&notified.calls);
+    atomic_or(&notified.keys, (atomic_val_t)changed_keys);
+}
+
+/**
+ * @brief Wait until a pending change notification has been delivered
+ */
+static void wait_notified(void)
+{
+    k_sleep(K_MSEC(CONFIG_NOTIFY_DELAY_MS * 3));
+}
+
+/**
+ * @brief Commit linked rate/interval/threshold batches within the power-save cap
+ */
+static void writer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint8_t thresholds[THRESHOLDS_SIZE];
+    config_txn_t txn;
+
+    for (uint32_t i = 0; i < COMMITS_PER_WRITER; i++) {
+        uint32_t rate = 1U + (stress_rand(&rng) % CONFIG_POWER_SAVE_MAX_RATE_HZ);
+
+        linked_thresholds(rate, thresholds);
+
+        if (config_begin(&txn) != CONFIG_OK ||
+            config_txn_set_uint32(&txn, CONFIG_KEY_SAMPLING_RATE, rate) != CONFIG_OK ||
+            config_txn_set_uint32(&txn, CONFIG_KEY_COMMUNICATION_INTERVAL,
+                                  LINKED_INTERVAL(rate)) != CONFIG_OK ||
+            config_txn_set_blob(&txn, CONFIG_KEY_ALERT_THRESHOLDS, thresholds,
+                                sizeof(thresholds)) != CONFIG_OK) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        stress_perturb(&rng);
+
+        if (config_commit(&txn) != CONFIG_OK) {
+            atomic_inc(&run.failures);
+            break;
+        }
+        atomic_inc(&run.commits);
+
+        stress_perturb(&rng);
+    }
+
+    atomic_inc(&run.writers_done);
+}
+
+/**
+ * @brief Commit linked batches above the power-save cap; every one must be refused
+ */
+static void rejected_writer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint8_t thresholds[THRESHOLDS_SIZE];
+    config_txn_t txn;
+
+    for (uint32_t i = 0; i < COMMITS_PER_WRITER; i++) {
+        uint32_t rate = CONFIG_POWER_SAVE_MAX_RATE_HZ + 1U +
+                        (stress_rand(&rng) % (1000U - CONFIG_POWER_SAVE_MAX_RATE_HZ));
+
+        linked_thresholds(rate, thresholds);
+
+        if (config_begin(&txn) != CONFIG_OK ||
+            config_txn_set_uint32(&txn, CONFIG_KEY_COMMUNICATION_INTERVAL, 1000U) != CONFIG_OK ||
+            config_txn_set_blob(&txn, CONFIG_KEY_ALERT_THRESHOLDS, thresholds,
+                                sizeof(thresholds)) != CONFIG_OK ||
+            config_txn_set_uint32(&txn, CONFIG_KEY_SAMPLING_RATE, rate) != CONFIG_OK) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        if (config_commit(&txn) != CONFIG_ERROR_VALIDATION) {
+            atomic_inc(&run.failures);
+            break;
+        }
+        atomic_inc(&run.rejected);
+
+        stress_perturb(&rng);
+    }
+}
+
+/**
+ * @brief Read the linked keys without locking and check they belong together
+ */
+static void reader_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint32_t last_version = 0;
+
+    for (uint32_t i = 0; i < READS_PER_READER && atomic_get(&run.writers_done) < WRITERS; i++) {
+        uint8_t thresholds[THRESHOLDS_SIZE];
+        uint32_t rate, interval;
+        size_t len;
+        uint32_t seq;
+        bool ok;
+
+        for (;;) {
+            seq = config_read_begin();
+
+            ok = config_get_uint32(CONFIG_KEY_SAMPLING_RATE, &rate) == CONFIG_OK;
+            stress_perturb(&rng);
+            ok = ok && config_get_uint32(CONFIG_KEY_COMMUNICATION_INTERVAL,
+                                         &interval) == CONFIG_OK;
+            ok = ok && config_get_blob(CONFIG_KEY_ALERT_THRESHOLDS, thresholds,
+                                       sizeof(thresholds), &len) == CONFIG_OK;
+
+            if (!config_read_retry(seq)) {
+                break;
+            }
+            atomic_inc(&run.retries);
+        }
+
+        if (!ok || len != sizeof(thresholds)) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        /* The defaults are a consistent state too, until the first commit lands */
+        bool defaults = rate == 100U && interval == 15000U;
+
+        if (rate > CONFIG_POWER_SAVE_MAX_RATE_HZ) {
+            atomic_inc(&run.violations);
+        } else if (!defaults) {
+            uint8_t expected[THRESHOLDS_SIZE];
+
+            linked_thresholds(rate, expected);
+            if (interval != LINKED_INTERVAL(rate) ||
+                memcmp(thresholds, expected, sizeof(expected)) != 0) {
+                atomic_inc(&run.torn);
+            }
+        }
+
+        /* The version never goes backwards */
+        if (seq / 2U < last_version) {
+            atomic_inc(&run.torn);
+        }
+        last_version = seq / 2U;
+
+        stress_perturb(&rng);
+    }
+}
+
+static void put_thresholds(uint8_t *blob, uint32_t hr, uint32_t temp, uint32_t motion,
+                           uint32_t spo2)
+{
+    sys_put_le32(hr, &blob[0]);
+    sys_put_le32(temp, &blob[4]);
+    sys_put_le32(motion, &blob[8]);
+    sys_put_le32(spo2, &blob[12]);
+}
+
+static void linked_thresholds(uint32_t rate, uint8_t *blob)
+{
+    put_thresholds(blob, LINKED_HR(rate), LINKED_TEMP(rate), LINKED_MOTION(rate),
+                   LINKED_SPO2(rate));
+}
+
+ZTEST_SUITE(config, NULL, config_suite_setup, config_before, NULL, NULL);
@@ -0,0 +1,306 @@
+/**
+ * @file main.c
+ * @brief medical_device test suite
+ * @details Covers the monitoring state gate, drop accounting on a full
+ * sensor queue and threshold alerts, then stresses the sensor path the way
+ * the application uses it: several producers (sensor hub, pipeline
+ * benchmark source) feeding medical_device_add_sensor_data() and a single
+ * consumer draining it, under randomized preemption. Every accepted sample
+ * must come out once, intact and in per-producer order, and the device
+ * statistics must account for every sample that was offered.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "medical_device.h"
+#include "diagnostics.h"
+#include "stress.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+#define PRODUCERS              3U
+#define SAMPLES_PER_PRODUCER   2000U
+#define MAX_THREADS            (PRODUCERS + 1U)
+
+/* Producer in flags, sequence in timestamp, both folded into value as a check */
+#define SAMPLE_VALUE(producer, seq)   ((float)((producer) * 100000U + (seq)))
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static const device_config_t test_config = {
+    .sampling_rate_hz = 100U,
+    .alert_thresholds = { 0U },         /* No alerts unless a test sets them */
+    .safety_monitoring_enabled = true,
+    .watchdog_timeout_ms = 5000U,
+};
+
+K_THREAD_STACK_ARRAY_DEFINE(stress_stacks, MAX_THREADS, STRESS_STACK_SIZE);
+static struct k_thread stress_threads[MAX_THREADS];
+
+/** @brief Shared state of a stress run */
+static struct {
+    atomic_t producers_done;
+    atomic_t failures;                          /* Unexpected return codes */
+    uint32_t accepted[PRODUCERS];
+    uint32_t rejected[PRODUCERS];
+    uint32_t received[PRODUCERS];
+    uint32_t corrupt;                           /* Samples that do not decode */
+    uint32_t order_errors;
+} run;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static sensor_data_t make_sample(uint32_t producer, uint32_t seq);
+static void producer_thread(void *arg1, void *arg2, void *arg3);
+static void consumer_thread(void *arg1, void *arg2, void *arg3);
+
+/*============================================================================*/
+/* Fixtures                                                                   */
+/*============================================================================*/
+
+static void *medical_device_suite_setup(void)
+{
+    diagnostics_init();
+    /* Drop warnings are expected here; keep the console to failures */
+    diagnostics_set_log_level(LOG_LEVEL_ERROR);
+
+    return NULL;
+}
+
+static void medical_device_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_equal(medical_device_init(&test_config), MEDICAL_OK);
+    zassert_equal(medical_device_start_monitoring(), MEDICAL_OK);
+}
+
+/*============================================================================*/
+/* Single-Thread Tests                                                        */
+/*============================================================================*/
+
+ZTEST(medical_device, test_rejects_samples_unless_monitoring)
+{
+    sensor_data_t sample = make_sample(0, 0);
+    device_stats_t stats;
+
+    zassert_equal(medical_device_add_sensor_data(NULL), MEDICAL_ERROR_SENSOR);
+
+    zassert_equal(medical_device_stop_monitoring(), MEDICAL_OK);
+    zassert_equal(medical_device_add_sensor_data(&sample), MEDICAL_ERROR_SAFETY);
+
+    /* Refused by state, not by a full queue: not a drop */
+    zassert_equal(medical_device_get_stats(&stats), MEDICAL_OK);
+    zassert_equal(stats.total_samples, 0);
+    zassert_equal(stats.dropped_samples, 0);
+}
+
+ZTEST(medical_device, test_full_queue_drops_newest)
+{
+    sensor_data_t sample;
+    device_stats_t stats;
+
+    for (uint32_t seq = 0; seq < MEDICAL_SENSOR_QUEUE_CAPACITY; seq++) {
+        sample = make_sample(0, seq);
+        zassert_equal(medical_device_add_sensor_data(&sample), MEDICAL_OK);
+    }
+
+    for (uint32_t seq = MEDICAL_SENSOR_QUEUE_CAPACITY;
+         seq < MEDICAL_SENSOR_QUEUE_CAPACITY + 5U; seq++) {
+        sample = make_sample(0, seq);
+        zassert_equal(medical_device_add_sensor_data(&sample), MEDICAL_ERROR_SENSOR);
+    }
+
+    zassert_equal(medical_device_get_stats(&stats), MEDICAL_OK);
+    zassert_equal(stats.total_samples, MEDICAL_SENSOR_QUEUE_CAPACITY);
+    zassert_equal(stats.dropped_samples, 5);
+
+    /* The queued samples are the oldest ones, intact and in order */
+    for (uint32_t seq = 0; seq < MEDICAL_SENSOR_QUEUE_CAPACITY; seq++) {
+        zassert_equal(medical_device_get_sensor_data(&sample), MEDICAL_OK);
+        zassert_equal(sample.timestamp, seq);
+        zassert_equal(sample.value, SAMPLE_VALUE(0, seq));
+    }
+    zassert_equal(medical_device_get_sensor_data(&sample), MEDICAL_ERROR_SENSOR);
+}
+
+ZTEST(medical_device, test_threshold_raises_alert)
+{
+    device_config_t config = test_config;
+    sensor_data_t sample = make_sample(0, 7);
+    medical_alert_t alert;
+    device_stats_t stats;
+
+    config.alert_thresholds[SENSOR_TYPE_HEART_RATE] = 120U;
+    zassert_equal(medical_device_reconfigure(&config), MEDICAL_OK);
+
+    sample.value = 120.0f;
+    zassert_equal(medical_device_add_sensor_data(&sample), MEDICAL_OK);
+    zassert_false(medical_device_check_alerts(&alert), "at the threshold is not above it");
+
+    sample.value = 150.0f;
+    zassert_equal(medical_device_add_sensor_data(&sample), MEDICAL_OK);
+    zassert_true(medical_device_check_alerts(&alert));
+    zassert_equal(alert.level, ALERT_LEVEL_WARNING);
+    zassert_equal(alert.sensor_type, SENSOR_TYPE_HEART_RATE);
+    zassert_equal(alert.timestamp, 7);
+    zassert_false(medical_device_check_alerts(&alert));
+
+    zassert_equal(medical_device_get_stats(&stats), MEDICAL_OK);
+    zassert_equal(stats.alert_count, 1);
+}
+
+/*============================================================================*/
+/* Stress Tests                                                               */
+/*============================================================================*/
+
+/**
+ * @brief Producers against the single consumer: drops accounted, nothing else lost
+ */
+ZTEST(medical_device, test_stress_sensor_path)
+{
+    uint32_t accepted = 0, rejected = 0;
+    device_stats_t stats;
+
+    memset(&run, 0, sizeof(run));
+
+    TC_PRINT("seed 0x%08x, %u producers, %u samples each\n",
+             STRESS_SEED, PRODUCERS, SAMPLES_PER_PRODUCER);
+
+    for (uint32_t i = 0; i < MAX_THREADS; i++) {
+        k_thread_create(&stress_threads[i], stress_stacks[i],
+                        K_THREAD_STACK_SIZEOF(stress_stacks[i]),
+                        (i < PRODUCERS) ? producer_thread : consumer_thread,
+                        (void *)(uintptr_t)i, NULL, NULL,
+                        STRESS_THREAD_PRIORITY, 0, K_NO_WAIT);
+    }
+
+    for (uint32_t i = 0; i < MAX_THREADS; i++) {
+        k_thread_join(&stress_threads[i], K_FOREVER);
+    }
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(run.corrupt, 0, "samples overwritten while queued");
+    zassert_equal(run.order_errors, 0, "samples out of order");
+
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        zassert_equal(run.accepted[p] + run.rejected[p], SAMPLES_PER_PRODUCER);
+        zassert_equal(run.received[p], run.accepted[p],
+                      "producer %u: %u accepted, %u received",
+                      p, run.accepted[p], run.received[p]);
+        accepted += run.accepted[p];
+        rejected += run.rejected[p];
+    }
+
+    TC_PRINT("%u accepted, %u dropped\n", accepted, rejected);
+
+    zassert_equal(medical_device_get_stats(&stats), MEDICAL_OK);
+    zassert_equal(stats.total_samples, accepted);
+    zassert_equal(stats.dropped_samples, rejected);
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+static sensor_data_t make_sample(uint32_t producer, uint32_t seq)
+{
+    sensor_data_t sample = {
+        .type = SENSOR_TYPE_HEART_RATE,
+        .value = SAMPLE_VALUE(producer, seq),
+        .timestamp = seq,
+        .quality = 100U,
+        .flags = (uint16_t)producer,
+    };
+
+    return sample;
+}
+
+/**
+ * @brief Offer SAMPLES_PER_PRODUCER samples; a full queue drops, never blocks
+ */
+static void producer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t producer = (uint32_t)(uintptr_t)arg1;
+    uint32_t rng = stress_seed(producer);
+
+    for (uint32_t seq = 0; seq < SAMPLES_PER_PRODUCER; seq++) {
+        sensor_data_t sample = make_sample(producer, seq);
+        int ret = medical_device_add_sensor_data(&sample);
+
+        if (ret == MEDICAL_OK) {
+            run.accepted[producer]++;
+        } else if (ret == MEDICAL_ERROR_SENSOR) {
+            run.rejected[producer]++;
+        } else {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        stress_perturb(&rng);
+    }
+
+    atomic_inc(&run.producers_done);
+}
+
+/**
+ * @brief Drain the sensor queue until the producers are done and it is empty
+ */
+static void consumer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    int64_t last_seq[PRODUCERS];
+
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        last_seq[p] = -1;
+    }
+
+    for (;;) {
+        bool done = atomic_get(&run.producers_done) == PRODUCERS;
+        sensor_data_t sample;
+
+        if (medical_device_get_sensor_data(&sample) != MEDICAL_OK) {
+            if (done) {
+                break;
+            }
+            stress_perturb(&rng);
+            continue;
+        }
+
+        uint32_t producer = sample.flags;
+
+        if (producer >= PRODUCERS || sample.timestamp >= SAMPLES_PER_PRODUCER ||
+            sample.value != SAMPLE_VALUE(producer, sample.timestamp)) {
+            run.corrupt++;
+            continue;
+        }
+
+        if ((int64_t)sample.timestamp <= last_seq[producer]) {
+            run.order_errors++;
+        }
+        last_seq[producer] = sample.timestamp;
+        run.received[producer]++;
+
+        stress_perturb(&rng);
+    }
+}
+
+ZTEST_SUITE(medical_device, NULL, medical_device_suite_setup, medical_device_before, NULL, NULL);
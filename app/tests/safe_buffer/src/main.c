@@ -0,0 +1,644 @@
+/**
+ * @file main.c
+ * @brief safe_buffer test suite
+ * @details Covers partial writes and wrap-around in the default mode, the
+ * overwrite-mode invariants of safe_buffer_write_nb() against a reference
+ * model, and stresses the buffer from several threads under randomized
+ * preemption: a byte stream must arrive intact and in order, one-byte
+ * writers must keep their order, and an overwriting writer must only ever
+ * lose bytes when the overflow counter says so.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "safe_buffer.h"
+#include "stress.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Capacity of the buffer under test (odd, so chunks straddle the wrap) */
+#define BUFFER_CAPACITY        61U
+
+/** @brief Random write_nb calls checked against the overwrite model */
+#define MODEL_STEPS            2000U
+
+/** @brief Bytes moved by the byte-stream stress run */
+#define STREAM_BYTES           20000U
+
+/** @brief Largest single write or read of the stress runs */
+#define MAX_CHUNK              24U
+
+/** @brief One-byte writers: the top bits of each byte name the writer */
+#define BYTE_WRITERS           4U
+#define BYTES_PER_WRITER       1500U
+#define WRITER_SHIFT           6U
+#define WRITER_SEQ_MASK        0x3FU
+
+/** @brief Writes issued by the overwriting writer */
+#define OVERWRITE_WRITES       3000U
+
+#define MAX_THREADS            (BYTE_WRITERS + 1U)
+
+/** @brief Reader wait before re-checking whether the writers are done */
+#define READER_POLL_MS         20
+
+/** @brief Byte at a given stream offset */
+#define STREAM_BYTE(offset)    ((uint8_t)((offset) ^ ((offset) >> 8)))
+
+/** @brief Byte at a given offset of the overwritten stream (consecutive values) */
+#define COUNTER_BYTE(offset)   ((uint8_t)(offset))
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static safe_buffer_t buffer;
+static uint8_t storage[BUFFER_CAPACITY];
+
+K_THREAD_STACK_ARRAY_DEFINE(stress_stacks, MAX_THREADS, STRESS_STACK_SIZE);
+static struct k_thread stress_threads[MAX_THREADS];
+
+/** @brief Shared state of a stress run */
+static struct {
+    atomic_t writers_done;
+    atomic_t failures;              /* Calls that returned an unexpected code */
+    atomic_t corrupt;               /* Bytes that do not match the stream */
+    uint32_t writes;                /* Successful write calls */
+    uint32_t reads;                 /* Successful read calls */
+    uint32_t bytes_written;
+    uint32_t bytes_read;
+    uint32_t gaps;                  /* Discontinuities seen by the reader */
+} run;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void start_threads(k_thread_entry_t writer, uint32_t writers, k_thread_entry_t reader);
+static void join_threads(uint32_t count);
+static void stream_writer(void *arg1, void *arg2, void *arg3);
+static void stream_reader(void *arg1, void *arg2, void *arg3);
+static void byte_writer(void *arg1, void *arg2, void *arg3);
+static void byte_reader(void *arg1, void *arg2, void *arg3);
+static void overwrite_writer(void *arg1, void *arg2, void *arg3);
+static void overwrite_reader(void *arg1, void *arg2, void *arg3);
+
+/*============================================================================*/
+/* Single-Thread Tests                                                        */
+/*============================================================================*/
+
+ZTEST(safe_buffer, test_init_rejects_invalid)
+{
+    uint8_t byte = 0;
+    size_t n;
+
+    zassert_equal(safe_buffer_init(NULL, storage, sizeof(storage), false), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_init(&buffer, NULL, sizeof(storage), false), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_init(&buffer, storage, 0, false), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), false), BUFFER_OK);
+
+    zassert_equal(safe_buffer_write_nb(&buffer, NULL, 1, &n), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_write_nb(&buffer, &byte, 0, &n), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_read_nb(&buffer, &byte, 1, &n), BUFFER_ERROR_EMPTY);
+    zassert_equal(n, 0);
+}
+
+ZTEST(safe_buffer, test_partial_write_when_full)
+{
+    uint8_t in[BUFFER_CAPACITY + 10];
+    uint8_t out[BUFFER_CAPACITY + 10];
+    uint32_t writes, reads, overflows;
+    size_t n;
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = STREAM_BYTE(i);
+    }
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), false), BUFFER_OK);
+
+    /* Only what fits is written, and the caller is told how much */
+    zassert_equal(safe_buffer_write_nb(&buffer, in, sizeof(in), &n), BUFFER_OK);
+    zassert_equal(n, BUFFER_CAPACITY);
+    zassert_true(safe_buffer_is_full(&buffer));
+
+    zassert_equal(safe_buffer_write_nb(&buffer, in, 1, &n), BUFFER_ERROR_FULL);
+    zassert_equal(n, 0);
+    zassert_equal(safe_buffer_write(&buffer, in, 1, K_MSEC(10), &n), BUFFER_ERROR_TIMEOUT);
+
+    zassert_equal(safe_buffer_read_nb(&buffer, out, sizeof(out), &n), BUFFER_OK);
+    zassert_equal(n, BUFFER_CAPACITY);
+    zassert_mem_equal(out, in, BUFFER_CAPACITY);
+
+    /* Rejected writes are neither writes nor overflows */
+    safe_buffer_get_stats(&buffer, &writes, &reads, &overflows);
+    zassert_equal(writes, 1);
+    zassert_equal(reads, 1);
+    zassert_equal(overflows, 0);
+}
+
+ZTEST(safe_buffer, test_wrap_around_and_spans)
+{
+    uint8_t in[40];
+    uint8_t out[40];
+    const uint8_t *span;
+    size_t length;
+    size_t n;
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = STREAM_BYTE(i + 100U);
+    }
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), false), BUFFER_OK);
+
+    /* Park head and tail 40 bytes in, then write across the end */
+    zassert_equal(safe_buffer_write_nb(&buffer, in, 40, &n), BUFFER_OK);
+    zassert_equal(safe_buffer_read_nb(&buffer, out, 40, &n), BUFFER_OK);
+    zassert_equal(safe_buffer_write_nb(&buffer, in, 40, &n), BUFFER_OK);
+    zassert_equal(n, 40);
+
+    /* The span stops at the end of storage; the rest follows from the start */
+    zassert_equal(safe_buffer_peek_span(&buffer, &span, &length), BUFFER_OK);
+    zassert_equal(length, BUFFER_CAPACITY - 40U);
+    zassert_mem_equal(span, in, length);
+    zassert_equal(safe_buffer_consume(&buffer, length + 1U), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_consume(&buffer, length), BUFFER_OK);
+
+    zassert_equal(safe_buffer_peek_span(&buffer, &span, &length), BUFFER_OK);
+    zassert_equal(length, 40U - (BUFFER_CAPACITY - 40U));
+    zassert_mem_equal(span, &in[BUFFER_CAPACITY - 40U], length);
+    zassert_equal(safe_buffer_consume(&buffer, length), BUFFER_OK);
+
+    zassert_true(safe_buffer_is_empty(&buffer));
+    zassert_equal(safe_buffer_peek_span(&buffer, &span, &length), BUFFER_ERROR_EMPTY);
+}
+
+/**
+ * @brief Overwrite mode against a model that keeps the newest bytes
+ * @details Every write_nb call must succeed and report the whole request as
+ * written, the buffer must hold min(previous + size, capacity) bytes, the
+ * overflow counter must go up by exactly one for each call that did not fit
+ * and the content must be the newest bytes in order.
+ */
+ZTEST(safe_buffer, test_overwrite_invariants)
+{
+    uint8_t model[BUFFER_CAPACITY];
+    size_t model_count = 0;
+    uint8_t in[2U * BUFFER_CAPACITY + 3U];
+    uint8_t out[BUFFER_CAPACITY];
+    uint32_t expected_writes = 0, expected_reads = 0, expected_overflows = 0;
+    uint32_t writes, reads, overflows;
+    uint32_t rng = stress_seed(0);
+    uint32_t offset = 0;
+    const uint8_t *span;
+    size_t length;
+    size_t n;
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), true), BUFFER_OK);
+
+    /* Zero-copy access is not offered while the writer may move the head */
+    zassert_equal(safe_buffer_peek_span(&buffer, &span, &length), BUFFER_ERROR_INVALID);
+    zassert_equal(safe_buffer_consume(&buffer, 0), BUFFER_ERROR_INVALID);
+
+    for (uint32_t step = 0; step < MODEL_STEPS; step++) {
+        uint32_t r = stress_rand(&rng);
+
+        if ((r & 3U) == 0U && model_count > 0) {
+            /* Read part of the content from the oldest end */
+            size_t want = 1U + ((r >> 8) % model_count);
+
+            zassert_equal(safe_buffer_read_nb(&buffer, out, want, &n), BUFFER_OK);
+            zassert_equal(n, want);
+            zassert_mem_equal(out, model, want, "step %u: wrong bytes read", step);
+
+            memmove(model, &model[want], model_count - want);
+            model_count -= want;
+            expected_reads++;
+        } else {
+            /* Writes of 1 byte up to twice the capacity */
+            size_t size = 1U + ((r >> 8) % sizeof(in));
+            bool overflow = size > BUFFER_CAPACITY - model_count;
+
+            for (size_t i = 0; i < size; i++) {
+                in[i] = STREAM_BYTE(offset + i);
+            }
+            offset += size;
+
+            zassert_equal(safe_buffer_write_nb(&buffer, in, size, &n), BUFFER_OK);
+            zassert_equal(n, size, "step %u: overwrite mode writes the whole request", step);
+
+            /* Model: append, then drop from the front to the capacity */
+            const uint8_t *src = in;
+            size_t keep = size;
+
+            if (keep > BUFFER_CAPACITY) {
+                src += keep - BUFFER_CAPACITY;
+                keep = BUFFER_CAPACITY;
+            }
+            if (model_count + keep > BUFFER_CAPACITY) {
+                size_t drop = model_count + keep - BUFFER_CAPACITY;
+
+                memmove(model, &model[drop], model_count - drop);
+                model_count -= drop;
+            }
+            memcpy(&model[model_count], src, keep);
+            model_count += keep;
+
+            expected_writes++;
+            expected_overflows += overflow ? 1U : 0U;
+        }
+
+        zassert_equal(safe_buffer_available(&buffer), model_count, "step %u", step);
+        zassert_equal(safe_buffer_free_space(&buffer), BUFFER_CAPACITY - model_count);
+
+        safe_buffer_get_stats(&buffer, &writes, &reads, &overflows);
+        zassert_equal(writes, expected_writes, "step %u", step);
+        zassert_equal(reads, expected_reads, "step %u", step);
+        zassert_equal(overflows, expected_overflows, "step %u", step);
+    }
+
+    /* Whatever is left is the newest bytes, oldest first */
+    if (model_count > 0) {
+        zassert_equal(safe_buffer_read_nb(&buffer, out, sizeof(out), &n), BUFFER_OK);
+        zassert_equal(n, model_count);
+        zassert_mem_equal(out, model, model_count);
+    }
+}
+
+ZTEST(safe_buffer, test_overwrite_oversized_write)
+{
+    uint8_t in[3U * BUFFER_CAPACITY];
+    uint8_t out[BUFFER_CAPACITY];
+    uint32_t overflows;
+    size_t n;
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = STREAM_BYTE(i);
+    }
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), true), BUFFER_OK);
+    zassert_equal(safe_buffer_write_nb(&buffer, in, 5, &n), BUFFER_OK);
+
+    /* One call larger than the buffer: one overflow, the last capacity bytes kept */
+    zassert_equal(safe_buffer_write_nb(&buffer, in, sizeof(in), &n), BUFFER_OK);
+    zassert_equal(n, sizeof(in));
+    zassert_true(safe_buffer_is_full(&buffer));
+
+    safe_buffer_get_stats(&buffer, NULL, NULL, &overflows);
+    zassert_equal(overflows, 1);
+
+    zassert_equal(safe_buffer_read_nb(&buffer, out, sizeof(out), &n), BUFFER_OK);
+    zassert_equal(n, BUFFER_CAPACITY);
+    zassert_mem_equal(out, &in[sizeof(in) - BUFFER_CAPACITY], BUFFER_CAPACITY);
+}
+
+/*============================================================================*/
+/* Stress Tests                                                               */
+/*============================================================================*/
+
+/**
+ * @brief One blocking writer, one blocking reader: the stream arrives intact
+ */
+ZTEST(safe_buffer, test_stress_stream)
+{
+    uint32_t writes, reads, overflows;
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), false), BUFFER_OK);
+
+    start_threads(stream_writer, 1U, stream_reader);
+    join_threads(2U);
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(atomic_get(&run.corrupt), 0, "bytes lost, duplicated or reordered");
+    zassert_equal(run.bytes_read, STREAM_BYTES);
+    zassert_true(safe_buffer_is_empty(&buffer));
+
+    safe_buffer_get_stats(&buffer, &writes, &reads, &overflows);
+    zassert_equal(writes, run.writes);
+    zassert_equal(reads, run.reads);
+    zassert_equal(overflows, 0);
+}
+
+/**
+ * @brief Several one-byte writers, one reader: every writer's bytes stay in order
+ */
+ZTEST(safe_buffer, test_stress_byte_writers)
+{
+    uint32_t writes, reads, overflows;
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), false), BUFFER_OK);
+
+    start_threads(byte_writer, BYTE_WRITERS, byte_reader);
+    join_threads(BYTE_WRITERS + 1U);
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(atomic_get(&run.corrupt), 0, "a writer's bytes lost or reordered");
+    zassert_equal(run.bytes_read, BYTE_WRITERS * BYTES_PER_WRITER);
+
+    safe_buffer_get_stats(&buffer, &writes, &reads, &overflows);
+    zassert_equal(writes, BYTE_WRITERS * BYTES_PER_WRITER);
+    zassert_equal(reads, run.reads);
+    zassert_equal(overflows, 0);
+}
+
+/**
+ * @brief Overwriting writer racing a reader: loss only ever comes with overflows
+ */
+ZTEST(safe_buffer, test_stress_overwrite)
+{
+    uint32_t writes, reads, overflows;
+
+    zassert_equal(safe_buffer_init(&buffer, storage, sizeof(storage), true), BUFFER_OK);
+
+    start_threads(overwrite_writer, 1U, overwrite_reader);
+    join_threads(2U);
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(atomic_get(&run.corrupt), 0, "a read returned non-contiguous bytes");
+
+    safe_buffer_get_stats(&buffer, &writes, &reads, &overflows);
+    zassert_equal(writes, OVERWRITE_WRITES);
+    zassert_equal(reads, run.reads);
+    zassert_true(overflows <= writes);
+    zassert_true(safe_buffer_available(&buffer) <= BUFFER_CAPACITY);
+
+    TC_PRINT("%u bytes written, %u read, %u overflows, %u gaps\n",
+             run.bytes_written, run.bytes_read, overflows, run.gaps);
+
+    if (overflows == 0U) {
+        zassert_equal(run.gaps, 0);
+        zassert_equal(run.bytes_read + safe_buffer_available(&buffer), run.bytes_written,
+                      "bytes lost without an overflow");
+    } else {
+        zassert_true(run.bytes_read + safe_buffer_available(&buffer) < run.bytes_written,
+                     "overflow counted but nothing was lost");
+    }
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Reset the run state and start the writers and the reader
+ */
+static void start_threads(k_thread_entry_t writer, uint32_t writers, k_thread_entry_t reader)
+{
+    memset(&run, 0, sizeof(run));
+
+    TC_PRINT("seed 0x%08x, %u writer(s)\n", STRESS_SEED, writers);
+
+    for (uint32_t i = 0; i <= writers; i++) {
+        k_thread_create(&stress_threads[i], stress_stacks[i],
+                        K_THREAD_STACK_SIZEOF(stress_stacks[i]),
+                        (i < writers) ? writer : reader,
+                        (void *)(uintptr_t)i, (void *)(uintptr_t)writers, NULL,
+                        STRESS_THREAD_PRIORITY, 0, K_NO_WAIT);
+    }
+}
+
+static void join_threads(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        k_thread_join(&stress_threads[i], K_FOREVER);
+    }
+}
+
+/**
+ * @brief Write STREAM_BYTES in random chunks, blocking while full
+ */
+static void stream_writer(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint8_t chunk[MAX_CHUNK];
+
+    while (run.bytes_written < STREAM_BYTES) {
+        size_t size = MIN(1U + (stress_rand(&rng) % MAX_CHUNK), STREAM_BYTES - run.bytes_written);
+        size_t n;
+
+        for (size_t i = 0; i < size; i++) {
+            chunk[i] = STREAM_BYTE(run.bytes_written + i);
+        }
+
+        if (safe_buffer_write(&buffer, chunk, size, K_FOREVER, &n) != BUFFER_OK || n != size) {
+            atomic_inc(&run.failures);
+            break;
+        }
+        run.writes++;
+        run.bytes_written += n;
+
+        stress_perturb(&rng);
+    }
+
+    atomic_inc(&run.writers_done);
+}
+
+/**
+ * @brief Read the stream in random chunks and compare every byte
+ */
+static void stream_reader(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint32_t writers = (uint32_t)(uintptr_t)arg2;
+    uint8_t chunk[MAX_CHUNK];
+
+    while (run.bytes_read < STREAM_BYTES) {
+        size_t size = 1U + (stress_rand(&rng) % MAX_CHUNK);
+        size_t n;
+        int ret = safe_buffer_read(&buffer, chunk, size, K_MSEC(READER_POLL_MS), &n);
+
+        if (ret == BUFFER_ERROR_TIMEOUT) {
+            if (atomic_get(&run.writers_done) == (atomic_val_t)writers) {
+                break;
+            }
+            continue;
+        }
+        if (ret != BUFFER_OK || n == 0U || n > size) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            if (chunk[i] != STREAM_BYTE(run.bytes_read + i)) {
+                atomic_inc(&run.corrupt);
+            }
+        }
+        run.reads++;
+        run.bytes_read += n;
+
+        stress_perturb(&rng);
+    }
+}
+
+/**
+ * @brief Write BYTES_PER_WRITER tagged bytes one at a time, retrying while full
+ */
+static void byte_writer(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t writer = (uint32_t)(uintptr_t)arg1;
+    uint32_t rng = stress_seed(writer);
+
+    for (uint32_t seq = 0; seq < BYTES_PER_WRITER; seq++) {
+        uint8_t byte = (uint8_t)((writer << WRITER_SHIFT) | (seq & WRITER_SEQ_MASK));
+        size_t n;
+        int ret;
+
+        while ((ret = safe_buffer_write_nb(&buffer, &byte, 1, &n)) == BUFFER_ERROR_FULL) {
+            stress_perturb(&rng);
+        }
+        if (ret != BUFFER_OK || n != 1U) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        stress_perturb(&rng);
+    }
+
+    atomic_inc(&run.writers_done);
+}
+
+/**
+ * @brief Read tagged bytes and check each writer's sequence has no gap
+ */
+static void byte_reader(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint32_t writers = (uint32_t)(uintptr_t)arg2;
+    uint32_t next_seq[BYTE_WRITERS] = { 0 };
+    uint8_t chunk[MAX_CHUNK];
+
+    while (run.bytes_read < writers * BYTES_PER_WRITER) {
+        size_t size = 1U + (stress_rand(&rng) % MAX_CHUNK);
+        size_t n;
+        int ret = safe_buffer_read(&buffer, chunk, size, K_MSEC(READER_POLL_MS), &n);
+
+        if (ret == BUFFER_ERROR_TIMEOUT) {
+            if (atomic_get(&run.writers_done) == (atomic_val_t)writers &&
+                safe_buffer_is_empty(&buffer)) {
+                break;
+            }
+            continue;
+        }
+        if (ret != BUFFER_OK || n == 0U || n > size) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            uint32_t writer = chunk[i] >> WRITER_SHIFT;
+
+            if (writer >= writers || (chunk[i] & WRITER_SEQ_MASK) != next_seq[writer]) {
+                atomic_inc(&run.corrupt);
+                continue;
+            }
+            next_seq[writer] = (next_seq[writer] + 1U) & WRITER_SEQ_MASK;
+        }
+        run.reads++;
+        run.bytes_read += n;
+
+        stress_perturb(&rng);
+    }
+}
+
+/**
+ * @brief Issue OVERWRITE_WRITES non-blocking writes of the stream, never waiting
+ */
+static void overwrite_writer(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint8_t chunk[MAX_CHUNK];
+
+    for (uint32_t w = 0; w < OVERWRITE_WRITES; w++) {
+        size_t size = 1U + (stress_rand(&rng) % MAX_CHUNK);
+        size_t n;
+
+        for (size_t i = 0; i < size; i++) {
+            chunk[i] = COUNTER_BYTE(run.bytes_written + i);
+        }
+
+        if (safe_buffer_write_nb(&buffer, chunk, size, &n) != BUFFER_OK || n != size) {
+            atomic_inc(&run.failures);
+            break;
+        }
+        run.writes++;
+        run.bytes_written += n;
+
+        stress_perturb(&rng);
+    }
+
+    atomic_inc(&run.writers_done);
+}
+
+/**
+ * @brief Read whatever survived; each read must be one contiguous run of the stream
+ * @details Overwriting only ever drops the oldest bytes, so a single read is
+ * a contiguous stretch of the stream; between two reads the stream may jump
+ * ahead (a gap), which is only allowed once the overflow counter has moved.
+ */
+static void overwrite_reader(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint32_t writers = (uint32_t)(uintptr_t)arg2;
+    uint8_t chunk[MAX_CHUNK];
+    bool have_last = false;
+    uint8_t last = 0;
+
+    for (;;) {
+        size_t size = 1U + (stress_rand(&rng) % MAX_CHUNK);
+        size_t n;
+        int ret = safe_buffer_read(&buffer, chunk, size, K_MSEC(READER_POLL_MS), &n);
+
+        if (ret == BUFFER_ERROR_TIMEOUT) {
+            if (atomic_get(&run.writers_done) == (atomic_val_t)writers) {
+                break;
+            }
+            continue;
+        }
+        if (ret != BUFFER_OK || n == 0U || n > size) {
+            atomic_inc(&run.failures);
+            break;
+        }
+
+        for (size_t i = 1; i < n; i++) {
+            if (chunk[i] != (uint8_t)(chunk[i - 1] + 1U)) {
+                atomic_inc(&run.corrupt);
+            }
+        }
+
+        if (have_last && chunk[0] != (uint8_t)(last + 1U)) {
+            run.gaps++;
+        }
+        last = chunk[n - 1];
+        have_last = true;
+
+        run.reads++;
+        run.bytes_read += n;
+
+        stress_perturb(&rng);
+    }
+}
+
+ZTEST_SUITE(safe_buffer, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,345 @@
+/**
+ * @file main.c
+ * @brief safe_queue test suite
+ * @details Covers the single-thread contract (FIFO order, sequence ids,
+ * full/empty/timeout returns, statistics) and stresses the queue with
+ * several producers and consumers under randomized preemption. The stress
+ * runs check that every element arrives exactly once, that each producer's
+ * elements leave in the order they went in, and that the statistics add up
+ * to what the threads observed.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "safe_queue.h"
+#include "stress.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Queue depth of the stress runs (small, so it is often full) */
+#define STRESS_QUEUE_DEPTH     4U
+
+#define PRODUCERS              3U
+#define CONSUMERS              3U
+#define ITEMS_PER_PRODUCER     1500U
+#define TOTAL_ITEMS            (PRODUCERS * ITEMS_PER_PRODUCER)
+
+/** @brief Consumer wait before re-checking whether everything has arrived */
+#define CONSUMER_POLL_MS       20
+
+/* Elements carry no payload: the data pointer itself encodes its origin */
+#define TAG(producer, index)   ((void *)(uintptr_t)((((producer) + 1U) << 16) | (index)))
+#define TAG_PRODUCER(data)     ((uint32_t)(((uintptr_t)(data) >> 16) - 1U))
+#define TAG_INDEX(data)        ((uint32_t)((uintptr_t)(data) & 0xFFFFU))
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static safe_queue_t queue;
+
+K_THREAD_STACK_ARRAY_DEFINE(stress_stacks, PRODUCERS + CONSUMERS, STRESS_STACK_SIZE);
+static struct k_thread stress_threads[PRODUCERS + CONSUMERS];
+
+/** @brief Shared state of a stress run */
+static struct {
+    bool blocking;                          /* Blocking or _nb calls */
+    atomic_t consumed;
+    atomic_t full_returns;                  /* QUEUE_ERROR_FULL seen by producers */
+    ATOMIC_DEFINE(seen, TOTAL_ITEMS);       /* Exactly-once check */
+    atomic_t duplicates;
+    atomic_t order_errors;
+    atomic_t bad_tags;
+    atomic_t failures;                      /* Calls that returned an unexpected code */
+} run;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void run_stress(bool blocking);
+static void producer_thread(void *arg1, void *arg2, void *arg3);
+static void consumer_thread(void *arg1, void *arg2, void *arg3);
+
+/*============================================================================*/
+/* Single-Thread Tests                                                        */
+/*============================================================================*/
+
+ZTEST(safe_queue, test_init_rejects_invalid)
+{
+    zassert_equal(safe_queue_init(NULL, 4), QUEUE_ERROR_INVALID);
+    zassert_equal(safe_queue_init(&queue, 0), QUEUE_ERROR_INVALID);
+    zassert_equal(safe_queue_init(&queue, SAFE_QUEUE_MAX_SIZE + 1), QUEUE_ERROR_INVALID);
+    zassert_equal(safe_queue_init(&queue, SAFE_QUEUE_MAX_SIZE), QUEUE_OK);
+
+    zassert_equal(safe_queue_enqueue_nb(&queue, NULL, 4), QUEUE_ERROR_INVALID);
+    zassert_equal(safe_queue_enqueue_nb(&queue, TAG(0, 0), 0), QUEUE_ERROR_INVALID);
+    zassert_equal(safe_queue_dequeue_nb(&queue, NULL), QUEUE_ERROR_INVALID);
+}
+
+ZTEST(safe_queue, test_fifo_order_and_sequence_ids)
+{
+    queue_item_t item;
+
+    zassert_equal(safe_queue_init(&queue, 8), QUEUE_OK);
+
+    /* Three passes so head and tail wrap */
+    for (uint32_t pass = 0; pass < 3; pass++) {
+        for (uint32_t i = 0; i < 6; i++) {
+            zassert_equal(safe_queue_enqueue_nb(&queue, TAG(pass, i), i + 1U), QUEUE_OK);
+        }
+        zassert_equal(safe_queue_size(&queue), 6);
+
+        for (uint32_t i = 0; i < 6; i++) {
+            zassert_equal(safe_queue_dequeue_nb(&queue, &item), QUEUE_OK);
+            zassert_equal_ptr(item.data, TAG(pass, i));
+            zassert_equal(item.size, i + 1U);
+            zassert_equal(item.sequence_id, pass * 6U + i + 1U, "sequence ids start at 1");
+        }
+        zassert_true(safe_queue_is_empty(&queue));
+    }
+}
+
+ZTEST(safe_queue, test_full_counts_overrun)
+{
+    uint32_t enqueued, dequeued, overruns;
+    queue_item_t item;
+
+    zassert_equal(safe_queue_init(&queue, 4), QUEUE_OK);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        zassert_equal(safe_queue_enqueue_nb(&queue, TAG(0, i), 1), QUEUE_OK);
+    }
+    zassert_true(safe_queue_is_full(&queue));
+
+    for (uint32_t i = 0; i < 3; i++) {
+        zassert_equal(safe_queue_enqueue_nb(&queue, TAG(1, i), 1), QUEUE_ERROR_FULL);
+    }
+
+    /* A rejected element must not displace a queued one */
+    zassert_equal(safe_queue_dequeue_nb(&queue, &item), QUEUE_OK);
+    zassert_equal_ptr(item.data, TAG(0, 0));
+
+    safe_queue_get_stats(&queue, &enqueued, &dequeued, &overruns);
+    zassert_equal(enqueued, 4);
+    zassert_equal(dequeued, 1);
+    zassert_equal(overruns, 3);
+}
+
+ZTEST(safe_queue, test_empty_and_timeouts)
+{
+    queue_item_t item;
+    uint32_t overruns;
+
+    zassert_equal(safe_queue_init(&queue, 2), QUEUE_OK);
+
+    zassert_equal(safe_queue_dequeue_nb(&queue, &item), QUEUE_ERROR_EMPTY);
+    zassert_equal(safe_queue_dequeue(&queue, &item, K_MSEC(10)), QUEUE_ERROR_TIMEOUT);
+
+    zassert_equal(safe_queue_enqueue(&queue, TAG(0, 0), 1, K_NO_WAIT), QUEUE_OK);
+    zassert_equal(safe_queue_enqueue(&queue, TAG(0, 1), 1, K_NO_WAIT), QUEUE_OK);
+    zassert_equal(safe_queue_enqueue(&queue, TAG(0, 2), 1, K_MSEC(10)), QUEUE_ERROR_TIMEOUT);
+
+    /* A blocking enqueue that times out is not an overrun */
+    safe_queue_get_stats(&queue, NULL, NULL, &overruns);
+    zassert_equal(overruns, 0);
+}
+
+ZTEST(safe_queue, test_clear_keeps_stats)
+{
+    uint32_t enqueued, dequeued;
+    queue_item_t item;
+
+    zassert_equal(safe_queue_init(&queue, 4), QUEUE_OK);
+    zassert_equal(safe_queue_enqueue_nb(&queue, TAG(0, 0), 1), QUEUE_OK);
+    zassert_equal(safe_queue_enqueue_nb(&queue, TAG(0, 1), 1), QUEUE_OK);
+
+    safe_queue_clear(&queue);
+    zassert_true(safe_queue_is_empty(&queue));
+    zassert_equal(safe_queue_dequeue_nb(&queue, &item), QUEUE_ERROR_EMPTY);
+
+    safe_queue_get_stats(&queue, &enqueued, &dequeued, NULL);
+    zassert_equal(enqueued, 2);
+    zassert_equal(dequeued, 0);
+
+    /* Sequence ids keep counting across a clear */
+    zassert_equal(safe_queue_enqueue_nb(&queue, TAG(0, 2), 1), QUEUE_OK);
+    zassert_equal(safe_queue_dequeue_nb(&queue, &item), QUEUE_OK);
+    zassert_equal(item.sequence_id, 3);
+}
+
+/*============================================================================*/
+/* Stress Tests                                                               */
+/*============================================================================*/
+
+/**
+ * @brief Blocking producers and consumers: nothing lost, nothing reordered
+ */
+ZTEST(safe_queue, test_stress_blocking)
+{
+    uint32_t enqueued, dequeued, overruns;
+
+    run_stress(true);
+
+    safe_queue_get_stats(&queue, &enqueued, &dequeued, &overruns);
+    zassert_equal(enqueued, TOTAL_ITEMS);
+    zassert_equal(dequeued, TOTAL_ITEMS);
+    zassert_equal(overruns, 0, "blocking enqueues never overrun");
+}
+
+/**
+ * @brief Non-blocking producers that retry on full: every overrun is counted
+ */
+ZTEST(safe_queue, test_stress_nonblocking)
+{
+    uint32_t enqueued, dequeued, overruns;
+
+    run_stress(false);
+
+    safe_queue_get_stats(&queue, &enqueued, &dequeued, &overruns);
+    zassert_equal(enqueued, TOTAL_ITEMS);
+    zassert_equal(dequeued, TOTAL_ITEMS);
+    zassert_equal(overruns, (uint32_t)atomic_get(&run.full_returns),
+                  "overrun_count %u, producers saw %u full returns",
+                  overruns, (uint32_t)atomic_get(&run.full_returns));
+    TC_PRINT("%u overruns\n", overruns);
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+/**
+ * @brief Move TOTAL_ITEMS through the queue and check what came out
+ */
+static void run_stress(bool blocking)
+{
+    zassert_equal(safe_queue_init(&queue, STRESS_QUEUE_DEPTH), QUEUE_OK);
+
+    memset(&run, 0, sizeof(run));
+    run.blocking = blocking;
+
+    TC_PRINT("seed 0x%08x, %u producers, %u consumers, %u items\n",
+             STRESS_SEED, PRODUCERS, CONSUMERS, TOTAL_ITEMS);
+
+    for (uint32_t i = 0; i < PRODUCERS + CONSUMERS; i++) {
+        k_thread_entry_t entry = (i < PRODUCERS) ? producer_thread : consumer_thread;
+
+        k_thread_create(&stress_threads[i], stress_stacks[i],
+                        K_THREAD_STACK_SIZEOF(stress_stacks[i]), entry,
+                        (void *)(uintptr_t)i, NULL, NULL,
+                        STRESS_THREAD_PRIORITY, 0, K_NO_WAIT);
+    }
+
+    for (uint32_t i = 0; i < PRODUCERS + CONSUMERS; i++) {
+        k_thread_join(&stress_threads[i], K_FOREVER);
+    }
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(atomic_get(&run.bad_tags), 0, "elements that were never enqueued");
+    zassert_equal(atomic_get(&run.duplicates), 0, "elements delivered twice");
+    zassert_equal(atomic_get(&run.order_errors), 0, "elements out of order");
+    zassert_equal(atomic_get(&run.consumed), TOTAL_ITEMS);
+
+    for (uint32_t i = 0; i < TOTAL_ITEMS; i++) {
+        zassert_true(atomic_test_bit(run.seen, i), "element %u lost", i);
+    }
+
+    zassert_true(safe_queue_is_empty(&queue));
+}
+
+static void producer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t producer = (uint32_t)(uintptr_t)arg1;
+    uint32_t rng = stress_seed(producer);
+
+    for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        int ret;
+
+        if (run.blocking) {
+            ret = safe_queue_enqueue(&queue, TAG(producer, i), sizeof(uint32_t), K_FOREVER);
+        } else {
+            while ((ret = safe_queue_enqueue_nb(&queue, TAG(producer, i),
+                                                sizeof(uint32_t))) == QUEUE_ERROR_FULL) {
+                atomic_inc(&run.full_returns);
+                stress_perturb(&rng);
+            }
+        }
+
+        if (ret != QUEUE_OK) {
+            atomic_inc(&run.failures);
+            return;
+        }
+
+        stress_perturb(&rng);
+    }
+}
+
+static void consumer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed((uint32_t)(uintptr_t)arg1);
+    uint32_t last_sequence = 0;
+    int32_t last_index[PRODUCERS];
+
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        last_index[p] = -1;
+    }
+
+    while (atomic_get(&run.consumed) < TOTAL_ITEMS) {
+        queue_item_t item;
+        int ret;
+
+        if (run.blocking) {
+            ret = safe_queue_dequeue(&queue, &item, K_MSEC(CONSUMER_POLL_MS));
+        } else {
+            ret = safe_queue_dequeue_nb(&queue, &item);
+        }
+
+        if (ret == QUEUE_ERROR_TIMEOUT || ret == QUEUE_ERROR_EMPTY) {
+            stress_perturb(&rng);
+            continue;
+        }
+        if (ret != QUEUE_OK) {
+            atomic_inc(&run.failures);
+            return;
+        }
+
+        uint32_t producer = TAG_PRODUCER(item.data);
+        uint32_t index = TAG_INDEX(item.data);
+
+        if (producer >= PRODUCERS || index >= ITEMS_PER_PRODUCER) {
+            atomic_inc(&run.bad_tags);
+            continue;
+        }
+
+        /* One queue, one lock: whatever a consumer takes it takes in queue order */
+        if ((int32_t)index <= last_index[producer] || item.sequence_id <= last_sequence) {
+            atomic_inc(&run.order_errors);
+        }
+        last_index[producer] = (int32_t)index;
+        last_sequence = item.sequence_id;
+
+        if (atomic_test_and_set_bit(run.seen, producer * ITEMS_PER_PRODUCER + index)) {
+            atomic_inc(&run.duplicates);
+        }
+        atomic_inc(&run.consumed);
+
+        stress_perturb(&rng);
+    }
+}
+
+ZTEST_SUITE(safe_queue, NULL, NULL, NULL, NULL, NULL);
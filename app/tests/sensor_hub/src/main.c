@@ -0,0 +1,427 @@
+/**
+ * @file main.c
+ * @brief sensor_hub test suite
+ * @details Covers the derived-channel decimator, then runs the hub the way
+ * the nRF52840 DK does at the default sampling rate: fake parts deliver a
+ * full FIFO watermark per drain (LIS2DH 28, MAX30101 30, MAX30205 one
+ * reading per second) while a consumer empties the sensor queue at the
+ * application's data processing cadence. Through the decimator no sample
+ * may be dropped; forwarding every derived sample, as the sink used to,
+ * overflows the queue on every burst.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_hub.h"
+#include "medical_device.h"
+#include "diagnostics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+/** @brief Default CONFIG_KEY_SAMPLING_RATE (config.c) */
+#define DEFAULT_RATE_HZ          100U
+
+/** @brief DATA_PROCESSING_INTERVAL_MS of the application (main.c) */
+#define PROCESSING_INTERVAL_MS   100U
+
+/** @brief FIFO watermarks of nrf52840dk_nrf52840.overlay */
+#define IMU_WATERMARK            28U
+#define PPG_WATERMARK            30U
+
+/** @brief MAX30205 poll interval (poll-interval-ms) */
+#define TEMP_PERIOD_MS           1000U
+
+#define RUN_MS                   3000U
+#define TICK_MS                  5U
+#define THREAD_PRIORITY          K_PRIO_PREEMPT(5)
+#define THREAD_STACK_SIZE        2048U
+
+/** @brief One emulated part: a FIFO that fills at the hub rate */
+typedef enum {
+    PART_IMU = 0,
+    PART_PPG,
+    PART_TEMP,
+    PART_MAX
+} part_id_t;
+
+typedef struct {
+    const sensor_hub_backend_t *backend;
+    const uint8_t *channels;        /* Channels of one FIFO entry */
+    size_t channel_count;
+    uint32_t watermark;             /* Entries per drain */
+    uint32_t period_ms;             /* Time to reach the watermark */
+    uint32_t next_ms;
+    bool running;
+} fake_part_t;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static int imu_drain(void);
+static int ppg_drain(void);
+static int temp_drain(void);
+static int part_start(uint32_t rate_hz);
+static int part_stop(void);
+static int part_drain(fake_part_t *part);
+static void decimating_sink(const sensor_hub_sample_t *samples, size_t count, void *user_data);
+static void direct_sink(const sensor_hub_sample_t *samples, size_t count, void *user_data);
+static void run_hub(sensor_hub_sink_t sink, device_stats_t *stats);
+static void interrupt_thread(void *arg1, void *arg2, void *arg3);
+static void processing_thread(void *arg1, void *arg2, void *arg3);
+static sensor_hub_sample_t make_sample(uint32_t timestamp_ms, uint8_t channel, int32_t value);
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+static const device_config_t test_config = {
+    .sampling_rate_hz = DEFAULT_RATE_HZ,
+    .alert_thresholds = { 0U },
+    .safety_monitoring_enabled = true,
+    .watchdog_timeout_ms = 5000U,
+};
+
+static const sensor_hub_backend_t backends[PART_MAX] = {
+    [PART_IMU] = { .name = "fake_imu", .start = part_start, .stop = part_stop,
+                   .drain = imu_drain },
+    [PART_PPG] = { .name = "fake_ppg", .start = part_start, .stop = part_stop,
+                   .drain = ppg_drain },
+    [PART_TEMP] = { .name = "fake_temp", .start = part_start, .stop = part_stop,
+                    .drain = temp_drain },
+};
+
+static const uint8_t imu_channels[] = {
+    SENSOR_HUB_CH_ACCEL_X, SENSOR_HUB_CH_ACCEL_Y, SENSOR_HUB_CH_ACCEL_Z, SENSOR_HUB_CH_MOTION
+};
+static const uint8_t ppg_channels[] = {
+    SENSOR_HUB_CH_PPG_RED, SENSOR_HUB_CH_PPG_IR, SENSOR_HUB_CH_HEART_RATE, SENSOR_HUB_CH_SPO2
+};
+static const uint8_t temp_channels[] = { SENSOR_HUB_CH_TEMPERATURE };
+
+/** @brief Milli-unit value per channel */
+static const int32_t channel_values[SENSOR_HUB_CH_MAX] = {
+    [SENSOR_HUB_CH_PPG_RED] = 100000,
+    [SENSOR_HUB_CH_PPG_IR] = 120000,
+    [SENSOR_HUB_CH_ACCEL_Z] = 1000,
+    [SENSOR_HUB_CH_HEART_RATE] = 72000,
+    [SENSOR_HUB_CH_TEMPERATURE] = 36600,
+    [SENSOR_HUB_CH_MOTION] = 50,
+    [SENSOR_HUB_CH_SPO2] = 98000,
+};
+
+static fake_part_t parts[PART_MAX] = {
+    [PART_IMU] = { .backend = &backends[PART_IMU], .channels = imu_channels,
+                   .channel_count = ARRAY_SIZE(imu_channels), .watermark = IMU_WATERMARK },
+    [PART_PPG] = { .backend = &backends[PART_PPG], .channels = ppg_channels,
+                   .channel_count = ARRAY_SIZE(ppg_channels), .watermark = PPG_WATERMARK },
+    [PART_TEMP] = { .backend = &backends[PART_TEMP], .channels = temp_channels,
+                    .channel_count = ARRAY_SIZE(temp_channels), .watermark = 1U },
+};
+
+static sensor_hub_sample_t drain_buf[PPG_WATERMARK * ARRAY_SIZE(ppg_channels)];
+static sensor_hub_decimator_t decimator;
+static uint32_t hub_rate_hz;
+static atomic_t run_done;
+
+K_THREAD_STACK_ARRAY_DEFINE(thread_stacks, 2, THREAD_STACK_SIZE);
+static struct k_thread threads[2];
+
+/*============================================================================*/
+/* Fixtures                                                                   */
+/*============================================================================*/
+
+/** @brief No devicetree parts in the test image; the fake parts register below */
+int sensor_drivers_register(void)
+{
+    return 0;
+}
+
+static void *sensor_hub_suite_setup(void)
+{
+    diagnostics_init();
+    /* The undecimated run overflows the queue on purpose */
+    diagnostics_set_log_level(LOG_LEVEL_ERROR);
+
+    zassert_equal(sensor_hub_init(), SENSOR_HUB_OK);
+    for (int i = 0; i < PART_MAX; i++) {
+        zassert_equal(sensor_hub_register_backend(&backends[i]), SENSOR_HUB_OK);
+    }
+
+    return NULL;
+}
+
+static void sensor_hub_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_equal(medical_device_init(&test_config), MEDICAL_OK);
+    zassert_equal(medical_device_start_monitoring(), MEDICAL_OK);
+    sensor_hub_decimator_init(&decimator, PROCESSING_INTERVAL_MS);
+}
+
+/*============================================================================*/
+/* Decimator Tests                                                            */
+/*============================================================================*/
+
+ZTEST(sensor_hub, test_decimate_peak_hold)
+{
+    sensor_hub_sample_t batch[8];
+    sensor_data_t out[SENSOR_TYPE_MAX];
+
+    /* First batch goes out at once, as its highest sample; raw channels never do */
+    batch[0] = make_sample(0U, SENSOR_HUB_CH_MOTION, 100);
+    batch[1] = make_sample(10U, SENSOR_HUB_CH_MOTION, 900);
+    batch[2] = make_sample(20U, SENSOR_HUB_CH_ACCEL_X, 5000);
+    batch[3] = make_sample(30U, SENSOR_HUB_CH_MOTION, 200);
+    zassert_equal(sensor_hub_decimate(&decimator, batch, 4, out), 1);
+    zassert_equal(out[0].type, SENSOR_TYPE_MOTION);
+    zassert_equal(out[0].value, 0.9f);
+    zassert_equal(out[0].timestamp, 10U);
+
+    /* Inside the interval: held, and the peak survives to the next output */
+    batch[0] = make_sample(60U, SENSOR_HUB_CH_MOTION, 1500);
+    batch[1] = make_sample(70U, SENSOR_HUB_CH_MOTION, 300);
+    zassert_equal(sensor_hub_decimate(&decimator, batch, 2, out), 0);
+
+    batch[0] = make_sample(130U, SENSOR_HUB_CH_MOTION, 400);
+    batch[1] = make_sample(130U, SENSOR_HUB_CH_HEART_RATE, 72000);
+    zassert_equal(sensor_hub_decimate(&decimator, batch, 2, out), 2);
+    zassert_equal(out[0].type, SENSOR_TYPE_HEART_RATE);
+    zassert_equal(out[1].type, SENSOR_TYPE_MOTION);
+    zassert_equal(out[1].value, 1.5f, "peak decimated away");
+
+    /* Spacing is per type */
+    batch[0] = make_sample(150U, SENSOR_HUB_CH_HEART_RATE, 73000);
+    batch[1] = make_sample(150U, SENSOR_HUB_CH_SPO2, 97000);
+    zassert_equal(sensor_hub_decimate(&decimator, batch, 2, out), 1);
+    zassert_equal(out[0].type, SENSOR_TYPE_BLOOD_OXYGEN);
+}
+
+/*============================================================================*/
+/* Pipeline Tests                                                             */
+/*============================================================================*/
+
+/**
+ * @brief Full watermarks at the default rate: the sensor queue never overflows
+ */
+ZTEST(sensor_hub, test_default_rate_no_drops)
+{
+    device_stats_t stats;
+    sensor_hub_stats_t hub_stats;
+
+    zassert_equal(sensor_hub_get_stats(&hub_stats), SENSOR_HUB_OK);
+    uint32_t hub_samples = hub_stats.samples;
+
+    run_hub(decimating_sink, &stats);
+
+    zassert_equal(sensor_hub_get_stats(&hub_stats), SENSOR_HUB_OK);
+    TC_PRINT("%u hub samples, %u queued, %u dropped\n", hub_stats.samples - hub_samples,
+             stats.total_samples, stats.dropped_samples);
+
+    zassert_true(hub_stats.samples - hub_samples >= RUN_MS * DEFAULT_RATE_HZ / 1000U,
+                 "the parts did not run at the default rate");
+    zassert_true(stats.total_samples > 0U);
+    zassert_equal(stats.dropped_samples, 0);
+}
+
+/**
+ * @brief The same load forwarded undecimated overflows the queue
+ */
+ZTEST(sensor_hub, test_undecimated_bursts_overflow)
+{
+    device_stats_t stats;
+
+    run_hub(direct_sink, &stats);
+
+    TC_PRINT("%u queued, %u dropped\n", stats.total_samples, stats.dropped_samples);
+    zassert_true(stats.dropped_samples > 0U, "test load too light to need the decimator");
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+static int imu_drain(void)
+{
+    return part_drain(&parts[PART_IMU]);
+}
+
+static int ppg_drain(void)
+{
+    return part_drain(&parts[PART_PPG]);
+}
+
+static int temp_drain(void)
+{
+    return part_drain(&parts[PART_TEMP]);
+}
+
+/**
+ * @brief Start every fake part (the hub calls this once per backend)
+ */
+static int part_start(uint32_t rate_hz)
+{
+    uint32_t now = k_uptime_get_32();
+
+    hub_rate_hz = rate_hz;
+    for (int i = 0; i < PART_MAX; i++) {
+        fake_part_t *part = &parts[i];
+
+        part->period_ms = (part->watermark > 1U) ? part->watermark * 1000U / rate_hz
+                                                 : TEMP_PERIOD_MS;
+        part->next_ms = now + part->period_ms;
+        part->running = true;
+    }
+
+    return SENSOR_HUB_OK;
+}
+
+static int part_stop(void)
+{
+    for (int i = 0; i < PART_MAX; i++) {
+        parts[i].running = false;
+    }
+
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief Publish one watermark of FIFO entries, oldest first
+ */
+static int part_drain(fake_part_t *part)
+{
+    uint32_t now = k_uptime_get_32();
+    size_t n = 0;
+
+    for (uint32_t entry = 0; entry < part->watermark; entry++) {
+        uint32_t age_ms = (part->watermark - 1U - entry) * 1000U / hub_rate_hz;
+
+        for (size_t c = 0; c < part->channel_count; c++) {
+            uint8_t channel = part->channels[c];
+
+            drain_buf[n++] = make_sample(now - age_ms, channel, channel_values[channel]);
+        }
+    }
+
+    sensor_hub_publish(drain_buf, n);
+    return SENSOR_HUB_OK;
+}
+
+/**
+ * @brief The application's sink: one sample per type per processing cycle
+ */
+static void decimating_sink(const sensor_hub_sample_t *samples, size_t count, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    sensor_data_t due[SENSOR_TYPE_MAX];
+    size_t due_count = sensor_hub_decimate(&decimator, samples, count, due);
+
+    for (size_t i = 0; i < due_count; i++) {
+        medical_device_add_sensor_data(&due[i]);
+    }
+}
+
+/**
+ * @brief Every derived sample straight into the sensor queue
+ */
+static void direct_sink(const sensor_hub_sample_t *samples, size_t count, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    for (size_t i = 0; i < count; i++) {
+        sensor_data_t data;
+
+        if (sensor_hub_to_sensor_data(&samples[i], &data)) {
+            medical_device_add_sensor_data(&data);
+        }
+    }
+}
+
+/**
+ * @brief Run the hub for RUN_MS with a consumer at the processing cadence
+ */
+static void run_hub(sensor_hub_sink_t sink, device_stats_t *stats)
+{
+    atomic_clear(&run_done);
+    zassert_equal(sensor_hub_set_sink(sink, NULL), SENSOR_HUB_OK);
+
+    /* Consumer first, as in the application */
+    k_thread_create(&threads[0], thread_stacks[0], K_THREAD_STACK_SIZEOF(thread_stacks[0]),
+                    processing_thread, NULL, NULL, NULL, THREAD_PRIORITY, 0, K_NO_WAIT);
+    zassert_equal(sensor_hub_start(DEFAULT_RATE_HZ), PART_MAX);
+    k_thread_create(&threads[1], thread_stacks[1], K_THREAD_STACK_SIZEOF(thread_stacks[1]),
+                    interrupt_thread, NULL, NULL, NULL, THREAD_PRIORITY, 0, K_NO_WAIT);
+
+    k_msleep(RUN_MS);
+
+    zassert_equal(sensor_hub_stop(), SENSOR_HUB_OK);
+    atomic_set(&run_done, 1);
+    k_thread_join(&threads[1], K_FOREVER);
+    k_thread_join(&threads[0], K_FOREVER);
+    zassert_equal(sensor_hub_set_sink(NULL, NULL), SENSOR_HUB_OK);
+
+    zassert_equal(medical_device_get_stats(stats), MEDICAL_OK);
+}
+
+/**
+ * @brief Watermark interrupts: notify each part as its FIFO fills
+ */
+static void interrupt_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    while (!atomic_get(&run_done)) {
+        uint32_t now = k_uptime_get_32();
+
+        for (int i = 0; i < PART_MAX; i++) {
+            fake_part_t *part = &parts[i];
+
+            if (part->running && (int32_t)(now - part->next_ms) >= 0) {
+                part->next_ms += part->period_ms;
+                sensor_hub_notify(part->backend);
+            }
+        }
+
+        k_msleep(TICK_MS);
+    }
+}
+
+/**
+ * @brief The application's data processing loop
+ */
+static void processing_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    while (!atomic_get(&run_done)) {
+        k_msleep(PROCESSING_INTERVAL_MS);
+        medical_device_process_sensor_data(UINT32_MAX);
+    }
+}
+
+static sensor_hub_sample_t make_sample(uint32_t timestamp_ms, uint8_t channel, int32_t value)
+{
+    sensor_hub_sample_t sample = {
+        .timestamp_ms = timestamp_ms,
+        .value = value,
+        .channel = channel,
+        .flags = 0U,
+    };
+
+    return sample;
+}
+
+ZTEST_SUITE(sensor_hub, NULL, sensor_hub_suite_setup, sensor_hub_before, NULL, NULL);
@@ -0,0 +1,578 @@
+/**
+ * @file main.c
+ * @brief vitals_frame / serial_frame test suite
+ * @details Round-trips random vitals batches through the device-side
+ * encoders (vitals_frame_encode() and serial_frame_encode()) into the
+ * incremental parser, fed in random chunk sizes, and checks every field
+ * after vitals_frame_decode(). Corrupted and truncated streams must never
+ * yield a frame and must not stop the parser from picking up the next
+ * clean one.
+ *
+ * The uplink tests replace the serial Bluetooth transport with a fake that
+ * feeds every transmitted frame into a receiver-side parser. They cover
+ * batching, the batch-ready wake-up, drop-oldest and retry on a rejected
+ * frame, and a producer adding samples while a flush is in flight, where
+ * every sample must be delivered once and in order or be counted as dropped.
+ *
+ * @author NISC Medical Devices
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "vitals_frame.h"
+#include "serial_frame.h"
+#include "hardware.h"
+#include "diagnostics.h"
+#include "stress.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/*============================================================================*/
+/* Private Definitions                                                        */
+/*============================================================================*/
+
+#define ROUND_TRIPS            500U
+#define CORRUPTED_FRAMES       500U
+#define TRUNCATED_FRAMES       300U
+
+/** @brief Received samples kept by the fake receiver */
+#define RX_CAPACITY            4096U
+
+#define STRESS_SAMPLES         3000U
+#define STRESS_SAMPLE_STEP_MS  10U
+
+/*============================================================================*/
+/* Private Variables                                                          */
+/*============================================================================*/
+
+/** @brief Receiver side of the fake serial Bluetooth link */
+static struct {
+    serial_frame_parser_t parser;
+    serial_frame_handler_entry_t handlers[1];
+    vitals_sample_t samples[RX_CAPACITY];
+    size_t count;
+    uint16_t next_batch_seq;
+    uint32_t batches;
+    uint32_t bad_batches;               /* Undecodable payloads or seq gaps */
+    uint32_t unhandled;
+    uint8_t unhandled_version;
+    bool fail_sends;                    /* Transport rejects every frame */
+    bool perturb;                       /* Randomly give up the CPU mid-send */
+    uint32_t rng;
+} rx;
+
+K_THREAD_STACK_ARRAY_DEFINE(stress_stacks, 2, STRESS_STACK_SIZE);
+static struct k_thread stress_threads[2];
+
+/** @brief Shared state of the producer/flusher stress run */
+static struct {
+    atomic_t producer_done;
+    atomic_t failures;
+} run;
+
+/*============================================================================*/
+/* Private Function Declarations                                              */
+/*============================================================================*/
+
+static void rx_batch_handler(const serial_frame_t *frame, void *user_data);
+static void rx_unhandled_handler(const serial_frame_t *frame, void *user_data);
+static void random_samples(uint32_t *rng, vitals_sample_t *samples, size_t count);
+static size_t encode_stream(const vitals_sample_t *samples, size_t count, uint16_t batch_seq,
+                            uint8_t *out, size_t out_size, size_t *encoded);
+static void feed_in_chunks(uint32_t *rng, const uint8_t *data, size_t length);
+static void assert_samples_equal(const vitals_sample_t *expected, const vitals_sample_t *actual,
+                                 size_t count);
+static void producer_thread(void *arg1, void *arg2, void *arg3);
+static void flusher_thread(void *arg1, void *arg2, void *arg3);
+
+/*============================================================================*/
+/* Fake Serial Bluetooth Transport                                            */
+/*============================================================================*/
+
+int hw_serial_bt_send(const uint8_t *data, uint32_t length)
+{
+    if (rx.fail_sends) {
+        return HW_ERROR_BUSY;
+    }
+
+    if (rx.perturb) {
+        stress_perturb(&rx.rng);
+    }
+
+    serial_frame_parser_feed(&rx.parser, data, length);
+    return HW_OK;
+}
+
+int hw_serial_bt_set_rx_callback(hw_serial_bt_rx_cb_t cb, void *user_data)
+{
+    ARG_UNUSED(cb);
+    ARG_UNUSED(user_data);
+
+    return HW_OK;
+}
+
+/*============================================================================*/
+/* Fixtures                                                                   */
+/*============================================================================*/
+
+static void *vitals_frame_suite_setup(void)
+{
+    diagnostics_init();
+    diagnostics_set_log_level(LOG_LEVEL_ERROR);
+
+    zassert_equal(serial_frame_init(), FRAME_OK);
+    return NULL;
+}
+
+static void vitals_frame_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    memset(&rx, 0, sizeof(rx));
+    rx.handlers[0].type = SERIAL_FRAME_TYPE_VITALS_BATCH;
+    rx.handlers[0].handler = rx_batch_handler;
+    zassert_equal(serial_frame_parser_init(&rx.parser, rx.handlers, ARRAY_SIZE(rx.handlers)),
+                  FRAME_OK);
+    serial_frame_parser_set_unhandled(&rx.parser, rx_unhandled_handler, NULL);
+    rx.rng = stress_seed(100);
+
+    zassert_equal(vitals_frame_init(), FRAME_OK);
+}
+
+/*============================================================================*/
+/* Encoder and Parser Tests                                                   */
+/*============================================================================*/
+
+ZTEST(vitals_frame, test_round_trip_random_batches)
+{
+    static vitals_sample_t batch[VITALS_BATCH_MAX_SAMPLES];
+    uint8_t stream[SERIAL_FRAME_MAX_ENCODED];
+    uint32_t rng = stress_seed(0);
+
+    for (uint32_t i = 0; i < ROUND_TRIPS; i++) {
+        size_t count = 1U + stress_rand(&rng) % VITALS_BATCH_MAX_SAMPLES;
+        size_t encoded = 0;
+
+        random_samples(&rng, batch, count);
+        rx.next_batch_seq = (uint16_t)i;
+        size_t before = rx.count;
+
+        size_t len = encode_stream(batch, count, (uint16_t)i, stream, sizeof(stream), &encoded);
+        zassert_equal(encoded, count, "batch %u: all samples fit one frame", i);
+
+        feed_in_chunks(&rng, stream, len);
+
+        zassert_equal(rx.count - before, count, "batch %u not delivered", i);
+        assert_samples_equal(batch, &rx.samples[before], count);
+        rx.count = 0;
+    }
+
+    zassert_equal(rx.batches, ROUND_TRIPS);
+    zassert_equal(rx.bad_batches, 0);
+    zassert_equal(rx.parser.crc_errors + rx.parser.length_errors + rx.parser.overflow_errors, 0);
+}
+
+ZTEST(vitals_frame, test_encode_stops_at_wide_gap)
+{
+    vitals_sample_t batch[3] = {
+        { .timestamp_ms = 1000U },
+        { .timestamp_ms = 1000U + UINT16_MAX },
+        { .timestamp_ms = 1001U + 2U * UINT16_MAX },     /* dt = 65536 */
+    };
+    uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD];
+    size_t len = 0, encoded = 0;
+
+    zassert_equal(vitals_frame_encode(batch, 3, 0, payload, sizeof(payload), &len, &encoded),
+                  FRAME_OK);
+    zassert_equal(encoded, 2);
+    zassert_equal(len, VITALS_BATCH_HEADER_SIZE + 2U * VITALS_SAMPLE_SIZE);
+}
+
+ZTEST(vitals_frame, test_corrupted_stream_resyncs)
+{
+    static vitals_sample_t batch[VITALS_BATCH_MAX_SAMPLES];
+    uint8_t clean[SERIAL_FRAME_MAX_ENCODED];
+    uint8_t corrupt[SERIAL_FRAME_MAX_ENCODED];
+    uint32_t rng = stress_seed(1);
+
+    for (uint32_t i = 0; i < CORRUPTED_FRAMES; i++) {
+        size_t count = 1U + stress_rand(&rng) % VITALS_BATCH_MAX_SAMPLES;
+        size_t encoded = 0;
+
+        random_samples(&rng, batch, count);
+        size_t len = encode_stream(batch, count, (uint16_t)i, clean, sizeof(clean), &encoded);
+
+        memcpy(corrupt, clean, len);
+        uint32_t flips = 1U + stress_rand(&rng) % 4U;
+        for (uint32_t f = 0; f < flips; f++) {
+            uint32_t r = stress_rand(&rng);
+            uint32_t pos = r % len;
+            uint8_t value = (uint8_t)(r >> 16);
+
+            corrupt[pos] = (value == corrupt[pos]) ? (uint8_t)~value : value;
+        }
+
+        /* The corrupted copy must be rejected, the clean one right after it accepted */
+        rx.count = 0;
+        rx.next_batch_seq = (uint16_t)i;
+        feed_in_chunks(&rng, corrupt, len);
+        zassert_equal(rx.count, 0, "frame %u: corrupted frame delivered", i);
+
+        rx.next_batch_seq = (uint16_t)i;
+        feed_in_chunks(&rng, clean, len);
+        zassert_equal(rx.count, count, "frame %u: parser did not resync", i);
+        assert_samples_equal(batch, rx.samples, count);
+    }
+
+    TC_PRINT("%u crc, %u length, %u overflow errors\n", rx.parser.crc_errors,
+             rx.parser.length_errors, rx.parser.overflow_errors);
+    zassert_true(rx.parser.crc_errors + rx.parser.length_errors > 0);
+}
+
+ZTEST(vitals_frame, test_truncated_stream_resyncs)
+{
+    static vitals_sample_t batch[VITALS_BATCH_MAX_SAMPLES];
+    uint8_t stream[SERIAL_FRAME_MAX_ENCODED];
+    uint32_t rng = stress_seed(2);
+
+    for (uint32_t i = 0; i < TRUNCATED_FRAMES; i++) {
+        size_t count = 1U + stress_rand(&rng) % VITALS_BATCH_MAX_SAMPLES;
+        size_t encoded = 0;
+
+        random_samples(&rng, batch, count);
+        size_t len = encode_stream(batch, count, (uint16_t)i, stream, sizeof(stream), &encoded);
+
+        /* Line drops out somewhere before the closing END; the next frame's
+         * leading END terminates the fragment */
+        size_t cut = 1U + stress_rand(&rng) % (len - 2U);
+
+        rx.count = 0;
+        rx.next_batch_seq = (uint16_t)i;
+        feed_in_chunks(&rng, stream, cut);
+        feed_in_chunks(&rng, stream, len);
+
+        zassert_equal(rx.count, count, "frame %u (cut at %u of %u)", i, (uint32_t)cut,
+                      (uint32_t)len);
+        assert_samples_equal(batch, rx.samples, count);
+    }
+
+    zassert_equal(rx.batches, TRUNCATED_FRAMES);
+}
+
+ZTEST(vitals_frame, test_wrong_version_not_dispatched)
+{
+    uint8_t body[SERIAL_FRAME_HEADER_SIZE + VITALS_BATCH_HEADER_SIZE + SERIAL_FRAME_CRC_SIZE] = {
+        SERIAL_FRAME_VERSION + 1U, SERIAL_FRAME_TYPE_VITALS_BATCH, 7U, VITALS_BATCH_HEADER_SIZE,
+        0U, 0U, 0U, 0U, 0U, 0U, 0U,     /* Empty batch */
+    };
+    uint16_t crc = crc16_itu_t(0xFFFFU, body, sizeof(body) - SERIAL_FRAME_CRC_SIZE);
+    uint8_t stream[sizeof(body) + 2U];
+
+    sys_put_le16(crc, &body[sizeof(body) - SERIAL_FRAME_CRC_SIZE]);
+    zassert_true(body[sizeof(body) - 2] != 0xC0U && body[sizeof(body) - 2] != 0xDBU &&
+                 body[sizeof(body) - 1] != 0xC0U && body[sizeof(body) - 1] != 0xDBU,
+                 "CRC needs SLIP escaping; change the test frame");
+
+    stream[0] = 0xC0U;
+    memcpy(&stream[1], body, sizeof(body));
+    stream[sizeof(stream) - 1] = 0xC0U;
+
+    zassert_equal(serial_frame_parser_feed(&rx.parser, stream, sizeof(stream)), 0);
+    zassert_equal(rx.batches, 0, "wrong-version frame reached the type handler");
+    zassert_equal(rx.unhandled, 1);
+    zassert_equal(rx.unhandled_version, SERIAL_FRAME_VERSION + 1U);
+    zassert_equal(rx.parser.version_errors, 1);
+    zassert_equal(rx.parser.frames_ok, 0);
+}
+
+/*============================================================================*/
+/* Uplink Tests                                                               */
+/*============================================================================*/
+
+ZTEST(vitals_frame, test_flush_batches_in_order)
+{
+    vitals_sample_t samples[VITALS_PENDING_MAX];
+    vitals_frame_stats_t stats;
+    uint32_t rng = stress_seed(3);
+
+    random_samples(&rng, samples, ARRAY_SIZE(samples));
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        zassert_equal(vitals_frame_add_sample(&samples[i]), FRAME_OK);
+    }
+
+    zassert_equal(vitals_frame_flush(), (int)ARRAY_SIZE(samples));
+    zassert_equal(rx.count, ARRAY_SIZE(samples));
+    assert_samples_equal(samples, rx.samples, ARRAY_SIZE(samples));
+    zassert_equal(rx.bad_batches, 0);
+
+    zassert_equal(vitals_frame_get_stats(&stats), FRAME_OK);
+    zassert_equal(stats.batches_sent, rx.batches);
+    zassert_equal(stats.batches_sent,
+                  DIV_ROUND_UP(ARRAY_SIZE(samples), VITALS_BATCH_MAX_SAMPLES));
+    zassert_equal(stats.samples_sent, ARRAY_SIZE(samples));
+    zassert_equal(vitals_frame_flush(), 0, "queue should be empty");
+}
+
+static void count_batch_ready(void *user_data)
+{
+    atomic_inc((atomic_t *)user_data);
+}
+
+ZTEST(vitals_frame, test_batch_handler_wakes_on_full_batch)
+{
+    vitals_sample_t samples[VITALS_BATCH_MAX_SAMPLES * 2U];
+    vitals_frame_stats_t stats;
+    atomic_t wakes = ATOMIC_INIT(0);
+    uint32_t rng = stress_seed(6);
+
+    random_samples(&rng, samples, ARRAY_SIZE(samples));
+    zassert_equal(vitals_frame_set_batch_handler(count_batch_ready, &wakes), FRAME_OK);
+
+    /* The handler flushes like the communication thread does on wake-up */
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        zassert_equal(vitals_frame_add_sample(&samples[i]), FRAME_OK);
+        zassert_equal(atomic_get(&wakes), (i + 1U) / VITALS_BATCH_MAX_SAMPLES);
+        if ((i + 1U) % VITALS_BATCH_MAX_SAMPLES == 0U) {
+            zassert_equal(vitals_frame_flush(), VITALS_BATCH_MAX_SAMPLES);
+        }
+    }
+
+    assert_samples_equal(samples, rx.samples, ARRAY_SIZE(samples));
+    zassert_equal(vitals_frame_get_stats(&stats), FRAME_OK);
+    zassert_equal(stats.samples_dropped, 0);
+    zassert_equal(stats.batches_sent, 2);
+}
+
+ZTEST(vitals_frame, test_full_queue_drops_oldest)
+{
+    vitals_sample_t samples[VITALS_PENDING_MAX + 8U];
+    vitals_frame_stats_t stats;
+    uint32_t rng = stress_seed(4);
+
+    random_samples(&rng, samples, ARRAY_SIZE(samples));
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        zassert_equal(vitals_frame_add_sample(&samples[i]), FRAME_OK);
+    }
+
+    zassert_equal(vitals_frame_flush(), VITALS_PENDING_MAX);
+    assert_samples_equal(&samples[8], rx.samples, VITALS_PENDING_MAX);
+
+    zassert_equal(vitals_frame_get_stats(&stats), FRAME_OK);
+    zassert_equal(stats.samples_dropped, 8);
+    zassert_equal(stats.samples_queued, ARRAY_SIZE(samples));
+}
+
+ZTEST(vitals_frame, test_rejected_frame_stays_queued)
+{
+    vitals_sample_t samples[4];
+    vitals_frame_stats_t stats;
+    uint32_t rng = stress_seed(5);
+
+    random_samples(&rng, samples, ARRAY_SIZE(samples));
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        zassert_equal(vitals_frame_add_sample(&samples[i]), FRAME_OK);
+    }
+
+    rx.fail_sends = true;
+    zassert_equal(vitals_frame_flush(), FRAME_ERROR_TX);
+    zassert_equal(rx.count, 0);
+
+    rx.fail_sends = false;
+    zassert_equal(vitals_frame_flush(), (int)ARRAY_SIZE(samples));
+    assert_samples_equal(samples, rx.samples, ARRAY_SIZE(samples));
+
+    zassert_equal(vitals_frame_get_stats(&stats), FRAME_OK);
+    zassert_equal(stats.batch_errors, 1);
+    zassert_equal(stats.next_batch_seq, 1, "a rejected frame must not use up a batch_seq");
+}
+
+/**
+ * @brief Producer adding samples while the flusher's frames are in flight
+ */
+ZTEST(vitals_frame, test_stress_add_during_flush)
+{
+    vitals_frame_stats_t stats;
+
+    memset(&run, 0, sizeof(run));
+    rx.perturb = true;
+
+    TC_PRINT("seed 0x%08x, %u samples\n", STRESS_SEED, STRESS_SAMPLES);
+
+    k_thread_create(&stress_threads[0], stress_stacks[0], K_THREAD_STACK_SIZEOF(stress_stacks[0]),
+                    producer_thread, NULL, NULL, NULL, STRESS_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_create(&stress_threads[1], stress_stacks[1], K_THREAD_STACK_SIZEOF(stress_stacks[1]),
+                    flusher_thread, NULL, NULL, NULL, STRESS_THREAD_PRIORITY, 0, K_NO_WAIT);
+
+    k_thread_join(&stress_threads[0], K_FOREVER);
+    k_thread_join(&stress_threads[1], K_FOREVER);
+
+    zassert_equal(atomic_get(&run.failures), 0, "unexpected return codes");
+    zassert_equal(rx.bad_batches, 0);
+
+    /* Delivered once and in order: timestamps strictly increase */
+    for (size_t i = 0; i < rx.count; i++) {
+        uint32_t ts = rx.samples[i].timestamp_ms;
+
+        zassert_equal(ts % STRESS_SAMPLE_STEP_MS, 0, "sample %u corrupted", (uint32_t)i);
+        zassert_equal(rx.samples[i].heart_rate_bpm,
+                      (uint8_t)(ts / STRESS_SAMPLE_STEP_MS), "sample %u corrupted", (uint32_t)i);
+        if (i > 0) {
+            zassert_true(ts > rx.samples[i - 1].timestamp_ms,
+                         "sample %u duplicated or out of order", (uint32_t)i);
+        }
+    }
+
+    zassert_equal(vitals_frame_get_stats(&stats), FRAME_OK);
+    TC_PRINT("%u sent, %u dropped in %u batches\n", stats.samples_sent,
+             stats.samples_dropped, stats.batches_sent);
+
+    zassert_equal(stats.samples_queued, STRESS_SAMPLES);
+    zassert_equal(stats.samples_sent, rx.count);
+    zassert_equal(stats.samples_sent + stats.samples_dropped, STRESS_SAMPLES,
+                  "%u sent + %u dropped", stats.samples_sent, stats.samples_dropped);
+    zassert_equal(stats.batches_sent, rx.batches);
+}
+
+/*============================================================================*/
+/* Private Function Implementations                                           */
+/*============================================================================*/
+
+static void rx_batch_handler(const serial_frame_t *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    size_t count = 0;
+    uint16_t batch_seq = 0;
+
+    if (vitals_frame_decode(frame->payload, frame->length, &rx.samples[rx.count],
+                            RX_CAPACITY - rx.count, &count, &batch_seq) != FRAME_OK ||
+        batch_seq != rx.next_batch_seq) {
+        rx.bad_batches++;
+        return;
+    }
+
+    rx.count += count;
+    rx.next_batch_seq++;
+    rx.batches++;
+}
+
+static void rx_unhandled_handler(const serial_frame_t *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    rx.unhandled++;
+    rx.unhandled_version = frame->version;
+}
+
+static void random_samples(uint32_t *rng, vitals_sample_t *samples, size_t count)
+{
+    uint32_t ts = stress_rand(rng);
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = stress_rand(rng);
+        uint32_t b = stress_rand(rng);
+
+        ts += (i == 0) ? 0U : (a & 0xFFFFU);
+        samples[i].timestamp_ms = ts;
+        samples[i].heart_rate_bpm = (uint8_t)(a >> 16);
+        samples[i].temperature_x10 = (int16_t)(b & 0xFFFFU);
+        samples[i].motion_x10 = (uint16_t)(b >> 16);
+        samples[i].spo2_x10 = (uint16_t)(a ^ b);
+    }
+}
+
+/**
+ * @brief Payload and SLIP frame of one batch, as vitals_frame_flush() builds them
+ */
+static size_t encode_stream(const vitals_sample_t *samples, size_t count, uint16_t batch_seq,
+                            uint8_t *out, size_t out_size, size_t *encoded)
+{
+    uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD];
+    size_t payload_len = 0;
+    size_t len = 0;
+
+    zassert_equal(vitals_frame_encode(samples, count, batch_seq, payload, sizeof(payload),
+                                      &payload_len, encoded), FRAME_OK);
+    zassert_equal(serial_frame_encode(SERIAL_FRAME_TYPE_VITALS_BATCH, (uint8_t)batch_seq,
+                                      payload, payload_len, out, out_size, &len), FRAME_OK);
+    return len;
+}
+
+/** @brief Feed a stream to the receiver in random chunk sizes, as UART reads arrive */
+static void feed_in_chunks(uint32_t *rng, const uint8_t *data, size_t length)
+{
+    size_t pos = 0;
+
+    while (pos < length) {
+        size_t chunk = 1U + stress_rand(rng) % 40U;
+
+        chunk = MIN(chunk, length - pos);
+
+        serial_frame_parser_feed(&rx.parser, &data[pos], chunk);
+        pos += chunk;
+    }
+}
+
+static void assert_samples_equal(const vitals_sample_t *expected, const vitals_sample_t *actual,
+                                 size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        zassert_equal(actual[i].timestamp_ms, expected[i].timestamp_ms, "sample %u", (uint32_t)i);
+        zassert_equal(actual[i].heart_rate_bpm, expected[i].heart_rate_bpm, "sample %u",
+                      (uint32_t)i);
+        zassert_equal(actual[i].temperature_x10, expected[i].temperature_x10, "sample %u",
+                      (uint32_t)i);
+        zassert_equal(actual[i].motion_x10, expected[i].motion_x10, "sample %u", (uint32_t)i);
+        zassert_equal(actual[i].spo2_x10, expected[i].spo2_x10, "sample %u", (uint32_t)i);
+    }
+}
+
+static void producer_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed(10);
+
+    for (uint32_t i = 1; i <= STRESS_SAMPLES; i++) {
+        vitals_sample_t sample = {
+            .timestamp_ms = i * STRESS_SAMPLE_STEP_MS,
+            .heart_rate_bpm = (uint8_t)i,
+        };
+
+        if (vitals_frame_add_sample(&sample) != FRAME_OK) {
+            atomic_inc(&run.failures);
+        }
+        stress_perturb(&rng);
+    }
+
+    atomic_set(&run.producer_done, 1);
+}
+
+static void flusher_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    uint32_t rng = stress_seed(11);
+
+    for (;;) {
+        bool done = atomic_get(&run.producer_done) != 0;
+
+        if (vitals_frame_flush() < 0) {
+            atomic_inc(&run.failures);
+        }
+        if (done) {
+            break; /* That flush saw every sample the producer queued */
+        }
+        stress_perturb(&rng);
+    }
+}
+
+ZTEST_SUITE(vitals_frame, NULL, vitals_frame_suite_setup, vitals_frame_before, NULL, NULL);
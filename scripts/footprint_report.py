@@ -0,0 +1,571 @@
+#!/usr/bin/env python3
+"""Report static RAM and flash per module and symbol class, and check budgets.
+
+Reads the linked image (zephyr.elf) and its linker map (zephyr.map). The map
+attributes every input section to the object it came from: application
+sources (app/libapp.a) are reported per source file, everything else per
+library archive. The ELF section flags decide what counts as RAM (writable:
+data, bss, noinit) and what counts as flash (loaded: code, rodata and the
+initialisers of data). Its symbol table is grouped into classes by name
+(stacks, queues, buffers), alongside code and string literals (.rodata.*str*
+input sections). Whatever no class claims (fill, vector tables, unnamed
+compiler data) is reported as "other".
+
+Budgets in bytes come from a TOML file (see app/footprint_budget.toml):
+  [total]          ram / flash of the whole image
+  [class.<name>]   ram / flash of one symbol class
+  [module.<name>]  ram / flash of one module
+  [patterns]       optional <class> = ["glob", ...] to add or replace classes
+Every exceeded budget is listed on stderr and the exit status is 1.
+
+Usage:
+  footprint_report.py build/zephyr/zephyr.elf [--budget app/footprint_budget.toml]
+  footprint_report.py build/zephyr/zephyr.elf --top 30
+  footprint_report.py build/zephyr/zephyr.elf --suggest 10
+  footprint_report.py --selftest
+"""
+
+import argparse
+import bisect
+import fnmatch
+import os
+import re
+import struct
+import sys
+import tomllib
+
+APP_ARCHIVE = "libapp"
+
+# Data symbol classes by name, first match wins. Functions are always "code",
+# string literal sections "strings".
+CLASS_PATTERNS = {
+    "stacks": ["*_stack", "*_stacks"],
+    "queues": ["*queue*", "*msgq*", "*fifo*"],
+    "buffers": ["*buf*", "*ring*", "*pool*", "*slab*", "*arena*"],
+}
+CLASS_CODE = "code"
+CLASS_STRINGS = "strings"
+CLASS_OTHER = "other"
+
+MODULE_FILL = "(fill)"
+MODULE_LINKER = "(linker)"
+MODULE_UNATTRIBUTED = "(unattributed)"
+
+STRING_SECTION = re.compile(r"^\.rodata.*\.str\d")
+ARCHIVE_MEMBER = re.compile(r"([^/()]+)\.a\(([^()]+)\)$")
+
+MAP_SECTION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s*(.*)$")
+MAP_CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s*(.*)$")
+MAP_REGION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+SHT_SYMTAB, SHT_NOBITS = 2, 8
+SHF_WRITE, SHF_ALLOC = 0x1, 0x2
+STT_OBJECT, STT_FUNC = 1, 2
+EM_ARM = 40
+
+BUDGET_KEYS = ("ram", "flash")
+SUGGEST_ROUNDING = 256
+
+
+class Elf:
+    """Section headers and symbol table of a 32- or 64-bit ELF image."""
+
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF":
+            raise ValueError("not an ELF file")
+        end = "<" if data[5] == 1 else ">"
+        if data[4] == 2:
+            header = struct.Struct(end + "16xHHIQQQIHHHHHH")
+            shdr = struct.Struct(end + "IIQQQQIIQQ")
+            sym = struct.Struct(end + "IBBHQQ")
+            sym_order = (0, 4, 5, 1, 3)
+        else:
+            header = struct.Struct(end + "16xHHIIIIIHHHHHH")
+            shdr = struct.Struct(end + "IIIIIIIIII")
+            sym = struct.Struct(end + "IIIBBH")
+            sym_order = (0, 1, 2, 3, 5)
+
+        fields = header.unpack_from(data)
+        machine, shoff = fields[1], fields[5]
+        shentsize, shnum, shstrndx = fields[10:13]
+
+        raw = [shdr.unpack_from(data, shoff + i * shentsize) for i in range(shnum)]
+        names = raw[shstrndx] if shnum else None
+
+        def string(table, offset):
+            start = table[4] + offset
+            return data[start:data.index(b"\0", start)].decode("utf-8", "replace")
+
+        # name, type, flags, addr, size
+        self.sections = [(string(names, s[0]), s[1], s[2], s[3], s[5]) for s in raw]
+        self.symbols = []  # name, value, size, type, section index
+        for s in raw:
+            if s[1] != SHT_SYMTAB:
+                continue
+            strtab = raw[s[6]]
+            for offset in range(s[4], s[4] + s[5], sym.size):
+                fields = sym.unpack_from(data, offset)
+                name, value, size, info, shndx = (fields[i] for i in sym_order)
+                kind = info & 0xF
+                if kind == STT_FUNC and machine == EM_ARM:
+                    value &= ~1  # Thumb bit
+                self.symbols.append((string(strtab, name), value, size, kind, shndx))
+
+
+def section_memory(section):
+    """(ram, flash) membership of an output section."""
+    _, stype, flags, _, _ = section
+    if not flags & SHF_ALLOC:
+        return False, False
+    return bool(flags & SHF_WRITE), stype != SHT_NOBITS
+
+
+def module_of(obj):
+    """Application source file, library archive or linker pseudo-module of an object."""
+    if not obj:
+        return MODULE_LINKER
+    member = ARCHIVE_MEMBER.search(obj)
+    if member:
+        archive, name = member.groups()
+        return name.split(".")[0] if archive == APP_ARCHIVE else archive
+    return os.path.basename(obj).split(".")[0]
+
+
+def is_app_object(obj):
+    return bool(obj) and ("/%s.a(" % APP_ARCHIVE in obj or obj.startswith(APP_ARCHIVE + ".a(")
+                          or "/app.dir/" in obj)
+
+
+def parse_map(text):
+    """Memory regions and, per output section, its input sections.
+
+    Returns (regions, contributions, app_modules) where regions maps a region
+    name to its length and contributions maps an output section name to a
+    sorted list of (address, size, module, input section name).
+    """
+    regions, contributions, app_modules = {}, {}, set()
+    in_regions = in_layout = False
+    output = pending = None
+
+    for line in text.splitlines():
+        if line.startswith("Memory Configuration"):
+            in_regions = True
+            continue
+        if line.startswith("Linker script and memory map"):
+            in_regions, in_layout = False, True
+            continue
+        if in_regions:
+            region = MAP_REGION.match(line)
+            if region and region.group(1) != "*default*":
+                regions[region.group(1)] = int(region.group(3), 16)
+            continue
+        if not in_layout or not line.strip():
+            continue
+
+        if not line[0].isspace():
+            # Output section, possibly with its address on the next line
+            head = MAP_SECTION.match(line)
+            output = head.group(1) if head else line.split()[0]
+            contributions.setdefault(output, [])
+            pending = None
+            continue
+        if output is None:
+            continue
+
+        if line.startswith(" ") and not line.startswith("  ") and not line.startswith(" *("):
+            head = MAP_SECTION.match(line[1:])
+            if head:
+                name, addr, size, obj = head.groups()
+            else:
+                pending = line.split()[0]
+                continue
+        elif pending:
+            tail = MAP_CONTINUATION.match(line)
+            if not tail:
+                pending = None
+                continue
+            name, (addr, size, obj) = pending, tail.groups()
+        else:
+            continue
+        pending = None
+
+        size = int(size, 16)
+        if size == 0 or name.startswith("*("):
+            continue
+        obj = obj.strip()
+        if name == "*fill*":
+            module = MODULE_FILL
+        else:
+            module = module_of(obj)
+            if is_app_object(obj):
+                app_modules.add(module)
+        contributions[output].append((int(addr, 16), size, module, name))
+
+    for entries in contributions.values():
+        entries.sort()
+    return regions, contributions, app_modules
+
+
+def new_usage():
+    return {"ram": 0, "flash": 0}
+
+
+def add_usage(usage, ram, flash, size):
+    if ram:
+        usage["ram"] += size
+    if flash:
+        usage["flash"] += size
+
+
+class Footprint:
+    """Static RAM/flash of an image by module, symbol class and symbol."""
+
+    def __init__(self, elf, map_text, patterns=None):
+        self.patterns = dict(CLASS_PATTERNS)
+        self.patterns.update(patterns or {})
+        self.regions, contributions, self.app_modules = parse_map(map_text)
+
+        self.total = new_usage()
+        self.modules = {}
+        self.classes = {name: new_usage() for name in
+                        list(self.patterns) + [CLASS_CODE, CLASS_STRINGS, CLASS_OTHER]}
+        self.symbols = []  # size, name, module, class, ram, flash
+
+        starts = {}
+        for section in elf.sections:
+            name, _, _, _, size = section
+            ram, flash = section_memory(section)
+            if not (ram or flash) or size == 0:
+                continue
+            add_usage(self.total, ram, flash, size)
+
+            attributed = 0
+            entries = contributions.get(name, [])
+            starts[name] = [entry[0] for entry in entries]
+            for _, entry_size, module, input_name in entries:
+                add_usage(self.modules.setdefault(module, new_usage()), ram, flash, entry_size)
+                if STRING_SECTION.match(input_name):
+                    add_usage(self.classes[CLASS_STRINGS], ram, flash, entry_size)
+                attributed += entry_size
+            if attributed < size:
+                add_usage(self.modules.setdefault(MODULE_UNATTRIBUTED, new_usage()),
+                          ram, flash, size - attributed)
+        # Objects that only contributed discarded or non-loaded sections
+        self.app_modules &= set(self.modules)
+
+        seen = set()
+        for name, value, size, kind, shndx in elf.symbols:
+            if size == 0 or kind not in (STT_OBJECT, STT_FUNC) or shndx >= len(elf.sections):
+                continue
+            section = elf.sections[shndx]
+            ram, flash = section_memory(section)
+            if not (ram or flash) or (shndx, value, size) in seen:
+                continue
+            seen.add((shndx, value, size))
+
+            module = MODULE_UNATTRIBUTED
+            entries = contributions.get(section[0], [])
+            index = bisect.bisect_right(starts.get(section[0], []), value) - 1
+            if index >= 0 and value < entries[index][0] + entries[index][1]:
+                module = entries[index][2]
+
+            cls = self.classify(name, kind)
+            add_usage(self.classes[cls], ram, flash, size)
+            self.symbols.append((size, name, module, cls, ram, flash))
+
+        self.symbols.sort(reverse=True)
+        other = self.classes[CLASS_OTHER]
+        for key in BUDGET_KEYS:
+            other[key] = self.total[key] - sum(usage[key] for cls, usage in self.classes.items()
+                                               if cls != CLASS_OTHER)
+
+    def classify(self, name, kind):
+        if kind == STT_FUNC:
+            return CLASS_CODE
+        for cls, globs in self.patterns.items():
+            if any(fnmatch.fnmatchcase(name, glob) for glob in globs):
+                return cls
+        return CLASS_OTHER
+
+    def check(self, budget):
+        """List of (scope, name, key, used, limit) for every exceeded budget."""
+        over = []
+        scopes = [("total", {"image": self.total}, {"image": budget.get("total", {})}),
+                  ("class", self.classes, budget.get("class", {})),
+                  ("module", self.modules, budget.get("module", {}))]
+        for scope, usage, limits in scopes:
+            for name, limit in limits.items():
+                used = usage.get(name, new_usage())
+                for key in BUDGET_KEYS:
+                    if key in limit and used[key] > limit[key]:
+                        over.append((scope, name, key, used[key], limit[key]))
+        return over
+
+
+def load_budget(path):
+    with open(path, "rb") as stream:
+        budget = tomllib.load(stream)
+    tables = [("total", budget.get("total", {}))]
+    tables += [("%s.%s" % (scope, name), limit) for scope in ("class", "module")
+               for name, limit in budget.get(scope, {}).items()]
+    for header, limit in tables:
+        unknown = set(limit) - set(BUDGET_KEYS)
+        if unknown:
+            raise ValueError("%s: [%s] has unknown keys %s"
+                             % (path, header, ", ".join(sorted(unknown))))
+    return budget
+
+
+def print_table(title, rows, limits, out):
+    out.write("\n--- %s ---\n" % title)
+    out.write("%-28s %10s %10s %10s %10s\n" % ("", "RAM", "budget", "FLASH", "budget"))
+    for name, usage in rows:
+        limit = limits.get(name, {})
+        flag = any(key in limit and usage[key] > limit[key] for key in BUDGET_KEYS)
+        out.write("%-28s %10d %10s %10d %10s%s\n" % (
+            name, usage["ram"], limit.get("ram", "-"), usage["flash"], limit.get("flash", "-"),
+            "  OVER" if flag else ""))
+
+
+def report(footprint, elf_path, budget, top, out=sys.stdout):
+    out.write("=== Static footprint: %s ===\n" % elf_path)
+    print_table("Image", [("total", footprint.total)], {"total": budget.get("total", {})}, out)
+    for name, length in footprint.regions.items():
+        out.write("%-28s %10s\n" % ("region " + name, length))
+
+    modules = budget.get("module", {})
+
+    def by_size(item):
+        return -(item[1]["ram"] + item[1]["flash"]), item[0]
+
+    app = sorted(((name, usage) for name, usage in footprint.modules.items()
+                  if name in footprint.app_modules), key=by_size)
+    other = sorted(((name, usage) for name, usage in footprint.modules.items()
+                    if name not in footprint.app_modules), key=by_size)
+    print_table("Application modules", app, modules, out)
+    print_table("Libraries and linker", other, modules, out)
+    print_table("Symbol classes", footprint.classes.items(), budget.get("class", {}), out)
+
+    if top:
+        out.write("\n--- Largest symbols ---\n")
+        out.write("%10s %-5s %-20s %-8s %s\n" % ("bytes", "mem", "module", "class", "symbol"))
+        for size, name, module, cls, ram, flash in footprint.symbols[:top]:
+            mem = ("R" if ram else "") + ("F" if flash else "")
+            out.write("%10d %-5s %-20s %-8s %s\n" % (size, mem, module, cls, name))
+
+
+def suggest(footprint, margin, out=sys.stdout):
+    """Print a budget file with the current sizes plus a margin."""
+    def limit(value):
+        value = value * (100 + margin) // 100
+        return -(-value // SUGGEST_ROUNDING) * SUGGEST_ROUNDING
+
+    def entry(header, usage):
+        keys = ["%s = %d" % (key, limit(usage[key])) for key in BUDGET_KEYS if usage[key]]
+        if keys:
+            out.write("\n[%s]\n%s\n" % (header, "\n".join(keys)))
+
+    out.write("# Current footprint + %d%%, rounded up to %d bytes\n" % (margin, SUGGEST_ROUNDING))
+    entry("total", footprint.total)
+    for name, usage in footprint.classes.items():
+        if name != CLASS_OTHER:
+            entry("class.%s" % name, usage)
+    for name in sorted(footprint.app_modules):
+        entry("module.%s" % name, footprint.modules[name])
+
+
+def build_test_elf(sections, symbols):
+    """Minimal little-endian ELF32 (ARM) with the given sections and symbols."""
+    shstrtab, strtab = bytearray(b"\0"), bytearray(b"\0")
+
+    def intern(table, name):
+        offset = len(table)
+        table.extend(name.encode() + b"\0")
+        return offset
+
+    shdr = struct.Struct("<IIIIIIIIII")
+    headers = [shdr.pack(*[0] * 10)]
+    for name, stype, flags, addr, size in sections:
+        headers.append(shdr.pack(intern(shstrtab, name), stype, flags, addr, 0, size, 0, 0, 4, 0))
+
+    sym = struct.Struct("<IIIBBH")
+    symtab = bytearray(sym.pack(0, 0, 0, 0, 0, 0))
+    for name, value, size, kind, shndx in symbols:
+        symtab.extend(sym.pack(intern(strtab, name), value, size, 0x10 | kind, 0, shndx))
+
+    names = [intern(shstrtab, name) for name in (".symtab", ".strtab", ".shstrtab")]
+    body = bytearray(52)
+    offsets = []
+    for content in (symtab, strtab, shstrtab):
+        offsets.append(len(body))
+        body.extend(content)
+
+    first = len(headers)
+    headers.append(shdr.pack(names[0], SHT_SYMTAB, 0, 0, offsets[0], len(symtab),
+                             first + 1, 1, 4, sym.size))
+    headers.append(shdr.pack(names[1], 3, 0, 0, offsets[1], len(strtab), 0, 0, 1, 0))
+    headers.append(shdr.pack(names[2], 3, 0, 0, offsets[2], len(shstrtab), 0, 0, 1, 0))
+
+    shoff = len(body)
+    body[:52] = struct.pack("<4sBBBB8xHHIIIIIHHHHHH", b"\x7fELF", 1, 1, 1, 0, 2, EM_ARM, 1,
+                            0, 0, shoff, 0, 52, 0, 0, shdr.size, len(headers), first + 2)
+    for header in headers:
+        body.extend(header)
+    return bytes(body)
+
+
+SELFTEST_MAP = """\
+Discarded input sections
+
+ .text.unused   0x00000000       0x10 app/libapp.a(main.c.obj)
+
+Memory Configuration
+
+Name             Origin             Length             Attributes
+FLASH            0x0000c000         0x00076000         xr
+RAM              0x20000000         0x00040000         xw
+*default*        0x00000000         0xffffffff
+
+Linker script and memory map
+
+LOAD app/libapp.a
+text            0x0000c000      0x100
+ *(.text .text.*)
+ .text.main     0x0000c000       0x40 app/libapp.a(main.c.obj)
+                0x0000c000                main
+ .text.z_sched_wake_thread
+                0x0000c040       0x80 zephyr/kernel/libkernel.a(sched.c.obj)
+ *fill*         0x0000c0c0       0x40
+rodata          0x0000c100       0x40
+ .rodata.alert_thresholds
+                0x0000c100       0x20 app/libapp.a(medical_device.c.obj)
+ .rodata.main.str1.1
+                0x0000c120       0x20 app/libapp.a(main.c.obj)
+datas           0x20000000       0x20 load address 0x0000c140
+ .data.config_scalars
+                0x20000000       0x20 app/libapp.a(config.c.obj)
+bss             0x20000020       0x60
+ .bss.sensor_queue
+                0x20000020       0x40 app/libapp.a(medical_device.c.obj)
+ .bss.log_ring_buf
+                0x20000060       0x20 app/libapp.a(diagnostics.c.obj)
+noinit          0x20000080      0x800
+ .noinit."WEST_TOPDIR/app/src/thread_manager.c".0
+                0x20000080      0x400 app/libapp.a(thread_manager.c.obj)
+ .noinit."WEST_TOPDIR/zephyr/kernel/init.c".1
+                0x20000480      0x3f0 zephyr/kernel/libkernel.a(init.c.obj)
+/DISCARD/
+ *(.comment)
+"""
+
+
+def selftest():
+    """Attribute a synthetic image and check the budgets against it."""
+    alloc, write, text = SHF_ALLOC, SHF_ALLOC | SHF_WRITE, SHF_ALLOC | 0x4
+    sections = [("text", 1, text, 0xC000, 0x100), ("rodata", 1, alloc, 0xC100, 0x40),
+                ("datas", 1, write, 0x20000000, 0x20), ("bss", SHT_NOBITS, write, 0x20000020, 0x60),
+                ("noinit", SHT_NOBITS, write, 0x20000080, 0x800), (".comment", 1, 0, 0, 0x30)]
+    symbols = [("main", 0xC001, 0x40, STT_FUNC, 1),
+               ("z_sched_wake_thread", 0xC041, 0x80, STT_FUNC, 1),
+               ("alert_thresholds", 0xC100, 0x20, STT_OBJECT, 2),
+               ("config_scalars", 0x20000000, 0x20, STT_OBJECT, 3),
+               ("sensor_queue", 0x20000020, 0x40, STT_OBJECT, 4),
+               ("log_ring_buf", 0x20000060, 0x20, STT_OBJECT, 4),
+               ("data_acq_stack", 0x20000080, 0x400, STT_OBJECT, 5),
+               ("z_main_stack", 0x20000480, 0x3F0, STT_OBJECT, 5),
+               ("z_main_stack_alias", 0x20000480, 0x3F0, STT_OBJECT, 5)]
+    elf = Elf(build_test_elf(sections, symbols))
+    fp = Footprint(elf, SELFTEST_MAP, {"config": ["config_*"]})
+
+    assert fp.regions == {"FLASH": 0x76000, "RAM": 0x40000}, fp.regions
+    assert fp.total == {"ram": 0x880, "flash": 0x160}, fp.total
+    assert fp.app_modules == {"main", "medical_device", "config", "diagnostics", "thread_manager"}
+    assert fp.modules["main"] == {"ram": 0, "flash": 0x60}
+    assert fp.modules["config"] == {"ram": 0x20, "flash": 0x20}
+    assert fp.modules["thread_manager"] == {"ram": 0x400, "flash": 0}
+    assert fp.modules["libkernel"] == {"ram": 0x3F0, "flash": 0x80}
+    assert fp.modules[MODULE_FILL] == {"ram": 0, "flash": 0x40}
+    assert fp.modules[MODULE_UNATTRIBUTED] == {"ram": 0x10, "flash": 0}
+    assert sum(m["ram"] for m in fp.modules.values()) == fp.total["ram"]
+    assert sum(m["flash"] for m in fp.modules.values()) == fp.total["flash"]
+
+    assert fp.classes["stacks"] == {"ram": 0x7F0, "flash": 0}, fp.classes["stacks"]
+    assert fp.classes["queues"] == {"ram": 0x40, "flash": 0}
+    assert fp.classes["buffers"] == {"ram": 0x20, "flash": 0}
+    assert fp.classes["config"] == {"ram": 0x20, "flash": 0x20}
+    assert fp.classes[CLASS_CODE] == {"ram": 0, "flash": 0xC0}
+    assert fp.classes[CLASS_STRINGS] == {"ram": 0, "flash": 0x20}
+    assert fp.classes[CLASS_OTHER] == {"ram": 0x10, "flash": 0x60}
+    assert [s[1] for s in fp.symbols[:2]] == ["data_acq_stack", "z_main_stack"]
+    assert "sensor_queue" in {s[1] for s in fp.symbols if s[2] == "medical_device"}
+
+    budget = {"total": {"ram": 0x880, "flash": 0x15F},
+              "class": {"stacks": {"ram": 0x800}, "strings": {"flash": 0x1F}},
+              "module": {"thread_manager": {"ram": 0x3FF}, "retired_module": {"ram": 1}}}
+    over = fp.check(budget)
+    assert sorted(over) == [("class", "strings", "flash", 0x20, 0x1F),
+                            ("module", "thread_manager", "ram", 0x400, 0x3FF),
+                            ("total", "image", "flash", 0x160, 0x15F)], over
+
+    sink = _NullWriter()
+    report(fp, "selftest.elf", budget, 5, out=sink)
+    suggest(fp, 10, out=sink)
+    print("selftest: OK")
+
+
+class _NullWriter:
+    def write(self, _):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", nargs="?", help="linked image (build/zephyr/zephyr.elf)")
+    parser.add_argument("--map", help="linker map (default: the ELF path with .map)")
+    parser.add_argument("--budget", help="TOML budget file to check against")
+    parser.add_argument("--top", type=int, default=0, help="also list the N largest symbols")
+    parser.add_argument("--suggest", type=int, metavar="MARGIN",
+                        help="print a budget file of the current sizes plus MARGIN percent")
+    parser.add_argument("--selftest", action="store_true", help="run the attribution self-test")
+    args = parser.parse_args()
+
+    if args.selftest:
+        selftest()
+        return 0
+    if not args.elf:
+        parser.error("an ELF image is required")
+
+    map_path = args.map or os.path.splitext(args.elf)[0] + ".map"
+    try:
+        budget = load_budget(args.budget) if args.budget else {}
+        with open(args.elf, "rb") as stream:
+            elf = Elf(stream.read())
+        with open(map_path, encoding="utf-8", errors="replace") as stream:
+            footprint = Footprint(elf, stream.read(), budget.get("patterns"))
+    except (OSError, ValueError) as err:
+        sys.stderr.write("footprint: %s\n" % err)
+        return 2
+
+    if args.suggest is not None:
+        suggest(footprint, args.suggest)
+        return 0
+
+    report(footprint, args.elf, budget, args.top)
+
+    for name in budget.get("module", {}):
+        if name not in footprint.modules:
+            sys.stderr.write("footprint: warning: budget for module '%s', which is not in the image\n"
+                             % name)
+    over = footprint.check(budget)
+    for scope, name, key, used, limit in over:
+        sys.stderr.write("footprint: %s %s %s %d B exceeds budget %d B (+%d)\n"
+                         % (scope, name, key.upper(), used, limit, used - limit))
+    if over:
+        return 1
+    if budget:
+        print("\nfootprint: all budgets met")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
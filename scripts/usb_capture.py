@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""Capture the binary sensor stream from the wearable's second CDC-ACM port.
+
+Reads the raw record stream (a serial port via pyserial, a capture file, or
+stdin), resynchronises on the sync byte, and prints samples as CSV. Records
+lost on the device (full ring) show up as sequence gaps and are reported on
+stderr together with the achieved throughput.
+
+Wire format (see app/src/usb_stream.h), little-endian, 12 bytes per record:
+  record = [sync 0xA5][channel u8][flags u8][seq u8][timestamp_ms u32][value i32]
+
+Usage:
+  usb_capture.py --port /dev/ttyACM1 [--raw capture.bin] [--seconds N]
+  usb_capture.py capture.bin
+  usb_capture.py --selftest [--iterations N]
+"""
+
+import argparse
+import random
+import struct
+import sys
+import time
+
+SYNC = 0xA5
+RECORD = struct.Struct("<BBBBIi")
+
+CHANNEL_NAMES = [
+    "PPG_RED",
+    "PPG_IR",
+    "ACCEL_X",
+    "ACCEL_Y",
+    "ACCEL_Z",
+    "HEART_RATE",
+    "TEMPERATURE",
+    "MOTION",
+    "SPO2",
+]
+
+FLAG_NAMES = {0x01: "S", 0x02: "O", 0x04: "M"}
+
+
+def channel_name(channel):
+    if channel < len(CHANNEL_NAMES):
+        return CHANNEL_NAMES[channel]
+    return "CH%d" % channel
+
+
+def flag_string(flags):
+    return "".join(name for bit, name in sorted(FLAG_NAMES.items()) if flags & bit)
+
+
+def encode_record(channel, flags, seq, ts, value):
+    """Reference encoder mirroring usb_stream_publish() (used by selftest)."""
+    return RECORD.pack(SYNC, channel, flags, seq & 0xFF, ts & 0xFFFFFFFF, value)
+
+
+class RecordDecoder:
+    """Splits a byte stream into records, resyncing after corruption.
+
+    A candidate record is accepted when it starts with the sync byte and names
+    a known channel. Until the first record is accepted, the following record
+    must also start with the sync byte, so a stray 0xA5 inside a value does
+    not lock the decoder onto the wrong alignment.
+    """
+
+    def __init__(self):
+        self._buf = bytearray()
+        self.records = 0
+        self.resyncs = 0
+        self.lost = 0
+        self._next_seq = None
+
+    def feed(self, data):
+        self._buf += data
+        pos = 0
+        size = RECORD.size
+        while len(self._buf) - pos >= size:
+            if not self._plausible(pos):
+                pos += 1
+                self.resyncs += 1
+                continue
+            # Hold back the last record until the next sync byte confirms it
+            if self._next_seq is None and len(self._buf) - pos < 2 * size:
+                break
+            _, channel, flags, seq, ts, value = RECORD.unpack_from(self._buf, pos)
+            pos += size
+            if self._next_seq is not None and seq != self._next_seq:
+                self.lost += (seq - self._next_seq) & 0xFF
+            self._next_seq = (seq + 1) & 0xFF
+            self.records += 1
+            yield seq, channel, flags, ts, value
+        del self._buf[:pos]
+
+    def _plausible(self, pos):
+        if self._buf[pos] != SYNC or self._buf[pos + 1] >= len(CHANNEL_NAMES):
+            return False
+        nxt = pos + RECORD.size
+        if self._next_seq is None and nxt < len(self._buf):
+            return self._buf[nxt] == SYNC
+        return True
+
+
+def selftest(iterations, seed):
+    """Round-trip random records and feed corrupted streams to the decoder."""
+    rng = random.Random(seed)
+    seq = 0
+    for _ in range(iterations):
+        records = []
+        for _ in range(rng.randint(1, 64)):
+            records.append((seq & 0xFF, rng.randrange(len(CHANNEL_NAMES)), rng.randrange(8),
+                            rng.randint(0, 0xFFFFFFFF), rng.randint(-2**31, 2**31 - 1)))
+            seq += 1
+        stream = b"".join(encode_record(ch, fl, sq, ts, val) for sq, ch, fl, ts, val in records)
+
+        decoder = RecordDecoder()
+        got = []
+        for cut in range(0, len(stream), 7):  # arbitrary USB packet boundaries
+            got += decoder.feed(stream[cut:cut + 7])
+        got += decoder.feed(encode_record(0, 0, seq, 0, 0))  # confirms a lone record
+        expected = [(sq, ch, fl, ts, val) for sq, ch, fl, ts, val in records]
+        assert got[:len(expected)] == expected, "round-trip mismatch"
+        assert decoder.lost == 0 and decoder.resyncs == 0
+
+        corrupted = bytearray(stream)
+        for _ in range(rng.randint(1, 4)):
+            corrupted[rng.randrange(len(corrupted))] = rng.randrange(256)
+        decoder = RecordDecoder()
+        list(decoder.feed(bytes(rng.randrange(256) for _ in range(rng.randint(0, 11)))))
+        list(decoder.feed(bytes(corrupted) + stream))  # must never raise, must resync
+        assert decoder.records >= len(records) - 1
+    print("selftest: %d iterations OK (seed %d)" % (iterations, seed))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("--port", help="CDC-ACM port to read from (requires pyserial)")
+    parser.add_argument("--raw", help="also save the raw byte stream to this file")
+    parser.add_argument("--seconds", type=float, default=0.0,
+                        help="stop after this many seconds (port only, 0 = until Ctrl-C)")
+    parser.add_argument("--quiet", action="store_true", help="do not print CSV rows")
+    parser.add_argument("--selftest", action="store_true", help="run round-trip fuzz test")
+    parser.add_argument("--iterations", type=int, default=2000)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if args.selftest:
+        selftest(args.iterations, args.seed)
+        return 0
+
+    decoder = RecordDecoder()
+    raw = open(args.raw, "wb") if args.raw else None
+    total_bytes = 0
+    start = time.monotonic()
+
+    def consume(chunk):
+        if raw:
+            raw.write(chunk)
+        for seq, channel, flags, ts, value in decoder.feed(chunk):
+            if not args.quiet:
+                sys.stdout.write("%d,%d,%s,%s,%d\n"
+                                 % (seq, ts, channel_name(channel), flag_string(flags), value))
+
+    if not args.quiet:
+        print("seq,timestamp_ms,channel,flags,value")
+
+    if args.port:
+        import serial  # pylint: disable=import-outside-toplevel
+        # Opening the port raises DTR, which starts the stream on the device
+        with serial.Serial(args.port, timeout=0.1) as port:
+            try:
+                while not args.seconds or time.monotonic() - start < args.seconds:
+                    chunk = port.read(max(port.in_waiting, RECORD.size * 64))
+                    total_bytes += len(chunk)
+                    consume(chunk)
+            except KeyboardInterrupt:
+                pass
+    else:
+        stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+        with stream:
+            while True:
+                chunk = stream.read(65536)
+                if not chunk:
+                    break
+                total_bytes += len(chunk)
+                consume(chunk)
+
+    if raw:
+        raw.close()
+
+    elapsed = max(time.monotonic() - start, 1e-6)
+    sys.stderr.write("records=%d lost=%d resync_bytes=%d bytes=%d (%.1f KiB/s)\n"
+                     % (decoder.records, decoder.lost, decoder.resyncs, total_bytes,
+                        total_bytes / 1024.0 / elapsed))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+"""Decode the serial Bluetooth uplink of the medical wearable.
+
+Reads the raw byte stream (a capture file, stdin, or a serial port via
+pyserial), splits it into SLIP frames, validates version and CRC-16/CCITT,
+and prints vitals batches as CSV. Non-vitals frames are reported on stderr.
+
+Wire format (see app/src/serial_frame.h and app/src/vitals_frame.h):
+  frame   = SLIP( [version][type][seq][len][payload][crc16 LE] )
+  payload = [count u8][batch_seq u16][base_ts_ms u32]
+            count x [dt_ms u16][hr u8][temp_x10 i16][motion_x10 u16][spo2_x10 u16]
+
+Usage:
+  vitals_decode.py capture.bin
+  vitals_decode.py --port /dev/ttyACM1 --baud 115200
+  vitals_decode.py --selftest [--iterations N]
+"""
+
+import argparse
+import random
+import struct
+import sys
+
+SLIP_END, SLIP_ESC, SLIP_ESC_END, SLIP_ESC_ESC = 0xC0, 0xDB, 0xDC, 0xDD
+
+FRAME_VERSION = 1
+FRAME_HEADER = struct.Struct("<BBBB")
+FRAME_MAX_PAYLOAD = 128
+
+TYPE_NAMES = {
+    0x01: "ACK",
+    0x02: "NACK",
+    0x03: "PING",
+    0x10: "STATUS_REQUEST",
+    0x11: "STATUS",
+    0x20: "VITALS_BATCH",
+}
+TYPE_VITALS_BATCH = 0x20
+
+BATCH_HEADER = struct.Struct("<BHI")
+SAMPLE = struct.Struct("<HBhHH")
+
+
+class FrameError(ValueError):
+    """Raised for frames that fail validation."""
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE (poly 0x1021), matching Zephyr crc16_itu_t()."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class SlipDecoder:
+    """Incremental SLIP decoder yielding raw (unescaped) frame bodies."""
+
+    def __init__(self):
+        self._buf = bytearray()
+        self._escaped = False
+        self._discard = False
+        self.errors = 0
+
+    def feed(self, data):
+        for byte in data:
+            if byte == SLIP_END:
+                if self._buf and not self._discard:
+                    yield bytes(self._buf)
+                self._buf.clear()
+                self._escaped = False
+                self._discard = False
+            elif self._discard:
+                continue
+            elif byte == SLIP_ESC:
+                self._escaped = True
+            elif self._escaped:
+                self._escaped = False
+                if byte == SLIP_ESC_END:
+                    self._buf.append(SLIP_END)
+                elif byte == SLIP_ESC_ESC:
+                    self._buf.append(SLIP_ESC)
+                else:
+                    self.errors += 1
+                    self._discard = True
+            else:
+                self._buf.append(byte)
+
+
+def parse_frame(body):
+    """Validate a frame body; return (version, type, seq, payload)."""
+    if len(body) < FRAME_HEADER.size + 2:
+        raise FrameError("short frame (%d bytes)" % len(body))
+    version, ftype, seq, length = FRAME_HEADER.unpack_from(body)
+    if len(body) != FRAME_HEADER.size + length + 2:
+        raise FrameError("length mismatch")
+    (crc,) = struct.unpack_from("<H", body, len(body) - 2)
+    if crc16_ccitt(body[:-2]) != crc:
+        raise FrameError("CRC mismatch")
+    if version != FRAME_VERSION:
+        raise FrameError("unsupported version %d" % version)
+    return version, ftype, seq, body[FRAME_HEADER.size:-2]
+
+
+def decode_vitals(payload):
+    """Decode a VITALS_BATCH payload; return (batch_seq, [sample tuples])."""
+    if len(payload) < BATCH_HEADER.size:
+        raise FrameError("short vitals payload")
+    count, batch_seq, ts = BATCH_HEADER.unpack_from(payload)
+    if len(payload) != BATCH_HEADER.size + count * SAMPLE.size:
+        raise FrameError("vitals sample count mismatch")
+    samples = []
+    for i in range(count):
+        dt, hr, temp, motion, spo2 = SAMPLE.unpack_from(payload, BATCH_HEADER.size + i * SAMPLE.size)
+        ts = (ts + dt) & 0xFFFFFFFF
+        samples.append((ts, hr, temp / 10.0, motion / 10.0, spo2 / 10.0))
+    return batch_seq, samples
+
+
+def encode_frame(ftype, seq, payload):
+    """Reference encoder mirroring serial_frame_encode() (used by selftest)."""
+    body = FRAME_HEADER.pack(FRAME_VERSION, ftype, seq, len(payload)) + payload
+    body += struct.pack("<H", crc16_ccitt(body))
+    out = bytearray([SLIP_END])
+    for byte in body:
+        if byte == SLIP_END:
+            out += bytes([SLIP_ESC, SLIP_ESC_END])
+        elif byte == SLIP_ESC:
+            out += bytes([SLIP_ESC, SLIP_ESC_ESC])
+        else:
+            out.append(byte)
+    out.append(SLIP_END)
+    return bytes(out)
+
+
+def encode_vitals(batch_seq, samples):
+    """Reference encoder mirroring vitals_frame_encode()."""
+    base = samples[0][0]
+    out = bytearray(BATCH_HEADER.pack(len(samples), batch_seq, base))
+    prev = base
+    for ts, hr, temp, motion, spo2 in samples:
+        out += SAMPLE.pack((ts - prev) & 0xFFFFFFFF, hr, temp, motion, spo2)
+        prev = ts
+    return bytes(out)
+
+
+class StreamDecoder:
+    """Turns a byte stream into printed CSV rows and tracks batch gaps."""
+
+    def __init__(self, out=sys.stdout, log=sys.stderr):
+        self.slip = SlipDecoder()
+        self.out = out
+        self.log = log
+        self.next_batch_seq = None
+        self.frames = 0
+        self.bad_frames = 0
+        self.lost_batches = 0
+
+    def feed(self, data):
+        for body in self.slip.feed(data):
+            try:
+                _, ftype, seq, payload = parse_frame(body)
+                self.frames += 1
+                if ftype == TYPE_VITALS_BATCH:
+                    self._vitals(payload)
+                else:
+                    self.log.write("frame %s seq=%d len=%d\n"
+                                   % (TYPE_NAMES.get(ftype, hex(ftype)), seq, len(payload)))
+            except FrameError as err:
+                self.bad_frames += 1
+                self.log.write("dropped frame: %s\n" % err)
+
+    def _vitals(self, payload):
+        batch_seq, samples = decode_vitals(payload)
+        if self.next_batch_seq is not None and batch_seq != self.next_batch_seq:
+            self.lost_batches += (batch_seq - self.next_batch_seq) & 0xFFFF
+            self.log.write("batch gap: expected %d got %d\n" % (self.next_batch_seq, batch_seq))
+        self.next_batch_seq = (batch_seq + 1) & 0xFFFF
+        for ts, hr, temp, motion, spo2 in samples:
+            self.out.write("%d,%d,%d,%.1f,%.1f,%.1f\n" % (batch_seq, ts, hr, temp, motion, spo2))
+
+
+def random_batch(rng):
+    count = rng.randint(1, (FRAME_MAX_PAYLOAD - BATCH_HEADER.size) // SAMPLE.size)
+    ts = rng.randint(0, 0xFFFF0000)
+    samples = []
+    for _ in range(count):
+        ts += rng.randint(0, 0xFFFF)
+        samples.append((ts & 0xFFFFFFFF, rng.randint(0, 255), rng.randint(-32768, 32767),
+                        rng.randint(0, 0xFFFF), rng.randint(0, 0xFFFF)))
+    return samples
+
+
+def selftest(iterations, seed):
+    """Round-trip random batches and feed corrupted streams to the decoder."""
+    rng = random.Random(seed)
+    for i in range(iterations):
+        samples = random_batch(rng)
+        frame = encode_frame(TYPE_VITALS_BATCH, i & 0xFF, encode_vitals(i & 0xFFFF, samples))
+        bodies = list(SlipDecoder().feed(frame))
+        assert len(bodies) == 1, "expected one frame"
+        _, ftype, seq, payload = parse_frame(bodies[0])
+        assert ftype == TYPE_VITALS_BATCH and seq == i & 0xFF
+        batch_seq, decoded = decode_vitals(payload)
+        assert batch_seq == i & 0xFFFF
+        for (ts, hr, temp, motion, spo2), got in zip(samples, decoded):
+            assert got[0] == ts and got[1] == hr
+            assert round(got[2] * 10) == temp and round(got[3] * 10) == motion
+            assert round(got[4] * 10) == spo2
+
+        corrupted = bytearray(frame)
+        for _ in range(rng.randint(1, 4)):
+            corrupted[rng.randrange(len(corrupted))] = rng.randrange(256)
+        sink = StreamDecoder(out=_NullWriter(), log=_NullWriter())
+        sink.feed(bytes(corrupted) + frame)  # must never raise, must resync
+        assert sink.frames >= 1
+    print("selftest: %d iterations OK (seed %d)" % (iterations, seed))
+
+
+class _NullWriter:
+    def write(self, _):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("--port", help="serial port to read from (requires pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--selftest", action="store_true", help="run round-trip fuzz test")
+    parser.add_argument("--iterations", type=int, default=2000)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if args.selftest:
+        selftest(args.iterations, args.seed)
+        return 0
+
+    decoder = StreamDecoder()
+    print("batch_seq,timestamp_ms,heart_rate_bpm,temperature_c,motion_g,spo2_pct")
+
+    if args.port:
+        import serial  # pylint: disable=import-outside-toplevel
+        with serial.Serial(args.port, args.baud, timeout=0.5) as port:
+            try:
+                while True:
+                    decoder.feed(port.read(256))
+                    sys.stdout.flush()
+            except KeyboardInterrupt:
+                pass
+    else:
+        stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+        with stream:
+            while True:
+                chunk = stream.read(4096)
+                if not chunk:
+                    break
+                decoder.feed(chunk)
+
+    sys.stderr.write("frames=%d bad=%d lost_batches=%d slip_errors=%d\n"
+                     % (decoder.frames, decoder.bad_frames, decoder.lost_batches,
+                        decoder.slip.errors))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())